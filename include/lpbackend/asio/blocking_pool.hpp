@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+namespace lpbackend::asio
+{
+/** @brief A small thread pool for blocking system calls, such as opening
+    and reading files, that must not stall the threads of an io_context.
+
+    Completions are delivered through the executor associated with the
+    completion handler, so a coroutine resumes on its own strand. The pool
+    reports its queue depth and the time tasks wait and run.
+*/
+class blocking_pool
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct statistics
+    {
+        std::uint64_t completed;
+        std::uint64_t depth;
+        std::uint64_t peak_depth;
+        std::chrono::nanoseconds total_wait;
+        std::chrono::nanoseconds max_wait;
+        std::chrono::nanoseconds total_run;
+    };
+
+  private:
+    std::optional<boost::asio::thread_pool> pool_;
+    std::atomic<bool> stopped_{false};
+    std::atomic<std::uint64_t> completed_{};
+    std::atomic<std::uint64_t> depth_{};
+    std::atomic<std::uint64_t> peak_depth_{};
+    std::atomic<std::int64_t> total_wait_ns_{};
+    std::atomic<std::int64_t> max_wait_ns_{};
+    std::atomic<std::int64_t> total_run_ns_{};
+
+    template <typename T> static void update_max(std::atomic<T> &target, const T value) noexcept
+    {
+        auto current{target.load(std::memory_order_relaxed)};
+        while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+  public:
+    /** @brief Starts the worker threads, must be called before any task is run
+
+        @param threads Number of worker threads, at least one is started.
+    */
+    inline void start(const std::size_t threads)
+    {
+        pool_.emplace(std::max<std::size_t>(threads, 1));
+    }
+
+    /** @brief Stops accepting tasks and joins the worker threads once the
+        queued tasks are done, so every waiting completion is invoked
+
+        Tasks run after this fail with boost::asio::error::operation_aborted.
+    */
+    inline void stop()
+    {
+        if (pool_ && !stopped_.exchange(true, std::memory_order_acq_rel))
+        {
+            pool_->join();
+        }
+    }
+
+    /** @brief Runs a function on a worker thread
+
+        @param function Invoked without arguments on a worker thread, its
+        result must be default constructible.
+        @param token Completion token with signature
+        `void(std::exception_ptr, R)`, where R is the result of the function.
+        An exception thrown by the function is passed to the completion, as
+        is boost::system::system_error with operation_aborted if the pool is
+        stopped.
+
+        @par Thread Safety
+        @e Distinct @e objects: Safe.@n
+        @e Shared @e objects: Safe.
+    */
+    template <typename Function, typename CompletionToken = boost::asio::deferred_t>
+    inline auto async_run(Function function, CompletionToken &&token = {})
+    {
+        using result_type = std::invoke_result_t<Function &>;
+        return boost::asio::async_initiate<CompletionToken, void(std::exception_ptr, result_type)>(
+            [this](auto handler, Function function) {
+                if (stopped_.load(std::memory_order_acquire))
+                {
+                    const auto executor{boost::asio::get_associated_executor(handler)};
+                    boost::asio::post(executor, [handler = std::move(handler)]() mutable {
+                        std::move(handler)(std::make_exception_ptr(boost::system::system_error{
+                                               boost::asio::error::operation_aborted}),
+                                           result_type{});
+                    });
+                    return;
+                }
+                const auto queued{clock_type::now()};
+                update_max(peak_depth_, depth_.fetch_add(1, std::memory_order_relaxed) + 1);
+                auto work{boost::asio::make_work_guard(boost::asio::get_associated_executor(handler))};
+                boost::asio::post(*pool_, [this, queued, handler = std::move(handler), work = std::move(work),
+                                           function = std::move(function)]() mutable {
+                    const auto started{clock_type::now()};
+                    std::exception_ptr eptr{};
+                    result_type result{};
+                    try
+                    {
+                        result = function();
+                    }
+                    catch (...)
+                    {
+                        eptr = std::current_exception();
+                    }
+                    const auto finished{clock_type::now()};
+
+                    const auto wait{std::chrono::duration_cast<std::chrono::nanoseconds>(started - queued).count()};
+                    total_wait_ns_.fetch_add(wait, std::memory_order_relaxed);
+                    update_max(max_wait_ns_, static_cast<std::int64_t>(wait));
+                    total_run_ns_.fetch_add(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started).count(),
+                        std::memory_order_relaxed);
+                    completed_.fetch_add(1, std::memory_order_relaxed);
+                    depth_.fetch_sub(1, std::memory_order_relaxed);
+
+                    auto executor{work.get_executor()};
+                    work.reset();
+                    boost::asio::post(executor,
+                                      [handler = std::move(handler), eptr, result = std::move(result)]() mutable {
+                                          std::move(handler)(eptr, std::move(result));
+                                      });
+                });
+            },
+            token, std::move(function));
+    }
+
+    /** @brief Returns the counters since the last call, the current depth is
+        not reset
+    */
+    inline statistics collect() noexcept
+    {
+        return statistics{.completed = completed_.exchange(0, std::memory_order_relaxed),
+                          .depth = depth_.load(std::memory_order_relaxed),
+                          .peak_depth = peak_depth_.exchange(depth_.load(std::memory_order_relaxed),
+                                                             std::memory_order_relaxed),
+                          .total_wait = std::chrono::nanoseconds{total_wait_ns_.exchange(0, std::memory_order_relaxed)},
+                          .max_wait = std::chrono::nanoseconds{max_wait_ns_.exchange(0, std::memory_order_relaxed)},
+                          .total_run = std::chrono::nanoseconds{total_run_ns_.exchange(0, std::memory_order_relaxed)}};
+    }
+};
+} // namespace lpbackend::asio
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::asio
+{
+/**
+ * @brief Per-thread caches of freed memory blocks, sorted into 64-byte size classes
+ *
+ * Blocks are returned to the cache of the thread that frees them, so a
+ * handler that completes on another thread still recycles its memory.
+ * Blocks larger than the largest class or with extended alignment go to
+ * the global allocator and are counted as bypassed, misses only count
+ * blocks that could have come from a free list.
+ */
+class LPBACKEND_EXTERN recycling_pool
+{
+  public:
+    static constexpr std::size_t class_bytes{64};
+    static constexpr std::size_t max_classes{256};
+
+    struct statistics
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        // blocks that are never recycled, so they are no misses
+        std::uint64_t bypassed;
+        std::size_t cached_bytes;
+    };
+
+    /**
+     * @brief Sets the limits of the caches, must be called before any thread allocates
+     *
+     * @param max_block_bytes largest block that is recycled, rounded up to a size class
+     * @param blocks_per_class blocks kept per size class and thread, 0 disables recycling
+     */
+    static void configure(std::size_t max_block_bytes, std::size_t blocks_per_class) noexcept;
+
+    static void *allocate(std::size_t size, std::size_t alignment);
+    static void deallocate(void *pointer, std::size_t size, std::size_t alignment) noexcept;
+
+    /**
+     * @brief Asks every thread to free its cached blocks, which happens on its next allocation or deallocation
+     */
+    static void trim() noexcept;
+
+    /**
+     * @brief Returns the bytes currently cached by all threads
+     */
+    static std::size_t cached_bytes();
+
+    /**
+     * @brief Returns the counters of all threads since the last call
+     */
+    static statistics collect();
+};
+
+/**
+ * @brief A stateless allocator on top of recycling_pool for completion handlers and containers
+ */
+template <typename T> class recycling_allocator
+{
+  public:
+    using value_type = T;
+
+    recycling_allocator() noexcept = default;
+
+    template <typename U> recycling_allocator(const recycling_allocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(const std::size_t n)
+    {
+        return static_cast<T *>(recycling_pool::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *const pointer, const std::size_t n) noexcept
+    {
+        recycling_pool::deallocate(pointer, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U> bool operator==(const recycling_allocator<U> &) const noexcept
+    {
+        return true;
+    }
+};
+
+/**
+ * @brief A completion token that returns the results as a tuple and allocates handlers from recycling_pool
+ */
+inline const auto recycled_tuple{boost::asio::as_tuple(boost::asio::bind_allocator(recycling_allocator<void>{}))};
+} // namespace lpbackend::asio
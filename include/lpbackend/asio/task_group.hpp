@@ -27,6 +27,8 @@
 
 #include <boost/asio.hpp>
 
+#include <lpbackend/asio/recycling_allocator.hpp>
+
 namespace lpbackend::asio
 {
 /** @brief A thread-safe task group that tracks child tasks, allows emitting
@@ -36,7 +38,8 @@ class task_group
 {
     std::mutex mutex_;
     boost::asio::steady_timer timer_;
-    std::list<boost::asio::cancellation_signal> signals_;
+    // a node is allocated for every child task, so nodes are recycled
+    std::list<boost::asio::cancellation_signal, recycling_allocator<boost::asio::cancellation_signal>> signals_;
 
   public:
     explicit inline task_group(const boost::asio::any_io_executor exec)
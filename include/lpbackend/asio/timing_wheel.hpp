@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace lpbackend::asio
+{
+/** @brief A hierarchical timing wheel that multiplexes coarse-grained timeouts
+    onto a single steady_timer.
+
+    Scheduling, cancelling and resetting a timer are O(1). The wheel is
+    driven by `run()`, which owns the only Asio timer used by the wheel.
+    Expired handlers are posted to the executor their timer was created with.
+*/
+class timing_wheel
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+    using duration = clock_type::duration;
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    static constexpr std::size_t slot_bits{6};
+    static constexpr std::size_t slots_per_level{std::size_t{1} << slot_bits};
+    static constexpr std::size_t levels{4};
+
+  private:
+    struct node : std::enable_shared_from_this<node>
+    {
+        node *prev{};
+        node *next{};
+        node **bucket{};
+        std::uint64_t expiry{};
+        std::uint64_t generation{};
+        boost::asio::any_io_executor executor;
+        std::function<void()> handler;
+
+        explicit node(boost::asio::any_io_executor exec) : executor{std::move(exec)}
+        {
+        }
+    };
+
+    std::mutex mutex_;
+    const duration tick_;
+    const clock_type::time_point start_;
+    std::uint64_t current_{};
+    std::array<std::array<node *, slots_per_level>, levels> slots_{};
+
+    static constexpr std::uint64_t slot_mask{slots_per_level - 1};
+    static constexpr std::uint64_t horizon{std::uint64_t{1} << (slot_bits * levels)};
+
+    // Must be called with mutex_ held
+    void link(node &n) noexcept
+    {
+        auto delta{n.expiry - current_};
+        if (delta >= horizon)
+        {
+            n.expiry = current_ + horizon - 1;
+            delta = horizon - 1;
+        }
+        std::size_t level{};
+        while (delta >= (std::uint64_t{1} << (slot_bits * (level + 1))))
+        {
+            ++level;
+        }
+        auto &head{slots_[level][(n.expiry >> (slot_bits * level)) & slot_mask]};
+        n.prev = nullptr;
+        n.next = head;
+        n.bucket = &head;
+        if (head)
+        {
+            head->prev = &n;
+        }
+        head = &n;
+    }
+
+    // Must be called with mutex_ held
+    static void unlink(node &n) noexcept
+    {
+        if (!n.bucket)
+        {
+            return;
+        }
+        if (n.prev)
+        {
+            n.prev->next = n.next;
+        }
+        else
+        {
+            *n.bucket = n.next;
+        }
+        if (n.next)
+        {
+            n.next->prev = n.prev;
+        }
+        n.prev = n.next = nullptr;
+        n.bucket = nullptr;
+    }
+
+    // Must be called with mutex_ held
+    void cascade(const std::size_t level) noexcept
+    {
+        auto &head{slots_[level][(current_ >> (slot_bits * level)) & slot_mask]};
+        auto *n{std::exchange(head, nullptr)};
+        while (n)
+        {
+            auto *next{n->next};
+            n->bucket = nullptr;
+            link(*n);
+            n = next;
+        }
+    }
+
+    void schedule(node &n, const duration timeout)
+    {
+        auto ticks{static_cast<std::uint64_t>((timeout + tick_ - duration{1}) / tick_)};
+        std::lock_guard lock{mutex_};
+        unlink(n);
+        ++n.generation;
+        n.expiry = current_ + std::max<std::uint64_t>(ticks, 1);
+        link(n);
+    }
+
+    void cancel(node &n)
+    {
+        std::lock_guard lock{mutex_};
+        unlink(n);
+        ++n.generation;
+    }
+
+    void advance(const clock_type::time_point now)
+    {
+        std::vector<std::pair<std::shared_ptr<node>, std::uint64_t>> expired{};
+        {
+            std::lock_guard lock{mutex_};
+            const auto target{static_cast<std::uint64_t>((now - start_) / tick_)};
+            while (current_ < target)
+            {
+                ++current_;
+                for (std::size_t level{1}; level < levels; ++level)
+                {
+                    if (current_ & ((std::uint64_t{1} << (slot_bits * level)) - 1))
+                    {
+                        break;
+                    }
+                    cascade(level);
+                }
+                auto *n{std::exchange(slots_[0][current_ & slot_mask], nullptr)};
+                while (n)
+                {
+                    auto *next{n->next};
+                    n->prev = n->next = nullptr;
+                    n->bucket = nullptr;
+                    expired.emplace_back(n->shared_from_this(), n->generation);
+                    n = next;
+                }
+            }
+        }
+
+        for (auto &[n, generation] : expired)
+        {
+            auto executor{n->executor};
+            boost::asio::post(std::move(executor), [n = std::move(n), generation] {
+                // the generation is only modified on this executor, so a
+                // reschedule or cancellation after expiry is observed here
+                if (n->generation == generation && n->handler)
+                {
+                    n->handler();
+                }
+            });
+        }
+    }
+
+  public:
+    /** @brief A handle to a timeout registered on a timing_wheel.
+
+        A timer must only be used from the executor it was created with, and
+        its handler is invoked on that executor. Destroying the timer cancels
+        any pending expiry.
+    */
+    class timer
+    {
+        timing_wheel *wheel_;
+        std::shared_ptr<node> node_;
+        duration timeout_{};
+
+      public:
+        inline timer(timing_wheel &wheel, boost::asio::any_io_executor executor)
+            : wheel_{&wheel}, node_{std::make_shared<node>(std::move(executor))}
+        {
+        }
+
+        /** @brief Sets the handler and (re)schedules the timer to expire after the timeout.
+         */
+        template <typename Handler> inline void expires_after(const duration timeout, Handler &&handler)
+        {
+            node_->handler = std::forward<Handler>(handler);
+            expires_after(timeout);
+        }
+
+        /** @brief (Re)schedules the timer to expire after the timeout.
+         */
+        inline void expires_after(const duration timeout)
+        {
+            timeout_ = timeout;
+            wheel_->schedule(*node_, timeout);
+        }
+
+        /** @brief Reschedules the timer with the timeout it was last scheduled with.
+         */
+        inline void reset()
+        {
+            wheel_->schedule(*node_, timeout_);
+        }
+
+        /** @brief Cancels the pending expiry, if any.
+         */
+        inline void cancel()
+        {
+            wheel_->cancel(*node_);
+        }
+
+        inline ~timer()
+        {
+            cancel();
+        }
+
+        timer(const timer &) = delete;
+        timer &operator=(const timer &) = delete;
+    };
+
+    explicit inline timing_wheel(const duration tick = std::chrono::milliseconds{100})
+        : tick_{tick}, start_{clock_type::now()}
+    {
+    }
+
+    /** @brief Drives the wheel until cancelled.
+     */
+    boost::asio::awaitable<void, executor_type> run()
+    {
+        auto state{co_await boost::asio::this_coro::cancellation_state};
+        auto executor{co_await boost::asio::this_coro::executor};
+        co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+
+        boost::asio::steady_timer timer{executor};
+        auto next{start_};
+        while (!state.cancelled())
+        {
+            next += tick_;
+            timer.expires_at(next);
+            auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+            if (ec == boost::asio::error::operation_aborted)
+            {
+                co_return;
+            }
+
+            const auto now{clock_type::now()};
+            advance(now);
+            if (now - next > tick_) // fell behind, skip the missed ticks
+            {
+                next = now;
+            }
+        }
+    }
+
+    timing_wheel(const timing_wheel &) = delete;
+    timing_wheel &operator=(const timing_wheel &) = delete;
+};
+} // namespace lpbackend::asio
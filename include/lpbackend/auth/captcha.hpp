@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::auth
+{
+struct captcha_options
+{
+    std::size_t width{160};
+    std::size_t height{60};
+    std::size_t length{5};
+    int quality{60};
+};
+
+/**
+ * @brief A rendered captcha and the text it shows
+ */
+struct captcha
+{
+    std::string answer;
+    std::string jpeg;
+};
+
+/**
+ * @brief Renders random text as a distorted grayscale JPEG
+ *
+ * The text is drawn from 32 characters that cannot be mistaken for each
+ * other, chosen with OpenSSL's generator. Every glyph is scaled, rotated
+ * and sheared on its own, then the image is warped by two sine waves and
+ * crossed by noise curves. Rendering takes a few milliseconds of CPU time,
+ * so it must not run on an I/O thread.
+ *
+ * @throws std::runtime_error if no random text can be generated
+ */
+LPBACKEND_EXTERN captcha render_captcha(const captcha_options &options);
+} // namespace lpbackend::auth
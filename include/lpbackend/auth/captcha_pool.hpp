@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/auth/captcha.hpp>
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+#include <lpbackend/log.hpp>
+
+namespace lpbackend::auth
+{
+/**
+ * @brief Captchas rendered ahead of time by worker threads
+ *
+ * Requests only pop a finished captcha, so no I/O thread ever renders or
+ * encodes an image. run() tops the pool up at a bounded rate, which caps
+ * the CPU time a flood of registrations can take; while the flood lasts
+ * the pool runs empty and requests are turned away instead.
+ */
+class LPBACKEND_EXTERN captcha_pool
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    /**
+     * @brief A captcha ready to be sent, the image is a data URI
+     */
+    struct entry
+    {
+        std::string answer;
+        std::string data_uri;
+    };
+
+    struct statistics
+    {
+        std::uint64_t rendered;
+        std::uint64_t served;
+        std::uint64_t exhausted;
+        std::size_t ready;
+    };
+
+  private:
+    logger lg_{channel_logger("captcha_pool")};
+    captcha_options options_{};
+    std::size_t capacity_{};
+    double refill_per_second_{};
+    std::optional<boost::asio::thread_pool> workers_;
+
+    std::mutex mutex_;
+    std::deque<entry> ready_;
+    // posted to the workers and not yet finished
+    std::size_t rendering_{};
+
+    std::atomic<std::uint64_t> rendered_{};
+    std::atomic<std::uint64_t> served_{};
+    std::atomic<std::uint64_t> exhausted_{};
+
+    void render_one();
+
+  public:
+    /**
+     * @brief Applies the configuration and starts the worker threads
+     */
+    void start(const config::lpbackend_config::fields_t::auth_t &auth);
+
+    /**
+     * @brief Refills the pool until cancelled
+     */
+    boost::asio::awaitable<void, executor_type> run();
+
+    /**
+     * @brief Joins the worker threads, captchas being rendered are dropped
+     */
+    void stop();
+
+    /**
+     * @brief Takes a captcha out of the pool
+     *
+     * @return std::nullopt if the pool is empty
+     */
+    std::optional<entry> pop();
+
+    /**
+     * @brief Returns the counters since the last call
+     */
+    statistics collect();
+
+    ~captcha_pool();
+};
+} // namespace lpbackend::auth
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::auth
+{
+/**
+ * @brief Cost of an Argon2id hash
+ */
+struct argon2_params
+{
+    std::uint32_t memory_kib{19456};
+    std::uint32_t iterations{2};
+    std::uint32_t parallelism{1};
+};
+
+/**
+ * @brief Computes an Argon2id (version 1.3) tag as specified by RFC 9106
+ *
+ * The lanes are filled one after another on the calling thread, a hash
+ * takes tens of milliseconds at the default cost.
+ *
+ * @throws std::invalid_argument if the parameters or lengths are out of range
+ */
+LPBACKEND_EXTERN std::string argon2id(std::string_view password, std::string_view salt, const argon2_params &params,
+                                      std::size_t tag_length);
+
+/**
+ * @brief Hashes a password with a random 16-byte salt
+ *
+ * @return the PHC string "$argon2id$v=19$m=<kib>,t=<iterations>,p=<lanes>$<salt>$<tag>"
+ * @throws std::runtime_error if no salt can be generated
+ */
+LPBACKEND_EXTERN std::string hash_password(std::string_view password, const argon2_params &params);
+
+/**
+ * @brief Checks a password against a string made by hash_password, using the cost stored in it
+ *
+ * @return false as well if the string is malformed
+ */
+LPBACKEND_EXTERN bool verify_password(std::string_view password, std::string_view encoded);
+} // namespace lpbackend::auth
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/asio/blocking_pool.hpp>
+#include <lpbackend/auth/password_hash.hpp>
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::auth
+{
+/**
+ * @brief Runs password hashes on threads of their own with bounded admission
+ *
+ * At most max_concurrent_password_hashes hashes run at once and at most
+ * password_hash_queue_depth more wait for a thread. Further requests are
+ * refused at once instead of queueing, so a burst of logins slows down
+ * logins but neither the I/O threads nor the blocking pool that serves
+ * files.
+ */
+class LPBACKEND_EXTERN password_hasher
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    struct statistics
+    {
+        std::uint64_t hashed;
+        std::uint64_t verified;
+        std::uint64_t rejected;
+        asio::blocking_pool::statistics workers;
+    };
+
+  private:
+    argon2_params params_{};
+    std::size_t limit_{};
+    // running or waiting for a thread
+    std::atomic<std::size_t> admitted_{};
+    std::atomic<std::uint64_t> hashed_{};
+    std::atomic<std::uint64_t> verified_{};
+    std::atomic<std::uint64_t> rejected_{};
+    asio::blocking_pool workers_;
+
+    bool admit() noexcept;
+
+  public:
+    /**
+     * @brief Applies the configuration and starts the worker threads
+     *
+     * @throws std::invalid_argument if the cost is out of range
+     */
+    void start(const config::lpbackend_config::fields_t::auth_t &auth);
+
+    /**
+     * @brief Joins the worker threads
+     */
+    void stop();
+
+    /**
+     * @brief Hashes a password with the configured cost, the copy of the password is wiped afterwards
+     *
+     * @return the PHC string of the hash, std::nullopt if too many hashes are pending
+     */
+    boost::asio::awaitable<std::optional<std::string>, executor_type> hash(std::string password);
+
+    /**
+     * @brief Checks a password against a PHC string made by hash()
+     *
+     * @return whether the password matches, std::nullopt if too many hashes are pending
+     */
+    boost::asio::awaitable<std::optional<bool>, executor_type> verify(std::string password, std::string encoded);
+
+    /**
+     * @brief Returns the counters since the last call
+     */
+    statistics collect() noexcept;
+
+    ~password_hasher();
+};
+} // namespace lpbackend::auth
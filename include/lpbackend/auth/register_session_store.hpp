@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::auth
+{
+/**
+ * @brief State of a registration between the captcha and the account creation
+ */
+struct register_session
+{
+    std::string captcha_answer;
+};
+
+/**
+ * @brief Register sessions keyed by random IDs, each one can be taken once before it expires
+ *
+ * Sessions are spread over cache-line-aligned shards by their ID, which is
+ * random, so concurrent requests rarely contend for a shard. Expired
+ * sessions are dropped when they are looked up and by sweep(). Every
+ * session lives for the same TTL, so each shard keeps its expiry order in
+ * a queue and a sweep only ever looks at sessions that did expire.
+ */
+class LPBACKEND_EXTERN register_session_store
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+
+    // IDs carry 128 random bits and are written as 32 lowercase hex digits
+    static constexpr std::size_t id_bytes{16};
+    static constexpr std::size_t id_length{2 * id_bytes};
+
+    struct statistics
+    {
+        std::uint64_t created;
+        std::uint64_t taken;
+        std::uint64_t expired;
+        std::uint64_t rejected;
+        std::size_t sessions;
+    };
+
+  private:
+    using session_id = std::array<std::uint8_t, id_bytes>;
+
+    struct id_hash
+    {
+        std::size_t operator()(const session_id &id) const noexcept
+        {
+            // the bytes are random already, the first ones select the shard
+            std::uint64_t hash{};
+            std::memcpy(&hash, id.data() + 8, sizeof(hash));
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    struct entry
+    {
+        register_session session;
+        clock_type::time_point expires;
+    };
+
+    static constexpr std::size_t shard_count{64};
+    static constexpr std::size_t cache_line_bytes{64};
+    // expired sessions removed per lock acquisition of a sweep
+    static constexpr std::size_t sweep_batch{256};
+    // queues shorter than this are not compacted
+    static constexpr std::size_t min_compact_expiry{64};
+
+    struct alignas(cache_line_bytes) shard
+    {
+        std::mutex mutex;
+        std::unordered_map<session_id, entry, id_hash> sessions;
+        // sessions in creation order, which is their expiry order; taken sessions are skipped lazily and pruned
+        // once they make up half of the queue, so it stays bounded while sessions are taken faster than they expire
+        std::deque<std::pair<clock_type::time_point, session_id>> expiry;
+
+        std::size_t drop_expired(clock_type::time_point now, std::size_t limit);
+        void compact_expiry();
+    };
+
+    std::array<shard, shard_count> shards_{};
+    clock_type::duration ttl_{std::chrono::minutes{5}};
+    std::size_t max_sessions_per_shard_{1024};
+
+    std::atomic<std::uint64_t> created_{};
+    std::atomic<std::uint64_t> taken_{};
+    std::atomic<std::uint64_t> expired_{};
+    std::atomic<std::uint64_t> rejected_{};
+
+    static session_id random_id();
+    static std::optional<session_id> parse_id(std::string_view id);
+    static std::string format_id(const session_id &id);
+
+    shard &shard_of(const session_id &id) noexcept;
+
+  public:
+    void configure(const config::lpbackend_config::fields_t::auth_t &auth);
+
+    std::chrono::seconds ttl() const noexcept;
+
+    /**
+     * @brief Stores a session under a new random ID
+     *
+     * @return the ID, or std::nullopt if the shard of the ID is full of unexpired sessions
+     * @throws std::runtime_error if no random ID can be generated
+     */
+    std::optional<std::string> create(register_session session);
+
+    /**
+     * @brief Removes a session and returns it, unless it does not exist or expired
+     */
+    std::optional<register_session> take(std::string_view id);
+
+    /**
+     * @brief Removes expired sessions from every shard
+     *
+     * @return the number of removed sessions
+     */
+    std::size_t sweep();
+
+    /**
+     * @brief Returns the counters since the last call
+     */
+    statistics collect();
+};
+} // namespace lpbackend::auth
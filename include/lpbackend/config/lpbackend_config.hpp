@@ -27,7 +27,9 @@
 #include <boost/url.hpp>
 
 #include <filesystem>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <lpbackend/config/config.hpp>
 #include <lpbackend/log.hpp>
@@ -47,12 +49,48 @@ class lpbackend_config : public config
         struct logging_t
         {
             bool color_logging{true};
+            std::uint64_t statistics_interval_seconds{300};
         } logging;
 
         struct networking_t
         {
-            std::string listen_address{"0.0.0.0"};
-            boost::asio::ip::port_type listen_port{443};
+            struct listener_t
+            {
+                // "auto" detects TLS on every connection and honours ssl.force_ssl, "https" and "http" only accept
+                // their protocol, "redirect" answers every request with a redirect to HTTPS
+                std::string protocol{"auto"};
+                // "::" falls back to "0.0.0.0" on hosts without IPv6
+                std::string address{"::"};
+                boost::asio::ip::port_type port{443};
+                // an IPv6 address also accepts IPv4 unless this is set
+                bool v6_only{false};
+                // listens on an AF_UNIX stream socket at this path instead of address and port
+                std::filesystem::path unix_socket{};
+                // the host of redirect locations, the Host header of the request if empty
+                std::string redirect_host{};
+                boost::asio::ip::port_type redirect_port{443};
+                // the name of an entry in socket_profiles
+                std::string socket_profile{"default"};
+            };
+
+            struct socket_profile_t
+            {
+                std::string name{"default"};
+                bool no_delay{true};
+                std::uint64_t defer_accept_seconds{5};
+                std::uint64_t fast_open_queue{0};
+                // 0 keeps the default of the system
+                std::uint64_t receive_buffer_bytes{0};
+                std::uint64_t send_buffer_bytes{0};
+                std::uint64_t not_sent_lowat_bytes{0};
+                // -1 keeps the connections on the CPU that accepted them
+                std::int64_t incoming_cpu{-1};
+            };
+
+            std::vector<listener_t> listeners{listener_t{}};
+            std::vector<socket_profile_t> socket_profiles{
+                socket_profile_t{},
+                socket_profile_t{.name = "low_latency", .fast_open_queue = 256, .not_sent_lowat_bytes = 16384}};
             boost::urls::url mime_database_url{"https://cdn.jsdelivr.net/gh/jshttp/mime-db@master/db.json"};
         } networking;
 
@@ -62,18 +100,117 @@ class lpbackend_config : public config
             std::filesystem::path private_key{"./ssl/key.pem"};
             std::filesystem::path tmp_dh{"./ssl/dh.pem"};
             bool force_ssl{false};
+            std::uint64_t session_cache_size{20480};
+            std::uint64_t session_timeout_seconds{7200};
+            bool session_tickets{true};
+            std::filesystem::path ticket_key_file{"./ssl/ticket_keys.bin"};
+            std::uint64_t ticket_key_rotation_seconds{43200};
+            bool early_data{false};
+            std::uint64_t max_early_data_bytes{16384};
         } ssl;
 
         struct asio_t
         {
             std::uint64_t worker_threads{std::thread::hardware_concurrency()};
+            std::uint64_t blocking_threads{4};
+            // handlers and small containers up to this size are recycled by every thread
+            std::uint64_t recycling_max_block_bytes{4096};
+            std::uint64_t recycling_blocks_per_class{64};
         } asio;
 
         struct http_t
         {
             std::filesystem::path doc_root{"./docroot"};
             std::string fallback_file{"home.html"};
+            std::uint64_t session_timeout_seconds{30};
+            std::uint64_t pipeline_depth{16};
+            std::uint64_t write_coalesce_bytes{16384};
+            std::uint64_t inline_file_bytes{65536};
+            std::uint64_t file_cache_entries{1024};
+            std::uint64_t file_cache_memory_bytes{33554432};
+            std::uint64_t file_cache_ttl_seconds{2};
+            // posts rendered to HTML, 0 disables the cache
+            std::uint64_t fragment_cache_memory_bytes{67108864};
+            // responses of API routes that opted in to the micro-cache, 0 keeps none but still coalesces requests
+            std::uint64_t api_cache_memory_bytes{16777216};
+            // packed by lpbackend-pack, consulted before doc_root if set
+            std::filesystem::path asset_bundle{};
+            std::uint64_t asset_bundle_check_seconds{5};
         } http;
+
+        struct http2_t
+        {
+            bool enabled{true};
+            std::uint64_t max_concurrent_streams{100};
+            std::uint64_t initial_window_size{1048576};
+            std::uint64_t max_request_body_bytes{1048576};
+            std::uint64_t header_table_size{4096};
+            std::uint64_t max_header_list_size{65536};
+        } http2;
+
+        struct memory_t
+        {
+            // caches are shrunk while the resident set exceeds it, 0 disables the limit
+            std::uint64_t soft_limit_bytes{0};
+            std::uint64_t check_interval_seconds{5};
+        } memory;
+
+        struct admin_t
+        {
+            // endpoints under path require "Authorization: Bearer <token>", disabled if empty
+            std::string token{};
+            std::string path{"/admin"};
+        } admin;
+
+        struct auth_t
+        {
+            std::uint64_t register_session_ttl_seconds{300};
+            // further registrations are refused while this many sessions are pending
+            std::uint64_t max_register_sessions{65536};
+            std::uint64_t register_session_sweep_seconds{10};
+            // captchas are rendered ahead of time, at most captcha_refill_per_second of them
+            std::uint64_t captcha_pool_size{256};
+            std::uint64_t captcha_refill_per_second{50};
+            std::uint64_t captcha_threads{1};
+            std::uint64_t captcha_width{160};
+            std::uint64_t captcha_height{60};
+            std::uint64_t captcha_length{5};
+            std::uint64_t captcha_quality{60};
+            // Argon2id cost of new password hashes, stored hashes keep the cost they were made with
+            std::uint64_t password_memory_kib{19456};
+            std::uint64_t password_iterations{2};
+            std::uint64_t password_parallelism{1};
+            // hashes beyond the running ones wait in a queue of this depth, further ones are refused at once
+            std::uint64_t max_concurrent_password_hashes{2};
+            std::uint64_t password_hash_queue_depth{32};
+        } auth;
+
+        struct storage_t
+        {
+            // the embedded store is not opened if empty, e.g. "./data"
+            std::filesystem::path directory{};
+            std::uint64_t segment_bytes{67108864};
+            // sealed segments are compacted once this share of their bytes is garbage
+            std::uint64_t compaction_garbage_percent{50};
+            // 0 disables compaction
+            std::uint64_t compaction_check_seconds{60};
+            // views, likes and reply counts are written in one batch this often, 0 only writes them on shutdown
+            std::uint64_t counter_flush_seconds{5};
+            // totals kept in memory, beyond this the ones not read lately are dropped and read again when needed
+            std::uint64_t max_counter_totals{1048576};
+        } storage;
+
+        struct search_t
+        {
+            // the full-text index is not opened if empty, e.g. "./data/search"
+            std::filesystem::path directory{};
+            // buffered documents are written to a new segment once there are this many or after flush_seconds,
+            // 0 only writes full segments
+            std::uint64_t flush_documents{16384};
+            std::uint64_t flush_seconds{30};
+            // adjacent segments are merged while there are more than this
+            std::uint64_t max_segments{16};
+        } search;
     } fields;
 
     /**
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <string_view>
 #include <thread>
 
 #include <fmt/format.h>
@@ -31,14 +32,29 @@
 #include <boost/beast.hpp>
 #include <boost/program_options.hpp>
 
+#include <lpbackend/asio/blocking_pool.hpp>
+#include <lpbackend/asio/recycling_allocator.hpp>
 #include <lpbackend/asio/task_group.hpp>
+#include <lpbackend/asio/timing_wheel.hpp>
+#include <lpbackend/auth/captcha_pool.hpp>
+#include <lpbackend/auth/password_hasher.hpp>
+#include <lpbackend/auth/register_session_store.hpp>
 #include <lpbackend/config/lpbackend_config.hpp>
 #include <lpbackend/extern.hpp>
 #include <lpbackend/log.hpp>
+#include <lpbackend/networking/early_data_acceptor.hpp>
+#include <lpbackend/networking/micro_cache.hpp>
 #include <lpbackend/networking/mime_database.hpp>
 #include <lpbackend/networking/request_handler.hpp>
+#include <lpbackend/networking/session_memory.hpp>
+#include <lpbackend/networking/socket_options.hpp>
+#include <lpbackend/networking/tls_session_manager.hpp>
 #include <lpbackend/plugin/plugin.hpp>
 #include <lpbackend/plugin/plugin_descriptor.hpp>
+#include <lpbackend/render/fragment_cache.hpp>
+#include <lpbackend/search/full_text_index.hpp>
+#include <lpbackend/storage/counter_service.hpp>
+#include <lpbackend/storage/log_store.hpp>
 #include <lpbackend/version.hpp>
 
 namespace lpbackend
@@ -49,21 +65,66 @@ class LPBACKEND_EXTERN lpbackend_server : public lpbackend::plugin::plugin
     using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
     using acceptor_type = typename boost::asio::ip::tcp::acceptor::rebind_executor<executor_type>::other;
     using stream_type = typename boost::beast::tcp_stream::rebind_executor<executor_type>::other;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    using local_acceptor_type =
+        typename boost::asio::local::stream_protocol::acceptor::rebind_executor<executor_type>::other;
+#endif
+    using listener_config = config::lpbackend_config::fields_t::networking_t::listener_t;
+
+    enum class listener_protocol
+    {
+        detect,
+        https,
+        http,
+        redirect
+    };
 
   private:
+    // exposes shutdown(), which destroys the pending handlers before the members they refer to go away
+    class io_context : public boost::asio::io_context
+    {
+      public:
+        using boost::asio::io_context::shutdown;
+    };
+
     logger lg_;
     config::lpbackend_config config_;
+    asio::blocking_pool blocking_pool_;
+    networking::file_cache file_cache_;
+    networking::micro_cache api_cache_;
+    render::fragment_cache fragment_cache_;
+    auth::register_session_store register_sessions_;
+    auth::captcha_pool captcha_pool_;
+    auth::password_hasher password_hasher_;
+    storage::log_store store_;
+    storage::counter_service counters_;
+    search::full_text_index search_index_;
     networking::request_handler request_handler_;
     networking::mime_database mime_database_;
     boost::program_options::variables_map vm_;
-    boost::asio::io_context context_;
+    io_context context_;
     boost::asio::ssl::context ssl_context_;
+    networking::tls_session_manager tls_sessions_;
     std::vector<std::thread> pool_;
     asio::task_group task_group_;
+    asio::timing_wheel timing_wheel_;
 
+    // completes a task of task_group_, logging "Exception occured <context>: ..." if it threw
+    auto adapt_logged(std::string_view context);
     boost::asio::awaitable<void, executor_type> handle_signals();
-    boost::asio::awaitable<void, executor_type> start_accept();
-    boost::asio::awaitable<void, executor_type> detect_session(stream_type stream);
+    boost::asio::awaitable<void, executor_type> start_accept(const listener_config &listener);
+    template <typename Acceptor>
+    boost::asio::awaitable<void, executor_type> accept_loop(Acceptor &acceptor, const listener_config &listener,
+                                                            listener_protocol protocol,
+                                                            const networking::socket_profile &profile);
+    template <typename Stream>
+    boost::asio::awaitable<void, executor_type> detect_session(Stream stream, const listener_config &listener,
+                                                               listener_protocol protocol);
+    boost::asio::awaitable<void, executor_type> rotate_ticket_keys();
+    boost::asio::awaitable<void, executor_type> watch_asset_bundle();
+    boost::asio::awaitable<void, executor_type> watch_memory();
+    boost::asio::awaitable<void, executor_type> sweep_register_sessions();
+    boost::asio::awaitable<void, executor_type> log_statistics();
 
   public:
     static constexpr auto name{"lpbackend::server"};
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::memory
+{
+/**
+ * @brief Subsystems whose memory is accounted
+ */
+enum class tag : std::uint8_t
+{
+    sessions,
+    file_cache,
+    asset_bundle,
+    mime_database,
+    recycling_pool,
+    storage_index,
+    search_index,
+    fragment_cache,
+    api_cache
+};
+
+inline constexpr std::size_t tag_count{9};
+
+LPBACKEND_EXTERN std::string_view tag_name(tag t) noexcept;
+
+/**
+ * @brief Adjusts the bytes accounted to a subsystem, a negative delta releases them
+ */
+LPBACKEND_EXTERN void account(tag t, std::int64_t delta) noexcept;
+
+/**
+ * @brief Replaces the bytes accounted to a subsystem that reports a total
+ */
+LPBACKEND_EXTERN void set_usage(tag t, std::size_t bytes) noexcept;
+
+/**
+ * @brief Lets a subsystem that already tracks its total be asked when the usage is read
+ */
+LPBACKEND_EXTERN void set_source(tag t, std::size_t (*source)());
+
+LPBACKEND_EXTERN std::size_t usage(tag t);
+
+/**
+ * @brief Memory of the whole process as seen by mimalloc and the system
+ */
+struct process_usage
+{
+    std::size_t current_rss;
+    std::size_t peak_rss;
+    std::size_t current_commit;
+    std::size_t peak_commit;
+};
+
+LPBACKEND_EXTERN process_usage get_process_usage() noexcept;
+
+/**
+ * @brief Formats the accounted totals and the process usage, one item per line
+ *
+ * @param detailed appends the statistics printed by mimalloc
+ */
+LPBACKEND_EXTERN std::string report(bool detailed);
+
+/**
+ * @brief Returns freed memory of the calling thread and abandoned threads to the system
+ */
+LPBACKEND_EXTERN void collect() noexcept;
+} // namespace lpbackend::memory
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include <boost/beast.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <lpbackend/extern.hpp>
+#include <lpbackend/networking/mime_database.hpp>
+
+namespace lpbackend::networking
+{
+/**
+ * @brief Encodings of the variants of an asset, in order of preference
+ */
+enum class content_coding : std::uint8_t
+{
+    br,
+    gzip,
+    identity
+};
+
+/**
+ * @brief An entry of an asset_bundle, the views point into the mapping
+ */
+struct asset
+{
+    std::string_view path;
+    std::string_view mime_type;
+    std::string_view etag;
+    // indexed by content_coding, the identity variant is always present
+    std::array<std::optional<std::string_view>, 3> variants;
+};
+
+/**
+ * @brief A packed directory of static files that is served from a memory mapping
+ *
+ * The archive starts with a header, followed by the displacements of a
+ * perfect hash, one fixed-size record per slot of the hash, the strings
+ * and finally the contents. Integers are stored in little endian.
+ *
+ * Lookups hash the path once and compare a single record, bodies are views
+ * of the mapping. A new archive is written to a temporary file and renamed
+ * over the old one, so a running server can remap it at any time.
+ */
+class LPBACKEND_EXTERN asset_bundle
+{
+  public:
+    static constexpr std::string_view magic{"LPBUNDLE"};
+    static constexpr std::uint32_t format_version{1};
+
+  private:
+    boost::interprocess::mapped_region region_;
+    std::string_view data_;
+    std::uint32_t entry_count_{};
+    std::uint32_t bucket_count_{};
+    std::uint64_t seeds_offset_{};
+    std::uint64_t records_offset_{};
+    std::filesystem::file_time_type last_write_time_{};
+
+    asset read_record(std::uint32_t slot) const noexcept;
+
+  public:
+    ~asset_bundle();
+
+    /**
+     * @brief Maps and validates an archive, must not be called on an I/O thread
+     *
+     * @throws std::runtime_error if the archive is malformed
+     * @throws boost::interprocess::interprocess_exception if it cannot be mapped
+     */
+    static std::shared_ptr<const asset_bundle> open(const std::filesystem::path &path);
+
+    /**
+     * @brief Packs the regular files under a directory into an archive
+     *
+     * A sibling "<file>.br" or "<file>.gz" is packed as a precompressed
+     * variant of <file> instead of an entry of its own.
+     *
+     * @return the number of entries
+     * @throws std::runtime_error on I/O failure or an unresolvable hash collision
+     */
+    static std::size_t pack(const std::filesystem::path &directory, const std::filesystem::path &output,
+                            mime_database &db);
+
+    /**
+     * @brief Looks up an asset by its absolute request path, e.g. "/index.html"
+     */
+    std::optional<asset> find(std::string_view path) const noexcept;
+
+    std::size_t size() const noexcept;
+    std::size_t mapped_bytes() const noexcept;
+    std::filesystem::file_time_type last_write_time() const noexcept;
+};
+
+/**
+ * @brief A body that refers to the content of an asset without copying it
+ *
+ * The body keeps the bundle mapped, so a response outlives a remapping.
+ */
+struct asset_body
+{
+    class value_type
+    {
+      private:
+        std::shared_ptr<const asset_bundle> bundle_;
+        std::string_view data_;
+
+      public:
+        value_type() = default;
+        value_type(std::shared_ptr<const asset_bundle> bundle, const std::string_view data) noexcept
+            : bundle_{std::move(bundle)}, data_{data}
+        {
+        }
+
+        std::uint64_t size() const noexcept
+        {
+            return data_.size();
+        }
+
+        std::string_view data() const noexcept
+        {
+            return data_;
+        }
+    };
+
+    static std::uint64_t size(const value_type &body) noexcept
+    {
+        return body.size();
+    }
+
+    class writer
+    {
+      private:
+        const value_type &body_;
+
+      public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, typename Fields>
+        writer(const boost::beast::http::header<isRequest, Fields> &, const value_type &body) : body_{body}
+        {
+        }
+
+        void init(boost::beast::error_code &ec)
+        {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code &ec)
+        {
+            ec = {};
+            return std::pair{const_buffers_type{body_.data().data(), body_.data().size()}, false};
+        }
+    };
+};
+} // namespace lpbackend::networking
@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <lpbackend/asio/recycling_allocator.hpp>
+#include <lpbackend/networking/session_memory.hpp>
+
+namespace lpbackend::networking
+{
+/**
+ * @brief Performs a TLS 1.3 server handshake that accepts 0-RTT early data
+ *
+ * Asio's SSL stream cannot read early data, so the handshake is driven over
+ * memory BIOs instead. Early data is made available before the client
+ * finishes the handshake, so it can be answered with 0.5-RTT data. Only
+ * whole TLS records are read from the socket, nothing is left behind when
+ * the completed SSL object is handed over to a boost::asio::ssl::stream.
+ */
+template <typename Stream> class early_data_acceptor
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+  private:
+    // RFC 8446 5.2, the largest TLSCiphertext
+    static constexpr std::size_t max_record_size{5 + 16384 + 256};
+
+    struct ssl_deleter
+    {
+        void operator()(SSL *ssl) const noexcept
+        {
+            SSL_free(ssl);
+        }
+    };
+
+    Stream &stream_;
+    session_buffer &buffer_;
+    std::unique_ptr<SSL, ssl_deleter> ssl_;
+    BIO *input_;
+    BIO *output_;
+    std::string chunk_;
+    std::string early_data_{};
+    std::size_t early_data_bytes_{};
+    bool early_data_finished_{};
+
+    [[noreturn]] static void throw_ssl_error(const int result, SSL *ssl)
+    {
+        if (SSL_get_error(ssl, result) == SSL_ERROR_SSL)
+        {
+            throw boost::system::system_error{static_cast<int>(ERR_get_error()),
+                                              boost::asio::error::get_ssl_category()};
+        }
+        throw std::runtime_error{"TLS handshake failed"};
+    }
+
+    bool record_buffered() const noexcept
+    {
+        if (buffer_.size() < 5)
+        {
+            return false;
+        }
+        const auto *header{static_cast<const std::uint8_t *>(buffer_.data().data())};
+        return buffer_.size() >= 5 + ((std::size_t{header[3]} << 8) | header[4]);
+    }
+
+    // Returns false if the socket was closed
+    boost::asio::awaitable<bool, executor_type> fill(const std::size_t size)
+    {
+        if (buffer_.size() >= size)
+        {
+            co_return true;
+        }
+        const auto missing{size - buffer_.size()};
+        auto [ec, bytes]{co_await boost::asio::async_read(stream_, buffer_.prepare(missing), asio::recycled_tuple)};
+        buffer_.commit(bytes);
+        if (ec && !boost::beast::get_lowest_layer(stream_).socket().is_open())
+        {
+            co_return false;
+        }
+        if (ec)
+        {
+            throw boost::system::system_error{ec};
+        }
+        co_return true;
+    }
+
+    // Moves one TLS record from the buffer, or the socket, into the SSL object
+    boost::asio::awaitable<bool, executor_type> read_record()
+    {
+        if (!co_await fill(5))
+        {
+            co_return false;
+        }
+        const auto *header{static_cast<const std::uint8_t *>(buffer_.data().data())};
+        const std::size_t size{5 + ((std::size_t{header[3]} << 8) | header[4])};
+        if (size > max_record_size)
+        {
+            throw boost::system::system_error{boost::asio::ssl::error::unexpected_result};
+        }
+        if (!co_await fill(size))
+        {
+            co_return false;
+        }
+        BIO_write(input_, buffer_.data().data(), static_cast<int>(size));
+        buffer_.consume(size);
+        co_return true;
+    }
+
+    boost::asio::awaitable<bool, executor_type> flush()
+    {
+        char *data{};
+        const auto size{BIO_get_mem_data(output_, &data)};
+        if (size <= 0)
+        {
+            co_return true;
+        }
+        auto [ec, _]{co_await boost::asio::async_write(
+            stream_, boost::asio::buffer(data, static_cast<std::size_t>(size)), asio::recycled_tuple)};
+        BIO_reset(output_);
+        if (ec && !boost::beast::get_lowest_layer(stream_).socket().is_open())
+        {
+            co_return false;
+        }
+        if (ec)
+        {
+            throw boost::system::system_error{ec};
+        }
+        co_return true;
+    }
+
+    // Reads early data until it ends, or until reading more would wait for the client
+    boost::asio::awaitable<bool, executor_type> read_early_data(const bool wait)
+    {
+        while (!early_data_finished_)
+        {
+            std::size_t bytes{};
+            switch (SSL_read_early_data(ssl_.get(), chunk_.data(), chunk_.size(), &bytes))
+            {
+            case SSL_READ_EARLY_DATA_SUCCESS:
+                early_data_.append(chunk_.data(), bytes);
+                break;
+            case SSL_READ_EARLY_DATA_FINISH:
+                early_data_finished_ = true;
+                break;
+            default:
+                if (SSL_get_error(ssl_.get(), 0) != SSL_ERROR_WANT_READ)
+                {
+                    throw_ssl_error(0, ssl_.get());
+                }
+                if (!co_await flush())
+                {
+                    co_return false;
+                }
+                // the rest of the early data needs the client to see our flight first
+                if (!wait && !early_data_.empty() && !record_buffered())
+                {
+                    co_return true;
+                }
+                if (!co_await read_record())
+                {
+                    co_return false;
+                }
+                break;
+            }
+        }
+        co_return co_await flush();
+    }
+
+  public:
+    early_data_acceptor(Stream &stream, session_buffer &buffer, SSL_CTX *ctx)
+        : stream_{stream}, buffer_{buffer}, ssl_{SSL_new(ctx)}, chunk_(max_record_size, '\0')
+    {
+        if (!ssl_)
+        {
+            throw std::runtime_error{"failed to create SSL object"};
+        }
+        input_ = BIO_new(BIO_s_mem());
+        output_ = BIO_new(BIO_s_mem());
+        SSL_set_bio(ssl_.get(), input_, output_);
+        SSL_set_accept_state(ssl_.get());
+    }
+
+    /**
+     * @brief Processes the ClientHello and reads the early data sent with it
+     *
+     * @return false if the socket was closed
+     */
+    boost::asio::awaitable<bool, executor_type> read_early_data()
+    {
+        return read_early_data(false);
+    }
+
+    /**
+     * @brief The early data that has not been consumed yet
+     */
+    std::string_view early_data() const noexcept
+    {
+        return early_data_;
+    }
+
+    void consume_early_data(const std::size_t size)
+    {
+        early_data_.erase(0, size);
+    }
+
+    SSL *native_handle() noexcept
+    {
+        return ssl_.get();
+    }
+
+    /**
+     * @brief Sends a response before the handshake is complete (0.5-RTT data)
+     *
+     * @param generator a boost::beast::http::message_generator, consumed as it is written
+     * @return false if the socket was closed
+     */
+    template <typename Generator> boost::asio::awaitable<bool, executor_type> write_early_response(Generator &generator)
+    {
+        while (!generator.is_done())
+        {
+            boost::beast::error_code ec{};
+            const auto buffers{generator.prepare(ec)};
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+            for (const auto buffer : boost::beast::buffers_range_ref(buffers))
+            {
+                std::size_t written{};
+                if (buffer.size() > 0 && SSL_write_early_data(ssl_.get(), buffer.data(), buffer.size(), &written) != 1)
+                {
+                    throw_ssl_error(0, ssl_.get());
+                }
+            }
+            generator.consume(boost::asio::buffer_size(buffers));
+            if (!co_await flush())
+            {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    /**
+     * @brief Completes the handshake
+     *
+     * On success the buffer holds all application data received so far,
+     * starting with the early data that has not been consumed.
+     *
+     * @return false if the socket was closed
+     */
+    boost::asio::awaitable<bool, executor_type> finish_handshake()
+    {
+        if (!co_await read_early_data(true))
+        {
+            co_return false;
+        }
+
+        for (;;)
+        {
+            const auto result{SSL_do_handshake(ssl_.get())};
+            if (result == 1)
+            {
+                break;
+            }
+            if (SSL_get_error(ssl_.get(), result) != SSL_ERROR_WANT_READ)
+            {
+                throw_ssl_error(result, ssl_.get());
+            }
+            if (!co_await flush() || !co_await read_record())
+            {
+                co_return false;
+            }
+        }
+
+        // decrypt records that arrived together with the handshake, reading
+        // the rest of a partial record so no ciphertext stays in the buffer
+        early_data_bytes_ = early_data_.size();
+        auto plaintext{std::move(early_data_)};
+        while (buffer_.size() > 0)
+        {
+            if (!co_await read_record())
+            {
+                co_return false;
+            }
+            for (;;)
+            {
+                const auto result{SSL_read(ssl_.get(), chunk_.data(), static_cast<int>(chunk_.size()))};
+                if (result > 0)
+                {
+                    plaintext.append(chunk_.data(), static_cast<std::size_t>(result));
+                    continue;
+                }
+                const auto error{SSL_get_error(ssl_.get(), result)};
+                if (error == SSL_ERROR_WANT_READ)
+                {
+                    break;
+                }
+                if (error == SSL_ERROR_ZERO_RETURN)
+                {
+                    co_return false;
+                }
+                throw_ssl_error(result, ssl_.get());
+            }
+        }
+        // post-handshake messages such as session tickets
+        if (!co_await flush())
+        {
+            co_return false;
+        }
+
+        boost::asio::buffer_copy(buffer_.prepare(plaintext.size()), boost::asio::buffer(plaintext));
+        buffer_.commit(plaintext.size());
+        co_return true;
+    }
+
+    /**
+     * @brief Number of bytes at the beginning of the buffer that arrived as early data
+     */
+    std::size_t early_data_bytes() const noexcept
+    {
+        return early_data_bytes_;
+    }
+
+    /**
+     * @brief Releases the SSL object for boost::asio::ssl::stream, which replaces its BIOs
+     */
+    SSL *release() noexcept
+    {
+        return ssl_.release();
+    }
+};
+} // namespace lpbackend::networking
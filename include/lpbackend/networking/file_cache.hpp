@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/beast.hpp>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::networking
+{
+/**
+ * @brief An opened file of doc_root that is shared by concurrent responses
+ *
+ * Reads are positional, so no file offset is shared between readers. Files
+ * up to http.inline_file_bytes are kept in memory and closed instead.
+ */
+class LPBACKEND_EXTERN cached_file
+{
+  private:
+    boost::beast::file file_;
+    std::optional<std::string> content_;
+    std::uint64_t size_{};
+    std::filesystem::file_time_type last_write_time_{};
+    std::string mime_type_;
+    boost::beast::http::response_header<> header_;
+
+  public:
+    /**
+     * @brief Opens a file for reading, must not be called on an I/O thread
+     */
+    static std::shared_ptr<cached_file> open(const std::string &path, std::string mime_type,
+                                             std::uint64_t inline_bytes, boost::beast::error_code &ec);
+
+    std::uint64_t size() const noexcept;
+    std::filesystem::file_time_type last_write_time() const noexcept;
+    const std::string &mime_type() const noexcept;
+
+    /**
+     * @brief Returns the header of a 200 response with the file, built when the file was opened
+     *
+     * Date and Connection are left to finish_response.
+     */
+    const boost::beast::http::response_header<> &header() const noexcept;
+
+    /**
+     * @brief Returns the whole content if the file is kept in memory
+     */
+    std::optional<std::string_view> content() const noexcept;
+
+    /**
+     * @brief Returns the handle of the file, unless it is kept in memory
+     */
+    boost::beast::file::native_handle_type native_handle() const noexcept;
+
+    /**
+     * @brief Reads at an offset without moving a file position
+     *
+     * @return the number of bytes read, 0 at the end of the file
+     */
+    std::size_t read_at(std::uint64_t offset, char *data, std::size_t size, boost::beast::error_code &ec) const;
+};
+
+/**
+ * @brief A body that streams a shared cached_file with positional reads
+ */
+struct cached_file_body
+{
+    class value_type
+    {
+      private:
+        std::shared_ptr<const cached_file> file_;
+
+      public:
+        value_type() = default;
+        explicit value_type(std::shared_ptr<const cached_file> file) noexcept : file_{std::move(file)}
+        {
+        }
+
+        bool is_open() const noexcept
+        {
+            return file_ != nullptr;
+        }
+
+        std::uint64_t size() const noexcept
+        {
+            return file_ ? file_->size() : 0;
+        }
+
+        const cached_file &file() const noexcept
+        {
+            return *file_;
+        }
+    };
+
+    static std::uint64_t size(const value_type &body) noexcept
+    {
+        return body.size();
+    }
+
+    class writer
+    {
+      private:
+        static constexpr std::size_t buffer_size{16384};
+
+        const value_type &body_;
+        std::uint64_t offset_{};
+        std::unique_ptr<char[]> buffer_{};
+
+      public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, typename Fields>
+        writer(const boost::beast::http::header<isRequest, Fields> &, const value_type &body) : body_{body}
+        {
+        }
+
+        void init(boost::beast::error_code &ec)
+        {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code &ec)
+        {
+            ec = {};
+            if (const auto content{body_.file().content()})
+            {
+                // served from memory in one piece
+                offset_ = content->size();
+                return std::pair{const_buffers_type{content->data(), content->size()}, false};
+            }
+            if (offset_ >= body_.size())
+            {
+                return boost::none;
+            }
+            if (!buffer_)
+            {
+                buffer_ = std::make_unique<char[]>(buffer_size);
+            }
+            const auto wanted{static_cast<std::size_t>(std::min<std::uint64_t>(body_.size() - offset_, buffer_size))};
+            const auto size{body_.file().read_at(offset_, buffer_.get(), wanted, ec)};
+            if (ec)
+            {
+                return boost::none;
+            }
+            if (size == 0)
+            {
+                ec = boost::beast::http::error::short_read;
+                return boost::none;
+            }
+            offset_ += size;
+            return std::pair{const_buffers_type{buffer_.get(), size}, offset_ < body_.size()};
+        }
+    };
+};
+
+/**
+ * @brief An LRU cache of opened files of doc_root
+ *
+ * Entries are looked up without any system call and revalidated with a
+ * stat once their TTL expired, a changed file is opened again. Responses
+ * hold references to the files, so evicted files are closed when their
+ * last response completes.
+ */
+class LPBACKEND_EXTERN file_cache
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct statistics
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t revalidations;
+        std::size_t entries;
+        std::size_t memory;
+    };
+
+  private:
+    struct entry
+    {
+        std::string path;
+        std::shared_ptr<const cached_file> file;
+        clock_type::time_point validated;
+    };
+
+    std::mutex mutex_;
+    // most recently used first
+    std::list<entry> entries_;
+    std::unordered_map<std::string_view, std::list<entry>::iterator> index_;
+    std::size_t memory_{};
+    std::size_t max_entries_{};
+    std::size_t max_memory_{};
+    std::uint64_t inline_bytes_{};
+    clock_type::duration ttl_{};
+
+    std::atomic<std::uint64_t> hits_{};
+    std::atomic<std::uint64_t> misses_{};
+    std::atomic<std::uint64_t> revalidations_{};
+
+    void erase(std::list<entry>::iterator it);
+    void insert(const std::string &path, std::shared_ptr<const cached_file> file);
+
+  public:
+    void configure(const config::lpbackend_config::fields_t::http_t &http);
+
+    /**
+     * @brief Returns a file that was validated within the TTL
+     *
+     * @return nullptr if the file has to be opened or revalidated with open()
+     */
+    std::shared_ptr<const cached_file> find(const std::string &path);
+
+    /**
+     * @brief Revalidates a cached file or opens it, must not be called on an I/O thread
+     *
+     * @param mime_type of the file, used when it is opened
+     */
+    std::shared_ptr<const cached_file> open(const std::string &path, std::string mime_type,
+                                            boost::beast::error_code &ec);
+
+    /**
+     * @brief Evicts the least recently used half of the entries, used when memory runs short
+     */
+    void shrink();
+
+    /**
+     * @brief Returns the counters since the last call
+     */
+    statistics collect();
+};
+} // namespace lpbackend::networking
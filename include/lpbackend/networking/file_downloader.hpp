@@ -31,6 +31,7 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/url.hpp>
 
+#include <lpbackend/asio/io_uring.hpp>
 #include <lpbackend/extern.hpp>
 #include <lpbackend/log.hpp>
 
@@ -158,6 +159,16 @@ class LPBACKEND_EXTERN file_downloader
 
         else if (url.scheme() == "file")
         {
+#if defined(BOOST_ASIO_HAS_IO_URING)
+            if (asio::io_uring_available())
+            {
+                boost::asio::basic_random_access_file<executor_type> file{executor, std::string{url.path()},
+                                                                          boost::asio::file_base::read_only};
+                std::vector<char> buffer(file.size());
+                co_await boost::asio::async_read_at(file, 0, boost::asio::buffer(buffer));
+                co_return buffer;
+            }
+#endif
             std::ifstream file{url.path()};
             if (!file)
             {
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::networking::http2
+{
+constexpr std::string_view connection_preface{"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+constexpr std::uint32_t default_window_size{65535};
+constexpr std::uint32_t max_window_size{0x7fffffff};
+constexpr std::uint32_t default_max_frame_size{16384};
+
+enum class frame_type : std::uint8_t
+{
+    data = 0x0,
+    headers = 0x1,
+    priority = 0x2,
+    rst_stream = 0x3,
+    settings = 0x4,
+    push_promise = 0x5,
+    ping = 0x6,
+    goaway = 0x7,
+    window_update = 0x8,
+    continuation = 0x9,
+    priority_update = 0x10 // RFC 9218
+};
+
+namespace flags
+{
+constexpr std::uint8_t end_stream{0x1};
+constexpr std::uint8_t ack{0x1};
+constexpr std::uint8_t end_headers{0x4};
+constexpr std::uint8_t padded{0x8};
+constexpr std::uint8_t priority{0x20};
+} // namespace flags
+
+enum class error_code : std::uint32_t
+{
+    no_error = 0x0,
+    protocol_error = 0x1,
+    internal_error = 0x2,
+    flow_control_error = 0x3,
+    settings_timeout = 0x4,
+    stream_closed = 0x5,
+    frame_size_error = 0x6,
+    refused_stream = 0x7,
+    cancel = 0x8,
+    compression_error = 0x9,
+    connect_error = 0xa,
+    enhance_your_calm = 0xb,
+    inadequate_security = 0xc,
+    http_1_1_required = 0xd
+};
+
+enum class setting : std::uint16_t
+{
+    header_table_size = 0x1,
+    enable_push = 0x2,
+    max_concurrent_streams = 0x3,
+    initial_window_size = 0x4,
+    max_frame_size = 0x5,
+    max_header_list_size = 0x6
+};
+
+struct frame_header
+{
+    static constexpr std::size_t size{9};
+
+    std::uint32_t length{};
+    frame_type type{};
+    std::uint8_t flags{};
+    std::uint32_t stream_id{};
+
+    static inline frame_header parse(const std::uint8_t *data) noexcept
+    {
+        return frame_header{.length = (std::uint32_t{data[0]} << 16) | (std::uint32_t{data[1]} << 8) | data[2],
+                            .type = static_cast<frame_type>(data[3]),
+                            .flags = data[4],
+                            .stream_id = ((std::uint32_t{data[5]} << 24) | (std::uint32_t{data[6]} << 16) |
+                                          (std::uint32_t{data[7]} << 8) | data[8]) &
+                                         0x7fffffff};
+    }
+
+    inline void serialize(std::string &out) const
+    {
+        out.push_back(static_cast<char>((length >> 16) & 0xff));
+        out.push_back(static_cast<char>((length >> 8) & 0xff));
+        out.push_back(static_cast<char>(length & 0xff));
+        out.push_back(static_cast<char>(type));
+        out.push_back(static_cast<char>(flags));
+        out.push_back(static_cast<char>((stream_id >> 24) & 0x7f));
+        out.push_back(static_cast<char>((stream_id >> 16) & 0xff));
+        out.push_back(static_cast<char>((stream_id >> 8) & 0xff));
+        out.push_back(static_cast<char>(stream_id & 0xff));
+    }
+};
+
+inline std::uint32_t read_uint32(const std::uint8_t *data) noexcept
+{
+    return (std::uint32_t{data[0]} << 24) | (std::uint32_t{data[1]} << 16) | (std::uint32_t{data[2]} << 8) | data[3];
+}
+
+inline void write_uint32(std::string &out, const std::uint32_t value)
+{
+    out.push_back(static_cast<char>((value >> 24) & 0xff));
+    out.push_back(static_cast<char>((value >> 16) & 0xff));
+    out.push_back(static_cast<char>((value >> 8) & 0xff));
+    out.push_back(static_cast<char>(value & 0xff));
+}
+
+/**
+ * @brief An error that terminates the whole connection with a GOAWAY frame
+ */
+class LPBACKEND_EXTERN connection_error : public std::runtime_error
+{
+  private:
+    error_code code_;
+
+  public:
+    connection_error(error_code code, const std::string &message);
+    error_code code() const noexcept;
+};
+
+/**
+ * @brief An error that only resets a single stream with a RST_STREAM frame
+ */
+class LPBACKEND_EXTERN stream_error : public std::runtime_error
+{
+  private:
+    std::uint32_t stream_id_;
+    error_code code_;
+
+  public:
+    stream_error(std::uint32_t stream_id, error_code code, const std::string &message);
+    std::uint32_t stream_id() const noexcept;
+    error_code code() const noexcept;
+};
+} // namespace lpbackend::networking::http2
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::networking::http2
+{
+namespace huffman
+{
+/**
+ * @brief Appends the Huffman encoding of a string (RFC 7541 Appendix B)
+ */
+LPBACKEND_EXTERN void encode(std::string_view input, std::string &out);
+
+/**
+ * @brief Returns the length of the Huffman encoding of a string in bytes
+ */
+LPBACKEND_EXTERN std::size_t encoded_size(std::string_view input) noexcept;
+
+/**
+ * @brief Appends the decoding of a Huffman encoded string
+ *
+ * @return false if the input is not a valid encoding
+ */
+LPBACKEND_EXTERN bool decode(std::span<const std::uint8_t> input, std::string &out);
+} // namespace huffman
+
+/**
+ * @brief A header field as stored in an HPACK table, the size is defined by RFC 7541 4.1
+ */
+struct header_entry
+{
+    std::string name;
+    std::string value;
+
+    inline std::size_t size() const noexcept
+    {
+        return name.size() + value.size() + 32;
+    }
+};
+
+/**
+ * @brief Decodes HPACK header blocks of one connection
+ */
+class LPBACKEND_EXTERN hpack_decoder
+{
+  private:
+    std::deque<header_entry> table_;
+    std::size_t table_size_{};
+    std::size_t max_table_size_;
+    std::size_t settings_table_size_;
+    std::size_t max_header_list_size_;
+
+    void insert(header_entry entry);
+    void evict(std::size_t max_size);
+    std::pair<std::string_view, std::string_view> lookup(std::uint64_t index) const;
+
+  public:
+    hpack_decoder(std::size_t max_table_size, std::size_t max_header_list_size);
+
+    /**
+     * @brief Decodes a complete header block
+     *
+     * @param block to decode
+     * @param callback invoked with the name and the value of every field in order
+     * @throws lpbackend::networking::http2::connection_error on malformed input
+     */
+    void decode(std::span<const std::uint8_t> block,
+                const std::function<void(std::string_view, std::string_view)> &callback);
+};
+
+/**
+ * @brief Encodes HPACK header blocks of one connection
+ */
+class LPBACKEND_EXTERN hpack_encoder
+{
+  private:
+    std::deque<header_entry> table_;
+    std::size_t table_size_{};
+    std::size_t max_table_size_{4096};
+    std::size_t pending_size_update_{};
+    bool size_update_pending_{};
+
+    void evict(std::size_t max_size);
+
+  public:
+    /**
+     * @brief Applies SETTINGS_HEADER_TABLE_SIZE of the peer, the change is
+     * announced at the beginning of the next header block
+     */
+    void max_table_size(std::size_t size);
+
+    /**
+     * @brief Starts a new header block
+     */
+    void begin_block(std::string &out);
+
+    /**
+     * @brief Appends a header field to the current header block
+     *
+     * @param name in lower case
+     * @param value of the field
+     * @param sensitive prevents the field from being indexed by intermediaries
+     */
+    void encode(std::string_view name, std::string_view value, std::string &out, bool sensitive = false);
+};
+} // namespace lpbackend::networking::http2
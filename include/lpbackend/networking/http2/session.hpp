@@ -0,0 +1,1145 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <boost/asio.hpp>
+#include <boost/asio/experimental/awaitable_operators.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+
+#include <fmt/format.h>
+
+#include <lpbackend/asio/recycling_allocator.hpp>
+#include <lpbackend/asio/timing_wheel.hpp>
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/log.hpp>
+#include <lpbackend/networking/http2/frame.hpp>
+#include <lpbackend/networking/http2/hpack.hpp>
+#include <lpbackend/networking/response.hpp>
+#include <lpbackend/networking/session_memory.hpp>
+
+namespace lpbackend::networking::http2
+{
+/**
+ * @brief Serves one HTTP/2 connection (RFC 9113)
+ *
+ * Frames are read and written by two coroutines on the strand of the
+ * connection. Responses are scheduled by the extensible priorities of
+ * RFC 9218 and within the flow control windows of the peer.
+ *
+ * @tparam Stream an established stream, usually TLS after "h2" was negotiated
+ * @tparam Handler invoked as `boost::asio::awaitable<response, executor_type>(
+ * boost::beast::http::request<boost::beast::http::string_body> &&)`, the
+ * session outlives every response it started
+ */
+template <typename Stream, typename Handler> class session
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+    using request_type = boost::beast::http::request<boost::beast::http::string_body>;
+    using config_type = config::lpbackend_config::fields_t::http2_t;
+
+  private:
+    // bytes written per write operation before other streams are reconsidered
+    static constexpr std::size_t write_budget{65536};
+    static constexpr std::uint8_t default_urgency{3};
+    // control frames the peer makes us queue, e.g. PING acknowledgements, while it does not read them
+    static constexpr std::size_t max_queued_control_bytes{262144};
+    // streams the peer may reset or have refused in a burst and per second afterwards, as in nghttp2
+    static constexpr std::uint32_t reset_burst{1000};
+    static constexpr std::uint32_t resets_per_second{33};
+
+    struct stream_state
+    {
+        std::uint32_t id;
+        request_type request{};
+        std::int64_t send_window;
+        std::int64_t recv_window;
+        std::optional<response> res{};
+        std::uint64_t body_offset{};
+        std::uint64_t body_size{};
+        std::uint8_t urgency{default_urgency};
+        bool incremental{};
+        bool remote_closed{};
+        bool headers_sent{};
+    };
+
+    logger lg_{channel_logger("http2_session")};
+    Stream &stream_;
+    session_buffer &buffer_;
+    const config_type &config_;
+    asio::timing_wheel::timer &deadline_;
+    Handler handler_;
+
+    hpack_decoder decoder_;
+    hpack_encoder encoder_{};
+
+    std::map<std::uint32_t, stream_state> streams_{};
+    std::deque<std::uint32_t> ready_{};
+    std::uint32_t last_stream_id_{};
+    std::uint32_t last_incremental_{};
+
+    std::int64_t send_window_{default_window_size};
+    // the connection window can only grow beyond the initial 65535 bytes
+    const std::int64_t connection_window_;
+    std::int64_t recv_window_;
+    std::uint32_t peer_initial_window_{default_window_size};
+    std::uint32_t peer_max_frame_size_{default_max_frame_size};
+
+    // header block being assembled from HEADERS and CONTINUATION frames
+    std::string header_block_{};
+    std::uint32_t header_stream_id_{};
+    bool header_end_stream_{};
+    bool header_early_{};
+
+    // received as TLS early data and not yet consumed
+    std::size_t early_data_bytes_;
+
+    std::uint32_t reset_tokens_{reset_burst};
+    std::chrono::steady_clock::time_point reset_refilled_{std::chrono::steady_clock::now()};
+
+    // control frames queued by the reader, written before any response
+    std::string output_{};
+    // timer is used as a condition variable, it is never expected to expire
+    boost::asio::steady_timer writable_;
+    bool reading_done_{};
+    // responses being produced, the session must not end before them
+    std::size_t pending_handlers_{};
+
+    void notify_writer()
+    {
+        writable_.cancel();
+    }
+
+    void queue_frame(const frame_type type, const std::uint8_t frame_flags, const std::uint32_t stream_id,
+                     const std::string_view payload)
+    {
+        frame_header{.length = static_cast<std::uint32_t>(payload.size()),
+                     .type = type,
+                     .flags = frame_flags,
+                     .stream_id = stream_id}
+            .serialize(output_);
+        output_.append(payload);
+    }
+
+    void queue_window_update(const std::uint32_t stream_id, const std::uint32_t increment)
+    {
+        std::string payload{};
+        write_uint32(payload, increment);
+        queue_frame(frame_type::window_update, 0, stream_id, payload);
+    }
+
+    void queue_goaway(const error_code code, const std::string_view debug_data)
+    {
+        std::string payload{};
+        write_uint32(payload, last_stream_id_);
+        write_uint32(payload, static_cast<std::uint32_t>(code));
+        payload.append(debug_data);
+        queue_frame(frame_type::goaway, 0, 0, payload);
+    }
+
+    void reset_stream(const std::uint32_t stream_id, const error_code code)
+    {
+        std::string payload{};
+        write_uint32(payload, static_cast<std::uint32_t>(code));
+        queue_frame(frame_type::rst_stream, 0, stream_id, payload);
+        streams_.erase(stream_id);
+    }
+
+    // Counts a stream that the peer reset or had refused, a peer that keeps
+    // doing so starts handlers without waiting for them (CVE-2023-44487)
+    void charge_reset()
+    {
+        const auto now{std::chrono::steady_clock::now()};
+        const auto refill{std::chrono::duration_cast<std::chrono::seconds>(now - reset_refilled_).count()};
+        if (refill > 0)
+        {
+            reset_tokens_ = static_cast<std::uint32_t>(std::min<std::uint64_t>(
+                reset_burst, reset_tokens_ + static_cast<std::uint64_t>(refill) * resets_per_second));
+            reset_refilled_ += std::chrono::seconds{refill};
+        }
+        if (reset_tokens_ == 0)
+        {
+            throw connection_error{error_code::enhance_your_calm, "too many reset streams"};
+        }
+        --reset_tokens_;
+    }
+
+    // Streams that count against SETTINGS_MAX_CONCURRENT_STREAMS, including the
+    // responses still being produced for streams that were reset meanwhile
+    std::size_t active_streams() const
+    {
+        return pending_handlers_ + static_cast<std::size_t>(std::ranges::count_if(streams_, [](const auto &entry) {
+                   // these are counted by pending_handlers_
+                   return !(entry.second.remote_closed && !entry.second.res);
+               }));
+    }
+
+    // Parses the `u` and `i` parameters of a Priority field value (RFC 9218 4)
+    static void parse_priority(const std::string_view value, std::uint8_t &urgency, bool &incremental)
+    {
+        std::size_t pos{};
+        while (pos < value.size())
+        {
+            auto end{value.find(',', pos)};
+            if (end == std::string_view::npos)
+            {
+                end = value.size();
+            }
+            auto item{value.substr(pos, end - pos)};
+            while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+            {
+                item.remove_prefix(1);
+            }
+            while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+            {
+                item.remove_suffix(1);
+            }
+            if (item.size() == 3 && item.starts_with("u=") && item[2] >= '0' && item[2] <= '7')
+            {
+                urgency = static_cast<std::uint8_t>(item[2] - '0');
+            }
+            else if (item == "i" || item == "i=?1")
+            {
+                incremental = true;
+            }
+            else if (item == "i=?0")
+            {
+                incremental = false;
+            }
+            pos = end + 1;
+        }
+    }
+
+    // Strips the padding of DATA and HEADERS frames
+    static std::string_view unpad(const frame_header &header, std::string_view payload)
+    {
+        if (!(header.flags & flags::padded))
+        {
+            return payload;
+        }
+        if (payload.empty())
+        {
+            throw connection_error{error_code::frame_size_error, "padded frame without pad length"};
+        }
+        const auto pad_length{static_cast<std::uint8_t>(payload.front())};
+        payload.remove_prefix(1);
+        if (pad_length > payload.size())
+        {
+            throw connection_error{error_code::protocol_error, "padding exceeds frame payload"};
+        }
+        payload.remove_suffix(pad_length);
+        return payload;
+    }
+
+    void dispatch(stream_state &s)
+    {
+        s.remote_closed = true;
+        if (s.request.method_string().empty() || s.request.target().empty())
+        {
+            throw stream_error{s.id, error_code::protocol_error, "missing pseudo-header fields"};
+        }
+        s.request.prepare_payload();
+
+        // the stream may be reset while the response is produced, so it is looked up again afterwards
+        ++pending_handlers_;
+        boost::asio::co_spawn(stream_.get_executor(), handle_stream(s.id, std::move(s.request)),
+                              boost::asio::detached);
+    }
+
+    boost::asio::awaitable<void, executor_type> handle_stream(const std::uint32_t id, request_type request)
+    {
+        struct finisher
+        {
+            session &self;
+            ~finisher()
+            {
+                --self.pending_handlers_;
+                self.notify_writer();
+            }
+        } finisher{*this};
+
+        const auto head{request.method() == boost::beast::http::verb::head};
+        std::optional<response> res{};
+        try
+        {
+            res.emplace(co_await handler_(std::move(request)));
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << fmt::format("Exception occured in request handler: {}", e.what());
+            if (streams_.contains(id))
+            {
+                reset_stream(id, error_code::internal_error);
+            }
+            co_return;
+        }
+
+        auto it{streams_.find(id)};
+        if (it == streams_.end())
+        {
+            co_return;
+        }
+        auto &s{it->second};
+        s.res = std::move(res);
+        s.body_size = head ? 0 : std::visit([](const auto &r) -> std::uint64_t {
+            if constexpr (std::is_same_v<std::decay_t<decltype(r)>, empty_response>)
+            {
+                return 0;
+            }
+            else
+            {
+                return r.body().size();
+            }
+        }, *s.res);
+        ready_.push_back(s.id);
+    }
+
+    void on_header_block()
+    {
+        const auto stream_id{header_stream_id_};
+        const auto end_stream{header_end_stream_};
+        header_stream_id_ = 0;
+
+        auto it{streams_.find(stream_id)};
+        const bool trailers{it != streams_.end()};
+        const bool refused{!trailers && active_streams() >= config_.max_concurrent_streams};
+
+        request_type request{};
+        request.version(20);
+        std::uint8_t urgency{default_urgency};
+        bool incremental{};
+        std::string cookie{};
+        bool regular_seen{};
+        bool malformed{};
+        // the block is decoded even for refused streams to keep the HPACK tables in sync
+        decoder_.decode({reinterpret_cast<const std::uint8_t *>(header_block_.data()), header_block_.size()},
+                        [&](const std::string_view name, const std::string_view value) {
+                            if (trailers || refused || malformed)
+                            {
+                                return;
+                            }
+                            if (std::ranges::any_of(name, [](const char c) { return c >= 'A' && c <= 'Z'; }))
+                            {
+                                malformed = true;
+                            }
+                            else if (name.starts_with(':'))
+                            {
+                                if (regular_seen)
+                                {
+                                    malformed = true;
+                                }
+                                else if (name == ":method")
+                                {
+                                    request.method_string(value);
+                                }
+                                else if (name == ":path")
+                                {
+                                    request.target(value);
+                                }
+                                else if (name == ":authority")
+                                {
+                                    if (request.find(boost::beast::http::field::host) == request.end())
+                                    {
+                                        request.set(boost::beast::http::field::host, value);
+                                    }
+                                }
+                                else if (name != ":scheme")
+                                {
+                                    malformed = true;
+                                }
+                            }
+                            else
+                            {
+                                regular_seen = true;
+                                if (name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+                                    name == "transfer-encoding" || name == "upgrade" ||
+                                    (name == "te" && value != "trailers"))
+                                {
+                                    malformed = true;
+                                }
+                                else if (name == "cookie")
+                                {
+                                    // RFC 9113 8.2.3
+                                    if (!cookie.empty())
+                                    {
+                                        cookie.append("; ");
+                                    }
+                                    cookie.append(value);
+                                }
+                                else
+                                {
+                                    if (name == "priority")
+                                    {
+                                        parse_priority(value, urgency, incremental);
+                                    }
+                                    request.insert(name, value);
+                                }
+                            }
+                        });
+        header_block_.clear();
+
+        if (trailers)
+        {
+            if (!end_stream || it->second.remote_closed)
+            {
+                throw stream_error{stream_id, error_code::protocol_error, "unexpected HEADERS frame"};
+            }
+            dispatch(it->second);
+            return;
+        }
+        if (refused)
+        {
+            charge_reset();
+            throw stream_error{stream_id, error_code::refused_stream, "too many concurrent streams"};
+        }
+        if (malformed)
+        {
+            throw stream_error{stream_id, error_code::protocol_error, "malformed request header fields"};
+        }
+        if (!cookie.empty())
+        {
+            request.set(boost::beast::http::field::cookie, cookie);
+        }
+        if (header_early_)
+        {
+            // RFC 8470 5.1
+            request.set("Early-Data", "1");
+        }
+
+        auto &s{streams_
+                    .emplace(stream_id, stream_state{.id = stream_id,
+                                                     .request = std::move(request),
+                                                     .send_window = peer_initial_window_,
+                                                     .recv_window = static_cast<std::int64_t>(
+                                                         config_.initial_window_size),
+                                                     .urgency = urgency,
+                                                     .incremental = incremental})
+                    .first->second};
+        if (end_stream)
+        {
+            dispatch(s);
+        }
+    }
+
+    void on_headers(const frame_header &header, std::string_view payload)
+    {
+        if (header.stream_id == 0 || !(header.stream_id & 1))
+        {
+            throw connection_error{error_code::protocol_error, "HEADERS frame on an invalid stream"};
+        }
+        if (!streams_.contains(header.stream_id))
+        {
+            if (header.stream_id <= last_stream_id_)
+            {
+                throw connection_error{error_code::stream_closed, "HEADERS frame on a closed stream"};
+            }
+            last_stream_id_ = header.stream_id;
+        }
+
+        payload = unpad(header, payload);
+        if (header.flags & flags::priority)
+        {
+            if (payload.size() < 5)
+            {
+                throw connection_error{error_code::frame_size_error, "truncated priority fields"};
+            }
+            payload.remove_prefix(5);
+        }
+
+        header_stream_id_ = header.stream_id;
+        header_end_stream_ = header.flags & flags::end_stream;
+        header_early_ = early_data_bytes_ > 0;
+        header_block_.assign(payload);
+        if (header.flags & flags::end_headers)
+        {
+            on_header_block();
+        }
+    }
+
+    void on_continuation(const frame_header &header, const std::string_view payload)
+    {
+        if (header_stream_id_ == 0 || header.stream_id != header_stream_id_)
+        {
+            throw connection_error{error_code::protocol_error, "unexpected CONTINUATION frame"};
+        }
+        if (header_block_.size() + payload.size() > config_.max_header_list_size)
+        {
+            throw connection_error{error_code::enhance_your_calm, "header block too large"};
+        }
+        header_block_.append(payload);
+        if (header.flags & flags::end_headers)
+        {
+            on_header_block();
+        }
+    }
+
+    void on_data(const frame_header &header, const std::string_view payload)
+    {
+        if (header.stream_id == 0)
+        {
+            throw connection_error{error_code::protocol_error, "DATA frame on stream 0"};
+        }
+
+        // the whole frame including padding counts against the windows
+        recv_window_ -= header.length;
+        if (recv_window_ < 0)
+        {
+            throw connection_error{error_code::flow_control_error, "connection receive window exceeded"};
+        }
+        if (recv_window_ <= connection_window_ / 2)
+        {
+            queue_window_update(0, static_cast<std::uint32_t>(connection_window_ - recv_window_));
+            recv_window_ = connection_window_;
+            notify_writer();
+        }
+
+        auto it{streams_.find(header.stream_id)};
+        if (it == streams_.end())
+        {
+            if (header.stream_id > last_stream_id_)
+            {
+                throw connection_error{error_code::protocol_error, "DATA frame on an idle stream"};
+            }
+            throw stream_error{header.stream_id, error_code::stream_closed, "DATA frame on a closed stream"};
+        }
+        auto &s{it->second};
+        if (s.remote_closed)
+        {
+            throw stream_error{s.id, error_code::stream_closed, "DATA frame on a half-closed stream"};
+        }
+
+        s.recv_window -= header.length;
+        if (s.recv_window < 0)
+        {
+            throw stream_error{s.id, error_code::flow_control_error, "stream receive window exceeded"};
+        }
+
+        const auto data{unpad(header, payload)};
+        if (s.request.body().size() + data.size() > config_.max_request_body_bytes)
+        {
+            throw stream_error{s.id, error_code::cancel, "request body too large"};
+        }
+        s.request.body().append(data);
+
+        if (header.flags & flags::end_stream)
+        {
+            dispatch(s);
+        }
+        else if (s.recv_window <= static_cast<std::int64_t>(config_.initial_window_size / 2))
+        {
+            queue_window_update(s.id, static_cast<std::uint32_t>(config_.initial_window_size - s.recv_window));
+            s.recv_window = static_cast<std::int64_t>(config_.initial_window_size);
+            notify_writer();
+        }
+    }
+
+    void on_settings(const frame_header &header, const std::string_view payload)
+    {
+        if (header.stream_id != 0)
+        {
+            throw connection_error{error_code::protocol_error, "SETTINGS frame on a stream"};
+        }
+        if (header.flags & flags::ack)
+        {
+            if (!payload.empty())
+            {
+                throw connection_error{error_code::frame_size_error, "SETTINGS acknowledgement with payload"};
+            }
+            return;
+        }
+        if (payload.size() % 6)
+        {
+            throw connection_error{error_code::frame_size_error, "malformed SETTINGS frame"};
+        }
+
+        const auto *data{reinterpret_cast<const std::uint8_t *>(payload.data())};
+        for (std::size_t i{}; i < payload.size(); i += 6)
+        {
+            const auto id{static_cast<setting>((data[i] << 8) | data[i + 1])};
+            const auto value{read_uint32(data + i + 2)};
+            switch (id)
+            {
+            case setting::header_table_size:
+                encoder_.max_table_size(value);
+                break;
+            case setting::enable_push:
+                if (value > 1)
+                {
+                    throw connection_error{error_code::protocol_error, "invalid SETTINGS_ENABLE_PUSH"};
+                }
+                break;
+            case setting::initial_window_size: {
+                if (value > max_window_size)
+                {
+                    throw connection_error{error_code::flow_control_error, "invalid SETTINGS_INITIAL_WINDOW_SIZE"};
+                }
+                const auto delta{static_cast<std::int64_t>(value) - peer_initial_window_};
+                for (auto &[_, s] : streams_)
+                {
+                    s.send_window += delta;
+                    if (s.send_window > max_window_size)
+                    {
+                        throw connection_error{error_code::flow_control_error, "stream send window overflow"};
+                    }
+                }
+                peer_initial_window_ = value;
+                break;
+            }
+            case setting::max_frame_size:
+                if (value < default_max_frame_size || value > 0xffffff)
+                {
+                    throw connection_error{error_code::protocol_error, "invalid SETTINGS_MAX_FRAME_SIZE"};
+                }
+                peer_max_frame_size_ = value;
+                break;
+            default:
+                break;
+            }
+        }
+        queue_frame(frame_type::settings, flags::ack, 0, {});
+        notify_writer();
+    }
+
+    void on_window_update(const frame_header &header, const std::string_view payload)
+    {
+        if (payload.size() != 4)
+        {
+            throw connection_error{error_code::frame_size_error, "malformed WINDOW_UPDATE frame"};
+        }
+        const auto increment{read_uint32(reinterpret_cast<const std::uint8_t *>(payload.data())) & max_window_size};
+        if (header.stream_id == 0)
+        {
+            if (increment == 0)
+            {
+                throw connection_error{error_code::protocol_error, "zero WINDOW_UPDATE increment"};
+            }
+            send_window_ += increment;
+            if (send_window_ > max_window_size)
+            {
+                throw connection_error{error_code::flow_control_error, "connection send window overflow"};
+            }
+        }
+        else
+        {
+            auto it{streams_.find(header.stream_id)};
+            if (it == streams_.end())
+            {
+                return;
+            }
+            if (increment == 0)
+            {
+                throw stream_error{header.stream_id, error_code::protocol_error, "zero WINDOW_UPDATE increment"};
+            }
+            it->second.send_window += increment;
+            if (it->second.send_window > max_window_size)
+            {
+                throw stream_error{header.stream_id, error_code::flow_control_error, "stream send window overflow"};
+            }
+        }
+        notify_writer();
+    }
+
+    void on_priority_update(const frame_header &header, const std::string_view payload)
+    {
+        if (header.stream_id != 0)
+        {
+            throw connection_error{error_code::protocol_error, "PRIORITY_UPDATE frame on a stream"};
+        }
+        if (payload.size() < 4)
+        {
+            throw connection_error{error_code::frame_size_error, "malformed PRIORITY_UPDATE frame"};
+        }
+        const auto stream_id{read_uint32(reinterpret_cast<const std::uint8_t *>(payload.data())) & max_window_size};
+        if (auto it{streams_.find(stream_id)}; it != streams_.end())
+        {
+            it->second.urgency = default_urgency;
+            it->second.incremental = false;
+            parse_priority(payload.substr(4), it->second.urgency, it->second.incremental);
+        }
+    }
+
+    void handle_frame(const frame_header &header, const std::string_view payload)
+    {
+        if (header_stream_id_ && header.type != frame_type::continuation)
+        {
+            throw connection_error{error_code::protocol_error, "header block interrupted"};
+        }
+
+        switch (header.type)
+        {
+        case frame_type::data:
+            on_data(header, payload);
+            break;
+        case frame_type::headers:
+            on_headers(header, payload);
+            break;
+        case frame_type::continuation:
+            on_continuation(header, payload);
+            break;
+        case frame_type::priority:
+            if (header.stream_id == 0)
+            {
+                throw connection_error{error_code::protocol_error, "PRIORITY frame on stream 0"};
+            }
+            if (payload.size() != 5)
+            {
+                throw stream_error{header.stream_id, error_code::frame_size_error, "malformed PRIORITY frame"};
+            }
+            break;
+        case frame_type::rst_stream:
+            if (header.stream_id == 0 || header.stream_id > last_stream_id_)
+            {
+                throw connection_error{error_code::protocol_error, "RST_STREAM frame on an idle stream"};
+            }
+            if (payload.size() != 4)
+            {
+                throw connection_error{error_code::frame_size_error, "malformed RST_STREAM frame"};
+            }
+            if (streams_.erase(header.stream_id))
+            {
+                charge_reset();
+            }
+            break;
+        case frame_type::settings:
+            on_settings(header, payload);
+            break;
+        case frame_type::push_promise:
+            throw connection_error{error_code::protocol_error, "PUSH_PROMISE frame from a client"};
+        case frame_type::ping:
+            if (header.stream_id != 0)
+            {
+                throw connection_error{error_code::protocol_error, "PING frame on a stream"};
+            }
+            if (payload.size() != 8)
+            {
+                throw connection_error{error_code::frame_size_error, "malformed PING frame"};
+            }
+            if (!(header.flags & flags::ack))
+            {
+                queue_frame(frame_type::ping, flags::ack, 0, payload);
+                notify_writer();
+            }
+            break;
+        case frame_type::goaway:
+            LPBACKEND_LOG(lg_, debug) << "Received GOAWAY";
+            break;
+        case frame_type::window_update:
+            on_window_update(header, payload);
+            break;
+        case frame_type::priority_update:
+            on_priority_update(header, payload);
+            break;
+        default: // unknown frame types are ignored
+            break;
+        }
+    }
+
+    // Reads until the buffer holds at least `size` bytes, returns false once the peer is gone
+    boost::asio::awaitable<bool, executor_type> fill(const std::size_t size)
+    {
+        while (buffer_.size() < size)
+        {
+            auto [ec, bytes]{co_await stream_.async_read_some(
+                buffer_.prepare(std::max<std::size_t>(size - buffer_.size(), default_max_frame_size)),
+                asio::recycled_tuple)};
+            if (ec == boost::asio::error::eof || ec == boost::asio::ssl::error::stream_truncated ||
+                (ec && !boost::beast::get_lowest_layer(stream_).socket().is_open()))
+            {
+                co_return false;
+            }
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+            buffer_.commit(bytes);
+        }
+        co_return true;
+    }
+
+    void consume(const std::size_t size)
+    {
+        buffer_.consume(size);
+        early_data_bytes_ -= std::min(early_data_bytes_, size);
+    }
+
+    boost::asio::awaitable<void, executor_type> read_frames()
+    {
+        struct finisher
+        {
+            session &self;
+            ~finisher()
+            {
+                self.reading_done_ = true;
+                self.notify_writer();
+            }
+        } finisher{*this};
+
+        try
+        {
+            if (!co_await fill(connection_preface.size()))
+            {
+                co_return;
+            }
+            if (std::string_view{static_cast<const char *>(buffer_.data().data()), connection_preface.size()} !=
+                connection_preface)
+            {
+                throw connection_error{error_code::protocol_error, "invalid connection preface"};
+            }
+            consume(connection_preface.size());
+
+            for (;;)
+            {
+                if (!co_await fill(frame_header::size))
+                {
+                    co_return;
+                }
+                const auto header{frame_header::parse(static_cast<const std::uint8_t *>(buffer_.data().data()))};
+                if (header.length > default_max_frame_size)
+                {
+                    throw connection_error{error_code::frame_size_error, "frame exceeds SETTINGS_MAX_FRAME_SIZE"};
+                }
+                if (!co_await fill(frame_header::size + header.length))
+                {
+                    co_return;
+                }
+                deadline_.reset();
+
+                const std::string_view payload{static_cast<const char *>(buffer_.data().data()) + frame_header::size,
+                                               header.length};
+                try
+                {
+                    handle_frame(header, payload);
+                }
+                catch (const stream_error &e)
+                {
+                    LPBACKEND_LOG(lg_, debug) << fmt::format("Resetting stream {}: {}", e.stream_id(), e.what());
+                    reset_stream(e.stream_id(), e.code());
+                    notify_writer();
+                }
+                consume(frame_header::size + header.length);
+                // only frames queued by this coroutine stay in output_ while the writer waits for the peer
+                if (output_.size() > max_queued_control_bytes)
+                {
+                    throw connection_error{error_code::enhance_your_calm, "peer does not read control frames"};
+                }
+            }
+        }
+        catch (const connection_error &e)
+        {
+            LPBACKEND_LOG(lg_, debug) << fmt::format("HTTP/2 connection error: {}", e.what());
+            queue_goaway(e.code(), e.what());
+        }
+    }
+
+    void queue_headers(stream_state &s)
+    {
+        std::string block{};
+        encoder_.begin_block(block);
+        std::visit(
+            [&](const auto &r) {
+                encoder_.encode(":status", std::to_string(r.result_int()), block);
+                std::string name{};
+                for (const auto &field : r.base())
+                {
+                    name.assign(field.name_string());
+                    std::ranges::transform(name, name.begin(),
+                                           [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                    if (name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+                        name == "transfer-encoding" || name == "upgrade")
+                    {
+                        continue;
+                    }
+                    encoder_.encode(name, field.value(), block, name == "set-cookie" || name == "authorization");
+                }
+            },
+            *s.res);
+
+        std::string_view rest{block};
+        auto type{frame_type::headers};
+        const std::uint8_t end_stream{s.body_size == 0 ? flags::end_stream : std::uint8_t{}};
+        do
+        {
+            const auto chunk{rest.substr(0, peer_max_frame_size_)};
+            rest.remove_prefix(chunk.size());
+            queue_frame(type, static_cast<std::uint8_t>((type == frame_type::headers ? end_stream : 0) |
+                                                        (rest.empty() ? flags::end_headers : 0)),
+                        s.id, chunk);
+            type = frame_type::continuation;
+        } while (!rest.empty());
+        s.headers_sent = true;
+    }
+
+    void read_body(stream_state &s, char *out, const std::size_t size)
+    {
+        std::visit(
+            [&](auto &r) {
+                using response_type = std::decay_t<decltype(r)>;
+                if constexpr (std::is_same_v<response_type, string_response>)
+                {
+                    std::memcpy(out, r.body().data() + s.body_offset, size);
+                }
+                else if constexpr (std::is_same_v<response_type, asset_response>)
+                {
+                    std::memcpy(out, r.body().data().data() + s.body_offset, size);
+                }
+                else if constexpr (std::is_same_v<response_type, file_response>)
+                {
+                    if (const auto content{r.body().file().content()})
+                    {
+                        std::memcpy(out, content->data() + s.body_offset, size);
+                        return;
+                    }
+                    std::size_t done{};
+                    while (done < size)
+                    {
+                        boost::beast::error_code ec{};
+                        const auto n{r.body().file().read_at(s.body_offset + done, out + done, size - done, ec)};
+                        if (ec)
+                        {
+                            throw boost::system::system_error{ec};
+                        }
+                        if (n == 0)
+                        {
+                            throw stream_error{s.id, error_code::internal_error, "file truncated"};
+                        }
+                        done += n;
+                    }
+                }
+            },
+            *s.res);
+        s.body_offset += size;
+    }
+
+    // Picks the stream to send DATA for next by urgency, then by stream id for
+    // non-incremental responses and round robin for incremental ones
+    stream_state *next_data_stream()
+    {
+        stream_state *best{};
+        for (auto &[id, s] : streams_)
+        {
+            if (!s.headers_sent || s.body_offset >= s.body_size || s.send_window <= 0)
+            {
+                continue;
+            }
+            if (!best || s.urgency < best->urgency ||
+                (s.urgency == best->urgency && best->incremental &&
+                 (!s.incremental || (best->id <= last_incremental_ && id > last_incremental_))))
+            {
+                best = &s;
+            }
+        }
+        return best;
+    }
+
+    void queue_data()
+    {
+        while (output_.size() < write_budget && send_window_ > 0)
+        {
+            auto *s{next_data_stream()};
+            if (!s)
+            {
+                return;
+            }
+            const auto size{static_cast<std::size_t>(
+                std::min<std::uint64_t>({s->body_size - s->body_offset, static_cast<std::uint64_t>(s->send_window),
+                                         static_cast<std::uint64_t>(send_window_), peer_max_frame_size_,
+                                         write_budget - output_.size()}))};
+            const auto last{s->body_offset + size == s->body_size};
+
+            frame_header{.length = static_cast<std::uint32_t>(size),
+                         .type = frame_type::data,
+                         .flags = last ? flags::end_stream : std::uint8_t{},
+                         .stream_id = s->id}
+                .serialize(output_);
+            const auto offset{output_.size()};
+            output_.resize(offset + size);
+            try
+            {
+                read_body(*s, output_.data() + offset, size);
+            }
+            catch (const std::exception &e)
+            {
+                LPBACKEND_LOG(lg_, error) << fmt::format("Failed to read response body: {}", e.what());
+                output_.resize(offset - frame_header::size);
+                reset_stream(s->id, error_code::internal_error);
+                continue;
+            }
+            s->send_window -= static_cast<std::int64_t>(size);
+            send_window_ -= static_cast<std::int64_t>(size);
+            if (s->incremental)
+            {
+                last_incremental_ = s->id;
+            }
+            if (last)
+            {
+                streams_.erase(s->id);
+            }
+        }
+    }
+
+    bool writable() const
+    {
+        if (!output_.empty() || !ready_.empty())
+        {
+            return true;
+        }
+        if (send_window_ <= 0)
+        {
+            return false;
+        }
+        return std::ranges::any_of(streams_, [](const auto &entry) {
+            const auto &s{entry.second};
+            return s.headers_sent && s.body_offset < s.body_size && s.send_window > 0;
+        });
+    }
+
+    boost::asio::awaitable<void, executor_type> write_frames()
+    {
+        std::string writing{};
+        for (;;)
+        {
+            while (!reading_done_ && !writable())
+            {
+                co_await writable_.async_wait(asio::recycled_tuple);
+            }
+            if (reading_done_)
+            {
+                // flush the frames queued by the reader, such as GOAWAY
+                streams_.clear();
+                ready_.clear();
+                if (output_.empty())
+                {
+                    co_return;
+                }
+            }
+
+            // headers are sent in the order the responses became ready
+            while (!ready_.empty())
+            {
+                auto it{streams_.find(ready_.front())};
+                ready_.pop_front();
+                if (it == streams_.end())
+                {
+                    continue;
+                }
+                queue_headers(it->second);
+                if (it->second.body_size == 0)
+                {
+                    streams_.erase(it);
+                }
+            }
+            queue_data();
+
+            writing.clear();
+            std::swap(writing, output_);
+            auto [ec, _]{co_await boost::asio::async_write(stream_, boost::asio::buffer(writing), asio::recycled_tuple)};
+            if (ec && !boost::beast::get_lowest_layer(stream_).socket().is_open())
+            {
+                co_return;
+            }
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+            deadline_.reset();
+        }
+    }
+
+  public:
+    session(Stream &stream, session_buffer &buffer, const config_type &config,
+            asio::timing_wheel::timer &deadline, Handler handler, const std::size_t early_data_bytes = 0)
+        : stream_{stream}, buffer_{buffer}, config_{config}, deadline_{deadline}, handler_{std::move(handler)},
+          decoder_{static_cast<std::size_t>(config.header_table_size),
+                   static_cast<std::size_t>(config.max_header_list_size)},
+          connection_window_{std::max<std::int64_t>(static_cast<std::int64_t>(config.initial_window_size),
+                                                    default_window_size)},
+          recv_window_{connection_window_}, early_data_bytes_{early_data_bytes},
+          writable_{stream.get_executor(), boost::asio::steady_timer::time_point::max()}
+    {
+    }
+
+    /**
+     * @brief Serves the connection until either side closes it
+     */
+    boost::asio::awaitable<void, executor_type> run()
+    {
+        using namespace boost::asio::experimental::awaitable_operators;
+
+        std::string settings{};
+        const auto add_setting{[&settings](const setting id, const std::uint64_t value) {
+            settings.push_back(static_cast<char>((static_cast<std::uint16_t>(id) >> 8) & 0xff));
+            settings.push_back(static_cast<char>(static_cast<std::uint16_t>(id) & 0xff));
+            write_uint32(settings, static_cast<std::uint32_t>(value));
+        }};
+        add_setting(setting::header_table_size, config_.header_table_size);
+        add_setting(setting::enable_push, 0);
+        add_setting(setting::max_concurrent_streams, config_.max_concurrent_streams);
+        add_setting(setting::initial_window_size, config_.initial_window_size);
+        add_setting(setting::max_header_list_size, config_.max_header_list_size);
+        queue_frame(frame_type::settings, 0, 0, settings);
+        if (connection_window_ > default_window_size)
+        {
+            queue_window_update(0, static_cast<std::uint32_t>(connection_window_ - default_window_size));
+        }
+
+        std::exception_ptr eptr{};
+        try
+        {
+            co_await (read_frames() && write_frames());
+        }
+        catch (...)
+        {
+            eptr = std::current_exception();
+        }
+
+        // responses still being produced refer to the session, so wait for them even when cancelled
+        co_await boost::asio::this_coro::reset_cancellation_state(
+            [](boost::asio::cancellation_type) { return boost::asio::cancellation_type::none; });
+        while (pending_handlers_ > 0)
+        {
+            co_await writable_.async_wait(asio::recycled_tuple);
+        }
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    }
+
+    session(const session &) = delete;
+    session &operator=(const session &) = delete;
+};
+} // namespace lpbackend::networking::http2
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+#include <lpbackend/log.hpp>
+
+namespace lpbackend::networking
+{
+/**
+ * @brief A response to an API GET as it is kept by micro_cache
+ */
+struct cached_response
+{
+    boost::beast::http::status status{boost::beast::http::status::ok};
+    std::string content_type{"application/json"};
+    std::string body;
+};
+
+/**
+ * @brief A short-lived cache of API GET responses with request coalescing
+ *
+ * Routes opt in by answering through fetch() with a policy of their own.
+ * Requests are keyed by their normalized path, their query parameters in
+ * sorted order and the request headers the policy varies on. Concurrent
+ * misses of one key wait for a single computation instead of repeating
+ * it. Once the TTL has passed, a response is still served for the
+ * stale-while-revalidate window while one request recomputes it in the
+ * background.
+ *
+ * Computations are not cached when they throw, every request that waited
+ * for one receives the exception. A computation runs detached from the
+ * request that started it and is cancelled after the timeout of its route.
+ * Its waiters fail with timed_out at that point even if it ignores the
+ * cancellation, so a stuck computation never holds requests.
+ */
+class LPBACKEND_EXTERN micro_cache
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+    using result_type = std::shared_ptr<const cached_response>;
+
+    struct policy
+    {
+        clock_type::duration ttl{std::chrono::milliseconds{500}};
+        clock_type::duration stale_while_revalidate{};
+        clock_type::duration timeout{std::chrono::seconds{5}};
+        // request headers whose values are part of the key
+        std::vector<boost::beast::http::field> vary{};
+    };
+
+    struct statistics
+    {
+        std::uint64_t hits;
+        std::uint64_t stale_hits;
+        std::uint64_t misses;
+        std::uint64_t coalesced;
+        std::uint64_t revalidations;
+        std::uint64_t failures;
+        std::size_t entries;
+        std::size_t memory;
+    };
+
+  private:
+    using completion_type = std::move_only_function<void(std::exception_ptr, result_type)>;
+
+    struct entry
+    {
+        std::string key;
+        result_type response;
+        clock_type::time_point fresh_until;
+        clock_type::time_point stale_until;
+        std::size_t charge;
+    };
+
+    // a computation in progress, completed once by the computation or by its timeout
+    struct flight
+    {
+        clock_type::time_point deadline;
+        bool done{};
+        std::exception_ptr error{};
+        result_type response{};
+        std::uint64_t next_waiter{};
+        std::vector<std::pair<std::uint64_t, completion_type>> waiters{};
+    };
+
+    enum class outcome
+    {
+        hit,
+        stale,
+        // stale, and the caller recomputes it
+        revalidate,
+        coalesce,
+        // missing, and the caller computes it
+        compute
+    };
+
+    struct claim
+    {
+        outcome kind;
+        result_type response{};
+        std::shared_ptr<flight> pending{};
+    };
+
+    logger lg_{channel_logger("micro_cache")};
+    std::mutex mutex_;
+    // most recently used first
+    std::list<entry> entries_;
+    std::unordered_map<std::string_view, std::list<entry>::iterator> index_;
+    std::unordered_map<std::string, std::shared_ptr<flight>> flights_;
+    std::size_t memory_{};
+    std::size_t max_memory_{};
+
+    std::atomic<std::uint64_t> hits_{};
+    std::atomic<std::uint64_t> stale_hits_{};
+    std::atomic<std::uint64_t> misses_{};
+    std::atomic<std::uint64_t> coalesced_{};
+    std::atomic<std::uint64_t> revalidations_{};
+    std::atomic<std::uint64_t> failures_{};
+
+    // requires mutex_ to be held
+    void erase(std::list<entry>::iterator it);
+    claim acquire(const std::string &key, const policy &route);
+    // returns the id of the waiter, or std::nullopt if the flight was done and completion was called
+    std::optional<std::uint64_t> wait(flight &pending, completion_type completion);
+    // fails one waiter with operation_aborted, or the whole flight with timed_out once it is past its deadline,
+    // waiters are cancelled at the deadline
+    void cancel_wait(const std::string &key, const std::shared_ptr<flight> &pending, std::uint64_t waiter);
+    // stores the response and wakes the requests that wait for it
+    void complete(const std::string &key, const std::shared_ptr<flight> &pending, const policy &route,
+                  std::exception_ptr error, result_type response);
+    // fails the waiters of a flight and forgets it, a late response of its computation is still stored
+    void abandon(const std::string &key, const std::shared_ptr<flight> &pending, std::exception_ptr error);
+
+    template <typename CompletionToken = boost::asio::deferred_t>
+    auto async_wait(std::string key, std::shared_ptr<flight> pending, CompletionToken &&token = {})
+    {
+        return boost::asio::async_initiate<CompletionToken, void(std::exception_ptr, result_type)>(
+            [this](auto handler, std::string key, std::shared_ptr<flight> pending) {
+                auto slot{boost::asio::get_associated_cancellation_slot(handler)};
+                auto work{boost::asio::make_work_guard(boost::asio::get_associated_executor(handler))};
+                const auto waiter{wait(*pending, [handler = std::move(handler), work = std::move(work)](
+                                                     const std::exception_ptr error, result_type response) mutable {
+                    auto executor{work.get_executor()};
+                    work.reset();
+                    boost::asio::post(executor, [handler = std::move(handler), error,
+                                                 response = std::move(response)]() mutable {
+                        boost::asio::get_associated_cancellation_slot(handler).clear();
+                        std::move(handler)(error, std::move(response));
+                    });
+                })};
+                if (waiter && slot.is_connected())
+                {
+                    slot.assign([this, key = std::move(key), pending = std::move(pending), waiter = *waiter](
+                                    boost::asio::cancellation_type) { cancel_wait(key, pending, waiter); });
+                }
+            },
+            token, std::move(key), std::move(pending));
+    }
+
+    template <typename Compute>
+    boost::asio::awaitable<std::exception_ptr, executor_type> run_computation(std::string key, policy route,
+                                                                              std::shared_ptr<flight> pending,
+                                                                              Compute compute)
+    {
+        std::exception_ptr error{};
+        result_type response{};
+        try
+        {
+            response = std::make_shared<const cached_response>(co_await compute());
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        complete(key, pending, route, error, response);
+        co_return error;
+    }
+
+    // runs a computation detached from the request that started it, cancelled after the timeout of the route
+    template <typename Compute>
+    void start(const executor_type &executor, std::string key, policy route, std::shared_ptr<flight> pending,
+               Compute compute, const bool background)
+    {
+        auto completion{[this, key, background](const std::exception_ptr, const std::exception_ptr error) {
+            // requests that waited report failures themselves
+            if (!background || !error)
+            {
+                return;
+            }
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception &e)
+            {
+                LPBACKEND_LOG(lg_, warning) << "Failed to revalidate " << key << ": " << e.what();
+            }
+        }};
+        const auto timeout{route.timeout};
+        boost::asio::co_spawn(
+            executor, run_computation(std::move(key), std::move(route), std::move(pending), std::move(compute)),
+            boost::asio::cancel_after(timeout, boost::asio::bind_executor(executor, std::move(completion))));
+    }
+
+    static std::optional<std::string> canonical_target(std::string_view target);
+
+  public:
+    micro_cache() = default;
+    micro_cache(const micro_cache &) = delete;
+    micro_cache &operator=(const micro_cache &) = delete;
+
+    /**
+     * @brief Calls close()
+     */
+    ~micro_cache();
+
+    /**
+     * @brief Fails the requests that still wait for a computation with operation_aborted
+     *
+     * Their completions are posted to the executors of the requests, so this
+     * has to be called while those still exist.
+     */
+    void close();
+
+    void configure(const config::lpbackend_config::fields_t::http_t &http);
+
+    /**
+     * @brief Returns the key of a request under a policy
+     *
+     * @return std::nullopt if the path of the target cannot be normalized
+     */
+    template <typename Fields>
+    static std::optional<std::string> make_key(const std::string_view target, const Fields &fields,
+                                               const policy &route)
+    {
+        auto key{canonical_target(target)};
+        if (key)
+        {
+            for (const auto field : route.vary)
+            {
+                key->push_back('\n');
+                key->append(std::string_view{boost::beast::http::to_string(field)});
+                key->push_back(':');
+                key->append(std::string_view{fields[field]});
+            }
+        }
+        return key;
+    }
+
+    /**
+     * @brief Returns the response of key, computing it unless it is cached or already being computed
+     *
+     * @param compute a function returning `boost::asio::awaitable<cached_response, executor_type>`, it runs on the
+     * executor of the caller and outlives the request that started it
+     * @throws whatever the computation throws, boost::system::system_error with timed_out if it takes longer
+     * than the timeout of the route
+     */
+    template <typename Compute>
+    boost::asio::awaitable<result_type, executor_type> fetch(std::string key, policy route, Compute compute)
+    {
+        auto claimed{acquire(key, route)};
+        switch (claimed.kind)
+        {
+        case outcome::hit:
+        case outcome::stale:
+            co_return std::move(claimed.response);
+        case outcome::revalidate:
+            start(co_await boost::asio::this_coro::executor, std::move(key), std::move(route),
+                  std::move(claimed.pending), std::move(compute), true);
+            co_return std::move(claimed.response);
+        case outcome::coalesce:
+            break;
+        case outcome::compute:
+            start(co_await boost::asio::this_coro::executor, key, route, claimed.pending, std::move(compute), false);
+            break;
+        }
+        const auto deadline{claimed.pending->deadline};
+        co_return co_await async_wait(std::move(key), std::move(claimed.pending), boost::asio::cancel_at(deadline));
+    }
+
+    /**
+     * @brief Evicts the least recently used half of the responses, used when memory runs short
+     */
+    void shrink();
+
+    /**
+     * @brief Returns the counters since the last call
+     */
+    statistics collect();
+};
+} // namespace lpbackend::networking
@@ -28,6 +28,7 @@
 
 #include <lpbackend/extern.hpp>
 #include <lpbackend/log.hpp>
+#include <lpbackend/memory/accounting.hpp>
 #include <lpbackend/networking/file_downloader.hpp>
 #include <lpbackend/version.hpp>
 
@@ -87,6 +88,19 @@ class LPBACKEND_EXTERN mime_database
 
     static inline const std::string default_mime{"application/octet-stream"};
 
+    // an estimate, nodes and buckets of the map are not measured exactly
+    std::size_t footprint() const noexcept
+    {
+        std::size_t bytes{db_.bucket_count() * sizeof(void *)};
+        for (const auto &[ext, mime_type] : db_)
+        {
+            bytes += sizeof(decltype(db_)::value_type) + 2 * sizeof(void *);
+            bytes += ext.capacity() > 15 ? ext.capacity() + 1 : 0;
+            bytes += mime_type.capacity() > 15 ? mime_type.capacity() + 1 : 0;
+        }
+        return bytes;
+    }
+
   public:
     boost::asio::awaitable<void, executor_type> start_update(const boost::urls::url_view url)
     {
@@ -120,6 +134,7 @@ class LPBACKEND_EXTERN mime_database
             }
         }
 
+        memory::set_usage(memory::tag::mime_database, footprint());
         LPBACKEND_LOG(lg_, info) << fmt::format("Finished MIME database update ({} entries)", db_.size());
     }
 
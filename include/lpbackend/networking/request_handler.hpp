@@ -22,15 +22,51 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
 #include <boost/asio.hpp>
+#include <boost/asio/experimental/awaitable_operators.hpp>
 #include <boost/beast.hpp>
+#include <boost/json.hpp>
 
 #include <fmt/format.h>
+#include <openssl/crypto.h>
 
+#include <lpbackend/asio/blocking_pool.hpp>
+#include <lpbackend/asio/io_uring.hpp>
+#include <lpbackend/asio/recycling_allocator.hpp>
+#include <lpbackend/asio/timing_wheel.hpp>
+#include <lpbackend/auth/captcha_pool.hpp>
+#include <lpbackend/auth/password_hasher.hpp>
+#include <lpbackend/auth/register_session_store.hpp>
 #include <lpbackend/config/lpbackend_config.hpp>
 #include <lpbackend/extern.hpp>
 #include <lpbackend/log.hpp>
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/networking/asset_bundle.hpp>
+#include <lpbackend/networking/file_cache.hpp>
+#include <lpbackend/networking/http2/session.hpp>
+#include <lpbackend/networking/micro_cache.hpp>
 #include <lpbackend/networking/mime_database.hpp>
+#include <lpbackend/networking/response.hpp>
+#include <lpbackend/networking/response_templates.hpp>
+#include <lpbackend/networking/session_memory.hpp>
+#include <lpbackend/search/full_text_index.hpp>
+#include <lpbackend/storage/log_store.hpp>
+#include <lpbackend/util/codec.hpp>
 
 namespace lpbackend::networking
 {
@@ -43,8 +79,377 @@ class LPBACKEND_EXTERN request_handler
 
   private:
     logger lg_{channel_logger("request_handler")};
+    const config::lpbackend_config &config_;
+    asio::blocking_pool &blocking_pool_;
+    file_cache &file_cache_;
+    micro_cache &api_cache_;
+    auth::register_session_store &register_sessions_;
+    auth::captcha_pool &captchas_;
+    auth::password_hasher &password_hasher_;
+    storage::log_store &store_;
+    const search::full_text_index &search_index_;
+    std::atomic<std::shared_ptr<const asset_bundle>> assets_{};
+    const response_templates templates_{};
+    const bool async_files_{asio::io_uring_available()};
+    // usernames whose accounts are being created, a second registration of one is refused
+    std::mutex registering_mutex_;
+    std::unordered_set<std::string> registering_;
+
+    static constexpr std::size_t file_chunk_bytes{65536};
+    static constexpr std::string_view register_path{"/api/v1/auth/register"};
+    static constexpr std::string_view login_path{"/api/v1/auth/login"};
+    static constexpr std::string_view account_prefix{"user/"};
+    static constexpr std::size_t min_username_length{3};
+    static constexpr std::size_t max_username_length{32};
+    static constexpr std::size_t min_password_length{8};
+    static constexpr std::size_t max_password_length{128};
+    static constexpr std::string_view search_path{"/api/v1/search"};
+    static constexpr std::size_t max_search_hits{100};
+
+    struct queued_response
+    {
+        boost::beast::http::message_generator generator;
+        // the body of a file response when files are read through io_uring, it is written after the header
+        cached_file_body::value_type file{};
+    };
+
+    struct pipeline
+    {
+        std::deque<queued_response> responses;
+        // timers are used as condition variables, they are never expected to expire
+        boost::asio::steady_timer readable;
+        boost::asio::steady_timer writable;
+        bool reading_done{};
+        bool writing_done{};
+
+        explicit pipeline(const boost::asio::any_io_executor &executor)
+            : readable{executor, boost::asio::steady_timer::time_point::max()},
+              writable{executor, boost::asio::steady_timer::time_point::max()}
+        {
+        }
+    };
+
+    template <typename Stream>
+    boost::asio::awaitable<void, executor_type> read_requests(Stream &stream, session_buffer &buffer,
+                                                              const std::string_view doc_root,
+                                                              const std::string_view fallback_path, mime_database &db,
+                                                              asio::timing_wheel::timer &deadline, pipeline &pipe,
+                                                              std::size_t early_data_bytes)
+    {
+        auto state{co_await boost::asio::this_coro::cancellation_state};
+
+        // let the writer drain the pipeline however reading ends
+        struct finisher
+        {
+            pipeline &pipe;
+            ~finisher()
+            {
+                pipe.reading_done = true;
+                pipe.readable.cancel();
+            }
+        } finisher{pipe};
+
+        while (!state.cancelled())
+        {
+            while (pipe.responses.size() >= config_.fields.http.pipeline_depth && !pipe.writing_done)
+            {
+                co_await pipe.writable.async_wait(asio::recycled_tuple);
+            }
+            if (pipe.writing_done)
+            {
+                co_return;
+            }
+
+            // the request lives in the memory of the connection
+            boost::beast::http::request_parser<session_body, session_allocator> parser{
+                std::piecewise_construct, std::make_tuple(buffer.get_allocator()),
+                std::make_tuple(buffer.get_allocator())};
+
+            deadline.reset();
+            const bool early{early_data_bytes > 0};
+            auto [ec, bytes]{co_await boost::beast::http::async_read(stream, buffer, parser, asio::recycled_tuple)};
+            // a closed socket means the deadline expired
+            if (ec == boost::beast::http::error::end_of_stream ||
+                (ec && !boost::beast::get_lowest_layer(stream).socket().is_open()))
+            {
+                co_return;
+            }
+            // a malformed request is answered, the connection is closed after it
+            if (const auto kind{parse_error_kind(ec)})
+            {
+                pipe.responses.push_back(queue_response(templates_.make(*kind, 11, false)));
+                pipe.readable.cancel();
+                co_return;
+            }
+            if (ec == boost::beast::http::error::partial_message)
+            {
+                co_return;
+            }
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+
+            if (boost::beast::websocket::is_upgrade(parser.get()))
+            {
+                deadline.cancel();
+                // co_await run_websocket_session(stream, buffer, parser.release());
+                co_return;
+            }
+
+            early_data_bytes -= std::min(early_data_bytes, bytes);
+            auto req{parser.release()};
+            if (early)
+            {
+                mark_early_data(req);
+            }
+            auto res{co_await handle_request(std::move(req), doc_root, fallback_path, db)};
+            const auto keep{keep_alive(res)};
+            pipe.responses.push_back(queue_response(std::move(res)));
+            pipe.readable.cancel();
+
+            if (!keep)
+            {
+                co_return;
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the response to a request that failed to parse with ec, std::nullopt if ec is no parse error
+     *
+     * A message that ended with the connection is no parse error, there is nobody to answer.
+     */
+    static std::optional<response_templates::error> parse_error_kind(const boost::system::error_code ec) noexcept
+    {
+        using boost::beast::http::error;
+        if (ec.category() != boost::beast::http::make_error_code(error::bad_target).category() ||
+            ec == error::end_of_stream || ec == error::partial_message || ec == error::need_more)
+        {
+            return std::nullopt;
+        }
+        if (ec == error::header_limit)
+        {
+            return response_templates::error::header_too_large;
+        }
+        if (ec == error::body_limit)
+        {
+            return response_templates::error::body_too_large;
+        }
+        return response_templates::error::bad_request;
+    }
+
+    queued_response queue_response(response &&res)
+    {
+#if defined(BOOST_ASIO_HAS_IO_URING)
+        if (async_files_ && std::holds_alternative<file_response>(res) &&
+            !std::get<file_response>(res).body().file().content())
+        {
+            // the header keeps the content length of the file
+            auto &file{std::get<file_response>(res)};
+            auto body{std::move(file.body())};
+            return queued_response{boost::beast::http::message_generator{empty_response{std::move(file.base())}},
+                                   std::move(body)};
+        }
+#endif
+        return queued_response{to_message_generator(std::move(res))};
+    }
+
+#if defined(BOOST_ASIO_HAS_IO_URING)
+    template <typename Stream>
+    boost::asio::awaitable<bool, executor_type> write_file_body(Stream &stream,
+                                                                cached_file_body::value_type &body,
+                                                                asio::timing_wheel::timer &deadline)
+    {
+        // the descriptor is only borrowed from the shared file, other responses may read it concurrently
+        boost::asio::basic_random_access_file<executor_type> file{stream.get_executor(), body.file().native_handle()};
+        struct releaser
+        {
+            boost::asio::basic_random_access_file<executor_type> &file;
+            ~releaser()
+            {
+                boost::system::error_code ec{};
+                file.release(ec);
+            }
+        } releaser{file};
+
+        std::vector<char> chunk(std::min<std::uint64_t>(body.size(), file_chunk_bytes));
+        std::uint64_t offset{};
+        while (offset < body.size())
+        {
+            const auto size{std::min<std::uint64_t>(body.size() - offset, chunk.size())};
+            auto [ec, bytes]{co_await boost::asio::async_read_at(file, offset, boost::asio::buffer(chunk.data(), size),
+                                                                 asio::recycled_tuple)};
+            if (ec)
+            {
+                // the content length is already sent, so the connection can only be dropped
+                throw boost::system::system_error{ec};
+            }
+            std::tie(ec, std::ignore) = co_await boost::asio::async_write(
+                stream, boost::asio::buffer(chunk.data(), bytes), asio::recycled_tuple);
+            if (ec && !boost::beast::get_lowest_layer(stream).socket().is_open())
+            {
+                co_return false;
+            }
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+            deadline.reset();
+            offset += bytes;
+        }
+        co_return true;
+    }
+#endif
+
+    template <typename Request> static void mark_early_data(Request &req)
+    {
+        // RFC 8470 5.1
+        req.set("Early-Data", "1");
+    }
+
+    template <typename Stream>
+    boost::asio::awaitable<void, executor_type> write_responses(Stream &stream, asio::timing_wheel::timer &deadline,
+                                                                pipeline &pipe, const session_allocator &allocator)
+    {
+        struct finisher
+        {
+            pipeline &pipe;
+            ~finisher()
+            {
+                pipe.writing_done = true;
+                pipe.writable.cancel();
+            }
+        } finisher{pipe};
+
+        session_buffer coalesced{allocator};
+        std::vector<boost::asio::const_buffer> gathered{};
+
+        for (;;)
+        {
+            while (pipe.responses.empty() && !pipe.reading_done)
+            {
+                co_await pipe.readable.async_wait(asio::recycled_tuple);
+            }
+            if (pipe.responses.empty())
+            {
+                co_return;
+            }
+
+            // Small pieces of queued responses are copied into one buffer, the
+            // first piece that does not fit is written in place after them
+            coalesced.clear();
+            gathered.clear();
+            queued_response *partial{};
+            std::size_t partial_size{};
+            while (!pipe.responses.empty())
+            {
+                auto &queued{pipe.responses.front()};
+                auto &generator{queued.generator};
+                boost::beast::error_code ec{};
+                const auto buffers{generator.prepare(ec)};
+                if (ec)
+                {
+                    throw boost::system::system_error{ec};
+                }
+
+                const auto size{boost::asio::buffer_size(buffers)};
+                if (coalesced.size() + size > config_.fields.http.write_coalesce_bytes)
+                {
+                    gathered.push_back(coalesced.data());
+                    gathered.insert(gathered.end(), buffers.begin(), buffers.end());
+                    partial = &queued;
+                    partial_size = size;
+                    break;
+                }
+
+                boost::asio::buffer_copy(coalesced.prepare(size), buffers);
+                coalesced.commit(size);
+                generator.consume(size);
+                if (generator.is_done() && queued.file.is_open())
+                {
+                    break;
+                }
+                if (generator.is_done())
+                {
+                    pipe.responses.pop_front();
+                    pipe.writable.cancel();
+                }
+            }
+
+            boost::system::error_code ec{};
+            if (partial)
+            {
+                std::tie(ec, std::ignore) = co_await boost::asio::async_write(stream, gathered, asio::recycled_tuple);
+            }
+            else
+            {
+                std::tie(ec, std::ignore) =
+                    co_await boost::asio::async_write(stream, coalesced.data(), asio::recycled_tuple);
+            }
+            if (ec && !boost::beast::get_lowest_layer(stream).socket().is_open())
+            {
+                co_return;
+            }
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+            deadline.reset();
+
+            if (partial)
+            {
+                // responses are only popped here, so the reference is still valid
+                partial->generator.consume(partial_size);
+                if (partial->generator.is_done() && !partial->file.is_open())
+                {
+                    pipe.responses.pop_front();
+                    pipe.writable.cancel();
+                }
+            }
+
+#if defined(BOOST_ASIO_HAS_IO_URING)
+            if (!pipe.responses.empty() && pipe.responses.front().generator.is_done())
+            {
+                if (!co_await write_file_body(stream, pipe.responses.front().file, deadline))
+                {
+                    co_return;
+                }
+                pipe.responses.pop_front();
+                pipe.writable.cancel();
+            }
+#endif
+        }
+    }
 
   public:
+    request_handler(const config::lpbackend_config &config, asio::blocking_pool &blocking_pool,
+                    file_cache &file_cache, micro_cache &api_cache, auth::register_session_store &register_sessions,
+                    auth::captcha_pool &captchas, auth::password_hasher &password_hasher, storage::log_store &store,
+                    const search::full_text_index &search_index)
+        : config_{config}, blocking_pool_{blocking_pool}, file_cache_{file_cache}, api_cache_{api_cache},
+          register_sessions_{register_sessions}, captchas_{captchas}, password_hasher_{password_hasher},
+          store_{store}, search_index_{search_index}
+    {
+    }
+
+    /**
+     * @brief Replaces the asset bundle that is consulted before doc_root
+     *
+     * Responses in flight keep the previous bundle mapped.
+     *
+     * @param bundle nullptr to serve doc_root only
+     */
+    void set_asset_bundle(std::shared_ptr<const asset_bundle> bundle) noexcept
+    {
+        assets_.store(std::move(bundle), std::memory_order_release);
+    }
+
+    std::shared_ptr<const asset_bundle> get_asset_bundle() const noexcept
+    {
+        return assets_.load(std::memory_order_acquire);
+    }
+
     // Append an HTTP rel-path to a local filesystem path.
     // The returned path is normalized for the platform.
     std::string path_cat(boost::beast::string_view base, boost::beast::string_view path)
@@ -73,146 +478,831 @@ class LPBACKEND_EXTERN request_handler
         return result;
     }
 
+    /**
+     * @brief Answers the complete requests received as TLS early data before the handshake completes
+     *
+     * The requests are marked with "Early-Data: 1", so unsafe methods are
+     * answered with 425 Too Early. An incomplete request is left for run_session.
+     *
+     * @return false if the connection is not kept alive
+     */
+    template <typename Acceptor>
+    boost::asio::awaitable<bool, executor_type> respond_early_data(Acceptor &acceptor, const std::string_view doc_root,
+                                                                   const std::string_view fallback_path,
+                                                                   mime_database &db)
+    {
+        while (!acceptor.early_data().empty())
+        {
+            const auto data{acceptor.early_data()};
+            boost::beast::http::request_parser<boost::beast::http::string_body> parser{};
+            parser.eager(true);
+            std::size_t used{};
+            boost::beast::error_code ec{};
+            while (!parser.is_done() && used < data.size())
+            {
+                const auto bytes{parser.put(boost::asio::buffer(data.data() + used, data.size() - used), ec)};
+                used += bytes;
+                if (ec || bytes == 0)
+                {
+                    break;
+                }
+            }
+            if (const auto kind{parse_error_kind(ec)})
+            {
+                auto generator{to_message_generator(templates_.make(*kind, 11, false))};
+                co_await acceptor.write_early_response(generator);
+                co_return false;
+            }
+            if (ec == boost::beast::http::error::need_more || !parser.is_done())
+            {
+                co_return true;
+            }
+            if (ec)
+            {
+                throw boost::system::system_error{ec};
+            }
+            if (boost::beast::websocket::is_upgrade(parser.get()))
+            {
+                co_return true;
+            }
+
+            acceptor.consume_early_data(used);
+            auto req{parser.release()};
+            mark_early_data(req);
+            auto res{co_await handle_request(std::move(req), doc_root, fallback_path, db)};
+            const auto keep{keep_alive(res)};
+            auto generator{to_message_generator(std::move(res))};
+            if (!co_await acceptor.write_early_response(generator) || !keep)
+            {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
     template <typename Stream>
-    boost::asio::awaitable<void, executor_type> run_session(Stream &stream, boost::beast::flat_buffer &buffer,
+    boost::asio::awaitable<void, executor_type> run_session(Stream &stream, session_buffer &buffer,
                                                             const std::string_view doc_root,
-                                                            const std::string_view fallback_path, mime_database &db)
+                                                            const std::string_view fallback_path, mime_database &db,
+                                                            asio::timing_wheel::timer &deadline,
+                                                            const std::size_t early_data_bytes = 0)
     {
-        auto state{co_await boost::asio::this_coro::cancellation_state};
+        using namespace boost::asio::experimental::awaitable_operators;
 
-        while (!state.cancelled())
+        // Requests are read and handled while earlier responses are still
+        // being written, the pipeline keeps the responses in request order
+        pipeline pipe{co_await boost::asio::this_coro::executor};
+        co_await (read_requests(stream, buffer, doc_root, fallback_path, db, deadline, pipe, early_data_bytes) &&
+                  write_responses(stream, deadline, pipe, buffer.get_allocator()));
+    }
+
+    /**
+     * @brief Runs an HTTP/2 session on a stream that negotiated "h2" via ALPN
+     */
+    template <typename Stream>
+    boost::asio::awaitable<void, executor_type> run_http2_session(Stream &stream, session_buffer &buffer,
+                                                                  const std::string_view doc_root,
+                                                                  const std::string_view fallback_path,
+                                                                  mime_database &db,
+                                                                  asio::timing_wheel::timer &deadline,
+                                                                  const std::size_t early_data_bytes = 0)
+    {
+        auto handler{[this, doc_root, fallback_path,
+                        &db](boost::beast::http::request<boost::beast::http::string_body> &&req) {
+            return handle_request(std::move(req), doc_root, fallback_path, db);
+        }};
+        http2::session<Stream, decltype(handler)> session{stream, buffer, config_.fields.http2, deadline,
+                                                          std::move(handler), early_data_bytes};
+        co_await session.run();
+    }
+
+    /**
+     * @brief Answers every request with a permanent redirect to HTTPS and closes the connection
+     *
+     * The constant parts of the response are serialized once, so only the
+     * request header is parsed and the location is written in between.
+     *
+     * @param host of the location, the Host header of the request if empty
+     * @param port of the location, omitted if 443
+     */
+    template <typename Stream>
+    boost::asio::awaitable<void, executor_type> run_redirect_session(Stream &stream, session_buffer &buffer,
+                                                                     const std::string_view host,
+                                                                     const std::uint16_t port,
+                                                                     asio::timing_wheel::timer &deadline)
+    {
+        static constexpr std::string_view head{"HTTP/1.1 301 Moved Permanently\r\n"
+                                               "Content-Length: 0\r\n"
+                                               "Connection: close\r\n"
+                                               "Location: https://"};
+        static constexpr std::string_view tail{"\r\n\r\n"};
+
+        boost::beast::http::request_parser<boost::beast::http::empty_body> parser{};
+        auto [ec, bytes]{co_await boost::beast::http::async_read_header(stream, buffer, parser, asio::recycled_tuple)};
+        if (ec == boost::beast::http::error::end_of_stream ||
+            (ec && !boost::beast::get_lowest_layer(stream).socket().is_open()))
         {
-            boost::beast::http::request_parser<boost::beast::http::string_body> parser{};
+            co_return;
+        }
+        if (ec)
+        {
+            throw boost::system::system_error{ec};
+        }
 
-            auto [ec, _]{co_await boost::beast::http::async_read(stream, buffer, parser, boost::asio::as_tuple)};
-            if (ec == boost::beast::http::error::end_of_stream)
+        const auto &req{parser.get()};
+        std::string authority{host};
+        if (authority.empty())
+        {
+            const std::string_view request_host{req[boost::beast::http::field::host]};
+            // strip the port of the plain listener, but not the colons of an IPv6 literal
+            const auto colon{request_host.rfind(':')};
+            authority = colon != std::string_view::npos && request_host.find(']', colon) == std::string_view::npos
+                            ? request_host.substr(0, colon)
+                            : request_host;
+        }
+        if (authority.empty())
+        {
+            co_return;
+        }
+        if (port != 443)
+        {
+            authority += fmt::format(":{}", port);
+        }
+        const std::string_view target{req.target()};
+
+        const std::array buffers{boost::asio::buffer(head), boost::asio::buffer(authority),
+                                 boost::asio::buffer(target.starts_with('/') ? target : std::string_view{"/"}),
+                                 boost::asio::buffer(tail)};
+        deadline.reset();
+        co_await boost::asio::async_write(stream, buffers, asio::recycled_tuple);
+        boost::beast::get_lowest_layer(stream).socket().shutdown(boost::asio::socket_base::shutdown_send, ec);
+    }
+
+    static std::string_view trim(std::string_view value) noexcept
+    {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+        {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+        {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+    // Checks whether an Accept-Encoding header lists a coding without refusing it with q=0
+    static bool accepts_encoding(std::string_view header, const std::string_view coding) noexcept
+    {
+        while (!header.empty())
+        {
+            const auto comma{header.find(',')};
+            const auto item{header.substr(0, comma)};
+            header.remove_prefix(comma == std::string_view::npos ? header.size() : comma + 1);
+
+            const auto semicolon{item.find(';')};
+            const auto name{trim(item.substr(0, semicolon))};
+            if (!std::ranges::equal(name, coding, [](const unsigned char a, const unsigned char b) {
+                    return std::tolower(a) == std::tolower(b);
+                }))
             {
-                co_return;
+                continue;
+            }
+            if (semicolon == std::string_view::npos)
+            {
+                return true;
+            }
+            const auto parameter{trim(item.substr(semicolon + 1))};
+            if (parameter.size() < 2 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=')
+            {
+                return true;
             }
+            const auto q{trim(parameter.substr(2))};
+            return q.find_first_not_of("0.") != std::string_view::npos;
+        }
+        return false;
+    }
 
-            if (boost::beast::websocket::is_upgrade(parser.get()))
+    static bool etag_matches(std::string_view header, const std::string_view etag) noexcept
+    {
+        if (trim(header) == "*")
+        {
+            return true;
+        }
+        while (!header.empty())
+        {
+            const auto comma{header.find(',')};
+            auto candidate{trim(header.substr(0, comma))};
+            header.remove_prefix(comma == std::string_view::npos ? header.size() : comma + 1);
+            // If-None-Match uses the weak comparison
+            if (candidate.starts_with("W/"))
             {
-                boost::beast::get_lowest_layer(stream).expires_never();
-                // co_await run_websocket_session(stream, buffer, parser.release());
-                co_return;
+                candidate.remove_prefix(2);
             }
+            if (candidate == etag)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 
-            auto res{handle_request(parser.release(), doc_root, fallback_path, db)};
-            if (!res.keep_alive())
+    /**
+     * @brief Answers a request from an asset of the bundle
+     *
+     * Brotli is preferred over gzip if the client accepts both, every
+     * variant has an ETag of its own. Bodies are views of the mapped bundle.
+     */
+    template <typename Request>
+    response serve_asset(const Request &req, std::shared_ptr<const asset_bundle> bundle, const asset &found) const
+    {
+        static constexpr std::array<std::pair<content_coding, std::string_view>, 2> encodings{
+            {{content_coding::br, "br"}, {content_coding::gzip, "gzip"}}};
+
+        auto coding{content_coding::identity};
+        std::string_view coding_name{};
+        const std::string_view accept{req[boost::beast::http::field::accept_encoding]};
+        for (const auto &[candidate, name] : encodings)
+        {
+            if (found.variants[static_cast<std::size_t>(candidate)] && accepts_encoding(accept, name))
             {
-                co_await boost::beast::async_write(stream, std::move(res));
-                co_return;
+                coding = candidate;
+                coding_name = name;
+                break;
+            }
+        }
+        const auto content{*found.variants[static_cast<std::size_t>(coding)]};
+        const bool negotiated{found.variants[static_cast<std::size_t>(content_coding::br)] ||
+                              found.variants[static_cast<std::size_t>(content_coding::gzip)]};
+        const auto etag{coding == content_coding::identity
+                            ? std::string{found.etag}
+                            : fmt::format("{}-{}\"", found.etag.substr(0, found.etag.size() - 1), coding_name)};
+
+        const auto set_headers{[&](auto &res) {
+            res.set(boost::beast::http::field::etag, etag);
+            if (negotiated)
+            {
+                res.set(boost::beast::http::field::vary, "Accept-Encoding");
+            }
+            finish_response(res, req.version(), req.keep_alive());
+        }};
+
+        if (etag_matches(req[boost::beast::http::field::if_none_match], etag))
+        {
+            empty_response res{
+                templates_.header(response_templates::content::asset, boost::beast::http::status::not_modified)};
+            set_headers(res);
+            return res;
+        }
+
+        const auto set_content_headers{[&](auto &res) {
+            set_headers(res);
+            res.set(boost::beast::http::field::content_type, found.mime_type);
+            if (coding != content_coding::identity)
+            {
+                res.set(boost::beast::http::field::content_encoding, coding_name);
             }
+            res.content_length(content.size());
+        }};
 
-            co_await boost::beast::async_write(stream, std::move(res));
+        auto header{templates_.header(response_templates::content::asset, boost::beast::http::status::ok)};
+        if (req.method() == boost::beast::http::verb::head)
+        {
+            empty_response res{std::move(header)};
+            set_content_headers(res);
+            return res;
         }
+
+        asset_response res{std::move(header), std::move(bundle), content};
+        set_content_headers(res);
+        return res;
     }
 
-    template <typename Body, typename Allocator>
-    boost::beast::http::message_generator handle_request(
-        boost::beast::http::request<Body, boost::beast::http::basic_fields<Allocator>> &&req,
-        const std::string_view doc_root, const std::string_view fallback_path, mime_database &db)
+    /**
+     * @brief Returns whether a request-target names prefix itself or a path below it
+     */
+    static bool is_below(const std::string_view target, const std::string_view prefix) noexcept
     {
-        // TODO: Flexible request handling
-        // Returns a bad request response
-        auto const bad_request{[&req](const boost::beast::string_view why) {
-            boost::beast::http::response<boost::beast::http::string_body> res{boost::beast::http::status::bad_request,
-                                                                              req.version()};
-            res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
-            res.set(boost::beast::http::field::content_type, "text/html");
-            res.keep_alive(req.keep_alive());
-            res.body() = std::string{why};
-            res.prepare_payload();
+        return target.starts_with(prefix) &&
+               (target.size() == prefix.size() || target[prefix.size()] == '/' || target[prefix.size()] == '?');
+    }
+
+    /**
+     * @brief Answers the administrative endpoints under admin.path
+     *
+     * The bearer token is compared in constant time. Reports are never
+     * cached, they reflect the moment of the request.
+     */
+    template <typename Request> response handle_admin(const Request &req) const
+    {
+        const auto &admin{config_.fields.admin};
+        constexpr std::string_view scheme{"Bearer "};
+        const std::string_view authorization{req[boost::beast::http::field::authorization]};
+        const auto token{authorization.starts_with(scheme) ? trim(authorization.substr(scheme.size()))
+                                                           : std::string_view{}};
+        if (token.size() != admin.token.size() ||
+            CRYPTO_memcmp(token.data(), admin.token.data(), token.size()) != 0)
+        {
+            return templates_.make(response_templates::error::unauthorized, req.version(), req.keep_alive());
+        }
+
+        const std::string_view target{req.target()};
+        const auto endpoint{target.substr(0, target.find('?')).substr(admin.path.size())};
+        if (endpoint != "/memory")
+        {
+            return templates_.make(response_templates::error::not_found, req.version(), req.keep_alive());
+        }
+
+        auto report{memory::report(true)};
+        auto header{templates_.header(response_templates::content::report, boost::beast::http::status::ok)};
+        if (req.method() == boost::beast::http::verb::head)
+        {
+            empty_response res{std::move(header)};
+            res.content_length(report.size());
+            finish_response(res, req.version(), req.keep_alive());
             return res;
-        }};
+        }
+        string_response res{std::move(header), std::move(report)};
+        res.content_length(res.body().size());
+        finish_response(res, req.version(), req.keep_alive());
+        return res;
+    }
 
-        // Returns a not found response
-        auto const not_found{[&req](const boost::beast::string_view target) {
-            boost::beast::http::response<boost::beast::http::string_body> res{boost::beast::http::status::not_found,
-                                                                              req.version()};
-            res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
-            res.set(boost::beast::http::field::content_type, "text/html");
-            res.keep_alive(req.keep_alive());
-            res.body() = fmt::format("The resource \"{}\" was not found.", target);
-            res.prepare_payload();
+    template <typename Request>
+    string_response json_response(const Request &req, const boost::beast::http::status status,
+                                  const boost::json::value &body) const
+    {
+        string_response res{templates_.header(response_templates::content::json, status),
+                            boost::json::serialize(body)};
+        res.prepare_payload();
+        finish_response(res, req.version(), req.keep_alive());
+        return res;
+    }
+
+    template <typename Request>
+    string_response json_error(const Request &req, const boost::beast::http::status status,
+                               const std::string_view message) const
+    {
+        return json_response(req, status, {{"success", false}, {"message", message}});
+    }
+
+    static std::optional<std::string_view> string_field(const boost::json::object &object, const std::string_view name)
+    {
+        const auto *value{object.if_contains(name)};
+        const auto *string{value ? value->if_string() : nullptr};
+        return string ? std::optional<std::string_view>{std::in_place, string->data(), string->size()} : std::nullopt;
+    }
+
+    /**
+     * @brief Answers an idempotent API GET or HEAD through the micro-cache
+     *
+     * A route opts in by returning this with a policy of its own, compute is
+     * a coroutine function returning a cached_response and runs at most once
+     * for concurrent requests of the same key.
+     */
+    template <typename Request, typename Compute>
+    boost::asio::awaitable<response, executor_type> cached_get(const Request &req, micro_cache::policy route,
+                                                               Compute compute)
+    {
+        auto key{micro_cache::make_key(req.target(), req, route)};
+        if (!key)
+        {
+            co_return templates_.make(response_templates::error::illegal_target, req.version(), req.keep_alive());
+        }
+
+        micro_cache::result_type cached{};
+        try
+        {
+            cached = co_await api_cache_.fetch(std::move(*key), std::move(route), std::move(compute));
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << fmt::format("Failed to answer {}: {}", std::string_view{req.target()},
+                                                     e.what());
+            co_return templates_.make(response_templates::error::server_error, req.version(), req.keep_alive());
+        }
+
+        // the response is shared with other requests, it may be up to a TTL old but clients should not keep it
+        auto header{templates_.header(response_templates::content::shared, cached->status)};
+        header.set(boost::beast::http::field::content_type, cached->content_type);
+        if (req.method() == boost::beast::http::verb::head)
+        {
+            empty_response res{std::move(header)};
+            res.content_length(cached->body.size());
+            finish_response(res, req.version(), req.keep_alive());
+            co_return res;
+        }
+        string_response res{std::move(header), cached->body};
+        res.content_length(res.body().size());
+        finish_response(res, req.version(), req.keep_alive());
+        co_return res;
+    }
+
+    /**
+     * @brief Opens a register session with a captcha, POST /api/v1/auth/register
+     *
+     * Captchas are taken from the pool, an empty pool means registrations
+     * arrive faster than the configured rate and the client has to retry.
+     */
+    template <typename Request> response handle_register(const Request &req)
+    {
+        const auto unavailable{[this, &req] {
+            auto res{json_error(req, boost::beast::http::status::service_unavailable,
+                                "Too many registrations, retry later.")};
+            res.set(boost::beast::http::field::retry_after, "1");
             return res;
         }};
 
-        // Returns a server error response
-        auto const server_error{[&req](const boost::beast::string_view what) {
-            boost::beast::http::response<boost::beast::http::string_body> res{
-                boost::beast::http::status::internal_server_error, req.version()};
-            res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
-            res.set(boost::beast::http::field::content_type, "text/html");
-            res.keep_alive(req.keep_alive());
-            res.body() = fmt::format("An error occurred: \"{}\"", what);
-            res.prepare_payload();
-            return res;
+        auto captcha{captchas_.pop()};
+        if (!captcha)
+        {
+            return unavailable();
+        }
+        std::optional<std::string> id{};
+        try
+        {
+            id = register_sessions_.create(auth::register_session{.captcha_answer = std::move(captcha->answer)});
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << "Failed to create a register session: " << e.what();
+            return templates_.make(response_templates::error::server_error, req.version(), req.keep_alive());
+        }
+        if (!id)
+        {
+            return unavailable();
+        }
+        return json_response(req, boost::beast::http::status::ok,
+                             {{"success", true},
+                              {"sessionId", *id},
+                              {"captcha",
+                               {{"data", std::move(captcha->data_uri)},
+                                {"expireInSeconds", register_sessions_.ttl().count()}}}});
+    }
+
+    /**
+     * @brief Searches the full-text index, GET /api/v1/search?q=<terms>&limit=<count>
+     *
+     * Popular queries are answered from the micro-cache, so a document
+     * shows up in their results up to a few seconds after it is added.
+     */
+    template <typename Request> boost::asio::awaitable<response, executor_type> handle_search(const Request &req)
+    {
+        if (!search_index_.is_open())
+        {
+            co_return templates_.make(response_templates::error::not_found, req.version(), req.keep_alive());
+        }
+
+        std::string_view query{};
+        std::size_t limit{10};
+        const std::string_view target{req.target()};
+        const auto query_start{target.find('?')};
+        auto parameters{query_start == std::string_view::npos ? std::string_view{} : target.substr(query_start + 1)};
+        while (!parameters.empty())
+        {
+            const auto parameter{parameters.substr(0, parameters.find('&'))};
+            parameters.remove_prefix(std::min(parameter.size() + 1, parameters.size()));
+            if (parameter.starts_with("q="))
+            {
+                query = parameter.substr(2);
+            }
+            else if (parameter.starts_with("limit="))
+            {
+                const auto value{parameter.substr(6)};
+                std::from_chars(value.data(), value.data() + value.size(), limit);
+            }
+        }
+        // forms encode spaces as '+'
+        std::string terms{query};
+        std::ranges::replace(terms, '+', ' ');
+        auto decoded{util::percent_decode(terms)};
+        if (!decoded || !util::is_valid_utf8(*decoded))
+        {
+            co_return templates_.make(response_templates::error::illegal_target, req.version(), req.keep_alive());
+        }
+        limit = std::clamp<std::size_t>(limit, 1, max_search_hits);
+
+        micro_cache::policy route{.ttl = std::chrono::seconds{2}, .stale_while_revalidate = std::chrono::seconds{10}};
+        co_return co_await cached_get(
+            req, std::move(route),
+            [this, terms = std::move(*decoded), limit]() -> boost::asio::awaitable<cached_response, executor_type> {
+                const auto hits{co_await blocking_pool_.async_run(
+                    [this, terms, limit] { return search_index_.search(terms, limit); })};
+                boost::json::array results{};
+                results.reserve(hits.size());
+                for (const auto &[id, score] : hits)
+                {
+                    results.emplace_back(boost::json::object{{"id", id}, {"score", score}});
+                }
+                boost::json::object body{{"success", true}, {"hits", std::move(results)}};
+                co_return cached_response{.body = boost::json::serialize(body)};
+            });
+    }
+
+    /**
+     * @brief Creates an account, PUT /api/v1/auth/register/<session id>
+     *
+     * The session is taken before the captcha is checked, so every captcha
+     * can be answered once. Accounts are stored under "user/" and the
+     * lowercase username, with the password hashed off the I/O threads.
+     */
+    template <typename Request>
+    boost::asio::awaitable<response, executor_type> complete_register(const Request &req, const std::string_view id)
+    {
+        using boost::beast::http::status;
+
+        if (!store_.is_open())
+        {
+            co_return json_error(req, status::service_unavailable, "Registrations are disabled.");
+        }
+
+        boost::system::error_code ec{};
+        const auto body{boost::json::parse(std::string_view{req.body()}, ec)};
+        const auto *fields{ec ? nullptr : body.if_object()};
+        const auto answer{fields ? string_field(*fields, "captcha") : std::nullopt};
+        const auto username{fields ? string_field(*fields, "username") : std::nullopt};
+        const auto password{fields ? string_field(*fields, "password") : std::nullopt};
+        if (!answer || !username || !password)
+        {
+            co_return json_error(req, status::bad_request, "Expected captcha, username and password.");
+        }
+
+        auto session{register_sessions_.take(id)};
+        if (!session)
+        {
+            co_return json_error(req, status::not_found, "The register session does not exist or expired.");
+        }
+        // answers are drawn from uppercase letters and digits
+        std::string upper{*answer};
+        std::ranges::transform(upper, upper.begin(), [](const unsigned char c) { return std::toupper(c); });
+        const auto &expected{session->captcha_answer};
+        if (upper.size() != expected.size() || CRYPTO_memcmp(upper.data(), expected.data(), upper.size()) != 0)
+        {
+            co_return json_error(req, status::forbidden, "Wrong captcha.");
+        }
+
+        if (username->size() < min_username_length || username->size() > max_username_length ||
+            !std::ranges::all_of(*username,
+                                 [](const unsigned char c) { return std::isalnum(c) || c == '_' || c == '-'; }))
+        {
+            co_return json_error(req, status::bad_request,
+                                 fmt::format("Usernames have {} to {} letters, digits, '_' or '-'.",
+                                             min_username_length, max_username_length));
+        }
+        if (password->size() < min_password_length || password->size() > max_password_length)
+        {
+            co_return json_error(req, status::bad_request,
+                                 fmt::format("Passwords have {} to {} bytes.", min_password_length,
+                                             max_password_length));
+        }
+
+        std::string key{account_prefix};
+        std::ranges::transform(*username, std::back_inserter(key),
+                               [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        {
+            std::lock_guard lock{registering_mutex_};
+            if (store_.contains(key) || !registering_.insert(key).second)
+            {
+                co_return json_error(req, status::conflict, "The username is taken.");
+            }
+        }
+        struct reservation
+        {
+            request_handler &handler;
+            const std::string &key;
+            ~reservation()
+            {
+                std::lock_guard lock{handler.registering_mutex_};
+                handler.registering_.erase(key);
+            }
+        } reservation{*this, key};
+
+        std::optional<std::string> encoded{};
+        try
+        {
+            encoded = co_await password_hasher_.hash(std::string{*password});
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << "Failed to hash a password: " << e.what();
+            co_return templates_.make(response_templates::error::server_error, req.version(), req.keep_alive());
+        }
+        if (!encoded)
+        {
+            auto res{json_error(req, status::service_unavailable, "Too many registrations, retry later.")};
+            res.set(boost::beast::http::field::retry_after, "1");
+            co_return res;
+        }
+
+        boost::json::object account{{"username", *username}, {"password", std::move(*encoded)}};
+        const auto [write_ec]{co_await store_.async_put(key, boost::json::serialize(account), asio::recycled_tuple)};
+        if (write_ec)
+        {
+            LPBACKEND_LOG(lg_, error) << fmt::format("Failed to store the account {}: {}", key, write_ec.message());
+            co_return templates_.make(response_templates::error::server_error, req.version(), req.keep_alive());
+        }
+        co_return json_response(req, status::ok, {{"success", true}});
+    }
+
+    /**
+     * @brief Checks the password of an account, POST /api/v1/auth/login
+     *
+     * Unknown usernames cost a hash as well, so the time of the answer does
+     * not tell whether an account exists.
+     */
+    template <typename Request> boost::asio::awaitable<response, executor_type> handle_login(const Request &req)
+    {
+        using boost::beast::http::status;
+
+        if (!store_.is_open())
+        {
+            co_return json_error(req, status::service_unavailable, "Logins are disabled.");
+        }
+
+        boost::system::error_code ec{};
+        const auto body{boost::json::parse(std::string_view{req.body()}, ec)};
+        const auto *fields{ec ? nullptr : body.if_object()};
+        const auto username{fields ? string_field(*fields, "username") : std::nullopt};
+        const auto password{fields ? string_field(*fields, "password") : std::nullopt};
+        if (!username || !password || username->size() > max_username_length ||
+            password->size() > max_password_length)
+        {
+            co_return json_error(req, status::bad_request, "Expected username and password.");
+        }
+
+        std::string key{account_prefix};
+        std::ranges::transform(*username, std::back_inserter(key),
+                               [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        const auto stored{store_.get(key)};
+        std::string encoded{};
+        std::string name{};
+        if (stored)
+        {
+            const auto account{boost::json::parse(*stored, ec)};
+            const auto *account_fields{ec ? nullptr : account.if_object()};
+            const auto stored_name{account_fields ? string_field(*account_fields, "username") : std::nullopt};
+            const auto stored_password{account_fields ? string_field(*account_fields, "password") : std::nullopt};
+            if (!stored_name || !stored_password)
+            {
+                LPBACKEND_LOG(lg_, error) << "Malformed account " << key;
+                co_return templates_.make(response_templates::error::server_error, req.version(), req.keep_alive());
+            }
+            name = *stored_name;
+            encoded = *stored_password;
+        }
+
+        std::optional<bool> matches{};
+        try
+        {
+            if (stored)
+            {
+                matches = co_await password_hasher_.verify(std::string{*password}, std::move(encoded));
+            }
+            else if (co_await password_hasher_.hash(std::string{*password}))
+            {
+                matches = false;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << fmt::format("Failed to verify the password of {}: {}", key, e.what());
+            co_return templates_.make(response_templates::error::server_error, req.version(), req.keep_alive());
+        }
+        if (!matches)
+        {
+            auto res{json_error(req, status::service_unavailable, "Too many logins, retry later.")};
+            res.set(boost::beast::http::field::retry_after, "1");
+            co_return res;
+        }
+        if (!*matches)
+        {
+            co_return json_error(req, status::unauthorized, "Wrong username or password.");
+        }
+        co_return json_response(req, status::ok, {{"success", true}, {"username", name}});
+    }
+
+    static std::string mime_type_of(const std::string &path, mime_database &db)
+    {
+        const auto extension{std::filesystem::path{path}.extension().string()};
+        return std::string{db.get_mime_type(extension.empty() ? extension : extension.substr(1))};
+    }
+
+    template <typename Body, typename Allocator>
+    boost::asio::awaitable<response, executor_type> handle_request(
+        boost::beast::http::request<Body, boost::beast::http::basic_fields<Allocator>> req,
+        const std::string_view doc_root, const std::string_view fallback_path, mime_database &db)
+    {
+        // TODO: Flexible request handling
+        // Error responses are copied from templates that are built once
+        const auto error_response{[this, &req](const response_templates::error kind) {
+            return templates_.make(kind, req.version(), req.keep_alive());
         }};
 
+        // Requests in TLS early data can be replayed, only safe methods are accepted
+        if (req["Early-Data"] == "1" && req.method() != boost::beast::http::verb::get &&
+            req.method() != boost::beast::http::verb::head)
+        {
+            co_return error_response(response_templates::error::too_early);
+        }
+
+        // REST API
+        const std::string_view target{req.target()};
+        if (target.substr(0, target.find('?')) == register_path && req.method() == boost::beast::http::verb::post)
+        {
+            co_return handle_register(req);
+        }
+        if (target.starts_with(register_path) && target.size() > register_path.size() + 1 &&
+            target[register_path.size()] == '/' && req.method() == boost::beast::http::verb::put)
+        {
+            co_return co_await complete_register(req, target.substr(register_path.size() + 1));
+        }
+        if (target.substr(0, target.find('?')) == login_path && req.method() == boost::beast::http::verb::post)
+        {
+            co_return co_await handle_login(req);
+        }
+        if (is_below(target, search_path) && (req.method() == boost::beast::http::verb::get ||
+                                              req.method() == boost::beast::http::verb::head))
+        {
+            co_return co_await handle_search(req);
+        }
+
         // Make sure we can handle the method
         if (req.method() != boost::beast::http::verb::get && req.method() != boost::beast::http::verb::head)
         {
-            return bad_request("Unknown HTTP-method");
+            co_return error_response(response_templates::error::unknown_method);
+        }
+
+        // Request path must be absolute and must not leave doc_root once it is decoded
+        const auto normalized{util::normalize_path(target)};
+        if (!normalized)
+        {
+            co_return error_response(response_templates::error::illegal_target);
         }
 
-        // Request path must be absolute and not contain "..".
-        if (req.target().empty() || req.target()[0] != '/' ||
-            req.target().find("..") != boost::beast::string_view::npos)
+        // Administrative endpoints exist only if a token is configured
+        if (!config_.fields.admin.token.empty() && is_below(req.target(), config_.fields.admin.path))
         {
-            return bad_request("Illegal request-target");
+            co_return handle_admin(req);
+        }
+
+        // Packed assets are answered from the mapping, doc_root serves what the bundle does not contain
+        if (auto assets{assets_.load(std::memory_order_acquire)})
+        {
+            std::string key{*normalized};
+            if (key.back() == '/')
+            {
+                key.append(fallback_path);
+            }
+            if (const auto found{assets->find(key)})
+            {
+                co_return serve_asset(req, std::move(assets), *found);
+            }
         }
 
         // Build the path to the requested file
-        auto path{path_cat(doc_root, req.target())};
-        if (req.target().back() == '/')
+        auto path{path_cat(doc_root, *normalized)};
+        if (normalized->back() == '/')
         {
             path.append(fallback_path);
         }
 
-        // Attempt to open the file
+        // Cached files are served without any system call, others are opened or revalidated on the blocking pool
+        auto file{file_cache_.find(path)};
         boost::beast::error_code ec{};
-        boost::beast::http::file_body::value_type body{};
-        body.open(path.c_str(), boost::beast::file_mode::scan, ec);
+        if (!file)
+        {
+            std::tie(ec, file) = co_await blocking_pool_.async_run([this, path, &db] {
+                boost::beast::error_code ec{};
+                auto file{file_cache_.open(path, mime_type_of(path, db), ec)};
+                return std::pair{ec, std::move(file)};
+            });
+        }
 
         // Handle the case where the file doesn't exist
         if (ec == boost::beast::errc::no_such_file_or_directory)
         {
-            return not_found(req.target());
+            co_return error_response(response_templates::error::not_found);
         }
 
         // Handle an unknown error
         if (ec)
         {
-            return server_error(ec.message());
+            LPBACKEND_LOG(lg_, error) << fmt::format("Failed to open {}: {}", path, ec.message());
+            co_return error_response(response_templates::error::server_error);
         }
 
-        // Cache the size since we need it after the move
-        const auto size{body.size()};
-
         // Respond to HEAD request
         if (req.method() == boost::beast::http::verb::head)
         {
-            boost::beast::http::response<boost::beast::http::empty_body> res{boost::beast::http::status::ok,
-                                                                             req.version()};
-            res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
-            res.set(boost::beast::http::field::content_type,
-                    db.get_mime_type(std::filesystem::path{path}.extension().string().substr(1)));
-            res.content_length(size);
-            res.keep_alive(req.keep_alive());
-            return res;
+            empty_response res{file->header()};
+            finish_response(res, req.version(), req.keep_alive());
+            co_return res;
         }
 
-        // Respond to GET request
-        boost::beast::http::response<boost::beast::http::file_body> res{
-            std::piecewise_construct, std::make_tuple(std::move(body)),
-            std::make_tuple(boost::beast::http::status::ok, req.version())};
-        res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(boost::beast::http::field::content_type,
-                db.get_mime_type(std::filesystem::path{path}.extension().string().substr(1)));
-        res.content_length(size);
-        res.keep_alive(req.keep_alive());
-        return res;
+        // Respond to GET request, the header was built when the file was opened
+        file_response res{file->header(), file};
+        finish_response(res, req.version(), req.keep_alive());
+        co_return res;
     }
 };
 } // namespace lpbackend::networking
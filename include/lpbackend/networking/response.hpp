@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <utility>
+#include <variant>
+
+#include <boost/beast.hpp>
+
+#include <lpbackend/networking/asset_bundle.hpp>
+#include <lpbackend/networking/file_cache.hpp>
+
+namespace lpbackend::networking
+{
+using string_response = boost::beast::http::response<boost::beast::http::string_body>;
+using empty_response = boost::beast::http::response<boost::beast::http::empty_body>;
+using file_response = boost::beast::http::response<cached_file_body>;
+using asset_response = boost::beast::http::response<asset_body>;
+
+/**
+ * @brief A response of request_handler that is not yet bound to a protocol
+ */
+using response = std::variant<string_response, empty_response, file_response, asset_response>;
+
+/**
+ * @brief Converts a response to a serializer for HTTP/1.x
+ */
+inline boost::beast::http::message_generator to_message_generator(response &&res)
+{
+    return std::visit([](auto &&r) { return boost::beast::http::message_generator{std::move(r)}; }, std::move(res));
+}
+
+inline bool keep_alive(const response &res)
+{
+    return std::visit([](const auto &r) { return r.keep_alive(); }, res);
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <boost/beast.hpp>
+
+#include <lpbackend/extern.hpp>
+#include <lpbackend/networking/response.hpp>
+
+namespace lpbackend::networking
+{
+/**
+ * @brief Formats a time point as an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+ */
+LPBACKEND_EXTERN std::string format_http_date(std::chrono::system_clock::time_point time);
+
+/**
+ * @brief Returns the current time as an IMF-fixdate for the Date header
+ *
+ * The date is formatted at most once per second on every thread, the view
+ * is valid until the next call on the same thread.
+ */
+LPBACKEND_EXTERN std::string_view http_date();
+
+/**
+ * @brief Sets the fields that differ between requests on a response built from a template
+ */
+template <typename Body>
+void finish_response(boost::beast::http::response<Body> &res, const unsigned version, const bool keep_alive)
+{
+    res.version(version);
+    res.keep_alive(keep_alive);
+    res.set(boost::beast::http::field::date, http_date());
+}
+
+/**
+ * @brief Error responses and headers that are built once and copied for every request
+ *
+ * The bodies are constant, so nothing of a request is reflected into them.
+ */
+class LPBACKEND_EXTERN response_templates
+{
+  public:
+    enum class error
+    {
+        unknown_method,
+        illegal_target,
+        not_found,
+        server_error,
+        too_early,
+        unauthorized,
+        // the request could not be parsed
+        bad_request,
+        header_too_large,
+        body_too_large
+    };
+
+    /**
+     * @brief Headers of successful responses by the fields they share
+     */
+    enum class content
+    {
+        // only Server, the other fields depend on the asset
+        asset,
+        // application/json that is never stored
+        json,
+        // plain text reports that are never stored
+        report,
+        // responses shared between requests by the micro-cache, revalidated on every use
+        shared
+    };
+
+  private:
+    std::array<string_response, 9> errors_;
+    std::array<boost::beast::http::response_header<>, 4> headers_;
+
+  public:
+    response_templates();
+
+    string_response make(error kind, unsigned version, bool keep_alive) const;
+
+    /**
+     * @brief Returns a copy of a header with the status set, finish_response completes it
+     */
+    boost::beast::http::response_header<> header(content kind, boost::beast::http::status status) const;
+};
+} // namespace lpbackend::networking
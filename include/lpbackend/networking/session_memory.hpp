@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+#include <boost/beast.hpp>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::networking
+{
+using session_allocator = std::pmr::polymorphic_allocator<char>;
+using session_buffer = boost::beast::basic_flat_buffer<session_allocator>;
+using session_body = boost::beast::http::basic_string_body<char, std::char_traits<char>, session_allocator>;
+
+/**
+ * @brief The memory of one connection, released at once when the connection closes
+ *
+ * Blocks are pooled by size, so a long keep-alive connection reuses the
+ * memory of its earlier requests instead of fragmenting the global heap.
+ * Chunks come from mimalloc and are counted, which makes the memory of a
+ * connection measurable. Like the connection, it must only be used by one
+ * thread at a time.
+ */
+class LPBACKEND_EXTERN session_memory
+{
+  public:
+    struct statistics
+    {
+        std::uint64_t sessions;
+        std::size_t average_peak;
+        std::size_t max_peak;
+        std::size_t in_use;
+    };
+
+  private:
+    class upstream_resource : public std::pmr::memory_resource
+    {
+      private:
+        std::size_t allocated_{};
+        std::size_t peak_{};
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+      public:
+        std::size_t allocated() const noexcept
+        {
+            return allocated_;
+        }
+
+        std::size_t peak() const noexcept
+        {
+            return peak_;
+        }
+    };
+
+    upstream_resource upstream_;
+    std::pmr::unsynchronized_pool_resource pool_;
+
+  public:
+    session_memory();
+    ~session_memory();
+
+    session_memory(const session_memory &) = delete;
+    session_memory &operator=(const session_memory &) = delete;
+
+    session_allocator get_allocator() noexcept;
+
+    /**
+     * @brief Returns the bytes currently taken from mimalloc
+     */
+    std::size_t allocated() const noexcept;
+    std::size_t peak() const noexcept;
+
+    /**
+     * @brief Returns the peaks of the sessions closed since the last call and the memory of open sessions
+     */
+    static statistics collect();
+};
+} // namespace lpbackend::networking
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+
+namespace lpbackend::networking
+{
+using socket_profile = config::lpbackend_config::fields_t::networking_t::socket_profile_t;
+
+/**
+ * @brief An integer socket option that Asio does not provide
+ */
+template <int Level, int Name> class integer_option
+{
+  private:
+    int value_;
+
+  public:
+    explicit integer_option(const int value = 0) noexcept : value_{value}
+    {
+    }
+
+    template <typename Protocol> int level(const Protocol &) const noexcept
+    {
+        return Level;
+    }
+
+    template <typename Protocol> int name(const Protocol &) const noexcept
+    {
+        return Name;
+    }
+
+    template <typename Protocol> const int *data(const Protocol &) const noexcept
+    {
+        return &value_;
+    }
+
+    template <typename Protocol> std::size_t size(const Protocol &) const noexcept
+    {
+        return sizeof(value_);
+    }
+};
+
+namespace detail
+{
+template <typename Socket, typename Option>
+void apply_option(Socket &socket, const char *name, const Option &option, const std::string &value,
+                  std::vector<std::string> &applied)
+{
+    boost::system::error_code ec{};
+    socket.set_option(option, ec);
+    applied.push_back(ec ? fmt::format("{}={} (failed: {})", name, value, ec.message())
+                         : fmt::format("{}={}", name, value));
+}
+} // namespace detail
+
+/**
+ * @brief Applies the options of a profile to an open acceptor that is not listening yet
+ *
+ * Buffer sizes have to be set before listen() to take part in window
+ * scaling, accepted sockets inherit them. Options unsupported by the
+ * platform or the protocol of the acceptor are skipped.
+ *
+ * @return the applied options for logging, including the ones that failed
+ */
+template <typename Acceptor>
+std::vector<std::string> apply_listen_options(Acceptor &acceptor, const socket_profile &profile)
+{
+    using socket_base = boost::asio::socket_base;
+
+    std::vector<std::string> applied{};
+    if (profile.receive_buffer_bytes)
+    {
+        detail::apply_option(acceptor, "SO_RCVBUF",
+                             socket_base::receive_buffer_size{static_cast<int>(profile.receive_buffer_bytes)},
+                             std::to_string(profile.receive_buffer_bytes), applied);
+    }
+    if (profile.send_buffer_bytes)
+    {
+        detail::apply_option(acceptor, "SO_SNDBUF",
+                             socket_base::send_buffer_size{static_cast<int>(profile.send_buffer_bytes)},
+                             std::to_string(profile.send_buffer_bytes), applied);
+    }
+    if constexpr (std::is_same_v<typename Acceptor::protocol_type, boost::asio::ip::tcp>)
+    {
+        detail::apply_option(acceptor, "TCP_NODELAY", boost::asio::ip::tcp::no_delay{profile.no_delay},
+                             profile.no_delay ? "1" : "0", applied);
+#if defined(TCP_DEFER_ACCEPT)
+        if (profile.defer_accept_seconds)
+        {
+            // the connection is only accepted once the first request bytes arrived
+            detail::apply_option(acceptor, "TCP_DEFER_ACCEPT",
+                                 integer_option<IPPROTO_TCP, TCP_DEFER_ACCEPT>{
+                                     static_cast<int>(profile.defer_accept_seconds)},
+                                 fmt::format("{}s", profile.defer_accept_seconds), applied);
+        }
+#endif
+#if defined(TCP_FASTOPEN)
+        if (profile.fast_open_queue)
+        {
+            detail::apply_option(acceptor, "TCP_FASTOPEN",
+                                 integer_option<IPPROTO_TCP, TCP_FASTOPEN>{static_cast<int>(profile.fast_open_queue)},
+                                 std::to_string(profile.fast_open_queue), applied);
+        }
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+        if (profile.not_sent_lowat_bytes)
+        {
+            detail::apply_option(acceptor, "TCP_NOTSENT_LOWAT",
+                                 integer_option<IPPROTO_TCP, TCP_NOTSENT_LOWAT>{
+                                     static_cast<int>(profile.not_sent_lowat_bytes)},
+                                 std::to_string(profile.not_sent_lowat_bytes), applied);
+        }
+#endif
+#if defined(SO_INCOMING_CPU)
+        if (profile.incoming_cpu >= 0)
+        {
+            detail::apply_option(acceptor, "SO_INCOMING_CPU",
+                                 integer_option<SOL_SOCKET, SO_INCOMING_CPU>{static_cast<int>(profile.incoming_cpu)},
+                                 std::to_string(profile.incoming_cpu), applied);
+        }
+#endif
+    }
+    return applied;
+}
+
+/**
+ * @brief Applies the TCP options of a profile again to an accepted socket
+ *
+ * Not every platform lets accepted sockets inherit them. Failures are
+ * ignored, they were already reported by apply_listen_options.
+ */
+template <typename Socket> void apply_accept_options(Socket &socket, const socket_profile &profile)
+{
+    if constexpr (std::is_same_v<typename Socket::protocol_type, boost::asio::ip::tcp>)
+    {
+        boost::system::error_code ec{};
+        socket.set_option(boost::asio::ip::tcp::no_delay{profile.no_delay}, ec);
+#if defined(TCP_NOTSENT_LOWAT)
+        if (profile.not_sent_lowat_bytes)
+        {
+            // keeps unsent data in user space, where HTTP/2 can still reprioritize it
+            socket.set_option(
+                integer_option<IPPROTO_TCP, TCP_NOTSENT_LOWAT>{static_cast<int>(profile.not_sent_lowat_bytes)}, ec);
+        }
+#endif
+    }
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+#include <lpbackend/log.hpp>
+
+namespace lpbackend::networking
+{
+/**
+ * @brief Manages TLS session resumption of an SSL context
+ *
+ * Sessions are cached by the context for all threads, session tickets are
+ * protected with rotating keys that are persisted to a key file, so tickets
+ * issued before a restart can still be resumed. When 0-RTT is enabled, early
+ * data of replayed ClientHellos is rejected by a sliding bloom filter.
+ */
+class LPBACKEND_EXTERN tls_session_manager
+{
+  private:
+    struct ticket_key
+    {
+        std::int64_t created{};
+        std::array<std::uint8_t, 16> name{};
+        std::array<std::uint8_t, 32> hmac_key{};
+        std::array<std::uint8_t, 32> aes_key{};
+    };
+
+    logger lg_{channel_logger("tls_session_manager")};
+    mutable std::shared_mutex mutex_;
+    // the newest key encrypts new tickets, older keys only decrypt
+    std::deque<ticket_key> keys_;
+    std::filesystem::path key_file_;
+    std::chrono::seconds rotation_interval_{};
+    std::chrono::seconds session_timeout_{};
+    std::atomic<std::uint64_t> full_handshakes_{};
+    std::atomic<std::uint64_t> resumed_handshakes_{};
+
+    // OpenSSL accepts early data when the ticket age is off by up to 10s
+    // either way, so a ClientHello can be replayed for 20s. An entry lives
+    // for one to two generations, one generation must cover the whole span.
+    static constexpr std::chrono::seconds ticket_age_allowance{10};
+    static constexpr std::chrono::seconds replay_window{2 * ticket_age_allowance};
+    static constexpr std::size_t replay_filter_bits{std::size_t{1} << 20};
+    static constexpr std::size_t replay_filter_hashes{4};
+    std::mutex replay_mutex_;
+    std::array<std::vector<std::uint64_t>, 2> replay_filters_{};
+    std::size_t replay_generation_{};
+    std::chrono::steady_clock::time_point replay_generation_start_{};
+    std::array<std::uint64_t, replay_filter_hashes> replay_salt_{};
+    std::atomic<std::uint64_t> early_data_accepted_{};
+    std::atomic<std::uint64_t> early_data_replays_{};
+
+    static int ticket_key_callback(SSL *ssl, unsigned char *key_name, unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx,
+                                   EVP_MAC_CTX *mac_ctx, int encrypt);
+    int handle_ticket_key(unsigned char *key_name, unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx,
+                          EVP_MAC_CTX *mac_ctx, bool encrypt);
+    static int allow_early_data_callback(SSL *ssl, void *arg);
+    bool first_seen(const SSL *ssl);
+    void configure_early_data(SSL_CTX *ctx, std::uint64_t max_early_data);
+    ticket_key generate_key() const;
+    bool current_key_expired(std::int64_t now) const noexcept;
+    void drop_expired_keys(std::int64_t now);
+    void load_keys();
+    void save_keys(const std::deque<ticket_key> &keys) const;
+
+  public:
+    /**
+     * @brief Configures the session cache and ticket keys of an SSL context
+     *
+     * @throws std::runtime_error if the SSL context rejects the configuration
+     */
+    void configure(SSL_CTX *ctx, const config::lpbackend_config::fields_t::ssl_t &config);
+
+    /**
+     * @brief Starts a new ticket key if the current one is due and drops expired keys
+     *
+     * The keys are written to the key file after the lock is released, so
+     * rotations must not run concurrently. The file is written synchronously,
+     * run it on the blocking pool.
+     *
+     * @return Whether a new key was started
+     */
+    bool rotate();
+
+    std::chrono::seconds rotation_interval() const noexcept;
+
+    /**
+     * @brief Counts a completed handshake as full or resumed
+     */
+    void record_handshake(const SSL *ssl) noexcept;
+
+    std::uint64_t full_handshakes() const noexcept;
+    std::uint64_t resumed_handshakes() const noexcept;
+    std::uint64_t early_data_accepted() const noexcept;
+    std::uint64_t early_data_replays() const noexcept;
+};
+} // namespace lpbackend::networking
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::render
+{
+/**
+ * @brief What a rendered fragment depends on besides its own post
+ */
+struct fragment_tag
+{
+    enum class kind : std::uint8_t
+    {
+        post,
+        thread,
+        // the avatar and name of a user shown next to the post
+        user
+    };
+
+    kind type;
+    std::uint64_t id;
+
+    bool operator==(const fragment_tag &) const noexcept = default;
+};
+
+/**
+ * @brief An LRU cache of posts rendered to sanitized HTML, keyed by post ID and revision
+ *
+ * Every fragment is tagged with its post and the tags it was rendered with,
+ * so an edit, a moved thread or a new avatar drops exactly the fragments it
+ * affects. A render runs outside the cache: find() hands out a ticket with
+ * a miss, and insert() refuses the result if one of its tags was
+ * invalidated after the ticket was taken, so a slow render never puts back
+ * what an edit just removed.
+ *
+ * Once the cache is full a new fragment is only admitted if it was asked
+ * for more often than the least recently used one, as counted by a
+ * frequency sketch that halves its counts periodically (TinyLFU). A burst
+ * of posts that are viewed once therefore cannot wash out the popular ones.
+ *
+ * Nothing renders posts yet, so the server only configures the cache,
+ * shrinks it under memory pressure and reports its statistics until the
+ * thread pages use find() and insert().
+ */
+class LPBACKEND_EXTERN fragment_cache
+{
+  public:
+    struct lookup
+    {
+        // nullptr on a miss
+        std::shared_ptr<const std::string> html;
+        std::uint64_t ticket;
+    };
+
+    struct statistics
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t admitted;
+        std::uint64_t rejected;
+        std::uint64_t stale;
+        std::uint64_t evicted;
+        std::uint64_t invalidated;
+        std::size_t entries;
+        std::size_t memory;
+    };
+
+  private:
+    struct key
+    {
+        std::uint64_t post;
+        std::uint64_t revision;
+
+        bool operator==(const key &) const noexcept = default;
+    };
+
+    struct key_hash
+    {
+        std::size_t operator()(const key &k) const noexcept;
+    };
+
+    struct tag_hash
+    {
+        std::size_t operator()(const fragment_tag &tag) const noexcept;
+    };
+
+    struct entry
+    {
+        key id;
+        std::shared_ptr<const std::string> html;
+        // the tag of the post first
+        std::vector<fragment_tag> tags;
+        // the HTML and the bookkeeping of the entry, counted against the memory cap
+        std::size_t charge;
+    };
+
+    // invalidations remembered for tickets, an older ticket refuses every insert
+    static constexpr std::size_t recent_invalidations{64};
+    static constexpr std::uint8_t max_frequency{15};
+
+    std::mutex mutex_;
+    // most recently used first
+    std::list<entry> entries_;
+    std::unordered_map<key, std::list<entry>::iterator, key_hash> index_;
+    std::unordered_map<fragment_tag, std::unordered_set<key, key_hash>, tag_hash> tagged_;
+    std::size_t memory_{};
+    std::size_t max_memory_{};
+
+    std::vector<std::uint8_t> sketch_;
+    std::size_t sketch_additions_{};
+    std::uint64_t epoch_{};
+    // the tags of the last invalidations, by epoch
+    std::array<fragment_tag, recent_invalidations> invalidations_{};
+
+    std::atomic<std::uint64_t> hits_{};
+    std::atomic<std::uint64_t> misses_{};
+    std::atomic<std::uint64_t> admitted_{};
+    std::atomic<std::uint64_t> rejected_{};
+    std::atomic<std::uint64_t> stale_{};
+    std::atomic<std::uint64_t> evicted_{};
+    std::atomic<std::uint64_t> invalidated_{};
+
+    // the functions below require mutex_ to be held
+    void record_access(const key &k);
+    std::uint8_t frequency(const key &k) const;
+    bool invalidated_since(std::uint64_t ticket, std::span<const fragment_tag> tags) const;
+    void erase(std::list<entry>::iterator it);
+
+  public:
+    void configure(const config::lpbackend_config::fields_t::http_t &http);
+
+    lookup find(std::uint64_t post, std::uint64_t revision);
+
+    /**
+     * @brief Offers a rendered fragment to the cache
+     *
+     * @param tags the fragment depends on, the tag of the post itself is implied
+     * @param ticket of the miss the fragment was rendered for
+     * @return the fragment, shared with the cache if it was admitted
+     */
+    std::shared_ptr<const std::string> insert(std::uint64_t post, std::uint64_t revision, std::string html,
+                                              std::span<const fragment_tag> tags, std::uint64_t ticket);
+
+    /**
+     * @brief Drops every fragment tagged with tag
+     *
+     * @return the number of fragments dropped
+     */
+    std::size_t invalidate(fragment_tag tag);
+
+    /**
+     * @brief Evicts the least recently used half of the fragments, used when memory runs short
+     */
+    void shrink();
+
+    /**
+     * @brief Returns the counters since the last call
+     */
+    statistics collect();
+};
+} // namespace lpbackend::render
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+#include <lpbackend/log.hpp>
+
+namespace lpbackend::search
+{
+/**
+ * @brief A full-text index of thread titles and post bodies
+ *
+ * Documents are buffered in memory and written to immutable segment files
+ * once enough of them are buffered or they are old enough, like the
+ * segments of Lucene. A segment maps its terms to posting lists compressed
+ * with deltas and varints in blocks with a skip table, see encode_postings.
+ * Replacing or removing a document marks its old copy dead, removals are
+ * also written as tombstones. Adjacent segments are merged in the background
+ * without their dead documents.
+ *
+ * A search matches the documents that contain every term of the query,
+ * ranked by BM25 with the terms of the title counting three times. The
+ * blocks of the rarest term give the candidates and are skipped if their
+ * bound cannot make it into the results, the blocks of the other terms are
+ * only decoded where candidates are left.
+ *
+ * Segment layout, little endian: a header with magic, version, flags, id
+ * and the lowest id a merged segment replaces, the posting lists, a table
+ * of documents with id, length and flags, the sorted term table and a
+ * footer with the offsets, counts and a CRC-32 of everything before it.
+ */
+class LPBACKEND_EXTERN full_text_index
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    struct hit
+    {
+        std::uint64_t id;
+        double score;
+    };
+
+    struct statistics
+    {
+        std::uint64_t added;
+        std::uint64_t removed;
+        std::uint64_t searches;
+        std::uint64_t slowest_search_us;
+        std::uint64_t flushes;
+        std::uint64_t merges;
+        std::size_t documents;
+        std::size_t segments;
+    };
+
+  private:
+    class segment;
+    class memory_segment;
+    class file_segment;
+    class segment_writer;
+
+    struct document_ref
+    {
+        std::uint64_t segment;
+        std::uint32_t document;
+    };
+
+    logger lg_{channel_logger("full_text_index")};
+    std::filesystem::path directory_;
+    std::size_t flush_documents_{};
+    std::chrono::seconds flush_interval_{};
+    std::size_t max_segments_{};
+    std::optional<boost::asio::thread_pool> thread_;
+
+    // guards everything below, the active segment included
+    mutable std::shared_mutex mutex_;
+    // ascending ids, sealed segments still in memory are written by the index thread
+    std::vector<std::shared_ptr<segment>> segments_;
+    std::shared_ptr<memory_segment> active_;
+    std::chrono::steady_clock::time_point active_since_;
+    // the live copy of every document
+    std::unordered_map<std::uint64_t, document_ref> live_;
+    std::uint64_t total_length_{};
+    std::uint64_t next_id_{};
+
+    std::atomic<bool> maintaining_{false};
+    std::atomic<bool> maintenance_requested_{false};
+    std::atomic<std::uint64_t> added_{};
+    std::atomic<std::uint64_t> removed_{};
+    mutable std::atomic<std::uint64_t> searches_{};
+    mutable std::atomic<std::uint64_t> slowest_search_us_{};
+    std::atomic<std::uint64_t> flushes_{};
+    std::atomic<std::uint64_t> merges_{};
+
+    std::filesystem::path path_of(std::uint64_t id, std::uint64_t generation = 0) const;
+    std::shared_ptr<segment> find_segment(std::uint64_t id) const;
+    void recover();
+    // require mutex_ to be held exclusively
+    void retire(std::uint64_t id);
+    void seal();
+    void schedule_maintenance();
+    // writes sealed segments and merges until there are at most max_segments_
+    void maintain();
+    void write_sealed();
+    // merges one window of segments, returns false if there are few enough
+    bool merge();
+
+  public:
+    /**
+     * @brief Loads the segments of the index and starts its thread
+     *
+     * Blocks while every segment is mapped and checked, so it must not run on an I/O thread.
+     *
+     * @throws std::runtime_error or std::filesystem::filesystem_error if the index cannot be opened
+     */
+    void open(const config::lpbackend_config::fields_t::search_t &search);
+
+    /**
+     * @brief Joins the thread and writes what is still buffered
+     */
+    void close();
+
+    bool is_open() const noexcept;
+
+    /**
+     * @brief Indexes a document, replacing the one with the same id
+     *
+     * Searches see the document at once, it is durable once its segment is written.
+     */
+    void add(std::uint64_t id, std::string_view title, std::string_view body);
+
+    void remove(std::uint64_t id);
+
+    /**
+     * @brief Returns the best matches of query, best first
+     */
+    std::vector<hit> search(std::string_view query, std::size_t limit) const;
+
+    /**
+     * @brief Writes buffered documents and merges segments periodically, until cancelled
+     */
+    boost::asio::awaitable<void, executor_type> run();
+
+    /**
+     * @brief Returns the counters since the last call and the current totals
+     */
+    statistics collect();
+
+    ~full_text_index();
+};
+} // namespace lpbackend::search
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::search
+{
+// documents per block of a posting list
+inline constexpr std::size_t posting_block_size{128};
+
+/**
+ * @brief Appends a posting list in the compressed form posting_reader reads
+ *
+ * The list is cut into blocks of posting_block_size documents. A skip table
+ * comes first with the last document, the byte size, the highest frequency
+ * and the shortest document length of every block, the latter two bound the
+ * score a block can contribute. Then come the blocks, each a sequence of
+ * varint document deltas and frequencies.
+ *
+ * @param documents ascending
+ * @param lengths the length of every document, only used for the skip table
+ */
+LPBACKEND_EXTERN void encode_postings(std::string &out, std::span<const std::uint32_t> documents,
+                                      std::span<const std::uint32_t> frequencies,
+                                      std::span<const std::uint32_t> lengths);
+
+/**
+ * @brief Decodes the blocks of a compressed posting list one at a time
+ *
+ * Only the skip table is read up front, so blocks that cannot contain a
+ * document of interest, or cannot score high enough, are never decoded.
+ */
+class LPBACKEND_EXTERN posting_reader
+{
+  private:
+    struct block
+    {
+        std::uint32_t last;
+        std::uint32_t base;
+        std::size_t offset;
+        std::size_t size;
+        std::uint32_t max_frequency;
+        std::uint32_t min_length;
+    };
+
+    std::string_view data_;
+    std::size_t count_{};
+    std::vector<block> blocks_;
+    std::uint32_t max_frequency_{};
+    std::uint32_t min_length_{};
+
+  public:
+    /**
+     * @throws std::runtime_error if the skip table is malformed
+     */
+    posting_reader(std::string_view data, std::size_t count);
+
+    std::size_t block_count() const noexcept
+    {
+        return blocks_.size();
+    }
+
+    std::uint32_t block_last(std::size_t i) const noexcept
+    {
+        return blocks_[i].last;
+    }
+
+    std::uint32_t block_max_frequency(std::size_t i) const noexcept
+    {
+        return blocks_[i].max_frequency;
+    }
+
+    std::uint32_t block_min_length(std::size_t i) const noexcept
+    {
+        return blocks_[i].min_length;
+    }
+
+    std::uint32_t max_frequency() const noexcept
+    {
+        return max_frequency_;
+    }
+
+    std::uint32_t min_length() const noexcept
+    {
+        return min_length_;
+    }
+
+    /**
+     * @brief Decodes block i into documents and frequencies
+     *
+     * @return the number of documents in the block
+     * @throws std::runtime_error if the block is malformed
+     */
+    std::size_t decode(std::size_t i, std::uint32_t *documents, std::uint32_t *frequencies) const;
+};
+
+/**
+ * @brief Returns the name of the instruction set intersect() runs on
+ */
+LPBACKEND_EXTERN std::string_view intersection_isa() noexcept;
+
+/**
+ * @brief Intersects two ascending lists without duplicates
+ *
+ * Writes the positions of the common values in a to a_hits and in b to
+ * b_hits, both must have room for the shorter list. Fastest when a is the
+ * shorter one.
+ *
+ * @return the number of common values
+ */
+LPBACKEND_EXTERN std::size_t intersect(std::span<const std::uint32_t> a, std::span<const std::uint32_t> b,
+                                       std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept;
+} // namespace lpbackend::search
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::search
+{
+enum class token_mode
+{
+    // CJK runs give their bigrams and their single characters, so a query of one character finds them too
+    document,
+    // CJK runs give their bigrams only, a run of one character gives itself
+    query
+};
+
+/**
+ * @brief Splits text into the terms of the full-text index
+ *
+ * Runs of letters and digits are words, lowercased for ASCII, Latin-1,
+ * Greek and Cyrillic; fullwidth forms count as their ASCII counterparts.
+ * Han, kana and hangul have no spaces between words, so their runs are
+ * indexed as overlapping bigrams instead. Everything else separates terms,
+ * bytes that are not valid UTF-8 included. Words longer than 64 bytes are
+ * dropped.
+ */
+LPBACKEND_EXTERN std::vector<std::string> tokenize(std::string_view text, token_mode mode);
+} // namespace lpbackend::search
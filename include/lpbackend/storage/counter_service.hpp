@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+#include <lpbackend/log.hpp>
+#include <lpbackend/storage/log_store.hpp>
+
+namespace lpbackend::storage
+{
+enum class counter : std::uint8_t
+{
+    thread_views,
+    thread_likes,
+    thread_replies,
+    post_likes
+};
+
+/**
+ * @brief Counters that are bumped on hot paths, e.g. a view of every thread page
+ *
+ * Every thread adds to a cache-line-aligned shard of its own, so bumping the
+ * counter of a popular thread from every worker at once never contends. The
+ * shards are drained periodically into the totals, which are what get()
+ * reads, and the changed totals are written to the store in one batch. A
+ * total therefore lags the increments by up to one flush interval.
+ *
+ * Totals are kept in the store under "counter/<name>/<id>" as 8 bytes little
+ * endian. Without an open store the counters live in memory only.
+ *
+ * At most max_counter_totals totals are kept in memory. Beyond that, committed
+ * totals that were not read since the previous eviction are dropped, like
+ * the second chance of a CLOCK cache, and read from the store again on their
+ * next use. Without a store a dropped total starts over at zero.
+ */
+class LPBACKEND_EXTERN counter_service
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+    using completion_type = std::move_only_function<void(boost::system::error_code)>;
+
+    struct statistics
+    {
+        std::uint64_t increments;
+        std::uint64_t flushes;
+        std::uint64_t written_totals;
+        std::uint64_t evicted_totals;
+        std::size_t totals;
+    };
+
+  private:
+    struct key
+    {
+        counter kind;
+        std::uint64_t id;
+
+        bool operator==(const key &) const noexcept = default;
+    };
+
+    struct key_hash
+    {
+        std::size_t operator()(const key &k) const noexcept
+        {
+            return std::hash<std::uint64_t>{}(k.id * 4 + static_cast<std::uint64_t>(k.kind));
+        }
+    };
+
+    static constexpr std::size_t cache_line_bytes{64};
+
+    struct total
+    {
+        std::int64_t value{};
+        // set by readers under a shared lock, cleared by evict()
+        mutable std::atomic<bool> referenced{true};
+    };
+
+    struct alignas(cache_line_bytes) shard
+    {
+        // only contended while the shard is drained
+        std::mutex mutex;
+        std::unordered_map<key, std::int64_t, key_hash> deltas;
+        std::uint64_t increments{};
+    };
+
+    logger lg_{channel_logger("counter_service")};
+    log_store &store_;
+    std::size_t shard_count_{};
+    std::unique_ptr<shard[]> shards_;
+    std::chrono::seconds flush_interval_{};
+    std::size_t max_totals_{1048576};
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<key, total, key_hash> totals_;
+    // totals that changed since they were last written
+    std::unordered_set<key, key_hash> dirty_;
+    // totals in batches that are not committed yet, with the number of those batches
+    std::unordered_map<key, std::size_t, key_hash> in_flight_;
+
+    std::atomic<std::uint64_t> flushes_{};
+    std::atomic<std::uint64_t> written_totals_{};
+    std::atomic<std::uint64_t> evicted_totals_{};
+
+    static std::string store_key(const key &k);
+    shard &local_shard() noexcept;
+    // require mutex_ to be held exclusively
+    std::int64_t &total_of(const key &k);
+    void evict();
+    void flush(completion_type completion);
+
+  public:
+    explicit counter_service(log_store &store);
+
+    /**
+     * @brief Sets the flush interval and the number of totals kept in memory, the counters work without it
+     */
+    void configure(const config::lpbackend_config::fields_t::storage_t &storage);
+
+    /**
+     * @brief Adds delta to a counter, never waits for another thread
+     */
+    void add(counter kind, std::uint64_t id, std::int64_t delta = 1);
+
+    /**
+     * @brief Returns the total of a counter as of the last flush
+     *
+     * Reads the store on the first access to a counter.
+     */
+    std::int64_t get(counter kind, std::uint64_t id);
+
+    /**
+     * @brief Drains the shards and writes the changed totals
+     *
+     * @param token Completion token with signature `void(boost::system::error_code)`.
+     * Everything added before the call is durable once the completion is invoked
+     * without an error, totals that failed to be written are retried by the next flush.
+     */
+    template <typename CompletionToken = boost::asio::deferred_t> auto async_flush(CompletionToken &&token = {})
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [this](auto handler) {
+                auto work{boost::asio::make_work_guard(boost::asio::get_associated_executor(handler))};
+                flush([handler = std::move(handler),
+                       work = std::move(work)](const boost::system::error_code ec) mutable {
+                    auto executor{work.get_executor()};
+                    work.reset();
+                    boost::asio::post(executor,
+                                      [handler = std::move(handler), ec]() mutable { std::move(handler)(ec); });
+                });
+            },
+            token);
+    }
+
+    /**
+     * @brief Flushes periodically, until cancelled
+     */
+    boost::asio::awaitable<void, executor_type> run();
+
+    /**
+     * @brief Flushes and waits for the totals to be written, the store must still be open
+     */
+    void close();
+
+    /**
+     * @brief Returns the counters since the last call, totals are not reset
+     */
+    statistics collect();
+};
+} // namespace lpbackend::storage
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::storage::epoch
+{
+/**
+ * @brief Pins the current epoch on this thread while it is alive
+ *
+ * Memory retired while a guard is alive is not freed before the guard is
+ * destroyed, so a reader may follow pointers it loaded under the guard even
+ * if a writer unlinks what they point at meanwhile. Guards may nest, they
+ * never block.
+ */
+class LPBACKEND_EXTERN guard
+{
+  public:
+    guard() noexcept;
+    guard(const guard &) = delete;
+    guard &operator=(const guard &) = delete;
+    ~guard();
+};
+
+/**
+ * @brief Frees memory once no guard that could have seen it is alive
+ *
+ * Must be called after the memory has been unlinked from every shared
+ * structure. Retired memory is freed by later calls of retire() and by
+ * collect().
+ */
+LPBACKEND_EXTERN void retire(void *pointer, void (*deleter)(void *));
+
+/**
+ * @brief Tries to advance the epoch and frees what became unreachable
+ *
+ * @return the number of retired pointers that are still waiting
+ */
+LPBACKEND_EXTERN std::size_t collect();
+} // namespace lpbackend::storage::epoch
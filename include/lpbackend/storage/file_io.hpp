@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include <boost/beast/core/file.hpp>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::storage
+{
+/**
+ * @brief Writes all of data at offset with positioned writes, retrying short ones
+ */
+LPBACKEND_EXTERN void write_at(boost::beast::file &file, std::uint64_t offset, std::string_view data,
+                               boost::system::error_code &ec);
+
+/**
+ * @brief Waits until the data written to file has reached the disk
+ */
+LPBACKEND_EXTERN void sync_file(boost::beast::file &file, boost::system::error_code &ec);
+
+/**
+ * @brief Makes created, renamed and removed entries of directory durable, NTFS journals them already
+ *
+ * @throws std::filesystem::filesystem_error if the directory cannot be synced
+ */
+LPBACKEND_EXTERN void sync_directory(const std::filesystem::path &directory);
+} // namespace lpbackend::storage
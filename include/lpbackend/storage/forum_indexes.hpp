@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include <lpbackend/storage/ordered_index.hpp>
+
+namespace lpbackend::storage
+{
+/**
+ * @brief Lists the threads of a board, the most recently active first
+ */
+struct board_thread_key
+{
+    std::uint64_t board;
+    // milliseconds since the epoch
+    std::int64_t last_activity;
+    std::uint64_t thread;
+
+    friend bool operator<(const board_thread_key &a, const board_thread_key &b) noexcept
+    {
+        return std::tuple{a.board, b.last_activity, b.thread} < std::tuple{b.board, a.last_activity, a.thread};
+    }
+
+    friend bool operator==(const board_thread_key &, const board_thread_key &) noexcept = default;
+
+    /** @brief The key before every thread of board */
+    static constexpr board_thread_key first(std::uint64_t board) noexcept
+    {
+        return {board, std::numeric_limits<std::int64_t>::max(), std::numeric_limits<std::uint64_t>::max()};
+    }
+
+    /** @brief The key after every thread of board */
+    static constexpr board_thread_key last(std::uint64_t board) noexcept
+    {
+        return {board, std::numeric_limits<std::int64_t>::min(), 0};
+    }
+};
+
+/**
+ * @brief Lists the posts of a thread in the order they were made
+ */
+struct thread_post_key
+{
+    std::uint64_t thread;
+    std::uint64_t seq;
+
+    friend auto operator<=>(const thread_post_key &, const thread_post_key &) noexcept = default;
+
+    static constexpr thread_post_key first(std::uint64_t thread) noexcept
+    {
+        return {thread, 0};
+    }
+
+    static constexpr thread_post_key last(std::uint64_t thread) noexcept
+    {
+        return {thread, std::numeric_limits<std::uint64_t>::max()};
+    }
+};
+
+// There is no forum data model yet, so nothing populates these indexes. The thread and post routes will keep
+// them up to date and answer their listings with the page functions below.
+
+// the thread is part of the key
+using board_thread_index = ordered_index<board_thread_key, std::monostate>;
+// maps to the id of the post
+using thread_post_index = ordered_index<thread_post_key, std::uint64_t>;
+
+/**
+ * @brief Returns the page of threads of board after cursor, or the first page
+ *
+ * The last key of a page is the cursor of the next one.
+ */
+inline std::vector<board_thread_index::entry> board_threads_page(const board_thread_index &index,
+                                                                 std::uint64_t board,
+                                                                 const std::optional<board_thread_key> &cursor,
+                                                                 std::size_t limit)
+{
+    // the bounds themselves are never used by a thread, an inclusive start is fine for the first page
+    return index.page(cursor.value_or(board_thread_key::first(board)), cursor.has_value(),
+                      board_thread_key::last(board), limit);
+}
+
+/**
+ * @brief Returns the page of posts of thread after cursor, or the first page
+ */
+inline std::vector<thread_post_index::entry> thread_posts_page(const thread_post_index &index, std::uint64_t thread,
+                                                               const std::optional<thread_post_key> &cursor,
+                                                               std::size_t limit)
+{
+    return index.page(cursor.value_or(thread_post_key::first(thread)), cursor.has_value(),
+                      thread_post_key::last(thread), limit);
+}
+} // namespace lpbackend::storage
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <lpbackend/config/lpbackend_config.hpp>
+#include <lpbackend/extern.hpp>
+#include <lpbackend/log.hpp>
+
+namespace lpbackend::storage
+{
+/**
+ * @brief Writes that are committed together, either all or none of them survive a crash
+ */
+class write_batch
+{
+  public:
+    struct operation
+    {
+        std::string key;
+        // std::nullopt erases the key
+        std::optional<std::string> value;
+    };
+
+  private:
+    std::vector<operation> operations_;
+
+  public:
+    void put(std::string key, std::string value)
+    {
+        operations_.push_back(operation{std::move(key), std::move(value)});
+    }
+
+    void erase(std::string key)
+    {
+        operations_.push_back(operation{std::move(key), std::nullopt});
+    }
+
+    bool empty() const noexcept
+    {
+        return operations_.empty();
+    }
+
+    const std::vector<operation> &operations() const noexcept
+    {
+        return operations_;
+    }
+};
+
+/**
+ * @brief An embedded key-value store made of append-only segment files
+ *
+ * Every key maps to the offset of its latest record in a segment. Segments
+ * are preallocated and mapped read-only, so a lookup is a hash probe and a
+ * copy out of the mapping. Records are appended with positioned writes,
+ * which the mapping sees as well.
+ *
+ * Writers queue their batches and a commit thread writes everything queued
+ * with a single write and a single fsync, batches arriving during an fsync
+ * go into the next one. Completions are delivered through the executor of
+ * the completion handler, no I/O thread ever waits for the disk.
+ *
+ * Compaction rewrites the live records of the oldest sealed segments into
+ * one segment that takes the id of the newest of them and marks everything
+ * below it obsolete, so a crash at any point leaves a consistent store. The
+ * compacted segment gets a new file name, the files it replaces are removed
+ * once no reader maps them any more.
+ *
+ * Record layout, little endian: CRC-32 of the rest of the record, flags,
+ * key size, value size, key, value.
+ */
+class LPBACKEND_EXTERN log_store
+{
+  public:
+    using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+    using completion_type = std::move_only_function<void(boost::system::error_code)>;
+
+    struct statistics
+    {
+        std::uint64_t commits;
+        std::uint64_t batches;
+        std::uint64_t records;
+        std::uint64_t written_bytes;
+        std::uint64_t largest_commit;
+        std::uint64_t compactions;
+        std::uint64_t reclaimed_bytes;
+        std::size_t keys;
+        std::size_t segments;
+    };
+
+  private:
+    struct segment;
+
+    struct location
+    {
+        std::uint64_t segment;
+        std::uint64_t offset;
+        std::uint32_t record_size;
+        std::uint32_t value_size;
+
+        bool operator==(const location &) const noexcept = default;
+    };
+
+    struct key_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(const std::string_view key) const noexcept
+        {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+
+    struct pending_batch
+    {
+        write_batch batch;
+        completion_type completion;
+    };
+
+    logger lg_{channel_logger("log_store")};
+    std::filesystem::path directory_;
+    std::uint64_t segment_bytes_{};
+    std::uint64_t garbage_percent_{};
+    std::chrono::seconds check_interval_{};
+    std::optional<boost::asio::thread_pool> threads_;
+
+    // guards the index and the segment table
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, location, key_hash, std::equal_to<>> index_;
+    std::map<std::uint64_t, std::shared_ptr<segment>> segments_;
+    // only touched by the commit thread once the store is open, segments below it are sealed
+    std::shared_ptr<segment> active_;
+    std::atomic<std::uint64_t> active_id_{};
+    std::uint64_t next_id_{};
+
+    std::mutex pending_mutex_;
+    std::vector<pending_batch> pending_;
+    bool committing_{false};
+    std::atomic<bool> compacting_{false};
+
+    std::atomic<std::uint64_t> commits_{};
+    std::atomic<std::uint64_t> batches_{};
+    std::atomic<std::uint64_t> records_{};
+    std::atomic<std::uint64_t> written_bytes_{};
+    std::atomic<std::uint64_t> largest_commit_{};
+    std::atomic<std::uint64_t> compactions_{};
+    std::atomic<std::uint64_t> reclaimed_bytes_{};
+
+    std::filesystem::path path_of(std::uint64_t id, std::uint64_t generation = 0) const;
+    std::shared_ptr<segment> map_segment(std::uint64_t id, const std::filesystem::path &path) const;
+    std::shared_ptr<segment> create_segment(std::uint64_t id);
+    void recover();
+    // requires mutex_ to be held exclusively, std::nullopt erases the key
+    void apply(std::string_view key, const std::optional<location> &record);
+    void submit(write_batch batch, completion_type completion);
+    void commit_pending();
+    void compact();
+
+  public:
+    /**
+     * @brief Recovers the store from its directory and starts the commit thread
+     *
+     * Blocks while every segment is scanned, so it must not run on an I/O thread.
+     *
+     * @throws std::runtime_error or std::filesystem::filesystem_error if the store cannot be opened
+     */
+    void open(const config::lpbackend_config::fields_t::storage_t &storage);
+
+    /**
+     * @brief Commits what is queued and joins the threads
+     */
+    void close();
+
+    bool is_open() const noexcept;
+
+    /**
+     * @brief Reads the committed value of a key
+     *
+     * Copies out of the mapping, which may fault in a page that is not cached.
+     */
+    std::optional<std::string> get(std::string_view key) const;
+
+    bool contains(std::string_view key) const;
+
+    /**
+     * @brief Commits a batch durably
+     *
+     * @param token Completion token with signature `void(boost::system::error_code)`.
+     * The writes are visible to get() once the completion is invoked.
+     *
+     * @par Thread Safety
+     * @e Distinct @e objects: Safe.@n
+     * @e Shared @e objects: Safe.
+     */
+    template <typename CompletionToken = boost::asio::deferred_t>
+    auto async_write(write_batch batch, CompletionToken &&token = {})
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [this](auto handler, write_batch batch) {
+                auto work{boost::asio::make_work_guard(boost::asio::get_associated_executor(handler))};
+                submit(std::move(batch), [handler = std::move(handler),
+                                          work = std::move(work)](const boost::system::error_code ec) mutable {
+                    auto executor{work.get_executor()};
+                    work.reset();
+                    boost::asio::post(executor,
+                                      [handler = std::move(handler), ec]() mutable { std::move(handler)(ec); });
+                });
+            },
+            token, std::move(batch));
+    }
+
+    template <typename CompletionToken = boost::asio::deferred_t>
+    auto async_put(std::string key, std::string value, CompletionToken &&token = {})
+    {
+        write_batch batch{};
+        batch.put(std::move(key), std::move(value));
+        return async_write(std::move(batch), std::forward<CompletionToken>(token));
+    }
+
+    template <typename CompletionToken = boost::asio::deferred_t>
+    auto async_erase(std::string key, CompletionToken &&token = {})
+    {
+        write_batch batch{};
+        batch.erase(std::move(key));
+        return async_write(std::move(batch), std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * @brief Compacts the sealed segments whenever enough of them is garbage, until cancelled
+     */
+    boost::asio::awaitable<void, executor_type> run();
+
+    /**
+     * @brief Returns the counters since the last call, keys and segments are not reset
+     */
+    statistics collect();
+
+    ~log_store();
+};
+} // namespace lpbackend::storage
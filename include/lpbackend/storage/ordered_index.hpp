@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <lpbackend/storage/epoch.hpp>
+
+namespace lpbackend::storage
+{
+/**
+ * @brief An ordered map for range scans, read without locks
+ *
+ * A skip list whose readers only load atomic links under an epoch guard, so
+ * they never wait for writers or for each other. Writers are serialised by a
+ * mutex and unlinked nodes are freed through the epoch domain. Keys are
+ * unique and an entry is never modified in place, updates erase and insert.
+ *
+ * A page starts with a seek in O(log n) and continues along the bottom level,
+ * so the cost of a page does not depend on how deep into the range it is.
+ */
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class ordered_index
+{
+  public:
+    using key_type = Key;
+    using mapped_type = Value;
+
+    struct entry
+    {
+        Key key;
+        Value value;
+    };
+
+  private:
+    static constexpr std::size_t max_height{24};
+
+    struct node
+    {
+        Key key;
+        Value value;
+        std::size_t height;
+
+        std::atomic<node *> *links() noexcept
+        {
+            return std::launder(reinterpret_cast<std::atomic<node *> *>(reinterpret_cast<std::byte *>(this) +
+                                                                        links_offset));
+        }
+
+        const std::atomic<node *> *links() const noexcept
+        {
+            return const_cast<node *>(this)->links();
+        }
+    };
+
+    static constexpr std::size_t links_offset{(sizeof(node) + alignof(std::atomic<node *>) - 1) /
+                                              alignof(std::atomic<node *>) * alignof(std::atomic<node *>)};
+    static constexpr std::size_t node_alignment{std::max(alignof(node), alignof(std::atomic<node *>))};
+
+    // the head has no key and only uses its links
+    struct head_t
+    {
+        std::array<std::atomic<node *>, max_height> links{};
+    } head_;
+    std::atomic<std::size_t> height_{1};
+    std::atomic<std::size_t> size_{0};
+    Compare compare_;
+    std::mutex write_mutex_;
+    std::minstd_rand random_{std::random_device{}()};
+
+    static node *create(std::size_t height, Key key, Value value)
+    {
+        auto *memory{::operator new(links_offset + height * sizeof(std::atomic<node *>),
+                                    std::align_val_t{node_alignment})};
+        auto *n{new (memory) node{std::move(key), std::move(value), height}};
+        for (std::size_t i{}; i < height; ++i)
+        {
+            new (n->links() + i) std::atomic<node *>{nullptr};
+        }
+        return n;
+    }
+
+    static void destroy(void *pointer) noexcept
+    {
+        auto *n{static_cast<node *>(pointer)};
+        const auto height{n->height};
+        n->~node();
+        ::operator delete(pointer, links_offset + height * sizeof(std::atomic<node *>),
+                          std::align_val_t{node_alignment});
+    }
+
+    std::atomic<node *> *links_of(node *n) noexcept
+    {
+        return n == nullptr ? head_.links.data() : n->links();
+    }
+
+    const std::atomic<node *> *links_of(const node *n) const noexcept
+    {
+        return n == nullptr ? head_.links.data() : n->links();
+    }
+
+    // every level has a quarter of the nodes of the one below
+    std::size_t random_height() noexcept
+    {
+        std::size_t height{1};
+        while (height < max_height && (random_() & 3) == 0)
+        {
+            ++height;
+        }
+        return height;
+    }
+
+    /**
+     * @brief Finds the first node not before key, or after it if exclusive
+     *
+     * Fills preceding with the last node before it on every level, nullptr
+     * standing for the head.
+     */
+    node *seek(const Key &key, bool exclusive, node **preceding) const noexcept
+    {
+        const node *x{nullptr};
+        node *next{nullptr};
+        for (auto level{height_.load(std::memory_order_acquire)}; level-- > 0;)
+        {
+            next = links_of(x)[level].load(std::memory_order_acquire);
+            while (next != nullptr && (exclusive ? !compare_(key, next->key) : compare_(next->key, key)))
+            {
+                x = next;
+                next = links_of(x)[level].load(std::memory_order_acquire);
+            }
+            if (preceding != nullptr)
+            {
+                preceding[level] = const_cast<node *>(x);
+            }
+        }
+        return next;
+    }
+
+    bool equal(const Key &a, const Key &b) const
+    {
+        return !compare_(a, b) && !compare_(b, a);
+    }
+
+  public:
+    ordered_index() = default;
+    explicit ordered_index(Compare compare) : compare_{std::move(compare)}
+    {
+    }
+    ordered_index(const ordered_index &) = delete;
+    ordered_index &operator=(const ordered_index &) = delete;
+
+    ~ordered_index()
+    {
+        for (auto *n{head_.links[0].load(std::memory_order_relaxed)}; n != nullptr;)
+        {
+            auto *next{n->links()[0].load(std::memory_order_relaxed)};
+            destroy(n);
+            n = next;
+        }
+    }
+
+    /**
+     * @brief Inserts an entry unless the key is present
+     *
+     * @return whether the entry was inserted
+     */
+    bool insert(Key key, Value value)
+    {
+        std::lock_guard lock{write_mutex_};
+        std::array<node *, max_height> preceding{};
+        auto *found{seek(key, false, preceding.data())};
+        if (found != nullptr && equal(found->key, key))
+        {
+            return false;
+        }
+        const auto height{random_height()};
+        const auto current{height_.load(std::memory_order_relaxed)};
+        for (auto level{current}; level < height; ++level)
+        {
+            preceding[level] = nullptr;
+        }
+        auto *n{create(height, std::move(key), std::move(value))};
+        for (std::size_t level{}; level < height; ++level)
+        {
+            n->links()[level].store(links_of(preceding[level])[level].load(std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+        }
+        // linked bottom up, a reader that finds the node on any level also finds it below
+        for (std::size_t level{}; level < height; ++level)
+        {
+            links_of(preceding[level])[level].store(n, std::memory_order_release);
+        }
+        if (height > current)
+        {
+            height_.store(height, std::memory_order_release);
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Erases the entry of key
+     *
+     * @return whether there was one
+     */
+    bool erase(const Key &key)
+    {
+        std::lock_guard lock{write_mutex_};
+        std::array<node *, max_height> preceding{};
+        auto *found{seek(key, false, preceding.data())};
+        if (found == nullptr || !equal(found->key, key))
+        {
+            return false;
+        }
+        // unlinked top down, the node keeps its own links for readers standing on it
+        for (auto level{found->height}; level-- > 0;)
+        {
+            links_of(preceding[level])[level].store(found->links()[level].load(std::memory_order_relaxed),
+                                                    std::memory_order_seq_cst);
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        epoch::retire(found, &ordered_index::destroy);
+        return true;
+    }
+
+    /**
+     * @brief Moves an entry to another key, like an erase followed by an insert
+     *
+     * @return whether from was present and to was not
+     */
+    bool rekey(const Key &from, Key to, Value value)
+    {
+        // readers may see both keys for a moment, never neither
+        if (!insert(std::move(to), std::move(value)))
+        {
+            return false;
+        }
+        return erase(from);
+    }
+
+    std::optional<Value> find(const Key &key) const
+    {
+        epoch::guard guard{};
+        const auto *found{seek(key, false, nullptr)};
+        if (found == nullptr || !equal(found->key, key))
+        {
+            return std::nullopt;
+        }
+        return found->value;
+    }
+
+    /**
+     * @brief Collects up to limit entries in [from, end), or (from, end) if exclusive
+     *
+     * Continuing after the key of the last entry of a page, exclusively, gives
+     * the next page no matter what was inserted or erased in between.
+     */
+    std::vector<entry> page(const Key &from, bool exclusive, const Key &end, std::size_t limit) const
+    {
+        std::vector<entry> result{};
+        result.reserve(limit);
+        epoch::guard guard{};
+        for (const auto *n{seek(from, exclusive, nullptr)};
+             n != nullptr && result.size() < limit && compare_(n->key, end);
+             n = n->links()[0].load(std::memory_order_acquire))
+        {
+            result.emplace_back(entry{n->key, n->value});
+        }
+        return result;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_.load(std::memory_order_relaxed);
+    }
+};
+} // namespace lpbackend::storage
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <lpbackend/extern.hpp>
+
+namespace lpbackend::util
+{
+/**
+ * @brief Returns the name of the instruction set the codecs run on, e.g. "avx2" or "scalar"
+ *
+ * The fastest kernels the CPU supports are chosen once, the first time a codec is used.
+ * Setting the environment variable LPBACKEND_CODEC_ISA to an instruction set name,
+ * e.g. "scalar", caps the choice at that instruction set.
+ */
+LPBACKEND_EXTERN std::string_view codec_isa() noexcept;
+
+/**
+ * @brief Encodes bytes as padded base64 of RFC 4648
+ */
+LPBACKEND_EXTERN std::string base64_encode(std::string_view data);
+
+/**
+ * @brief Decodes padded base64 of RFC 4648
+ *
+ * @return std::nullopt if the input contains other characters or is not padded to a multiple of 4
+ */
+LPBACKEND_EXTERN std::optional<std::string> base64_decode(std::string_view text);
+
+/**
+ * @brief Encodes bytes as lowercase hex digits
+ */
+LPBACKEND_EXTERN std::string hex_encode(std::string_view data);
+
+/**
+ * @brief Decodes hex digits of either case
+ *
+ * @return std::nullopt if the length is odd or a character is not a hex digit
+ */
+LPBACKEND_EXTERN std::optional<std::string> hex_decode(std::string_view text);
+
+/**
+ * @brief Returns whether text is well-formed UTF-8, without overlong forms, surrogates or code points above U+10FFFF
+ */
+LPBACKEND_EXTERN bool is_valid_utf8(std::string_view text) noexcept;
+
+/**
+ * @brief Decodes %XX escapes, '+' is left alone
+ *
+ * @return std::nullopt if a '%' is not followed by two hex digits
+ */
+LPBACKEND_EXTERN std::optional<std::string> percent_decode(std::string_view text);
+
+/**
+ * @brief Turns the path of a request-target into a canonical absolute path
+ *
+ * The query is dropped, escapes are decoded, empty and "." segments are
+ * removed and ".." segments remove their parent. A trailing slash is kept.
+ *
+ * @return std::nullopt if the path is not absolute, an escape is malformed,
+ *         the decoded path contains a NUL or a backslash, or ".." leaves the root
+ */
+LPBACKEND_EXTERN std::optional<std::string> normalize_path(std::string_view target);
+} // namespace lpbackend::util
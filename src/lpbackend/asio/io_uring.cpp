@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <memory>
+
+#include <boost/asio.hpp>
+
+#if defined(BOOST_ASIO_HAS_IO_URING)
+#include <liburing.h>
+#endif
+
+#include <lpbackend/asio/io_uring.hpp>
+
+namespace lpbackend::asio
+{
+bool io_uring_available() noexcept
+{
+#if defined(BOOST_ASIO_HAS_IO_URING)
+    static const bool available{[] {
+        // seccomp filters of containers commonly reject io_uring_setup
+        io_uring ring{};
+        if (io_uring_queue_init(4, &ring, 0) < 0)
+        {
+            return false;
+        }
+        const std::unique_ptr<io_uring_probe, decltype(&io_uring_free_probe)> probe{io_uring_get_probe_ring(&ring),
+                                                                                    io_uring_free_probe};
+        const bool supported{probe && io_uring_opcode_supported(probe.get(), IORING_OP_READV) &&
+                             io_uring_opcode_supported(probe.get(), IORING_OP_WRITEV)};
+        io_uring_queue_exit(&ring);
+        return supported;
+    }()};
+    return available;
+#else
+    return false;
+#endif
+}
+} // namespace lpbackend::asio
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <lpbackend/asio/recycling_allocator.hpp>
+
+namespace lpbackend::asio
+{
+namespace
+{
+std::atomic<std::size_t> class_count{recycling_pool::max_classes / 4};
+std::atomic<std::size_t> blocks_per_class{64};
+// bumped by trim(), every thread empties its cache when it sees a new value
+std::atomic<std::uint64_t> trim_generation{};
+
+struct thread_cache;
+
+struct registry
+{
+    std::mutex mutex;
+    std::vector<thread_cache *> caches;
+    // counters of exited threads
+    std::uint64_t hits{};
+    std::uint64_t misses{};
+    std::uint64_t bypassed{};
+    // totals at the last collect()
+    std::uint64_t reported_hits{};
+    std::uint64_t reported_misses{};
+    std::uint64_t reported_bypassed{};
+};
+
+registry &get_registry()
+{
+    // never destroyed, threads may exit after static destruction
+    static auto *const instance{new registry{}};
+    return *instance;
+}
+
+struct free_list
+{
+    void *head{};
+    std::size_t count{};
+};
+
+struct thread_cache
+{
+    std::array<free_list, recycling_pool::max_classes> lists{};
+    // only written by the owning thread, read by collect()
+    std::atomic<std::uint64_t> hits{};
+    std::atomic<std::uint64_t> misses{};
+    std::atomic<std::uint64_t> bypassed{};
+    std::atomic<std::size_t> cached_bytes{};
+    std::uint64_t generation{trim_generation.load(std::memory_order_relaxed)};
+
+    thread_cache()
+    {
+        auto &r{get_registry()};
+        std::lock_guard lock{r.mutex};
+        r.caches.push_back(this);
+    }
+
+    ~thread_cache()
+    {
+        release();
+        auto &r{get_registry()};
+        std::lock_guard lock{r.mutex};
+        r.hits += hits.load(std::memory_order_relaxed);
+        r.misses += misses.load(std::memory_order_relaxed);
+        r.bypassed += bypassed.load(std::memory_order_relaxed);
+        std::erase(r.caches, this);
+    }
+
+    void release() noexcept
+    {
+        for (auto &list : lists)
+        {
+            while (list.head)
+            {
+                ::operator delete(std::exchange(list.head, *static_cast<void **>(list.head)));
+            }
+            list.count = 0;
+        }
+        cached_bytes.store(0, std::memory_order_relaxed);
+    }
+
+    void check_trim() noexcept
+    {
+        if (const auto current{trim_generation.load(std::memory_order_relaxed)}; current != generation)
+        {
+            generation = current;
+            release();
+        }
+    }
+
+    void count(std::atomic<std::uint64_t> &counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// trivially destructible, so it can be checked while other thread_local objects are destroyed
+thread_local bool thread_exited{};
+
+thread_cache *local_cache()
+{
+    if (thread_exited)
+    {
+        return nullptr;
+    }
+    thread_local struct cache_holder
+    {
+        thread_cache cache{};
+        ~cache_holder()
+        {
+            thread_exited = true;
+        }
+    } holder{};
+    return &holder.cache;
+}
+
+// Blocks up to the largest possible class are always rounded up to their class, so
+// a block can be cached by any thread, whatever the limits were when it was allocated
+std::size_t size_class(const std::size_t size, const std::size_t alignment) noexcept
+{
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ || size == 0 ||
+        size > recycling_pool::max_classes * recycling_pool::class_bytes)
+    {
+        return 0;
+    }
+    return (size + recycling_pool::class_bytes - 1) / recycling_pool::class_bytes;
+}
+
+bool is_cached(const std::size_t index) noexcept
+{
+    return index > 0 && index <= class_count.load(std::memory_order_relaxed) &&
+           blocks_per_class.load(std::memory_order_relaxed) > 0;
+}
+} // namespace
+
+void recycling_pool::configure(const std::size_t max_block_bytes, const std::size_t blocks) noexcept
+{
+    class_count.store(std::clamp<std::size_t>((max_block_bytes + class_bytes - 1) / class_bytes, 1, max_classes),
+                      std::memory_order_relaxed);
+    blocks_per_class.store(blocks, std::memory_order_relaxed);
+}
+
+void *recycling_pool::allocate(const std::size_t size, const std::size_t alignment)
+{
+    const auto index{size_class(size, alignment)};
+    const auto cached{is_cached(index)};
+    auto *const cache{local_cache()};
+    if (cache && cached)
+    {
+        cache->check_trim();
+        auto &list{cache->lists[index - 1]};
+        if (list.head)
+        {
+            cache->count(cache->hits);
+            --list.count;
+            cache->cached_bytes.store(cache->cached_bytes.load(std::memory_order_relaxed) - index * class_bytes,
+                                      std::memory_order_relaxed);
+            return std::exchange(list.head, *static_cast<void **>(list.head));
+        }
+    }
+    if (cache)
+    {
+        cache->count(cached ? cache->misses : cache->bypassed);
+    }
+
+    if (index)
+    {
+        return ::operator new(index * class_bytes);
+    }
+    return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? ::operator new(size, std::align_val_t{alignment})
+                                                         : ::operator new(size);
+}
+
+void recycling_pool::deallocate(void *const pointer, const std::size_t size, const std::size_t alignment) noexcept
+{
+    const auto index{size_class(size, alignment)};
+    thread_cache *cache{};
+    if (is_cached(index))
+    {
+        try
+        {
+            cache = local_cache();
+        }
+        catch (const std::bad_alloc &)
+        {
+        }
+    }
+    if (cache)
+    {
+        cache->check_trim();
+    }
+    if (cache && cache->lists[index - 1].count < blocks_per_class.load(std::memory_order_relaxed))
+    {
+        auto &list{cache->lists[index - 1]};
+        *static_cast<void **>(pointer) = list.head;
+        list.head = pointer;
+        ++list.count;
+        cache->cached_bytes.store(cache->cached_bytes.load(std::memory_order_relaxed) + index * class_bytes,
+                                  std::memory_order_relaxed);
+        return;
+    }
+
+    if (!index && alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        ::operator delete(pointer, std::align_val_t{alignment});
+        return;
+    }
+    ::operator delete(pointer);
+}
+
+void recycling_pool::trim() noexcept
+{
+    trim_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t recycling_pool::cached_bytes()
+{
+    auto &r{get_registry()};
+    std::lock_guard lock{r.mutex};
+    std::size_t bytes{};
+    for (const auto *const cache : r.caches)
+    {
+        bytes += cache->cached_bytes.load(std::memory_order_relaxed);
+    }
+    return bytes;
+}
+
+recycling_pool::statistics recycling_pool::collect()
+{
+    auto &r{get_registry()};
+    std::lock_guard lock{r.mutex};
+    auto hits{r.hits};
+    auto misses{r.misses};
+    auto bypassed{r.bypassed};
+    std::size_t cached_bytes{};
+    for (const auto *const cache : r.caches)
+    {
+        hits += cache->hits.load(std::memory_order_relaxed);
+        misses += cache->misses.load(std::memory_order_relaxed);
+        bypassed += cache->bypassed.load(std::memory_order_relaxed);
+        cached_bytes += cache->cached_bytes.load(std::memory_order_relaxed);
+    }
+    const statistics result{hits - r.reported_hits, misses - r.reported_misses, bypassed - r.reported_bypassed,
+                            cached_bytes};
+    r.reported_hits = hits;
+    r.reported_misses = misses;
+    r.reported_bypassed = bypassed;
+    return result;
+}
+} // namespace lpbackend::asio
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <openssl/rand.h>
+
+#include <lpbackend/auth/captcha.hpp>
+#include <lpbackend/image/jpeg_encoder.hpp>
+
+namespace lpbackend::auth
+{
+namespace
+{
+// no 0, 1, I or O, and a power of two, so a random byte picks a character without bias
+constexpr std::string_view alphabet{"ABCDEFGHJKLMNPQRSTUVWXYZ23456789"};
+
+constexpr std::size_t glyph_width{5};
+constexpr std::size_t glyph_height{7};
+
+// 5x7 glyphs in the order of the alphabet, the most significant of the 5 bits is the leftmost column
+constexpr std::array<std::array<std::uint8_t, glyph_height>, alphabet.size()> glyphs{{
+    {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}, // A
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110}, // B
+    {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110}, // C
+    {0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110}, // D
+    {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111}, // E
+    {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000}, // F
+    {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111}, // G
+    {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}, // H
+    {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100}, // J
+    {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001}, // K
+    {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111}, // L
+    {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001}, // M
+    {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001}, // N
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000}, // P
+    {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101}, // Q
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001}, // R
+    {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110}, // S
+    {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100}, // T
+    {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}, // U
+    {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100}, // V
+    {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010}, // W
+    {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001}, // X
+    {0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100}, // Y
+    {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111}, // Z
+    {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111}, // 2
+    {0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110}, // 3
+    {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010}, // 4
+    {0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110}, // 5
+    {0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110}, // 6
+    {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000}, // 7
+    {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110}, // 8
+    {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100}, // 9
+}};
+
+struct stroke
+{
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+};
+
+bool glyph_cell(const std::size_t glyph, const std::ptrdiff_t column, const std::ptrdiff_t row) noexcept
+{
+    if (column < 0 || row < 0 || column >= static_cast<std::ptrdiff_t>(glyph_width) ||
+        row >= static_cast<std::ptrdiff_t>(glyph_height))
+    {
+        return false;
+    }
+    return (glyphs[glyph][static_cast<std::size_t>(row)] >> (glyph_width - 1 - static_cast<std::size_t>(column))) & 1;
+}
+
+// Joins the centers of neighbouring cells, so diagonals become strokes instead of staircases.
+// Diagonal neighbours are only joined if no cell beside them is set, which would fill the corner.
+std::vector<stroke> glyph_strokes(const std::size_t glyph)
+{
+    std::vector<stroke> strokes{};
+    for (std::ptrdiff_t row{}; row < static_cast<std::ptrdiff_t>(glyph_height); ++row)
+    {
+        for (std::ptrdiff_t column{}; column < static_cast<std::ptrdiff_t>(glyph_width); ++column)
+        {
+            if (!glyph_cell(glyph, column, row))
+            {
+                continue;
+            }
+            const auto x{static_cast<double>(column) + 0.5};
+            const auto y{static_cast<double>(row) + 0.5};
+            strokes.push_back(stroke{x, y, x, y});
+            if (glyph_cell(glyph, column + 1, row))
+            {
+                strokes.push_back(stroke{x, y, x + 1, y});
+            }
+            if (glyph_cell(glyph, column, row + 1))
+            {
+                strokes.push_back(stroke{x, y, x, y + 1});
+            }
+            for (const std::ptrdiff_t side : {-1, 1})
+            {
+                if (glyph_cell(glyph, column + side, row + 1) && !glyph_cell(glyph, column + side, row) &&
+                    !glyph_cell(glyph, column, row + 1))
+                {
+                    strokes.push_back(stroke{x, y, x + static_cast<double>(side), y + 1});
+                }
+            }
+        }
+    }
+    return strokes;
+}
+
+bool inked(const std::vector<stroke> &strokes, const double x, const double y) noexcept
+{
+    constexpr double half_width{0.5};
+    return std::ranges::any_of(strokes, [&](const stroke &s) {
+        const auto dx{s.x1 - s.x0};
+        const auto dy{s.y1 - s.y0};
+        const auto length{dx * dx + dy * dy};
+        const auto t{length > 0 ? std::clamp(((x - s.x0) * dx + (y - s.y0) * dy) / length, 0.0, 1.0) : 0.0};
+        const auto px{s.x0 + t * dx - x};
+        const auto py{s.y0 + t * dy - y};
+        return px * px + py * py <= half_width * half_width;
+    });
+}
+
+class canvas
+{
+  private:
+    std::size_t width_;
+    std::size_t height_;
+    std::vector<double> pixels_;
+
+  public:
+    canvas(const std::size_t width, const std::size_t height, const double background)
+        : width_{width}, height_{height}, pixels_(width * height, background)
+    {
+    }
+
+    std::size_t width() const noexcept
+    {
+        return width_;
+    }
+
+    std::size_t height() const noexcept
+    {
+        return height_;
+    }
+
+    // blends ink over a pixel by its coverage
+    void blend(const std::ptrdiff_t x, const std::ptrdiff_t y, const double ink, const double coverage) noexcept
+    {
+        if (x < 0 || y < 0 || static_cast<std::size_t>(x) >= width_ || static_cast<std::size_t>(y) >= height_)
+        {
+            return;
+        }
+        auto &pixel{pixels_[static_cast<std::size_t>(y) * width_ + static_cast<std::size_t>(x)]};
+        pixel += (ink - pixel) * coverage;
+    }
+
+    double sample(const double x, const double y, const double outside) const noexcept
+    {
+        // bilinear, so warped strokes stay smooth
+        const auto x0{std::floor(x)};
+        const auto y0{std::floor(y)};
+        const auto at{[&](const double px, const double py) {
+            if (px < 0 || py < 0 || px >= static_cast<double>(width_) || py >= static_cast<double>(height_))
+            {
+                return outside;
+            }
+            return pixels_[static_cast<std::size_t>(py) * width_ + static_cast<std::size_t>(px)];
+        }};
+        const auto fx{x - x0};
+        const auto fy{y - y0};
+        return (at(x0, y0) * (1 - fx) + at(x0 + 1, y0) * fx) * (1 - fy) +
+               (at(x0, y0 + 1) * (1 - fx) + at(x0 + 1, y0 + 1) * fx) * fy;
+    }
+
+    std::vector<std::uint8_t> to_gray() const
+    {
+        std::vector<std::uint8_t> gray(pixels_.size());
+        std::ranges::transform(pixels_, gray.begin(), [](const double value) {
+            return static_cast<std::uint8_t>(std::clamp(std::lround(value), 0L, 255L));
+        });
+        return gray;
+    }
+};
+
+std::string random_text(const std::size_t length)
+{
+    std::string bytes(length, '\0');
+    if (RAND_bytes(reinterpret_cast<unsigned char *>(bytes.data()), static_cast<int>(bytes.size())) != 1)
+    {
+        throw std::runtime_error{"failed to generate captcha text"};
+    }
+    for (auto &c : bytes)
+    {
+        c = alphabet[static_cast<unsigned char>(c) % alphabet.size()];
+    }
+    return bytes;
+}
+
+void draw_glyph(canvas &image, const std::size_t glyph, const double center_x, const double center_y,
+                const double scale, const double angle, const double shear, const double ink)
+{
+    // pixels are mapped back into the glyph, sampled 4 times each for antialiasing
+    const auto strokes{glyph_strokes(glyph)};
+    const auto cos_a{std::cos(angle)};
+    const auto sin_a{std::sin(angle)};
+    const auto radius{scale * std::hypot(glyph_width, glyph_height) * 0.5 * (1 + std::abs(shear))};
+    for (auto y{static_cast<std::ptrdiff_t>(center_y - radius)}; y <= static_cast<std::ptrdiff_t>(center_y + radius);
+         ++y)
+    {
+        for (auto x{static_cast<std::ptrdiff_t>(center_x - radius)};
+             x <= static_cast<std::ptrdiff_t>(center_x + radius); ++x)
+        {
+            int covered{};
+            for (const auto &[sx, sy] : {std::pair{0.25, 0.25}, {0.75, 0.25}, {0.25, 0.75}, {0.75, 0.75}})
+            {
+                const auto dx{static_cast<double>(x) + sx - center_x};
+                const auto dy{static_cast<double>(y) + sy - center_y};
+                const auto u{(dx * cos_a + dy * sin_a) / scale};
+                const auto v{(-dx * sin_a + dy * cos_a) / scale};
+                covered += inked(strokes, u - shear * v + glyph_width / 2.0, v + glyph_height / 2.0);
+            }
+            if (covered > 0)
+            {
+                image.blend(x, y, ink, covered / 4.0);
+            }
+        }
+    }
+}
+
+void draw_curve(canvas &image, std::mt19937 &rng, const double ink)
+{
+    std::uniform_real_distribution<double> unit{0, 1};
+    const auto height{static_cast<double>(image.height())};
+    const auto base{height * (0.2 + 0.6 * unit(rng))};
+    const auto amplitude{height * (0.05 + 0.2 * unit(rng))};
+    const auto period{static_cast<double>(image.width()) * (0.5 + unit(rng))};
+    const auto phase{2 * std::numbers::pi * unit(rng)};
+    const auto thickness{1 + unit(rng)};
+    for (std::size_t x{}; x < image.width(); ++x)
+    {
+        const auto y{base + amplitude * std::sin(2 * std::numbers::pi * static_cast<double>(x) / period + phase)};
+        for (auto py{static_cast<std::ptrdiff_t>(y - thickness)}; py <= static_cast<std::ptrdiff_t>(y + thickness);
+             ++py)
+        {
+            const auto distance{std::abs(static_cast<double>(py) + 0.5 - y)};
+            image.blend(static_cast<std::ptrdiff_t>(x), py, ink, std::clamp(thickness - distance, 0.0, 1.0));
+        }
+    }
+}
+} // namespace
+
+captcha render_captcha(const captcha_options &options)
+{
+    const auto width{std::max<std::size_t>(options.width, 16)};
+    const auto height{std::max<std::size_t>(options.height, 16)};
+    const auto length{std::max<std::size_t>(options.length, 1)};
+
+    captcha result{.answer = random_text(length), .jpeg = {}};
+
+    // the distortion does not have to be unpredictable, only the text does
+    std::uint32_t seed{};
+    if (RAND_bytes(reinterpret_cast<unsigned char *>(&seed), sizeof(seed)) != 1)
+    {
+        throw std::runtime_error{"failed to seed captcha distortion"};
+    }
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<double> unit{0, 1};
+    const auto between{[&](const double low, const double high) { return low + (high - low) * unit(rng); }};
+
+    const auto background{between(225, 250)};
+    canvas text{width, height, background};
+    const auto cell{static_cast<double>(width) / static_cast<double>(length + 1)};
+    const auto glyph_scale{std::min(static_cast<double>(height) * 0.55 / glyph_height, cell * 0.9 / glyph_width)};
+    for (std::size_t i{}; i < length; ++i)
+    {
+        const auto glyph{alphabet.find(result.answer[i])};
+        draw_glyph(text, glyph, cell * (static_cast<double>(i) + 1) + between(-0.15, 0.15) * cell,
+                   static_cast<double>(height) * between(0.42, 0.58), glyph_scale * between(0.85, 1.15),
+                   between(-0.35, 0.35), between(-0.3, 0.3), between(20, 90));
+    }
+    for (auto curves{2 + rng() % 3}; curves > 0; --curves)
+    {
+        draw_curve(text, rng, between(40, 120));
+    }
+
+    // warp the whole image, so glyphs cannot be cut apart along straight lines
+    canvas warped{width, height, background};
+    const auto amplitude_x{between(1.5, 3.5)};
+    const auto amplitude_y{between(1.5, 3.5)};
+    const auto period_x{static_cast<double>(height) * between(0.8, 1.6)};
+    const auto period_y{static_cast<double>(width) * between(0.3, 0.6)};
+    const auto phase_x{between(0, 2 * std::numbers::pi)};
+    const auto phase_y{between(0, 2 * std::numbers::pi)};
+    for (std::size_t y{}; y < height; ++y)
+    {
+        for (std::size_t x{}; x < width; ++x)
+        {
+            const auto fx{static_cast<double>(x)};
+            const auto fy{static_cast<double>(y)};
+            const auto sx{fx + amplitude_x * std::sin(2 * std::numbers::pi * fy / period_x + phase_x)};
+            const auto sy{fy + amplitude_y * std::sin(2 * std::numbers::pi * fx / period_y + phase_y)};
+            const auto speckle{unit(rng) < 0.03 ? between(-80, 40) : between(-6, 6)};
+            warped.blend(static_cast<std::ptrdiff_t>(x), static_cast<std::ptrdiff_t>(y),
+                         text.sample(sx, sy, background) + speckle, 1);
+        }
+    }
+
+    result.jpeg = image::encode_jpeg(warped.to_gray(), width, height, options.quality);
+    return result;
+}
+} // namespace lpbackend::auth
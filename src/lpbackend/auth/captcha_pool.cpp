@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+
+#include <lpbackend/auth/captcha_pool.hpp>
+#include <lpbackend/util/codec.hpp>
+
+namespace lpbackend::auth
+{
+namespace
+{
+constexpr std::string_view data_uri_prefix{"data:image/jpeg;base64,"};
+
+std::string to_data_uri(const std::string_view jpeg)
+{
+    std::string out{data_uri_prefix};
+    out.append(util::base64_encode(jpeg));
+    return out;
+}
+} // namespace
+
+void captcha_pool::start(const config::lpbackend_config::fields_t::auth_t &auth)
+{
+    options_ = captcha_options{.width = static_cast<std::size_t>(auth.captcha_width),
+                               .height = static_cast<std::size_t>(auth.captcha_height),
+                               .length = static_cast<std::size_t>(auth.captcha_length),
+                               .quality = static_cast<int>(std::min<std::uint64_t>(auth.captcha_quality, 100))};
+    capacity_ = static_cast<std::size_t>(auth.captcha_pool_size);
+    refill_per_second_ = static_cast<double>(auth.captcha_refill_per_second);
+    workers_.emplace(std::max<std::size_t>(static_cast<std::size_t>(auth.captcha_threads), 1));
+}
+
+void captcha_pool::render_one()
+{
+    std::optional<entry> rendered{};
+    try
+    {
+        auto result{render_captcha(options_)};
+        rendered.emplace(entry{.answer = std::move(result.answer), .data_uri = to_data_uri(result.jpeg)});
+    }
+    catch (const std::exception &e)
+    {
+        LPBACKEND_LOG(lg_, error) << "Failed to render a captcha: " << e.what();
+    }
+
+    std::lock_guard lock{mutex_};
+    --rendering_;
+    if (rendered)
+    {
+        ready_.push_back(std::move(*rendered));
+        rendered_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+boost::asio::awaitable<void, captcha_pool::executor_type> captcha_pool::run()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (!workers_ || capacity_ == 0)
+    {
+        co_return;
+    }
+
+    // a token bucket of renders, it starts full so the pool is filled right after startup
+    constexpr std::chrono::milliseconds tick{100};
+    const auto refill_per_tick{refill_per_second_ * std::chrono::duration<double>{tick}.count()};
+    auto budget{static_cast<double>(capacity_)};
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        std::size_t wanted{};
+        {
+            std::lock_guard lock{mutex_};
+            const auto missing{capacity_ - std::min(capacity_, ready_.size() + rendering_)};
+            wanted = std::min(missing, static_cast<std::size_t>(budget));
+            rendering_ += wanted;
+        }
+        budget -= static_cast<double>(wanted);
+        for (std::size_t i{}; i < wanted; ++i)
+        {
+            boost::asio::post(*workers_, [this] { render_one(); });
+        }
+
+        timer.expires_after(tick);
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+        budget = std::min(budget + refill_per_tick, static_cast<double>(capacity_));
+    }
+}
+
+void captcha_pool::stop()
+{
+    if (workers_)
+    {
+        workers_->stop();
+        workers_->join();
+    }
+}
+
+std::optional<captcha_pool::entry> captcha_pool::pop()
+{
+    std::unique_lock lock{mutex_};
+    if (ready_.empty())
+    {
+        lock.unlock();
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    auto result{std::move(ready_.front())};
+    ready_.pop_front();
+    lock.unlock();
+    served_.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+captcha_pool::statistics captcha_pool::collect()
+{
+    std::lock_guard lock{mutex_};
+    return statistics{.rendered = rendered_.exchange(0, std::memory_order_relaxed),
+                      .served = served_.exchange(0, std::memory_order_relaxed),
+                      .exhausted = exhausted_.exchange(0, std::memory_order_relaxed),
+                      .ready = ready_.size()};
+}
+
+captcha_pool::~captcha_pool()
+{
+    stop();
+}
+} // namespace lpbackend::auth
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include <lpbackend/auth/password_hash.hpp>
+#include <lpbackend/util/codec.hpp>
+
+namespace lpbackend::auth
+{
+namespace
+{
+constexpr std::uint32_t argon2_version{0x13};
+constexpr std::uint32_t argon2id_type{2};
+constexpr std::size_t block_bytes{1024};
+constexpr std::size_t block_words{block_bytes / 8};
+constexpr std::size_t sync_points{4};
+constexpr std::size_t salt_bytes{16};
+constexpr std::size_t tag_bytes{32};
+
+using block = std::array<std::uint64_t, block_words>;
+
+std::uint64_t load64(const std::uint8_t *in) noexcept
+{
+    std::uint64_t value{};
+    for (std::size_t i{8}; i-- > 0;)
+    {
+        value = value << 8 | in[i];
+    }
+    return value;
+}
+
+void store32(std::uint8_t *out, const std::uint32_t value) noexcept
+{
+    for (std::size_t i{}; i < 4; ++i)
+    {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+void store64(std::uint8_t *out, const std::uint64_t value) noexcept
+{
+    for (std::size_t i{}; i < 8; ++i)
+    {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+/**
+ * @brief BLAKE2b without a key, with a digest of 1 to 64 bytes
+ *
+ * OpenSSL only offers the 64-byte digest, Argon2 needs the shorter ones too.
+ */
+class blake2b
+{
+  private:
+    static constexpr std::array<std::uint64_t, 8> iv{0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b,
+                                                     0xa54ff53a5f1d36f1, 0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+                                                     0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+    static constexpr std::array<std::array<std::uint8_t, 16>, 12> sigma{{
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+        {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+        {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+        {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+        {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+        {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+        {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+        {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+        {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+        {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+        {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    }};
+
+    std::array<std::uint64_t, 8> h_{iv};
+    std::array<std::uint8_t, 128> buffer_{};
+    std::size_t buffered_{};
+    std::uint64_t counter_{};
+    std::size_t length_;
+
+    static void mix(std::array<std::uint64_t, 16> &v, const std::size_t a, const std::size_t b, const std::size_t c,
+                    const std::size_t d, const std::uint64_t x, const std::uint64_t y) noexcept
+    {
+        v[a] = v[a] + v[b] + x;
+        v[d] = std::rotr(v[d] ^ v[a], 32);
+        v[c] = v[c] + v[d];
+        v[b] = std::rotr(v[b] ^ v[c], 24);
+        v[a] = v[a] + v[b] + y;
+        v[d] = std::rotr(v[d] ^ v[a], 16);
+        v[c] = v[c] + v[d];
+        v[b] = std::rotr(v[b] ^ v[c], 63);
+    }
+
+    void compress(const bool last) noexcept
+    {
+        std::array<std::uint64_t, 16> m{};
+        std::array<std::uint64_t, 16> v{};
+        for (std::size_t i{}; i < m.size(); ++i)
+        {
+            m[i] = load64(buffer_.data() + 8 * i);
+        }
+        for (std::size_t i{}; i < 8; ++i)
+        {
+            v[i] = h_[i];
+            v[i + 8] = iv[i];
+        }
+        v[12] ^= counter_;
+        if (last)
+        {
+            v[14] = ~v[14];
+        }
+        for (const auto &s : sigma)
+        {
+            mix(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+            mix(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+            mix(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+            mix(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+            mix(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+            mix(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+            mix(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+            mix(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+        }
+        for (std::size_t i{}; i < 8; ++i)
+        {
+            h_[i] ^= v[i] ^ v[i + 8];
+        }
+    }
+
+  public:
+    explicit blake2b(const std::size_t length) noexcept : length_{length}
+    {
+        h_[0] ^= 0x01010000 ^ length;
+    }
+
+    blake2b(const blake2b &) = delete;
+    blake2b &operator=(const blake2b &) = delete;
+
+    ~blake2b()
+    {
+        OPENSSL_cleanse(buffer_.data(), buffer_.size());
+        OPENSSL_cleanse(h_.data(), sizeof(h_));
+    }
+
+    void update(const void *data, std::size_t size) noexcept
+    {
+        // a full buffer is only compressed once more data follows, the last block carries the final flag
+        const auto *in{static_cast<const std::uint8_t *>(data)};
+        while (size > 0)
+        {
+            if (buffered_ == buffer_.size())
+            {
+                counter_ += buffer_.size();
+                compress(false);
+                buffered_ = 0;
+            }
+            const auto chunk{std::min(size, buffer_.size() - buffered_)};
+            std::memcpy(buffer_.data() + buffered_, in, chunk);
+            buffered_ += chunk;
+            in += chunk;
+            size -= chunk;
+        }
+    }
+
+    void update(const std::uint32_t value) noexcept
+    {
+        std::array<std::uint8_t, 4> bytes{};
+        store32(bytes.data(), value);
+        update(bytes.data(), bytes.size());
+    }
+
+    void final(std::uint8_t *out) noexcept
+    {
+        counter_ += buffered_;
+        std::fill(buffer_.begin() + static_cast<std::ptrdiff_t>(buffered_), buffer_.end(), 0);
+        compress(true);
+        std::array<std::uint8_t, 64> digest{};
+        for (std::size_t i{}; i < h_.size(); ++i)
+        {
+            store64(digest.data() + 8 * i, h_[i]);
+        }
+        std::memcpy(out, digest.data(), length_);
+        OPENSSL_cleanse(digest.data(), digest.size());
+    }
+};
+
+// H' of RFC 9106, a hash of any length made of chained 64-byte digests
+void hash_long(std::uint8_t *out, const std::size_t length, const std::uint8_t *in, const std::size_t size) noexcept
+{
+    if (length <= 64)
+    {
+        blake2b hash{length};
+        hash.update(static_cast<std::uint32_t>(length));
+        hash.update(in, size);
+        hash.final(out);
+        return;
+    }
+
+    std::array<std::uint8_t, 64> v{};
+    blake2b first{v.size()};
+    first.update(static_cast<std::uint32_t>(length));
+    first.update(in, size);
+    first.final(v.data());
+    std::memcpy(out, v.data(), 32);
+    out += 32;
+    auto remaining{length - 32};
+    while (remaining > 64)
+    {
+        blake2b next{v.size()};
+        next.update(v.data(), v.size());
+        next.final(v.data());
+        std::memcpy(out, v.data(), 32);
+        out += 32;
+        remaining -= 32;
+    }
+    blake2b last{remaining};
+    last.update(v.data(), v.size());
+    last.final(out);
+    OPENSSL_cleanse(v.data(), v.size());
+}
+
+std::uint64_t blamka(const std::uint64_t x, const std::uint64_t y) noexcept
+{
+    return x + y + 2 * (x & 0xffffffff) * (y & 0xffffffff);
+}
+
+// the BLAKE2b round with multiplications and without message words
+void permute(block &b, const std::array<std::size_t, 16> &at) noexcept
+{
+    std::array<std::uint64_t, 16> v{};
+    for (std::size_t i{}; i < v.size(); ++i)
+    {
+        v[i] = b[at[i]];
+    }
+    const auto mix{[&v](const std::size_t a, const std::size_t b, const std::size_t c, const std::size_t d) {
+        v[a] = blamka(v[a], v[b]);
+        v[d] = std::rotr(v[d] ^ v[a], 32);
+        v[c] = blamka(v[c], v[d]);
+        v[b] = std::rotr(v[b] ^ v[c], 24);
+        v[a] = blamka(v[a], v[b]);
+        v[d] = std::rotr(v[d] ^ v[a], 16);
+        v[c] = blamka(v[c], v[d]);
+        v[b] = std::rotr(v[b] ^ v[c], 63);
+    }};
+    mix(0, 4, 8, 12);
+    mix(1, 5, 9, 13);
+    mix(2, 6, 10, 14);
+    mix(3, 7, 11, 15);
+    mix(0, 5, 10, 15);
+    mix(1, 6, 11, 12);
+    mix(2, 7, 8, 13);
+    mix(3, 4, 9, 14);
+    for (std::size_t i{}; i < v.size(); ++i)
+    {
+        b[at[i]] = v[i];
+    }
+}
+
+// the compression function G, out may alias y
+void compress(const block &x, const block &y, block &out, const bool with_xor) noexcept
+{
+    block r{};
+    for (std::size_t i{}; i < block_words; ++i)
+    {
+        r[i] = x[i] ^ y[i];
+    }
+    auto z{r};
+    // the block is a matrix of 8 x 8 pairs of words, permuted by rows and then by columns
+    for (std::size_t row{}; row < 8; ++row)
+    {
+        std::array<std::size_t, 16> at{};
+        for (std::size_t i{}; i < at.size(); ++i)
+        {
+            at[i] = 16 * row + i;
+        }
+        permute(z, at);
+    }
+    for (std::size_t column{}; column < 8; ++column)
+    {
+        std::array<std::size_t, 16> at{};
+        for (std::size_t i{}; i < at.size(); i += 2)
+        {
+            at[i] = 2 * column + 8 * i;
+            at[i + 1] = 2 * column + 8 * i + 1;
+        }
+        permute(z, at);
+    }
+    for (std::size_t i{}; i < block_words; ++i)
+    {
+        out[i] = (with_xor ? out[i] : 0) ^ z[i] ^ r[i];
+    }
+}
+
+struct instance
+{
+    std::uint32_t passes;
+    std::size_t lanes;
+    std::size_t segment_length;
+    std::size_t lane_length;
+    std::vector<block> memory;
+};
+
+void fill_segment(instance &state, const std::uint32_t pass, const std::size_t slice, const std::size_t lane) noexcept
+{
+    // Argon2id takes reference blocks independently of the password in the first half of the first pass
+    const bool independent{pass == 0 && slice < sync_points / 2};
+    block input{};
+    block address{};
+    const block zero{};
+    const auto next_addresses{[&] {
+        ++input[6];
+        compress(zero, input, address, false);
+        compress(zero, address, address, false);
+    }};
+    if (independent)
+    {
+        input[0] = pass;
+        input[1] = lane;
+        input[2] = slice;
+        input[3] = state.memory.size();
+        input[4] = state.passes;
+        input[5] = argon2id_type;
+    }
+
+    // the first two blocks of every lane are made from the seed
+    std::size_t first{};
+    if (pass == 0 && slice == 0)
+    {
+        first = 2;
+        if (independent)
+        {
+            next_addresses();
+        }
+    }
+
+    auto current{lane * state.lane_length + slice * state.segment_length + first};
+    auto previous{current % state.lane_length == 0 ? current + state.lane_length - 1 : current - 1};
+    for (auto i{first}; i < state.segment_length; ++i, ++current, ++previous)
+    {
+        if (current % state.lane_length == 1)
+        {
+            previous = current - 1;
+        }
+
+        std::uint64_t pseudo_random{};
+        if (independent)
+        {
+            if (i % block_words == 0)
+            {
+                next_addresses();
+            }
+            pseudo_random = address[i % block_words];
+        }
+        else
+        {
+            pseudo_random = state.memory[previous][0];
+        }
+
+        const auto reference_lane{pass == 0 && slice == 0 ? lane : (pseudo_random >> 32) % state.lanes};
+        const bool same_lane{reference_lane == lane};
+        // blocks that are finished and not the previous one
+        std::uint64_t area{};
+        if (pass == 0)
+        {
+            area = slice * state.segment_length;
+            area = same_lane ? area + i - 1 : area - (i == 0 ? 1 : 0);
+        }
+        else
+        {
+            area = state.lane_length - state.segment_length;
+            area = same_lane ? area + i - 1 : area - (i == 0 ? 1 : 0);
+        }
+        std::uint64_t relative{pseudo_random & 0xffffffff};
+        relative = relative * relative >> 32;
+        relative = area - 1 - (area * relative >> 32);
+        const auto start{pass != 0 && slice != sync_points - 1 ? (slice + 1) * state.segment_length : 0};
+        const auto reference{reference_lane * state.lane_length + (start + relative) % state.lane_length};
+
+        compress(state.memory[previous], state.memory[reference], state.memory[current], pass != 0);
+    }
+}
+
+std::string encode_unpadded(const std::string_view data)
+{
+    auto text{util::base64_encode(data)};
+    text.erase(text.find_last_not_of('=') + 1);
+    return text;
+}
+
+std::optional<std::string> decode_unpadded(const std::string_view text)
+{
+    if (text.size() % 4 == 1 || text.find('=') != std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+    std::string padded{text};
+    padded.append((4 - text.size() % 4) % 4, '=');
+    return util::base64_decode(padded);
+}
+} // namespace
+
+std::string argon2id(const std::string_view password, const std::string_view salt, const argon2_params &params,
+                     const std::size_t tag_length)
+{
+    if (params.parallelism < 1 || params.parallelism > 0xffffff || params.iterations < 1 ||
+        params.memory_kib < 8 * static_cast<std::uint64_t>(params.parallelism) || salt.size() < 8 ||
+        tag_length < 4 || tag_length > 0xffffffff || password.size() > 0xffffffff)
+    {
+        throw std::invalid_argument{"Argon2id parameters out of range"};
+    }
+
+    instance state{.passes = params.iterations,
+                   .lanes = params.parallelism,
+                   .segment_length = params.memory_kib / (sync_points * params.parallelism),
+                   .lane_length = 0,
+                   .memory = {}};
+    state.lane_length = state.segment_length * sync_points;
+    state.memory.resize(state.lane_length * state.lanes);
+
+    // H0 followed by room for the block and lane number
+    std::array<std::uint8_t, 72> seed{};
+    {
+        blake2b hash{64};
+        hash.update(params.parallelism);
+        hash.update(static_cast<std::uint32_t>(tag_length));
+        hash.update(params.memory_kib);
+        hash.update(params.iterations);
+        hash.update(argon2_version);
+        hash.update(argon2id_type);
+        hash.update(static_cast<std::uint32_t>(password.size()));
+        hash.update(password.data(), password.size());
+        hash.update(static_cast<std::uint32_t>(salt.size()));
+        hash.update(salt.data(), salt.size());
+        // neither a secret nor associated data
+        hash.update(std::uint32_t{0});
+        hash.update(std::uint32_t{0});
+        hash.final(seed.data());
+    }
+
+    std::array<std::uint8_t, block_bytes> bytes{};
+    for (std::size_t lane{}; lane < state.lanes; ++lane)
+    {
+        for (std::uint32_t index{}; index < 2; ++index)
+        {
+            store32(seed.data() + 64, index);
+            store32(seed.data() + 68, static_cast<std::uint32_t>(lane));
+            hash_long(bytes.data(), bytes.size(), seed.data(), seed.size());
+            auto &target{state.memory[lane * state.lane_length + index]};
+            for (std::size_t i{}; i < block_words; ++i)
+            {
+                target[i] = load64(bytes.data() + 8 * i);
+            }
+        }
+    }
+
+    // lanes only read finished slices of other lanes, so filling them one after another is equivalent
+    for (std::uint32_t pass{}; pass < state.passes; ++pass)
+    {
+        for (std::size_t slice{}; slice < sync_points; ++slice)
+        {
+            for (std::size_t lane{}; lane < state.lanes; ++lane)
+            {
+                fill_segment(state, pass, slice, lane);
+            }
+        }
+    }
+
+    auto last{state.memory[state.lane_length - 1]};
+    for (std::size_t lane{1}; lane < state.lanes; ++lane)
+    {
+        const auto &column{state.memory[lane * state.lane_length + state.lane_length - 1]};
+        for (std::size_t i{}; i < block_words; ++i)
+        {
+            last[i] ^= column[i];
+        }
+    }
+    for (std::size_t i{}; i < block_words; ++i)
+    {
+        store64(bytes.data() + 8 * i, last[i]);
+    }
+    std::string tag(tag_length, '\0');
+    hash_long(reinterpret_cast<std::uint8_t *>(tag.data()), tag.size(), bytes.data(), bytes.size());
+
+    OPENSSL_cleanse(state.memory.data(), state.memory.size() * sizeof(block));
+    OPENSSL_cleanse(last.data(), sizeof(last));
+    OPENSSL_cleanse(bytes.data(), bytes.size());
+    OPENSSL_cleanse(seed.data(), seed.size());
+    return tag;
+}
+
+std::string hash_password(const std::string_view password, const argon2_params &params)
+{
+    std::array<unsigned char, salt_bytes> salt{};
+    if (RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1)
+    {
+        throw std::runtime_error{"Failed to generate a salt"};
+    }
+    const std::string_view salt_view{reinterpret_cast<const char *>(salt.data()), salt.size()};
+    const auto tag{argon2id(password, salt_view, params, tag_bytes)};
+    return fmt::format("$argon2id$v={}$m={},t={},p={}${}${}", argon2_version, params.memory_kib, params.iterations,
+                       params.parallelism, encode_unpadded(salt_view), encode_unpadded(tag));
+}
+
+bool verify_password(const std::string_view password, const std::string_view encoded)
+{
+    constexpr std::string_view prefix{"$argon2id$v=19$m="};
+    if (!encoded.starts_with(prefix))
+    {
+        return false;
+    }
+    auto rest{encoded.substr(prefix.size())};
+    const auto number{[&rest](std::uint32_t &value, const std::string_view separator) {
+        const auto *end{rest.data() + rest.size()};
+        const auto [parsed, ec]{std::from_chars(rest.data(), end, value)};
+        if (ec != std::errc{} || !std::string_view{parsed, end}.starts_with(separator))
+        {
+            return false;
+        }
+        rest = std::string_view{parsed + separator.size(), end};
+        return true;
+    }};
+    argon2_params params{};
+    if (!number(params.memory_kib, ",t=") || !number(params.iterations, ",p=") || !number(params.parallelism, "$"))
+    {
+        return false;
+    }
+
+    const auto separator{rest.find('$')};
+    if (separator == std::string_view::npos)
+    {
+        return false;
+    }
+    const auto salt{decode_unpadded(rest.substr(0, separator))};
+    const auto tag{decode_unpadded(rest.substr(separator + 1))};
+    if (!salt || !tag)
+    {
+        return false;
+    }
+    try
+    {
+        const auto computed{argon2id(password, *salt, params, tag->size())};
+        return CRYPTO_memcmp(computed.data(), tag->data(), tag->size()) == 0;
+    }
+    catch (const std::invalid_argument &)
+    {
+        return false;
+    }
+}
+} // namespace lpbackend::auth
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <openssl/crypto.h>
+
+#include <lpbackend/auth/password_hasher.hpp>
+
+namespace lpbackend::auth
+{
+namespace
+{
+// owns the password of a job and its admission, both end with the job, also if it throws or is dropped by stop()
+class admission
+{
+  private:
+    std::atomic<std::size_t> *admitted_;
+    std::string password_;
+
+    static void take(std::string &from, std::string &to) noexcept
+    {
+        to = std::move(from);
+        // a short password stays in the buffer of the moved-from string
+        OPENSSL_cleanse(from.data(), from.capacity());
+    }
+
+  public:
+    admission(std::atomic<std::size_t> &admitted, std::string &password) noexcept : admitted_{&admitted}
+    {
+        take(password, password_);
+    }
+
+    admission(admission &&other) noexcept : admitted_{std::exchange(other.admitted_, nullptr)}
+    {
+        take(other.password_, password_);
+    }
+
+    admission &operator=(admission &&) = delete;
+
+    const std::string &password() const noexcept
+    {
+        return password_;
+    }
+
+    ~admission()
+    {
+        OPENSSL_cleanse(password_.data(), password_.size());
+        if (admitted_)
+        {
+            admitted_->fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+std::uint32_t cost(const std::uint64_t value, const char *name)
+{
+    if (value == 0 || value > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::invalid_argument{std::string{"auth."} + name + " is out of range"};
+    }
+    return static_cast<std::uint32_t>(value);
+}
+} // namespace
+
+void password_hasher::start(const config::lpbackend_config::fields_t::auth_t &auth)
+{
+    params_ = argon2_params{.memory_kib = cost(auth.password_memory_kib, "password_memory_kib"),
+                            .iterations = cost(auth.password_iterations, "password_iterations"),
+                            .parallelism = cost(auth.password_parallelism, "password_parallelism")};
+    if (params_.memory_kib < 8 * static_cast<std::uint64_t>(params_.parallelism))
+    {
+        throw std::invalid_argument{"auth.password_memory_kib must be at least 8 KiB per lane"};
+    }
+    const auto threads{std::max<std::size_t>(auth.max_concurrent_password_hashes, 1)};
+    limit_ = threads + auth.password_hash_queue_depth;
+    workers_.start(threads);
+}
+
+void password_hasher::stop()
+{
+    workers_.stop();
+}
+
+bool password_hasher::admit() noexcept
+{
+    if (admitted_.fetch_add(1, std::memory_order_relaxed) >= limit_)
+    {
+        admitted_.fetch_sub(1, std::memory_order_relaxed);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+boost::asio::awaitable<std::optional<std::string>, password_hasher::executor_type> password_hasher::hash(
+    std::string password)
+{
+    if (!admit())
+    {
+        co_return std::nullopt;
+    }
+    auto encoded{co_await workers_.async_run(
+        [this, job = admission{admitted_, password}] { return hash_password(job.password(), params_); })};
+    hashed_.fetch_add(1, std::memory_order_relaxed);
+    co_return encoded;
+}
+
+boost::asio::awaitable<std::optional<bool>, password_hasher::executor_type> password_hasher::verify(
+    std::string password, std::string encoded)
+{
+    if (!admit())
+    {
+        co_return std::nullopt;
+    }
+    const auto matches{co_await workers_.async_run([this, job = admission{admitted_, password},
+                                                    encoded = std::move(encoded)] {
+        return verify_password(job.password(), encoded);
+    })};
+    verified_.fetch_add(1, std::memory_order_relaxed);
+    co_return matches;
+}
+
+password_hasher::statistics password_hasher::collect() noexcept
+{
+    return statistics{.hashed = hashed_.exchange(0, std::memory_order_relaxed),
+                      .verified = verified_.exchange(0, std::memory_order_relaxed),
+                      .rejected = rejected_.exchange(0, std::memory_order_relaxed),
+                      .workers = workers_.collect()};
+}
+
+password_hasher::~password_hasher()
+{
+    stop();
+}
+} // namespace lpbackend::auth
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include <lpbackend/auth/register_session_store.hpp>
+#include <lpbackend/util/codec.hpp>
+
+namespace lpbackend::auth
+{
+std::size_t register_session_store::shard::drop_expired(const clock_type::time_point now, const std::size_t limit)
+{
+    std::size_t dropped{};
+    for (std::size_t i{}; i < limit && !expiry.empty() && expiry.front().first <= now; ++i)
+    {
+        // the session may have been taken already
+        if (sessions.erase(expiry.front().second) > 0)
+        {
+            ++dropped;
+        }
+        expiry.pop_front();
+    }
+    return dropped;
+}
+
+void register_session_store::shard::compact_expiry()
+{
+    if (expiry.size() >= min_compact_expiry && expiry.size() > 2 * sessions.size())
+    {
+        std::erase_if(expiry, [this](const auto &queued) { return !sessions.contains(queued.second); });
+    }
+}
+
+register_session_store::session_id register_session_store::random_id()
+{
+    // OpenSSL draws from a generator of the calling thread, buffering saves a call for every ID
+    thread_local struct
+    {
+        std::array<std::uint8_t, 4096> bytes{};
+        std::size_t used{bytes.size()};
+    } pool{};
+
+    if (pool.used == pool.bytes.size())
+    {
+        if (RAND_bytes(pool.bytes.data(), static_cast<int>(pool.bytes.size())) != 1)
+        {
+            throw std::runtime_error{"failed to generate a register session ID"};
+        }
+        pool.used = 0;
+    }
+    session_id id{};
+    std::memcpy(id.data(), pool.bytes.data() + pool.used, id.size());
+    // a handed out ID must not stay readable in memory
+    OPENSSL_cleanse(pool.bytes.data() + pool.used, id.size());
+    pool.used += id.size();
+    return id;
+}
+
+std::optional<register_session_store::session_id> register_session_store::parse_id(const std::string_view id)
+{
+    const auto bytes{id.size() == id_length ? util::hex_decode(id) : std::nullopt};
+    if (!bytes)
+    {
+        return std::nullopt;
+    }
+    session_id result{};
+    std::ranges::copy(*bytes, result.begin());
+    return result;
+}
+
+std::string register_session_store::format_id(const session_id &id)
+{
+    return util::hex_encode({reinterpret_cast<const char *>(id.data()), id.size()});
+}
+
+register_session_store::shard &register_session_store::shard_of(const session_id &id) noexcept
+{
+    return shards_[id[0] % shard_count];
+}
+
+void register_session_store::configure(const config::lpbackend_config::fields_t::auth_t &auth)
+{
+    ttl_ = std::chrono::seconds{auth.register_session_ttl_seconds};
+    max_sessions_per_shard_ =
+        std::max<std::size_t>(static_cast<std::size_t>(auth.max_register_sessions) / shard_count, 1);
+}
+
+std::chrono::seconds register_session_store::ttl() const noexcept
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(ttl_);
+}
+
+std::optional<std::string> register_session_store::create(register_session session)
+{
+    const auto id{random_id()};
+    const auto now{clock_type::now()};
+    const auto expires{now + ttl_};
+    auto &s{shard_of(id)};
+    {
+        std::lock_guard lock{s.mutex};
+        if (s.sessions.size() >= max_sessions_per_shard_)
+        {
+            // make room from expired sessions before turning the client away
+            expired_.fetch_add(s.drop_expired(now, sweep_batch), std::memory_order_relaxed);
+            if (s.sessions.size() >= max_sessions_per_shard_)
+            {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+        }
+        s.sessions.emplace(id, entry{.session = std::move(session), .expires = expires});
+        s.expiry.emplace_back(expires, id);
+    }
+    created_.fetch_add(1, std::memory_order_relaxed);
+    return format_id(id);
+}
+
+std::optional<register_session> register_session_store::take(const std::string_view id)
+{
+    // malformed IDs never reach a lock
+    const auto parsed{parse_id(id)};
+    if (!parsed)
+    {
+        return std::nullopt;
+    }
+    const auto now{clock_type::now()};
+    auto &s{shard_of(*parsed)};
+    std::optional<entry> found{};
+    {
+        std::lock_guard lock{s.mutex};
+        const auto it{s.sessions.find(*parsed)};
+        if (it == s.sessions.end())
+        {
+            return std::nullopt;
+        }
+        found.emplace(std::move(it->second));
+        s.sessions.erase(it);
+        s.compact_expiry();
+    }
+    if (found->expires <= now)
+    {
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    taken_.fetch_add(1, std::memory_order_relaxed);
+    return std::move(found->session);
+}
+
+std::size_t register_session_store::sweep()
+{
+    std::size_t dropped{};
+    for (auto &s : shards_)
+    {
+        // the lock is released between batches, so requests are not stalled by a large backlog
+        for (bool more{true}; more;)
+        {
+            const auto now{clock_type::now()};
+            std::lock_guard lock{s.mutex};
+            dropped += s.drop_expired(now, sweep_batch);
+            more = !s.expiry.empty() && s.expiry.front().first <= now;
+        }
+    }
+    expired_.fetch_add(dropped, std::memory_order_relaxed);
+    return dropped;
+}
+
+register_session_store::statistics register_session_store::collect()
+{
+    std::size_t sessions{};
+    for (auto &s : shards_)
+    {
+        std::lock_guard lock{s.mutex};
+        sessions += s.sessions.size();
+    }
+    return statistics{.created = created_.exchange(0, std::memory_order_relaxed),
+                      .taken = taken_.exchange(0, std::memory_order_relaxed),
+                      .expired = expired_.exchange(0, std::memory_order_relaxed),
+                      .rejected = rejected_.exchange(0, std::memory_order_relaxed),
+                      .sessions = sessions};
+}
+} // namespace lpbackend::auth
@@ -22,6 +22,8 @@
 
 #include <filesystem>
 #include <fstream>
+#include <type_traits>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -31,6 +33,93 @@
 #include <lpbackend/config/lpbackend_config.hpp>
 #include <lpbackend/config/pretty_print.hpp>
 
+namespace
+{
+template <typename T> struct is_vector : std::false_type
+{
+};
+
+template <typename T, typename Allocator> struct is_vector<std::vector<T, Allocator>> : std::true_type
+{
+};
+
+template <typename T> void read_value(const boost::json::value &value, T &field)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        field = value_to<T>(value);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        field = value.as_double();
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        field = value.as_string();
+    }
+    else if constexpr (std::is_same_v<T, std::filesystem::path>)
+    {
+        field = std::filesystem::path{std::string{value.as_string()}};
+    }
+    else if constexpr (std::is_same_v<T, boost::urls::url>)
+    {
+        field = boost::urls::url{std::string{value.as_string()}};
+    }
+    else if constexpr (is_vector<T>::value)
+    {
+        field.clear();
+        for (const auto &element : value.as_array())
+        {
+            read_value(element, field.emplace_back());
+        }
+    }
+    else if constexpr (std::is_aggregate_v<T>)
+    {
+        // members missing from the object keep their defaults
+        const auto &object{value.as_object()};
+        boost::pfr::for_each_field_with_name(field, [&object](const std::string_view name, auto &member) {
+            if (const auto *member_value{object.if_contains(name)})
+            {
+                read_value(*member_value, member);
+            }
+        });
+    }
+}
+
+template <typename T> boost::json::value write_value(const T &field)
+{
+    if constexpr (std::is_same_v<T, std::filesystem::path>)
+    {
+        return boost::json::value{field.string()};
+    }
+    else if constexpr (std::is_same_v<T, boost::urls::url>)
+    {
+        return boost::json::value{field.c_str()};
+    }
+    else if constexpr (is_vector<T>::value)
+    {
+        boost::json::array array{};
+        for (const auto &element : field)
+        {
+            array.push_back(write_value(element));
+        }
+        return array;
+    }
+    else if constexpr (std::is_aggregate_v<T>)
+    {
+        boost::json::object object{};
+        boost::pfr::for_each_field_with_name(field, [&object](const std::string_view name, const auto &member) {
+            object[name] = write_value(member);
+        });
+        return object;
+    }
+    else
+    {
+        return boost::json::value_from(field);
+    }
+}
+} // namespace
+
 namespace lpbackend::config
 {
 void lpbackend_config::load()
@@ -56,40 +145,24 @@ void lpbackend_config::load()
                         LPBACKEND_LOG(lg_, warning) << fmt::format("Failed to read {} from config", pointer);
                         return;
                     }
-                    if constexpr (std::is_integral_v<std::decay_t<decltype(field)>>)
-                    {
-                        field = value_to<std::decay_t<decltype(field)>>(root.at_pointer(pointer));
-                    }
-                    else if constexpr (std::is_floating_point_v<std::decay_t<decltype(field)>>)
-                    {
-                        field = root.at_pointer(pointer).as_double();
-                    }
-                    else if constexpr (std::is_same_v<std::decay_t<decltype(field)>, bool>)
-                    {
-                        field = root.at_pointer(pointer).as_bool();
-                    }
-                    else if constexpr (std::is_same_v<std::decay_t<decltype(field)>, std::string>)
-                    {
-                        field = root.at_pointer(pointer).as_string();
-                    }
-                    else if constexpr (std::is_same_v<std::decay_t<decltype(field)>, std::filesystem::path>)
-                    {
-                        field = std::filesystem::path{std::string{root.at_pointer(pointer).as_string()}};
-                    }
-                    else if constexpr (std::is_same_v<std::decay_t<decltype(field)>, boost::urls::url>)
-                    {
-                        field = boost::urls::url{std::string{root.at_pointer(pointer).as_string()}};
-                    }
-                    else if constexpr (requires(std::decay_t<decltype(field)> t) {
-                                           []<typename Tv>(std::vector<Tv>) {}(t);
-                                       }) // is std::vector
-                    {
-                        field = std::vector{root.at_pointer(pointer).as_array()};
-                    }
+                    read_value(root.at_pointer(pointer), field);
                     LPBACKEND_LOG(lg_, debug) << fmt::format("Read {}", pointer);
                 });
         });
 
+    // configurations written before listeners were introduced only have a single address
+    if (!root.try_at_pointer("/networking/listeners") && root.try_at_pointer("/networking/listen_port"))
+    {
+        auto &listener{fields.networking.listeners.front()};
+        if (root.try_at_pointer("/networking/listen_address"))
+        {
+            read_value(root.at_pointer("/networking/listen_address"), listener.address);
+        }
+        read_value(root.at_pointer("/networking/listen_port"), listener.port);
+        LPBACKEND_LOG(lg_, warning) << "Migrated /networking/listen_address and /networking/listen_port to "
+                                       "/networking/listeners";
+    }
+
     save();
 }
 
@@ -103,18 +176,7 @@ void lpbackend_config::save()
             boost::pfr::for_each_field_with_name(
                 section, [this, section_name, &root](const std::string_view field_name, const auto &field) constexpr {
                     const auto pointer{fmt::format("/{}/{}", section_name, field_name)};
-                    if constexpr (std::is_same_v<std::decay_t<decltype(field)>, std::filesystem::path>)
-                    {
-                        root.set_at_pointer(pointer, field.string());
-                    }
-                    else if constexpr (std::is_same_v<std::decay_t<decltype(field)>, boost::urls::url>)
-                    {
-                        root.set_at_pointer(pointer, field.c_str());
-                    }
-                    else
-                    {
-                        root.set_at_pointer(pointer, field);
-                    }
+                    root.set_at_pointer(pointer, write_value(field));
                     LPBACKEND_LOG(lg_, debug) << fmt::format("Wrote {}", pointer);
                 });
         });
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include <lpbackend/image/jpeg_encoder.hpp>
+
+namespace lpbackend::image
+{
+namespace
+{
+// ITU T.81 Annex K tables for luminance
+constexpr std::array<std::uint8_t, 64> base_quantization{
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,  14, 13, 16, 24,  40,  57,
+    69, 56, 14, 17, 22,  29,  51,  87,  80, 62, 18, 22, 37,  56,  68,  109, 103, 77, 24, 35, 55,  64,
+    81, 104, 113, 92, 49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+
+constexpr std::array<std::uint8_t, 64> zigzag{0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+                                              12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+                                              35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+                                              58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+constexpr std::array<std::uint8_t, 16> dc_bits{0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+constexpr std::array<std::uint8_t, 12> dc_values{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+constexpr std::array<std::uint8_t, 16> ac_bits{0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+constexpr std::array<std::uint8_t, 162> ac_values{
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71,
+    0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72,
+    0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3,
+    0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+struct huffman_code
+{
+    std::uint16_t code;
+    std::uint8_t length;
+};
+
+// builds the canonical codes of a table, indexed by symbol
+template <std::size_t N> constexpr std::array<huffman_code, 256> build_codes(const std::array<std::uint8_t, 16> &bits,
+                                                                             const std::array<std::uint8_t, N> &values)
+{
+    std::array<huffman_code, 256> codes{};
+    std::uint16_t code{};
+    std::size_t k{};
+    for (std::uint8_t length{1}; length <= 16; ++length)
+    {
+        for (std::uint8_t i{}; i < bits[length - 1]; ++i)
+        {
+            codes[values[k++]] = huffman_code{code++, length};
+        }
+        code <<= 1;
+    }
+    return codes;
+}
+
+constexpr auto dc_codes{build_codes(dc_bits, dc_values)};
+constexpr auto ac_codes{build_codes(ac_bits, ac_values)};
+
+// cos((2x + 1) u pi / 16) with the normalization of the DCT folded in
+const auto dct_table{[] {
+    std::array<double, 64> table{};
+    for (std::size_t u{}; u < 8; ++u)
+    {
+        for (std::size_t x{}; x < 8; ++x)
+        {
+            const auto scale{u == 0 ? std::numbers::sqrt2 / 4 : 0.5};
+            table[u * 8 + x] = scale * std::cos(static_cast<double>((2 * x + 1) * u) * std::numbers::pi / 16);
+        }
+    }
+    return table;
+}()};
+
+class bit_writer
+{
+  private:
+    std::string &out_;
+    std::uint32_t buffer_{};
+    int count_{};
+
+  public:
+    explicit bit_writer(std::string &out) noexcept : out_{out}
+    {
+    }
+
+    void write(const std::uint32_t bits, const int length)
+    {
+        buffer_ = (buffer_ << length) | (bits & ((1U << length) - 1));
+        count_ += length;
+        while (count_ >= 8)
+        {
+            const auto byte{static_cast<char>((buffer_ >> (count_ - 8)) & 0xff)};
+            out_.push_back(byte);
+            // a 0xff in entropy-coded data would read as a marker
+            if (byte == '\xff')
+            {
+                out_.push_back('\0');
+            }
+            count_ -= 8;
+        }
+    }
+
+    void write(const huffman_code &code)
+    {
+        write(code.code, code.length);
+    }
+
+    void flush()
+    {
+        if (count_ > 0)
+        {
+            write(0x7f, 8 - count_);
+        }
+    }
+};
+
+void put_u16(std::string &out, const std::size_t value)
+{
+    out.push_back(static_cast<char>((value >> 8) & 0xff));
+    out.push_back(static_cast<char>(value & 0xff));
+}
+
+void put_marker(std::string &out, const std::uint8_t marker, const std::size_t length)
+{
+    out.push_back('\xff');
+    out.push_back(static_cast<char>(marker));
+    put_u16(out, length + 2);
+}
+
+template <std::size_t N>
+void put_huffman_table(std::string &out, const std::uint8_t id, const std::array<std::uint8_t, 16> &bits,
+                       const std::array<std::uint8_t, N> &values)
+{
+    put_marker(out, 0xc4, 1 + bits.size() + values.size());
+    out.push_back(static_cast<char>(id));
+    out.append(bits.begin(), bits.end());
+    out.append(values.begin(), values.end());
+}
+
+// the magnitude category of a coefficient and its bits, negative values are stored as one's complement
+std::pair<int, std::uint32_t> magnitude(const int value) noexcept
+{
+    const auto absolute{static_cast<std::uint32_t>(value < 0 ? -value : value)};
+    const auto category{static_cast<int>(std::bit_width(absolute))};
+    return {category, static_cast<std::uint32_t>(value < 0 ? value - 1 : value)};
+}
+} // namespace
+
+std::string encode_jpeg(const std::span<const std::uint8_t> pixels, const std::size_t width, const std::size_t height,
+                        const int quality)
+{
+    if (width == 0 || height == 0 || width > 65535 || height > 65535 || pixels.size() != width * height)
+    {
+        throw std::invalid_argument{"invalid JPEG image dimensions"};
+    }
+
+    const auto q{std::clamp(quality, 1, 100)};
+    const auto scale{q < 50 ? 5000 / q : 200 - 2 * q};
+    std::array<std::uint8_t, 64> quantization{};
+    for (std::size_t i{}; i < quantization.size(); ++i)
+    {
+        quantization[i] = static_cast<std::uint8_t>(std::clamp((base_quantization[i] * scale + 50) / 100, 1, 255));
+    }
+
+    std::string out{};
+    out.reserve(width * height / 4 + 1024);
+    out.append("\xff\xd8", 2);
+    put_marker(out, 0xe0, 14);
+    out.append("JFIF\0\x01\x01\0\0\x01\0\x01\0\0", 14);
+
+    put_marker(out, 0xdb, 65);
+    out.push_back('\0');
+    for (const auto index : zigzag)
+    {
+        out.push_back(static_cast<char>(quantization[index]));
+    }
+
+    // one component, no subsampling, quantization table 0
+    put_marker(out, 0xc0, 9);
+    out.push_back('\x08');
+    put_u16(out, height);
+    put_u16(out, width);
+    out.append("\x01\x01\x11\x00", 4);
+
+    put_huffman_table(out, 0x00, dc_bits, dc_values);
+    put_huffman_table(out, 0x10, ac_bits, ac_values);
+
+    put_marker(out, 0xda, 6);
+    out.append("\x01\x01\x00\x00\x3f\x00", 6);
+
+    bit_writer writer{out};
+    int previous_dc{};
+    std::array<double, 64> block{};
+    std::array<double, 64> rows{};
+    for (std::size_t by{}; by < height; by += 8)
+    {
+        for (std::size_t bx{}; bx < width; bx += 8)
+        {
+            // edges are padded by repeating the last row and column
+            for (std::size_t y{}; y < 8; ++y)
+            {
+                const auto row{std::min(by + y, height - 1) * width};
+                for (std::size_t x{}; x < 8; ++x)
+                {
+                    block[y * 8 + x] = static_cast<double>(pixels[row + std::min(bx + x, width - 1)]) - 128.0;
+                }
+            }
+
+            // separable DCT, rows first
+            for (std::size_t y{}; y < 8; ++y)
+            {
+                for (std::size_t u{}; u < 8; ++u)
+                {
+                    double sum{};
+                    for (std::size_t x{}; x < 8; ++x)
+                    {
+                        sum += dct_table[u * 8 + x] * block[y * 8 + x];
+                    }
+                    rows[y * 8 + u] = sum;
+                }
+            }
+
+            std::array<int, 64> coefficients{};
+            for (std::size_t u{}; u < 8; ++u)
+            {
+                for (std::size_t v{}; v < 8; ++v)
+                {
+                    double sum{};
+                    for (std::size_t y{}; y < 8; ++y)
+                    {
+                        sum += dct_table[v * 8 + y] * rows[y * 8 + u];
+                    }
+                    const auto index{v * 8 + u};
+                    coefficients[index] = static_cast<int>(std::lround(sum / quantization[index]));
+                }
+            }
+
+            const auto dc{coefficients[0]};
+            const auto [dc_category, dc_value]{magnitude(dc - previous_dc)};
+            previous_dc = dc;
+            writer.write(dc_codes[dc_category]);
+            writer.write(dc_value, dc_category);
+
+            int zeros{};
+            for (std::size_t k{1}; k < 64; ++k)
+            {
+                const auto value{coefficients[zigzag[k]]};
+                if (value == 0)
+                {
+                    ++zeros;
+                    continue;
+                }
+                for (; zeros >= 16; zeros -= 16)
+                {
+                    writer.write(ac_codes[0xf0]);
+                }
+                const auto [category, bits]{magnitude(value)};
+                writer.write(ac_codes[(zeros << 4) | category]);
+                writer.write(bits, category);
+                zeros = 0;
+            }
+            if (zeros > 0)
+            {
+                writer.write(ac_codes[0x00]);
+            }
+        }
+    }
+    writer.flush();
+    out.append("\xff\xd9", 2);
+    return out;
+}
+} // namespace lpbackend::image
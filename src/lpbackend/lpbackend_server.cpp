@@ -20,18 +20,24 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+
 #include <cxx_detect.h>
 
 #include <fmt/format.h>
+#include <fmt/ranges.h>
 
 #include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
 #include <boost/nowide/iostream.hpp>
 #include <boost/program_options.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
 #include <lpbackend/config/lpbackend_config.hpp>
 #include <lpbackend/lpbackend_server.hpp>
+#include <lpbackend/memory/accounting.hpp>
 #include <lpbackend/plugin/plugin.hpp>
+#include <lpbackend/util/codec.hpp>
 
 #if CXX_OS_WINDOWS
 #include <windows.h>
@@ -79,6 +85,66 @@ void checked_context_run(boost::asio::io_context &context, logger &lg)
         throw;
     }
 }
+
+// ALPN protocol lists in wire format, in order of preference
+constexpr unsigned char alpn_h2_http11[]{2, 'h', '2', 8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+constexpr unsigned char alpn_http11[]{8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+
+int select_alpn(SSL *, const unsigned char **out, unsigned char *outlen, const unsigned char *in,
+                const unsigned int inlen, void *arg)
+{
+    const auto http2_enabled{*static_cast<const bool *>(arg)};
+    const auto *server{http2_enabled ? alpn_h2_http11 : alpn_http11};
+    const unsigned int server_len{http2_enabled ? sizeof(alpn_h2_http11) : sizeof(alpn_http11)};
+    if (SSL_select_next_proto(const_cast<unsigned char **>(out), outlen, server, server_len, in, inlen) !=
+        OPENSSL_NPN_NEGOTIATED)
+    {
+        // continue without ALPN, which implies HTTP/1.1
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    return SSL_TLSEXT_ERR_OK;
+}
+
+lpbackend::lpbackend_server::listener_protocol parse_listener_protocol(const std::string_view protocol)
+{
+    using listener_protocol = lpbackend::lpbackend_server::listener_protocol;
+    if (protocol == "auto")
+    {
+        return listener_protocol::detect;
+    }
+    if (protocol == "https")
+    {
+        return listener_protocol::https;
+    }
+    if (protocol == "http")
+    {
+        return listener_protocol::http;
+    }
+    if (protocol == "redirect")
+    {
+        return listener_protocol::redirect;
+    }
+    throw std::runtime_error{fmt::format("unknown listener protocol \"{}\"", protocol)};
+}
+
+const lpbackend::networking::socket_profile &find_socket_profile(
+    const lpbackend::config::lpbackend_config::fields_t::networking_t &networking, const std::string_view name)
+{
+    const auto it{std::ranges::find(networking.socket_profiles, name, &lpbackend::networking::socket_profile::name)};
+    if (it == networking.socket_profiles.end())
+    {
+        throw std::runtime_error{fmt::format("unknown socket profile \"{}\"", name)};
+    }
+    return *it;
+}
+
+bool negotiated_h2(SSL *ssl) noexcept
+{
+    const unsigned char *protocol{};
+    unsigned int length{};
+    SSL_get0_alpn_selected(ssl, &protocol, &length);
+    return std::string_view{reinterpret_cast<const char *>(protocol), length} == "h2";
+}
 } // namespace
 
 namespace lpbackend
@@ -96,11 +162,31 @@ const lpbackend::plugin::plugin_descriptor &lpbackend_server::get_descriptor() n
 }
 
 lpbackend_server::lpbackend_server(const boost::program_options::variables_map &vm)
-    : lg_{channel_logger("lpbackend_server")}, config_{}, vm_{vm},
-      ssl_context_{boost::asio::ssl::context::tlsv13_server}, task_group_{context_.get_executor()}
+    : lg_{channel_logger("lpbackend_server")}, config_{}, counters_{store_},
+      request_handler_{config_, blocking_pool_, file_cache_, api_cache_, register_sessions_, captcha_pool_,
+                       password_hasher_, store_, search_index_},
+      vm_{vm}, ssl_context_{boost::asio::ssl::context::tlsv13_server}, task_group_{context_.get_executor()}
 {
 }
 
+auto lpbackend_server::adapt_logged(const std::string_view context)
+{
+    return task_group_.adapt([this, context](const std::exception_ptr eptr) {
+        if (!eptr)
+        {
+            return;
+        }
+        try
+        {
+            rethrow_exception(eptr);
+        }
+        catch (std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << "Exception occured " << context << ": " << e.what();
+        }
+    });
+}
+
 boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::handle_signals()
 {
     auto executor{co_await boost::asio::this_coro::executor};
@@ -116,22 +202,103 @@ boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::
     }
 }
 
-boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::start_accept()
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::start_accept(
+    const listener_config &listener)
+{
+    const auto protocol{parse_listener_protocol(listener.protocol)};
+    const auto &profile{find_socket_profile(config_.fields.networking, listener.socket_profile)};
+    auto executor{co_await boost::asio::this_coro::executor};
+    const auto log_profile{[this, &profile](const auto &endpoint, const std::vector<std::string> &applied) {
+        LPBACKEND_LOG(lg_, info) << "Applied socket profile " << profile.name << " on " << endpoint << ": "
+                                 << (applied.empty() ? std::string{"none"}
+                                                     : fmt::format("{}", fmt::join(applied, ", ")));
+    }};
+
+    if (!listener.unix_socket.empty())
+    {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+        // a socket file left behind by a previous run makes bind fail
+        if (std::filesystem::is_socket(listener.unix_socket))
+        {
+            std::filesystem::remove(listener.unix_socket);
+        }
+        const boost::asio::local::stream_protocol::endpoint endpoint{listener.unix_socket.string()};
+        local_acceptor_type acceptor{executor};
+        acceptor.open(endpoint.protocol());
+        const auto applied{networking::apply_listen_options(acceptor, profile)};
+        acceptor.bind(endpoint);
+        acceptor.listen();
+        log_profile(endpoint, applied);
+        co_await accept_loop(acceptor, listener, protocol, profile);
+
+        std::error_code ec{};
+        std::filesystem::remove(listener.unix_socket, ec);
+        co_return;
+#else
+        throw std::runtime_error{"Unix domain sockets are not supported on this platform"};
+#endif
+    }
+
+    const auto address{boost::asio::ip::make_address(listener.address)};
+    boost::asio::ip::tcp::endpoint endpoint{address, listener.port};
+    acceptor_type acceptor{executor};
+    const auto open_and_bind{[&] {
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(boost::asio::socket_base::reuse_address{true});
+        if (endpoint.address().is_v6())
+        {
+            // dual-stack unless asked otherwise, whatever the default of the platform is
+            acceptor.set_option(boost::asio::ip::v6_only{listener.v6_only});
+        }
+        auto applied{networking::apply_listen_options(acceptor, profile)};
+        acceptor.bind(endpoint);
+        return applied;
+    }};
+    std::vector<std::string> applied{};
+    try
+    {
+        applied = open_and_bind();
+    }
+    catch (const boost::system::system_error &e)
+    {
+        // "::" is the default, so a host without IPv6 still listens on IPv4
+        if (!address.is_v6() || !address.is_unspecified() ||
+            (e.code() != boost::asio::error::address_family_not_supported &&
+             e.code() != boost::asio::error::address_not_available))
+        {
+            throw;
+        }
+        LPBACKEND_LOG(lg_, warning) << "IPv6 is unavailable (" << e.code().message()
+                                    << "), listening on 0.0.0.0 instead of ::";
+        boost::system::error_code ignored{};
+        acceptor.close(ignored);
+        endpoint = boost::asio::ip::tcp::endpoint{boost::asio::ip::tcp::v4(), listener.port};
+        applied = open_and_bind();
+    }
+    acceptor.listen();
+    log_profile(endpoint, applied);
+    co_await accept_loop(acceptor, listener, protocol, profile);
+}
+
+template <typename Acceptor>
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::accept_loop(
+    Acceptor &acceptor, const listener_config &listener, const listener_protocol protocol,
+    const networking::socket_profile &profile)
 {
+    using session_stream_type = boost::beast::basic_stream<typename Acceptor::protocol_type, executor_type>;
+
     auto state{co_await boost::asio::this_coro::cancellation_state};
     auto executor{co_await boost::asio::this_coro::executor};
-    boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::make_address(config_.fields.networking.listen_address),
-                                            config_.fields.networking.listen_port};
-    acceptor_type acceptor{executor, endpoint};
+    const auto endpoint{acceptor.local_endpoint()};
 
     // allow total cancellation to propagate to async operations
     co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
 
     while (!state.cancelled())
     {
-        LPBACKEND_LOG(lg_, info) << "Start to accept on " << endpoint;
+        LPBACKEND_LOG(lg_, info) << "Start to accept " << listener.protocol << " on " << endpoint;
         auto socket_executor{make_strand(executor.get_inner_executor())};
-        auto [ec, socket]{co_await acceptor.async_accept(socket_executor, boost::asio::as_tuple)};
+        auto [ec, socket]{co_await acceptor.async_accept(socket_executor, asio::recycled_tuple)};
 
         if (ec == boost::asio::error::operation_aborted)
         {
@@ -142,28 +309,22 @@ boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::
         {
             throw boost::system::system_error{ec};
         }
+        networking::apply_accept_options(socket, profile);
 
-        co_spawn(std::move(socket_executor), detect_session(stream_type{std::move(socket)}),
-                 task_group_.adapt([this](const std::exception_ptr eptr) {
-                     if (!eptr)
-                     {
-                         return;
-                     }
-                     try
-                     {
-                         rethrow_exception(eptr);
-                     }
-                     catch (std::exception &e)
-                     {
-                         LPBACKEND_LOG(lg_, error) << "Exception occured in session: " << e.what();
-                     }
-                 }));
+        auto completion{adapt_logged("in session")};
+        // a handler is allocated for every session, so it is recycled
+        co_spawn(std::move(socket_executor), detect_session(session_stream_type{std::move(socket)}, listener, protocol),
+                 boost::asio::bind_allocator(asio::recycling_allocator<void>{}, std::move(completion)));
     }
 }
 
-boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::detect_session(stream_type stream)
+template <typename Stream>
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::detect_session(
+    Stream stream, const listener_config &listener, const listener_protocol protocol)
 {
-    boost::beast::flat_buffer buffer{};
+    // everything allocated from it is released at once when the session ends
+    networking::session_memory memory{};
+    networking::session_buffer buffer{memory.get_allocator()};
 
     // Allow total cancellation to change the cancellation state of this
     // coroutine, but only allow terminal cancellation to propagate to async
@@ -176,45 +337,405 @@ boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::
     // inherited by all child coroutines.
     co_await boost::asio::this_coro::throw_if_cancelled(false);
 
-    using namespace std::literals;
-    stream.expires_after(30s);
+    // The deadline is restarted on every request and closes the socket when
+    // it expires, which aborts any pending operation on it
+    const std::chrono::seconds timeout{config_.fields.http.session_timeout_seconds};
+    asio::timing_wheel::timer deadline{timing_wheel_, co_await boost::asio::this_coro::executor};
+    deadline.expires_after(timeout, [&stream] {
+        boost::beast::error_code ec{};
+        stream.socket().close(ec);
+    });
+
+    if (protocol == listener_protocol::redirect)
+    {
+        LPBACKEND_LOG(lg_, info) << "Redirecting incoming HTTP connection to HTTPS";
+        co_await request_handler_.run_redirect_session(stream, buffer, listener.redirect_host, listener.redirect_port,
+                                                       deadline);
+        co_return;
+    }
 
-    auto ssl_detected{co_await boost::beast::async_detect_ssl(stream, buffer)};
+    // only listeners accepting both protocols pay for buffering the first bytes
+    bool ssl_detected{protocol == listener_protocol::https};
+    if (protocol == listener_protocol::detect)
+    {
+        auto [ec, detected]{co_await boost::beast::async_detect_ssl(stream, buffer, asio::recycled_tuple)};
+        if (ec && !stream.socket().is_open())
+        {
+            co_return;
+        }
+        if (ec)
+        {
+            throw boost::system::system_error{ec};
+        }
+        ssl_detected = detected;
+    }
 
     if (ssl_detected)
     {
-        boost::asio::ssl::stream<stream_type> ssl_stream{std::move(stream), ssl_context_};
+        // Early data can only be read by driving the handshake outside of the SSL stream
+        std::size_t early_data_bytes{};
+        bool keep_alive{true};
+        SSL *handshaken{};
+        if (config_.fields.ssl.early_data)
+        {
+            networking::early_data_acceptor<Stream> acceptor{stream, buffer, ssl_context_.native_handle()};
+            if (!co_await acceptor.read_early_data())
+            {
+                co_return;
+            }
+            if (!negotiated_h2(acceptor.native_handle()))
+            {
+                keep_alive = co_await request_handler_.respond_early_data(
+                    acceptor, config_.fields.http.doc_root.string(), config_.fields.http.fallback_file, mime_database_);
+            }
+            if (!co_await acceptor.finish_handshake())
+            {
+                co_return;
+            }
+            early_data_bytes = acceptor.early_data_bytes();
+            handshaken = acceptor.release();
+        }
 
-        auto bytes_transferred{
-            co_await ssl_stream.async_handshake(boost::asio::ssl::stream_base::server, buffer.data())};
+        auto ssl_stream{handshaken ? boost::asio::ssl::stream<Stream>{std::move(stream), handshaken}
+                                   : boost::asio::ssl::stream<Stream>{std::move(stream), ssl_context_}};
+        deadline.expires_after(timeout, [&ssl_stream] {
+            boost::beast::error_code ec{};
+            boost::beast::get_lowest_layer(ssl_stream).socket().close(ec);
+        });
 
-        buffer.consume(bytes_transferred);
+        if (!handshaken)
+        {
+            auto bytes_transferred{
+                co_await ssl_stream.async_handshake(boost::asio::ssl::stream_base::server, buffer.data())};
+            buffer.consume(bytes_transferred);
+        }
+        tls_sessions_.record_handshake(ssl_stream.native_handle());
 
-        LPBACKEND_LOG(lg_, info) << "Accepting incoming HTTPS connection";
-        co_await request_handler_.run_session(ssl_stream, buffer, config_.fields.http.doc_root.string(),
-                                              config_.fields.http.fallback_file, mime_database_);
+        // a request answered as early data may already have ended the connection
+        if (keep_alive && negotiated_h2(ssl_stream.native_handle()))
+        {
+            LPBACKEND_LOG(lg_, info) << "Accepting incoming HTTP/2 connection";
+            co_await request_handler_.run_http2_session(ssl_stream, buffer, config_.fields.http.doc_root.string(),
+                                                        config_.fields.http.fallback_file, mime_database_, deadline,
+                                                        early_data_bytes);
+        }
+        else if (keep_alive)
+        {
+            LPBACKEND_LOG(lg_, info) << "Accepting incoming HTTPS connection";
+            co_await request_handler_.run_session(ssl_stream, buffer, config_.fields.http.doc_root.string(),
+                                                  config_.fields.http.fallback_file, mime_database_, deadline,
+                                                  early_data_bytes);
+        }
 
         if (!ssl_stream.lowest_layer().is_open())
         {
             co_return;
         }
 
-        auto [ec]{co_await ssl_stream.async_shutdown(boost::asio::as_tuple)};
-        if (ec && ec != boost::asio::ssl::error::stream_truncated)
+        deadline.reset();
+        auto [ec]{co_await ssl_stream.async_shutdown(asio::recycled_tuple)};
+        if (ec && ec != boost::asio::ssl::error::stream_truncated && ssl_stream.lowest_layer().is_open())
         {
             throw boost::system::system_error{ec};
         }
     }
-    else if (!ssl_detected && !config_.fields.ssl.force_ssl)
+    else if (protocol == listener_protocol::http || !config_.fields.ssl.force_ssl)
     {
         LPBACKEND_LOG(lg_, info) << "Accepting incoming HTTP connection";
         co_await request_handler_.run_session(stream, buffer, config_.fields.http.doc_root.string(),
-                                              config_.fields.http.fallback_file, mime_database_);
+                                              config_.fields.http.fallback_file, mime_database_, deadline);
     }
-    else if (!ssl_detected && config_.fields.ssl.force_ssl)
+    else
     {
         LPBACKEND_LOG(lg_, error) << "Rejecting incoming HTTP connection (forcing SSL)";
-        stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+        stream.socket().shutdown(boost::asio::socket_base::shutdown_both);
+    }
+}
+
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::rotate_ticket_keys()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (!config_.fields.ssl.session_tickets)
+    {
+        co_return;
+    }
+
+    // check more often than the keys rotate, so a key is never used much longer than intended
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(std::max(tls_sessions_.rotation_interval() / 16, std::chrono::seconds{1}));
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+        co_await blocking_pool_.async_run([this] { return tls_sessions_.rotate(); });
+    }
+}
+
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::watch_asset_bundle()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (config_.fields.http.asset_bundle.empty() || config_.fields.http.asset_bundle_check_seconds == 0)
+    {
+        co_return;
+    }
+
+    // deploys rename a new bundle over the old one, which changes the modification time
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(std::chrono::seconds{config_.fields.http.asset_bundle_check_seconds});
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+
+        try
+        {
+            const auto bundle{co_await blocking_pool_.async_run(
+                [path = config_.fields.http.asset_bundle,
+                 current = request_handler_.get_asset_bundle()]() -> std::shared_ptr<const networking::asset_bundle> {
+                    std::error_code ec{};
+                    const auto last_write_time{std::filesystem::last_write_time(path, ec)};
+                    if (ec || (current && current->last_write_time() == last_write_time))
+                    {
+                        return nullptr;
+                    }
+                    return networking::asset_bundle::open(path);
+                })};
+            if (bundle)
+            {
+                request_handler_.set_asset_bundle(bundle);
+                LPBACKEND_LOG(lg_, info) << fmt::format("Reloaded asset bundle ({} assets, {} bytes)", bundle->size(),
+                                                        bundle->mapped_bytes());
+            }
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, error) << "Failed to reload asset bundle, keeping the previous one: " << e.what();
+        }
+    }
+}
+
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::watch_memory()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    const auto limit{config_.fields.memory.soft_limit_bytes};
+    if (limit == 0 || config_.fields.memory.check_interval_seconds == 0)
+    {
+        co_return;
+    }
+
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    bool over_limit{};
+    while (!state.cancelled())
+    {
+        timer.expires_after(std::chrono::seconds{config_.fields.memory.check_interval_seconds});
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+
+        const auto resident{memory::get_process_usage().current_rss};
+        if (resident <= limit)
+        {
+            if (std::exchange(over_limit, false))
+            {
+                LPBACKEND_LOG(lg_, info) << fmt::format("Resident memory is back below the soft limit ({} bytes)",
+                                                        resident);
+            }
+            continue;
+        }
+        if (!std::exchange(over_limit, true))
+        {
+            LPBACKEND_LOG(lg_, warning) << fmt::format(
+                "Resident memory of {} bytes exceeds the soft limit of {} bytes, shrinking caches\n{}", resident,
+                limit, memory::report(false));
+        }
+
+        // caches give back half of their entries on every check until the process fits again
+        file_cache_.shrink();
+        fragment_cache_.shrink();
+        api_cache_.shrink();
+        asio::recycling_pool::trim();
+        const auto collected{co_await blocking_pool_.async_run([] {
+            memory::collect();
+            return memory::get_process_usage().current_rss;
+        })};
+        LPBACKEND_LOG(lg_, debug) << fmt::format("Shrunk caches, {} bytes resident", collected);
+    }
+}
+
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::sweep_register_sessions()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (config_.fields.auth.register_session_sweep_seconds == 0)
+    {
+        co_return;
+    }
+
+    // lookups drop expired sessions as well, sweeps free the ones nobody comes back for
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(std::chrono::seconds{config_.fields.auth.register_session_sweep_seconds});
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+        register_sessions_.sweep();
+    }
+}
+
+boost::asio::awaitable<void, lpbackend_server::executor_type> lpbackend_server::log_statistics()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (config_.fields.logging.statistics_interval_seconds == 0)
+    {
+        co_return;
+    }
+
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(std::chrono::seconds{config_.fields.logging.statistics_interval_seconds});
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+
+        const auto full{tls_sessions_.full_handshakes()};
+        const auto resumed{tls_sessions_.resumed_handshakes()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "TLS handshakes: {} full, {} resumed ({:.1f}% resumption hit rate)", full, resumed,
+            full + resumed ? 100.0 * static_cast<double>(resumed) / static_cast<double>(full + resumed) : 0.0);
+        if (config_.fields.ssl.early_data)
+        {
+            LPBACKEND_LOG(lg_, info) << fmt::format("TLS early data: {} accepted, {} replays rejected",
+                                                    tls_sessions_.early_data_accepted(),
+                                                    tls_sessions_.early_data_replays());
+        }
+
+        const auto files{file_cache_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "File cache: {} hits, {} misses ({:.1f}% hit rate), {} revalidated, {} entries, {} bytes in memory",
+            files.hits, files.misses,
+            files.hits + files.misses
+                ? 100.0 * static_cast<double>(files.hits) / static_cast<double>(files.hits + files.misses)
+                : 0.0,
+            files.revalidations, files.entries, files.memory);
+
+        const auto fragments{fragment_cache_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Fragment cache: {} hits, {} misses ({:.1f}% hit rate), {} admitted, {} rejected, {} stale, {} evicted, "
+            "{} invalidated, {} entries, {} bytes in memory",
+            fragments.hits, fragments.misses,
+            fragments.hits + fragments.misses
+                ? 100.0 * static_cast<double>(fragments.hits) / static_cast<double>(fragments.hits + fragments.misses)
+                : 0.0,
+            fragments.admitted, fragments.rejected, fragments.stale, fragments.evicted, fragments.invalidated,
+            fragments.entries, fragments.memory);
+
+        const auto api{api_cache_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "API cache: {} hits, {} stale hits, {} misses, {} coalesced, {} revalidations, {} failures, {} entries, "
+            "{} bytes in memory",
+            api.hits, api.stale_hits, api.misses, api.coalesced, api.revalidations, api.failures, api.entries,
+            api.memory);
+
+        const auto sessions{networking::session_memory::collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Session memory: {} sessions closed, {} bytes average peak, {} bytes max peak, {} bytes in use",
+            sessions.sessions, sessions.average_peak, sessions.max_peak, sessions.in_use);
+
+        const auto recycling{asio::recycling_pool::collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Recycling allocator: {} hits, {} misses ({:.1f}% hit rate), {} bypassed, {} bytes cached", recycling.hits,
+            recycling.misses,
+            recycling.hits + recycling.misses
+                ? 100.0 * static_cast<double>(recycling.hits) / static_cast<double>(recycling.hits + recycling.misses)
+                : 0.0,
+            recycling.bypassed, recycling.cached_bytes);
+
+        const auto registers{register_sessions_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Register sessions: {} created, {} completed, {} expired, {} rejected, {} pending", registers.created,
+            registers.taken, registers.expired, registers.rejected, registers.sessions);
+
+        const auto captchas{captcha_pool_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format("Captchas: {} rendered, {} served, {} requests found the pool empty, "
+                                                "{} ready",
+                                                captchas.rendered, captchas.served, captchas.exhausted,
+                                                captchas.ready);
+
+        std::string accounted{};
+        for (std::size_t i{}; i < memory::tag_count; ++i)
+        {
+            const auto tag{static_cast<memory::tag>(i)};
+            fmt::format_to(std::back_inserter(accounted), "{}{} {}", i ? ", " : "", memory::tag_name(tag),
+                           memory::usage(tag));
+        }
+        const auto process{memory::get_process_usage()};
+        LPBACKEND_LOG(lg_, info) << fmt::format("Memory: {} bytes resident (peak {}), {} bytes committed; {}",
+                                                process.current_rss, process.peak_rss, process.current_commit,
+                                                accounted);
+
+        const auto blocking{blocking_pool_.collect()};
+        const auto milliseconds{[](const std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::milli>{duration}.count();
+        }};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Blocking I/O: {} tasks, queue depth {} (peak {}), wait {:.2f}ms average {:.2f}ms max, "
+            "run {:.2f}ms average",
+            blocking.completed, blocking.depth, blocking.peak_depth,
+            blocking.completed ? milliseconds(blocking.total_wait) / static_cast<double>(blocking.completed) : 0.0,
+            milliseconds(blocking.max_wait),
+            blocking.completed ? milliseconds(blocking.total_run) / static_cast<double>(blocking.completed) : 0.0);
+
+        if (store_.is_open())
+        {
+            const auto store{store_.collect()};
+            LPBACKEND_LOG(lg_, info) << fmt::format(
+                "Storage: {} batches of {} records in {} commits (at most {} per commit), {} bytes written, "
+                "{} compactions reclaimed {} bytes, {} keys in {} segments",
+                store.batches, store.records, store.commits, store.largest_commit, store.written_bytes,
+                store.compactions, store.reclaimed_bytes, store.keys, store.segments);
+        }
+
+        const auto counters{counters_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Counters: {} increments, {} flushes wrote {} totals, {} totals cached, {} evicted", counters.increments,
+            counters.flushes, counters.written_totals, counters.totals, counters.evicted_totals);
+
+        if (search_index_.is_open())
+        {
+            const auto search{search_index_.collect()};
+            LPBACKEND_LOG(lg_, info) << fmt::format(
+                "Search: {} searches (slowest {}us), {} documents added, {} removed, {} segments written, "
+                "{} merges, {} documents in {} segments",
+                search.searches, search.slowest_search_us, search.added, search.removed, search.flushes,
+                search.merges, search.documents, search.segments);
+        }
+
+        const auto passwords{password_hasher_.collect()};
+        LPBACKEND_LOG(lg_, info) << fmt::format(
+            "Password hashes: {} hashed, {} verified, {} refused, queue depth {} (peak {}), run {:.2f}ms average",
+            passwords.hashed, passwords.verified, passwords.rejected, passwords.workers.depth,
+            passwords.workers.peak_depth,
+            passwords.workers.completed
+                ? milliseconds(passwords.workers.total_run) / static_cast<double>(passwords.workers.completed)
+                : 0.0);
     }
 }
 
@@ -231,27 +752,63 @@ void lpbackend_server::initialize(lpbackend::plugin::plugin_manager &)
         throw;
     }
 
+    asio::recycling_pool::configure(config_.fields.asio.recycling_max_block_bytes,
+                                    config_.fields.asio.recycling_blocks_per_class);
+    memory::set_source(memory::tag::recycling_pool, &asio::recycling_pool::cached_bytes);
+    blocking_pool_.start(config_.fields.asio.blocking_threads);
+    file_cache_.configure(config_.fields.http);
+    fragment_cache_.configure(config_.fields.http);
+    api_cache_.configure(config_.fields.http);
+    register_sessions_.configure(config_.fields.auth);
+    captcha_pool_.start(config_.fields.auth);
+    password_hasher_.start(config_.fields.auth);
+    if (!config_.fields.storage.directory.empty())
+    {
+        try
+        {
+            store_.open(config_.fields.storage);
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, fatal) << "Failed to open the store: " << e.what();
+            throw;
+        }
+    }
+    counters_.configure(config_.fields.storage);
+    if (!config_.fields.search.directory.empty())
+    {
+        try
+        {
+            search_index_.open(config_.fields.search);
+        }
+        catch (const std::exception &e)
+        {
+            LPBACKEND_LOG(lg_, fatal) << "Failed to open the full-text index: " << e.what();
+            throw;
+        }
+    }
+
     if (!vm_.count("color") && !config_.fields.logging.color_logging)
     {
         lpbackend::log::color_enabled = false;
         LPBACKEND_LOG(lg_, info) << "Disabled colored logging";
     }
 
+#if defined(BOOST_ASIO_HAS_IO_URING)
+    if (asio::io_uring_available())
+    {
+        LPBACKEND_LOG(lg_, info) << "Reading files through io_uring";
+    }
+    else
+    {
+        LPBACKEND_LOG(lg_, warning) << "io_uring is not available, falling back to synchronous file reads";
+    }
+#endif
+
+    LPBACKEND_LOG(lg_, info) << "Using " << util::codec_isa() << " codec kernels";
+
     co_spawn(make_strand(context_), mime_database_.start_update(config_.fields.networking.mime_database_url),
-             task_group_.adapt([this](const std::exception_ptr eptr) {
-                 if (!eptr)
-                 {
-                     return;
-                 }
-                 try
-                 {
-                     rethrow_exception(eptr);
-                 }
-                 catch (std::exception &e)
-                 {
-                     LPBACKEND_LOG(lg_, error) << "Exception occured on updating MIME database: " << e.what();
-                 }
-             }));
+             adapt_logged("on updating MIME database"));
 
     // setup SSL context
     try
@@ -275,13 +832,34 @@ void lpbackend_server::initialize(lpbackend::plugin::plugin_manager &)
         ssl_context_.use_private_key_file(config_.fields.ssl.private_key.string(),
                                           boost::asio::ssl::context::file_format::pem);
         ssl_context_.use_tmp_dh_file(config_.fields.ssl.tmp_dh.string());
+        SSL_CTX_set_alpn_select_cb(ssl_context_.native_handle(), select_alpn, &config_.fields.http2.enabled);
+        tls_sessions_.configure(ssl_context_.native_handle(), config_.fields.ssl);
     }
-    catch (const boost::system::system_error &e)
+    catch (const std::exception &e)
     {
         LPBACKEND_LOG(lg_, fatal) << "Failed to load SSL certificates";
         throw;
     }
 
+    if (config_.fields.networking.listeners.empty())
+    {
+        LPBACKEND_LOG(lg_, fatal) << "No listener is configured";
+        throw std::runtime_error{"no listener is configured"};
+    }
+    for (const auto &listener : config_.fields.networking.listeners)
+    {
+        try
+        {
+            parse_listener_protocol(listener.protocol);
+            find_socket_profile(config_.fields.networking, listener.socket_profile);
+        }
+        catch (const std::runtime_error &e)
+        {
+            LPBACKEND_LOG(lg_, fatal) << "Failed to configure listener: " << e.what();
+            throw;
+        }
+    }
+
     if (exists(config_.fields.http.doc_root) && !is_directory(config_.fields.http.doc_root))
     {
         LPBACKEND_LOG(lg_, fatal) << "Failed to open HTTP root: is a file";
@@ -289,26 +867,50 @@ void lpbackend_server::initialize(lpbackend::plugin::plugin_manager &)
     }
 
     create_directories(config_.fields.http.doc_root);
-}
-
-void lpbackend_server::start()
-{
-    LPBACKEND_LOG(lg_, info) << "Starting LPBackend server";
 
-    co_spawn(make_strand(context_), start_accept(), task_group_.adapt([this](const std::exception_ptr eptr) {
-        if (!eptr)
-        {
-            return;
-        }
+    if (!config_.fields.http.asset_bundle.empty())
+    {
         try
         {
-            rethrow_exception(eptr);
+            const auto bundle{networking::asset_bundle::open(config_.fields.http.asset_bundle)};
+            request_handler_.set_asset_bundle(bundle);
+            LPBACKEND_LOG(lg_, info) << fmt::format("Loaded asset bundle {} ({} assets, {} bytes)",
+                                                    config_.fields.http.asset_bundle.string(), bundle->size(),
+                                                    bundle->mapped_bytes());
         }
-        catch (std::exception &e)
+        catch (const std::exception &e)
         {
-            LPBACKEND_LOG(lg_, error) << "Exception occured on starting accept: " << e.what();
+            LPBACKEND_LOG(lg_, fatal) << "Failed to load asset bundle: " << e.what();
+            throw;
         }
-    }));
+    }
+}
+
+void lpbackend_server::start()
+{
+    LPBACKEND_LOG(lg_, info) << "Starting LPBackend server";
+
+    for (const auto &listener : config_.fields.networking.listeners)
+    {
+        co_spawn(make_strand(context_), start_accept(listener), adapt_logged("on starting accept"));
+    }
+
+    co_spawn(make_strand(context_), timing_wheel_.run(), adapt_logged("in timing wheel"));
+
+    co_spawn(make_strand(context_), rotate_ticket_keys(), adapt_logged("on rotating session ticket keys"));
+
+    co_spawn(make_strand(context_), watch_asset_bundle(), adapt_logged("on watching asset bundle"));
+
+    co_spawn(make_strand(context_), watch_memory(), adapt_logged("on watching memory"));
+
+    co_spawn(make_strand(context_), captcha_pool_.run(), adapt_logged("on refilling captchas"));
+    co_spawn(make_strand(context_), store_.run(), adapt_logged("on compacting the store"));
+    co_spawn(make_strand(context_), counters_.run(), adapt_logged("on flushing the counters"));
+    co_spawn(make_strand(context_), search_index_.run(), adapt_logged("on maintaining the full-text index"));
+
+    co_spawn(make_strand(context_), sweep_register_sessions(), adapt_logged("on sweeping register sessions"));
+
+    co_spawn(make_strand(context_), log_statistics(), adapt_logged("on logging statistics"));
 
     co_spawn(make_strand(context_), handle_signals(), boost::asio::detached);
 
@@ -353,6 +955,19 @@ void lpbackend_server::terminate()
 lpbackend_server::~lpbackend_server()
 {
     LPBACKEND_LOG(lg_, info) << "Destructing LPBackend server";
+    // the pool posts completions to the I/O context, so it has to be joined first
+    blocking_pool_.stop();
+    captcha_pool_.stop();
+    password_hasher_.stop();
+    // the waiting requests are posted to their strands, so the shutdown below destroys them as well
+    api_cache_.close();
+    // after a hard stop the context still holds suspended sessions, they use timing_wheel_ and task_group_ when
+    // they are destroyed, so they have to go before those members do
+    context_.shutdown();
+    // the last increments are written before the store goes away
+    counters_.close();
+    store_.close();
+    search_index_.close();
     config_.save();
 }
 } // namespace lpbackend
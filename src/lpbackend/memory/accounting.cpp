@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
+#include <fmt/format.h>
+#include <mimalloc.h>
+
+#include <lpbackend/memory/accounting.hpp>
+
+namespace lpbackend::memory
+{
+namespace
+{
+constexpr std::array<std::string_view, tag_count> tag_names{"sessions",      "file_cache",     "asset_bundle",
+                                                            "mime_database", "recycling_pool", "storage_index",
+                                                            "search_index",  "fragment_cache", "api_cache"};
+
+std::array<std::atomic<std::int64_t>, tag_count> usages{};
+std::array<std::atomic<std::size_t (*)()>, tag_count> sources{};
+} // namespace
+
+std::string_view tag_name(const tag t) noexcept
+{
+    return tag_names[static_cast<std::size_t>(t)];
+}
+
+void account(const tag t, const std::int64_t delta) noexcept
+{
+    usages[static_cast<std::size_t>(t)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+void set_usage(const tag t, const std::size_t bytes) noexcept
+{
+    usages[static_cast<std::size_t>(t)].store(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+}
+
+void set_source(const tag t, std::size_t (*const source)())
+{
+    sources[static_cast<std::size_t>(t)].store(source);
+}
+
+std::size_t usage(const tag t)
+{
+    if (const auto source{sources[static_cast<std::size_t>(t)].load()})
+    {
+        return source();
+    }
+    // concurrent deltas may be observed out of order
+    return static_cast<std::size_t>(std::max<std::int64_t>(usages[static_cast<std::size_t>(t)].load(), 0));
+}
+
+process_usage get_process_usage() noexcept
+{
+    std::size_t elapsed{}, user{}, system{}, page_faults{};
+    process_usage result{};
+    mi_process_info(&elapsed, &user, &system, &result.current_rss, &result.peak_rss, &result.current_commit,
+                    &result.peak_commit, &page_faults);
+    return result;
+}
+
+std::string report(const bool detailed)
+{
+    std::string out{};
+    std::size_t total{};
+    for (std::size_t i{}; i < tag_count; ++i)
+    {
+        const auto bytes{usage(static_cast<tag>(i))};
+        total += bytes;
+        fmt::format_to(std::back_inserter(out), "{}: {}\n", tag_names[i], bytes);
+    }
+    const auto process{get_process_usage()};
+    fmt::format_to(std::back_inserter(out),
+                   "accounted: {}\nrss: {}\npeak_rss: {}\ncommit: {}\npeak_commit: {}\n", total,
+                   process.current_rss, process.peak_rss, process.current_commit, process.peak_commit);
+    if (detailed)
+    {
+        out += "\n";
+        mi_stats_print_out([](const char *message, void *arg) { *static_cast<std::string *>(arg) += message; }, &out);
+    }
+    return out;
+}
+
+void collect() noexcept
+{
+    mi_collect(true);
+}
+} // namespace lpbackend::memory
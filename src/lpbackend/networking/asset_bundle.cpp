@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <fmt/format.h>
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/networking/asset_bundle.hpp>
+
+namespace lpbackend::networking
+{
+namespace
+{
+// magic, version, entry count, bucket count, reserved, seeds offset, records offset
+constexpr std::size_t header_size{40};
+// path offset and size, MIME type size and offset, ETag offset and size, codings, 3 variants of offset and size
+constexpr std::size_t record_size{88};
+constexpr std::size_t variant_count{3};
+constexpr std::uint32_t max_seed{1U << 24};
+
+template <typename T> T load(const char *data) noexcept
+{
+    T value{};
+    for (std::size_t i{}; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(static_cast<std::uint8_t>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+template <typename T> void store(std::string &out, const T value)
+{
+    for (std::size_t i{}; i < sizeof(T); ++i)
+    {
+        out.push_back(static_cast<char>(static_cast<std::uint8_t>(value >> (8 * i))));
+    }
+}
+
+std::uint64_t fnv1a(const std::string_view data, std::uint64_t hash = 0xcbf29ce484222325) noexcept
+{
+    for (const auto c : data)
+    {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// finalizer of splitmix64, spreads the bits of the path hash for the bucket and slot choices
+std::uint64_t mix(std::uint64_t value) noexcept
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111eb;
+    value ^= value >> 31;
+    return value;
+}
+
+std::uint32_t bucket_of(const std::uint64_t hash, const std::uint32_t bucket_count) noexcept
+{
+    return static_cast<std::uint32_t>(mix(hash) % bucket_count);
+}
+
+std::uint32_t slot_of(const std::uint64_t hash, const std::uint32_t seed, const std::uint32_t entry_count) noexcept
+{
+    return static_cast<std::uint32_t>(mix(hash ^ (seed * 0x9e3779b97f4a7c15)) % entry_count);
+}
+
+bool in_bounds(const std::uint64_t offset, const std::uint64_t size, const std::uint64_t total) noexcept
+{
+    return offset <= total && size <= total - offset;
+}
+
+struct packed_entry
+{
+    std::string path;
+    std::string mime_type;
+    std::string etag;
+    std::uint64_t hash;
+    std::array<std::filesystem::path, variant_count> sources;
+    std::array<std::uint64_t, variant_count> sizes;
+};
+
+constexpr std::array<std::string_view, variant_count> coding_extensions{".br", ".gz", ""};
+
+std::string content_etag(const std::filesystem::path &path)
+{
+    std::ifstream stream{path, std::ios::binary};
+    std::array<char, 65536> buffer{};
+    std::uint64_t hash{0xcbf29ce484222325};
+    while (stream)
+    {
+        stream.read(buffer.data(), buffer.size());
+        hash = fnv1a(std::string_view{buffer.data(), static_cast<std::size_t>(stream.gcount())}, hash);
+    }
+    if (!stream.eof())
+    {
+        throw std::runtime_error{fmt::format("failed to read {}", path.string())};
+    }
+    return fmt::format("\"{:016x}\"", hash);
+}
+
+void copy_content(const std::filesystem::path &path, const std::uint64_t size, std::ofstream &out)
+{
+    std::ifstream stream{path, std::ios::binary};
+    std::array<char, 65536> buffer{};
+    std::uint64_t copied{};
+    while (stream)
+    {
+        stream.read(buffer.data(), buffer.size());
+        out.write(buffer.data(), stream.gcount());
+        copied += static_cast<std::uint64_t>(stream.gcount());
+    }
+    if (!stream.eof() || copied != size)
+    {
+        throw std::runtime_error{fmt::format("{} changed while being packed", path.string())};
+    }
+}
+
+// Hash and displace: buckets are placed largest first, each with the first
+// seed that moves all of its paths to free slots
+std::vector<std::uint32_t> place_entries(const std::vector<packed_entry> &entries, const std::uint32_t bucket_count,
+                                         std::vector<std::uint32_t> &slots)
+{
+    const auto entry_count{static_cast<std::uint32_t>(entries.size())};
+    std::vector<std::vector<std::uint32_t>> buckets(bucket_count);
+    for (std::uint32_t i{}; i < entry_count; ++i)
+    {
+        buckets[bucket_of(entries[i].hash, bucket_count)].push_back(i);
+    }
+    std::vector<std::uint32_t> order(bucket_count);
+    for (std::uint32_t i{}; i < bucket_count; ++i)
+    {
+        order[i] = i;
+    }
+    std::ranges::stable_sort(order, std::ranges::greater{}, [&](const auto b) { return buckets[b].size(); });
+
+    std::vector<std::uint32_t> seeds(bucket_count);
+    std::vector<bool> used(entry_count);
+    std::vector<std::uint32_t> candidate{};
+    for (const auto b : order)
+    {
+        const auto &bucket{buckets[b]};
+        if (bucket.empty())
+        {
+            break;
+        }
+        std::uint32_t seed{1};
+        for (;; ++seed)
+        {
+            if (seed == max_seed)
+            {
+                throw std::runtime_error{fmt::format("failed to place \"{}\" in the hash", entries[bucket[0]].path)};
+            }
+            candidate.clear();
+            for (const auto i : bucket)
+            {
+                const auto slot{slot_of(entries[i].hash, seed, entry_count)};
+                if (used[slot] || std::ranges::find(candidate, slot) != candidate.end())
+                {
+                    break;
+                }
+                candidate.push_back(slot);
+            }
+            if (candidate.size() == bucket.size())
+            {
+                break;
+            }
+        }
+        seeds[b] = seed;
+        for (std::size_t k{}; k < bucket.size(); ++k)
+        {
+            used[candidate[k]] = true;
+            slots[candidate[k]] = bucket[k];
+        }
+    }
+    return seeds;
+}
+} // namespace
+
+asset_bundle::~asset_bundle()
+{
+    memory::account(memory::tag::asset_bundle, -static_cast<std::int64_t>(data_.size()));
+}
+
+std::shared_ptr<const asset_bundle> asset_bundle::open(const std::filesystem::path &path)
+{
+    auto bundle{std::make_shared<asset_bundle>()};
+    bundle->last_write_time_ = std::filesystem::last_write_time(path);
+    {
+        // the region stays valid after the mapping object is closed
+        const boost::interprocess::file_mapping file{path.string().c_str(), boost::interprocess::read_only};
+        bundle->region_ = boost::interprocess::mapped_region{file, boost::interprocess::read_only};
+    }
+    bundle->data_ = {static_cast<const char *>(bundle->region_.get_address()), bundle->region_.get_size()};
+    memory::account(memory::tag::asset_bundle, static_cast<std::int64_t>(bundle->data_.size()));
+
+    const auto &data{bundle->data_};
+    if (data.size() < header_size || !data.starts_with(magic))
+    {
+        throw std::runtime_error{fmt::format("{} is not an asset bundle", path.string())};
+    }
+    if (const auto version{load<std::uint32_t>(data.data() + 8)}; version != format_version)
+    {
+        throw std::runtime_error{fmt::format("unsupported asset bundle version {}", version)};
+    }
+    bundle->entry_count_ = load<std::uint32_t>(data.data() + 12);
+    bundle->bucket_count_ = load<std::uint32_t>(data.data() + 16);
+    bundle->seeds_offset_ = load<std::uint64_t>(data.data() + 24);
+    bundle->records_offset_ = load<std::uint64_t>(data.data() + 32);
+    if ((bundle->entry_count_ > 0 && bundle->bucket_count_ == 0) ||
+        !in_bounds(bundle->seeds_offset_, std::uint64_t{bundle->bucket_count_} * 4, data.size()) ||
+        !in_bounds(bundle->records_offset_, std::uint64_t{bundle->entry_count_} * record_size, data.size()))
+    {
+        throw std::runtime_error{fmt::format("{} has a malformed index", path.string())};
+    }
+
+    // validated once, so lookups can trust every record
+    for (std::uint32_t slot{}; slot < bundle->entry_count_; ++slot)
+    {
+        const auto record{data.data() + bundle->records_offset_ + slot * record_size};
+        bool valid{in_bounds(load<std::uint64_t>(record), load<std::uint32_t>(record + 8), data.size()) &&
+                   in_bounds(load<std::uint64_t>(record + 16), load<std::uint32_t>(record + 12), data.size()) &&
+                   in_bounds(load<std::uint64_t>(record + 24), load<std::uint32_t>(record + 32), data.size()) &&
+                   (load<std::uint32_t>(record + 36) & (1U << static_cast<unsigned>(content_coding::identity)))};
+        for (std::size_t i{}; i < variant_count; ++i)
+        {
+            valid = valid && in_bounds(load<std::uint64_t>(record + 40 + 16 * i),
+                                       load<std::uint64_t>(record + 48 + 16 * i), data.size());
+        }
+        if (!valid)
+        {
+            throw std::runtime_error{fmt::format("{} has a malformed record in slot {}", path.string(), slot)};
+        }
+    }
+    return bundle;
+}
+
+std::size_t asset_bundle::pack(const std::filesystem::path &directory, const std::filesystem::path &output,
+                               mime_database &db)
+{
+    std::vector<packed_entry> entries{};
+    for (const auto &file : std::filesystem::recursive_directory_iterator{directory})
+    {
+        if (!file.is_regular_file())
+        {
+            continue;
+        }
+        const auto &source{file.path()};
+        const auto extension{source.extension().string()};
+        if ((extension == ".br" || extension == ".gz") &&
+            std::filesystem::is_regular_file(std::filesystem::path{source}.replace_extension()))
+        {
+            // packed as a variant of the uncompressed file
+            continue;
+        }
+
+        packed_entry entry{};
+        entry.path = "/" + std::filesystem::relative(source, directory).generic_string();
+        entry.mime_type = db.get_mime_type(extension.empty() ? extension : extension.substr(1));
+        entry.etag = content_etag(source);
+        entry.hash = fnv1a(entry.path);
+        for (std::size_t i{}; i < variant_count; ++i)
+        {
+            auto variant{source};
+            variant += coding_extensions[i];
+            if (std::filesystem::is_regular_file(variant))
+            {
+                entry.sizes[i] = std::filesystem::file_size(variant);
+                entry.sources[i] = std::move(variant);
+            }
+        }
+        entries.push_back(std::move(entry));
+    }
+    if (entries.size() > std::numeric_limits<std::uint32_t>::max() / 2)
+    {
+        throw std::runtime_error{"too many files to pack"};
+    }
+
+    const auto entry_count{static_cast<std::uint32_t>(entries.size())};
+    const auto bucket_count{std::max<std::uint32_t>((entry_count + 3) / 4, 1)};
+    std::vector<std::uint32_t> slots(entry_count);
+    const auto seeds{place_entries(entries, bucket_count, slots)};
+
+    const std::uint64_t seeds_offset{header_size};
+    const std::uint64_t records_offset{seeds_offset + std::uint64_t{bucket_count} * 4};
+    std::uint64_t offset{records_offset + std::uint64_t{entry_count} * record_size};
+
+    std::string index{};
+    index.append(magic);
+    store<std::uint32_t>(index, format_version);
+    store<std::uint32_t>(index, entry_count);
+    store<std::uint32_t>(index, bucket_count);
+    store<std::uint32_t>(index, 0);
+    store<std::uint64_t>(index, seeds_offset);
+    store<std::uint64_t>(index, records_offset);
+    for (const auto seed : seeds)
+    {
+        store<std::uint32_t>(index, seed);
+    }
+
+    std::string strings{};
+    for (const auto i : slots)
+    {
+        offset += entries[i].path.size() + entries[i].mime_type.size() + entries[i].etag.size();
+    }
+    for (const auto i : slots)
+    {
+        const auto &entry{entries[i]};
+        const auto strings_offset{records_offset + std::uint64_t{entry_count} * record_size + strings.size()};
+        std::uint32_t codings{};
+        for (std::size_t k{}; k < variant_count; ++k)
+        {
+            codings |= entry.sources[k].empty() ? 0 : 1U << k;
+        }
+        store<std::uint64_t>(index, strings_offset);
+        store<std::uint32_t>(index, static_cast<std::uint32_t>(entry.path.size()));
+        store<std::uint32_t>(index, static_cast<std::uint32_t>(entry.mime_type.size()));
+        store<std::uint64_t>(index, strings_offset + entry.path.size());
+        store<std::uint64_t>(index, strings_offset + entry.path.size() + entry.mime_type.size());
+        store<std::uint32_t>(index, static_cast<std::uint32_t>(entry.etag.size()));
+        store<std::uint32_t>(index, codings);
+        for (std::size_t k{}; k < variant_count; ++k)
+        {
+            store<std::uint64_t>(index, entry.sources[k].empty() ? 0 : offset);
+            store<std::uint64_t>(index, entry.sizes[k]);
+            offset += entry.sizes[k];
+        }
+        strings += entry.path;
+        strings += entry.mime_type;
+        strings += entry.etag;
+    }
+
+    auto temp_path{output};
+    temp_path += ".tmp";
+    {
+        std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+        out.write(index.data(), static_cast<std::streamsize>(index.size()));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        for (const auto i : slots)
+        {
+            for (std::size_t k{}; k < variant_count; ++k)
+            {
+                if (!entries[i].sources[k].empty())
+                {
+                    copy_content(entries[i].sources[k], entries[i].sizes[k], out);
+                }
+            }
+        }
+        if (!out)
+        {
+            throw std::runtime_error{fmt::format("failed to write {}", temp_path.string())};
+        }
+    }
+    // a server mapping the old archive keeps it until it remaps
+    std::filesystem::rename(temp_path, output);
+    return entries.size();
+}
+
+asset asset_bundle::read_record(const std::uint32_t slot) const noexcept
+{
+    const auto record{data_.data() + records_offset_ + slot * record_size};
+    const auto codings{load<std::uint32_t>(record + 36)};
+    asset result{
+        .path = data_.substr(load<std::uint64_t>(record), load<std::uint32_t>(record + 8)),
+        .mime_type = data_.substr(load<std::uint64_t>(record + 16), load<std::uint32_t>(record + 12)),
+        .etag = data_.substr(load<std::uint64_t>(record + 24), load<std::uint32_t>(record + 32)),
+        .variants = {},
+    };
+    for (std::size_t i{}; i < variant_count; ++i)
+    {
+        if (codings & (1U << i))
+        {
+            result.variants[i] =
+                data_.substr(load<std::uint64_t>(record + 40 + 16 * i), load<std::uint64_t>(record + 48 + 16 * i));
+        }
+    }
+    return result;
+}
+
+std::optional<asset> asset_bundle::find(const std::string_view path) const noexcept
+{
+    if (entry_count_ == 0)
+    {
+        return std::nullopt;
+    }
+    const auto hash{fnv1a(path)};
+    const auto seed{load<std::uint32_t>(data_.data() + seeds_offset_ + 4 * bucket_of(hash, bucket_count_))};
+    auto result{read_record(slot_of(hash, seed, entry_count_))};
+    if (result.path != path)
+    {
+        return std::nullopt;
+    }
+    return result;
+}
+
+std::size_t asset_bundle::size() const noexcept
+{
+    return entry_count_;
+}
+
+std::size_t asset_bundle::mapped_bytes() const noexcept
+{
+    return data_.size();
+}
+
+std::filesystem::file_time_type asset_bundle::last_write_time() const noexcept
+{
+    return last_write_time_;
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cxx_detect.h>
+
+#if CXX_OS_WINDOWS
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/networking/file_cache.hpp>
+#include <lpbackend/networking/response_templates.hpp>
+
+namespace lpbackend::networking
+{
+namespace
+{
+std::chrono::system_clock::time_point to_system_time(const std::filesystem::file_time_type time)
+{
+#if __cpp_lib_chrono >= 201907L
+    return std::chrono::clock_cast<std::chrono::system_clock>(time);
+#else
+    // older standard libraries lack clock_cast, but provide the conversion of file_clock
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(std::chrono::file_clock::to_sys(time));
+#endif
+}
+} // namespace
+
+std::shared_ptr<cached_file> cached_file::open(const std::string &path, std::string mime_type,
+                                               const std::uint64_t inline_bytes, boost::beast::error_code &ec)
+{
+    auto file{std::make_shared<cached_file>()};
+    file->mime_type_ = std::move(mime_type);
+
+    file->file_.open(path.c_str(), boost::beast::file_mode::read, ec);
+    if (ec)
+    {
+        return nullptr;
+    }
+    std::error_code std_ec{};
+    file->last_write_time_ = std::filesystem::last_write_time(path, std_ec);
+    if (std_ec)
+    {
+        ec.assign(std_ec.value(), boost::system::system_category());
+        return nullptr;
+    }
+    file->size_ = file->file_.size(ec);
+    if (ec)
+    {
+        return nullptr;
+    }
+
+    if (file->size_ <= inline_bytes)
+    {
+        std::string content(static_cast<std::size_t>(file->size_), '\0');
+        std::size_t done{};
+        while (done < content.size())
+        {
+            const auto n{file->read_at(done, content.data() + done, content.size() - done, ec)};
+            if (ec)
+            {
+                return nullptr;
+            }
+            if (n == 0)
+            {
+                // truncated while being read
+                content.resize(done);
+                break;
+            }
+            done += n;
+        }
+        file->size_ = content.size();
+        file->content_ = std::move(content);
+        file->file_.close(ec);
+    }
+#if BOOST_BEAST_USE_POSIX_FILE && defined(POSIX_FADV_WILLNEED)
+    else
+    {
+        // start reading ahead, so the first reads of a response find the page cache warm
+        ::posix_fadvise(file->file_.native_handle(), 0, 0, POSIX_FADV_WILLNEED);
+    }
+#endif
+
+    auto &header{file->header_};
+    header.result(boost::beast::http::status::ok);
+    header.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
+    header.set(boost::beast::http::field::content_type, file->mime_type_);
+    header.set(boost::beast::http::field::content_length, std::to_string(file->size_));
+    header.set(boost::beast::http::field::last_modified, format_http_date(to_system_time(file->last_write_time_)));
+    return file;
+}
+
+std::uint64_t cached_file::size() const noexcept
+{
+    return size_;
+}
+
+std::filesystem::file_time_type cached_file::last_write_time() const noexcept
+{
+    return last_write_time_;
+}
+
+const std::string &cached_file::mime_type() const noexcept
+{
+    return mime_type_;
+}
+
+const boost::beast::http::response_header<> &cached_file::header() const noexcept
+{
+    return header_;
+}
+
+std::optional<std::string_view> cached_file::content() const noexcept
+{
+    if (!content_)
+    {
+        return std::nullopt;
+    }
+    return std::string_view{*content_};
+}
+
+boost::beast::file::native_handle_type cached_file::native_handle() const noexcept
+{
+    return file_.native_handle();
+}
+
+std::size_t cached_file::read_at(const std::uint64_t offset, char *data, const std::size_t size,
+                                 boost::beast::error_code &ec) const
+{
+    ec = {};
+#if CXX_OS_WINDOWS
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(offset & 0xffffffff);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD bytes{};
+    if (!ReadFile(file_.native_handle(), data, static_cast<DWORD>(std::min<std::size_t>(size, MAXDWORD)), &bytes,
+                  &overlapped))
+    {
+        const auto error{GetLastError()};
+        if (error != ERROR_HANDLE_EOF)
+        {
+            ec.assign(static_cast<int>(error), boost::system::system_category());
+        }
+        return 0;
+    }
+    return bytes;
+#else
+    for (;;)
+    {
+        const auto n{::pread(file_.native_handle(), data, size, static_cast<off_t>(offset))};
+        if (n >= 0)
+        {
+            return static_cast<std::size_t>(n);
+        }
+        if (errno != EINTR)
+        {
+            ec.assign(errno, boost::system::generic_category());
+            return 0;
+        }
+    }
+#endif
+}
+
+void file_cache::configure(const config::lpbackend_config::fields_t::http_t &http)
+{
+    std::lock_guard lock{mutex_};
+    max_entries_ = static_cast<std::size_t>(http.file_cache_entries);
+    max_memory_ = static_cast<std::size_t>(http.file_cache_memory_bytes);
+    inline_bytes_ = http.inline_file_bytes;
+    ttl_ = std::chrono::seconds{http.file_cache_ttl_seconds};
+}
+
+void file_cache::erase(const std::list<entry>::iterator it)
+{
+    memory_ -= it->file->content() ? static_cast<std::size_t>(it->file->size()) : 0;
+    index_.erase(it->path);
+    entries_.erase(it);
+    memory::set_usage(memory::tag::file_cache, memory_);
+}
+
+void file_cache::insert(const std::string &path, std::shared_ptr<const cached_file> file)
+{
+    if (const auto it{index_.find(path)}; it != index_.end())
+    {
+        erase(it->second);
+    }
+    if (max_entries_ == 0)
+    {
+        return;
+    }
+
+    memory_ += file->content() ? static_cast<std::size_t>(file->size()) : 0;
+    entries_.push_front(entry{.path = path, .file = std::move(file), .validated = clock_type::now()});
+    index_.emplace(entries_.front().path, entries_.begin());
+    while (entries_.size() > max_entries_ || (memory_ > max_memory_ && entries_.size() > 1))
+    {
+        erase(std::prev(entries_.end()));
+    }
+    memory::set_usage(memory::tag::file_cache, memory_);
+}
+
+std::shared_ptr<const cached_file> file_cache::find(const std::string &path)
+{
+    std::lock_guard lock{mutex_};
+    const auto it{index_.find(path)};
+    if (it == index_.end() || clock_type::now() - it->second->validated > ttl_)
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->file;
+}
+
+std::shared_ptr<const cached_file> file_cache::open(const std::string &path, std::string mime_type,
+                                                    boost::beast::error_code &ec)
+{
+    std::shared_ptr<const cached_file> cached{};
+    {
+        std::lock_guard lock{mutex_};
+        if (const auto it{index_.find(path)}; it != index_.end())
+        {
+            cached = it->second->file;
+        }
+    }
+
+    // an unchanged file is kept open, so only a stat is needed
+    if (cached)
+    {
+        std::error_code std_ec{};
+        const auto last_write_time{std::filesystem::last_write_time(path, std_ec)};
+        const auto size{std_ec ? 0 : std::filesystem::file_size(path, std_ec)};
+        if (!std_ec && last_write_time == cached->last_write_time() && size == cached->size())
+        {
+            revalidations_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard lock{mutex_};
+            if (const auto it{index_.find(path)}; it != index_.end() && it->second->file == cached)
+            {
+                it->second->validated = clock_type::now();
+            }
+            return cached;
+        }
+    }
+
+    auto file{cached_file::open(path, std::move(mime_type), inline_bytes_, ec)};
+    std::lock_guard lock{mutex_};
+    if (!file)
+    {
+        if (const auto it{index_.find(path)}; it != index_.end())
+        {
+            erase(it->second);
+        }
+        return nullptr;
+    }
+    insert(path, file);
+    return file;
+}
+
+void file_cache::shrink()
+{
+    std::lock_guard lock{mutex_};
+    for (auto count{entries_.size() / 2}; count > 0; --count)
+    {
+        erase(std::prev(entries_.end()));
+    }
+}
+
+file_cache::statistics file_cache::collect()
+{
+    std::lock_guard lock{mutex_};
+    return statistics{.hits = hits_.exchange(0, std::memory_order_relaxed),
+                      .misses = misses_.exchange(0, std::memory_order_relaxed),
+                      .revalidations = revalidations_.exchange(0, std::memory_order_relaxed),
+                      .entries = entries_.size(),
+                      .memory = memory_};
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <lpbackend/networking/http2/frame.hpp>
+
+namespace lpbackend::networking::http2
+{
+connection_error::connection_error(const error_code code, const std::string &message)
+    : std::runtime_error{message}, code_{code}
+{
+}
+
+error_code connection_error::code() const noexcept
+{
+    return code_;
+}
+
+stream_error::stream_error(const std::uint32_t stream_id, const error_code code, const std::string &message)
+    : std::runtime_error{message}, stream_id_{stream_id}, code_{code}
+{
+}
+
+std::uint32_t stream_error::stream_id() const noexcept
+{
+    return stream_id_;
+}
+
+error_code stream_error::code() const noexcept
+{
+    return code_;
+}
+} // namespace lpbackend::networking::http2
@@ -0,0 +1,594 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <lpbackend/networking/http2/frame.hpp>
+#include <lpbackend/networking/http2/hpack.hpp>
+
+namespace
+{
+using namespace lpbackend::networking::http2;
+
+// RFC 7541 Appendix A
+constexpr std::array<std::pair<std::string_view, std::string_view>, 61> static_table{{
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+}};
+
+// RFC 7541 Appendix B, the last entry is EOS
+constexpr std::array<std::pair<std::uint32_t, std::uint8_t>, 257> huffman_codes{{
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28}, {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28},
+    {0xfffffe7, 28}, {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28}, {0xfffffea, 28},
+    {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28}, {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28},
+    {0xffffff0, 28}, {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28}, {0xffffff4, 28},
+    {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28}, {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28},
+    {0xffffffb, 28}, {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12}, {0x1ff9, 13}, {0x15, 6}, {0xf8, 8},
+    {0x7fa, 11}, {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11}, {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+    {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6}, {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6}, {0x1e, 6}, {0x1f, 6},
+    {0x5c, 7}, {0xfb, 8}, {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10}, {0x1ffa, 13}, {0x21, 6}, {0x5d, 7},
+    {0x5e, 7}, {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7}, {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7}, {0x67, 7},
+    {0x68, 7}, {0x69, 7}, {0x6a, 7}, {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7}, {0x6f, 7}, {0x70, 7}, {0x71, 7},
+    {0x72, 7}, {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13}, {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+    {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5}, {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6}, {0x27, 6}, {0x6, 5},
+    {0x74, 7}, {0x75, 7}, {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5}, {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+    {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7}, {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15}, {0x7fc, 11},
+    {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28}, {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+    {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23}, {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23},
+    {0x7fffdc, 23}, {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23}, {0xffffec, 24}, {0xffffed, 24},
+    {0x3fffd7, 22}, {0x7fffe0, 23}, {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23}, {0x7fffe4, 23},
+    {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23}, {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+    {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22}, {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23},
+    {0x1fffde, 21}, {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24}, {0x1fffdf, 21}, {0x3fffdf, 22},
+    {0x7fffeb, 23}, {0x7fffec, 23}, {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21}, {0x7fffed, 23},
+    {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23}, {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+    {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23}, {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20},
+    {0x7fff1, 19}, {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25}, {0x3ffffe2, 26}, {0x3ffffe3, 26},
+    {0x3ffffe4, 26}, {0x7ffffde, 27}, {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+    {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27}, {0x7ffffe1, 27}, {0x3ffffe7, 26},
+    {0x7ffffe2, 27}, {0xfffff2, 24}, {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+    {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27}, {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20},
+    {0x1fffe6, 21}, {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23}, {0x3fffea, 22}, {0x3fffeb, 22},
+    {0x1ffffee, 25}, {0x1ffffef, 25}, {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+    {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26}, {0x7ffffe7, 27}, {0x7ffffe8, 27},
+    {0x7ffffe9, 27}, {0x7ffffea, 27}, {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+    {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26}, {0x3fffffff, 30}
+
+}};
+
+constexpr std::uint16_t huffman_eos{256};
+
+// Fields whose values rarely repeat are not worth a slot in the dynamic table
+constexpr std::array<std::string_view, 8> unindexed_fields{
+    "content-length", "date", "etag", "last-modified", "age", "expires", "content-range", ":path"};
+
+// A nibble-driven state machine built from the code table. Every state is an
+// internal node of the code tree, so 4 input bits emit at most one symbol.
+struct huffman_decode_table
+{
+    static constexpr std::uint8_t emit{0x1};
+    static constexpr std::uint8_t fail{0x2};
+
+    struct transition
+    {
+        std::uint8_t next;
+        std::uint8_t flags;
+        std::uint8_t symbol;
+    };
+
+    std::array<std::array<transition, 16>, 256> states{};
+    std::array<bool, 256> accepting{};
+    std::uint8_t root{};
+
+    huffman_decode_table()
+    {
+        struct node
+        {
+            std::array<int, 2> children{-1, -1};
+            int symbol{-1};
+        };
+        std::vector<node> nodes(1);
+        for (std::size_t symbol{}; symbol < huffman_codes.size(); ++symbol)
+        {
+            const auto [code, length]{huffman_codes[symbol]};
+            std::size_t current{};
+            for (int bit{length - 1}; bit >= 0; --bit)
+            {
+                const auto branch{(code >> bit) & 1};
+                if (nodes[current].children[branch] < 0)
+                {
+                    nodes[current].children[branch] = static_cast<int>(nodes.size());
+                    nodes.emplace_back();
+                }
+                current = static_cast<std::size_t>(nodes[current].children[branch]);
+            }
+            nodes[current].symbol = static_cast<int>(symbol);
+        }
+
+        // number the internal nodes and find the ones a valid padding may end at
+        std::vector<int> state_of(nodes.size(), -1);
+        std::vector<std::pair<std::size_t, std::pair<int, bool>>> pending{{0, {0, true}}};
+        int next_state{};
+        while (!pending.empty())
+        {
+            const auto [index, info]{pending.back()};
+            pending.pop_back();
+            if (nodes[index].symbol >= 0)
+            {
+                continue;
+            }
+            const auto [depth, all_ones]{info};
+            state_of[index] = next_state;
+            accepting[static_cast<std::size_t>(next_state)] = all_ones && depth < 8;
+            ++next_state;
+            pending.push_back({static_cast<std::size_t>(nodes[index].children[0]), {depth + 1, false}});
+            pending.push_back({static_cast<std::size_t>(nodes[index].children[1]), {depth + 1, all_ones}});
+        }
+        root = static_cast<std::uint8_t>(state_of[0]);
+
+        for (std::size_t index{}; index < nodes.size(); ++index)
+        {
+            if (state_of[index] < 0)
+            {
+                continue;
+            }
+            for (std::uint8_t nibble{}; nibble < 16; ++nibble)
+            {
+                transition t{};
+                auto current{index};
+                for (int bit{3}; bit >= 0; --bit)
+                {
+                    current = static_cast<std::size_t>(nodes[current].children[(nibble >> bit) & 1]);
+                    if (nodes[current].symbol == huffman_eos)
+                    {
+                        t.flags |= fail;
+                        current = 0;
+                        break;
+                    }
+                    if (nodes[current].symbol >= 0)
+                    {
+                        t.flags |= emit;
+                        t.symbol = static_cast<std::uint8_t>(nodes[current].symbol);
+                        current = 0;
+                    }
+                }
+                t.next = static_cast<std::uint8_t>(state_of[current]);
+                states[static_cast<std::size_t>(state_of[index])][nibble] = t;
+            }
+        }
+    }
+};
+
+const huffman_decode_table &decode_table()
+{
+    static const huffman_decode_table table{};
+    return table;
+}
+
+void encode_integer(std::string &out, const std::uint64_t value, const int prefix_bits, const std::uint8_t first_byte)
+{
+    const std::uint64_t max_prefix{(std::uint64_t{1} << prefix_bits) - 1};
+    if (value < max_prefix)
+    {
+        out.push_back(static_cast<char>(first_byte | value));
+        return;
+    }
+    out.push_back(static_cast<char>(first_byte | max_prefix));
+    auto remaining{value - max_prefix};
+    while (remaining >= 128)
+    {
+        out.push_back(static_cast<char>((remaining & 0x7f) | 0x80));
+        remaining >>= 7;
+    }
+    out.push_back(static_cast<char>(remaining));
+}
+
+std::uint64_t decode_integer(const std::uint8_t *&pos, const std::uint8_t *const end, const int prefix_bits)
+{
+    const std::uint64_t max_prefix{(std::uint64_t{1} << prefix_bits) - 1};
+    std::uint64_t value{*pos++ & max_prefix};
+    if (value < max_prefix)
+    {
+        return value;
+    }
+    for (int shift{};; shift += 7)
+    {
+        if (pos == end || shift > 28)
+        {
+            throw connection_error{error_code::compression_error, "malformed HPACK integer"};
+        }
+        const auto byte{*pos++};
+        value += std::uint64_t{byte & 0x7fu} << shift;
+        if (!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+}
+
+void encode_string(std::string &out, const std::string_view value)
+{
+    const auto huffman_size{huffman::encoded_size(value)};
+    if (huffman_size < value.size())
+    {
+        encode_integer(out, huffman_size, 7, 0x80);
+        huffman::encode(value, out);
+        return;
+    }
+    encode_integer(out, value.size(), 7, 0x00);
+    out.append(value);
+}
+
+std::string decode_string(const std::uint8_t *&pos, const std::uint8_t *const end)
+{
+    if (pos == end)
+    {
+        throw connection_error{error_code::compression_error, "truncated HPACK string"};
+    }
+    const bool huffman_encoded{(*pos & 0x80) != 0};
+    const auto length{decode_integer(pos, end, 7)};
+    if (length > static_cast<std::uint64_t>(end - pos))
+    {
+        throw connection_error{error_code::compression_error, "truncated HPACK string"};
+    }
+    std::string result{};
+    if (huffman_encoded)
+    {
+        if (!huffman::decode({pos, static_cast<std::size_t>(length)}, result))
+        {
+            throw connection_error{error_code::compression_error, "malformed Huffman string"};
+        }
+    }
+    else
+    {
+        result.assign(reinterpret_cast<const char *>(pos), static_cast<std::size_t>(length));
+    }
+    pos += length;
+    return result;
+}
+} // namespace
+
+namespace lpbackend::networking::http2
+{
+namespace huffman
+{
+void encode(const std::string_view input, std::string &out)
+{
+    std::uint64_t bits{};
+    int bit_count{};
+    for (const auto c : input)
+    {
+        const auto [code, length]{huffman_codes[static_cast<std::uint8_t>(c)]};
+        bits = (bits << length) | code;
+        bit_count += length;
+        while (bit_count >= 8)
+        {
+            bit_count -= 8;
+            out.push_back(static_cast<char>((bits >> bit_count) & 0xff));
+        }
+        bits &= (std::uint64_t{1} << bit_count) - 1;
+    }
+    if (bit_count > 0)
+    {
+        // pad with the most significant bits of EOS
+        out.push_back(static_cast<char>(((bits << (8 - bit_count)) | (0xffu >> bit_count)) & 0xff));
+    }
+}
+
+std::size_t encoded_size(const std::string_view input) noexcept
+{
+    std::size_t bits{};
+    for (const auto c : input)
+    {
+        bits += huffman_codes[static_cast<std::uint8_t>(c)].second;
+    }
+    return (bits + 7) / 8;
+}
+
+bool decode(const std::span<const std::uint8_t> input, std::string &out)
+{
+    const auto &table{decode_table()};
+    auto state{table.root};
+    for (const auto byte : input)
+    {
+        for (const auto nibble : {byte >> 4, byte & 0xf})
+        {
+            const auto &t{table.states[state][static_cast<std::size_t>(nibble)]};
+            if (t.flags & huffman_decode_table::fail)
+            {
+                return false;
+            }
+            if (t.flags & huffman_decode_table::emit)
+            {
+                out.push_back(static_cast<char>(t.symbol));
+            }
+            state = t.next;
+        }
+    }
+    return table.accepting[state];
+}
+} // namespace huffman
+
+hpack_decoder::hpack_decoder(const std::size_t max_table_size, const std::size_t max_header_list_size)
+    : max_table_size_{max_table_size}, settings_table_size_{max_table_size},
+      max_header_list_size_{max_header_list_size}
+{
+}
+
+void hpack_decoder::evict(const std::size_t max_size)
+{
+    while (table_size_ > max_size && !table_.empty())
+    {
+        table_size_ -= table_.back().size();
+        table_.pop_back();
+    }
+}
+
+void hpack_decoder::insert(header_entry entry)
+{
+    const auto size{entry.size()};
+    if (size > max_table_size_)
+    {
+        evict(0);
+        return;
+    }
+    evict(max_table_size_ - size);
+    table_size_ += size;
+    table_.push_front(std::move(entry));
+}
+
+std::pair<std::string_view, std::string_view> hpack_decoder::lookup(const std::uint64_t index) const
+{
+    if (index == 0)
+    {
+        throw connection_error{error_code::compression_error, "HPACK index 0"};
+    }
+    if (index <= static_table.size())
+    {
+        return static_table[index - 1];
+    }
+    const auto dynamic_index{index - static_table.size() - 1};
+    if (dynamic_index >= table_.size())
+    {
+        throw connection_error{error_code::compression_error, "HPACK index out of range"};
+    }
+    const auto &entry{table_[dynamic_index]};
+    return {entry.name, entry.value};
+}
+
+void hpack_decoder::decode(const std::span<const std::uint8_t> block,
+                           const std::function<void(std::string_view, std::string_view)> &callback)
+{
+    const auto *pos{block.data()};
+    const auto *const end{block.data() + block.size()};
+    std::size_t list_size{};
+    bool fields_started{};
+
+    auto emit{[&](const std::string_view name, const std::string_view value) {
+        fields_started = true;
+        list_size += name.size() + value.size() + 32;
+        if (list_size > max_header_list_size_)
+        {
+            throw connection_error{error_code::enhance_your_calm, "header list too large"};
+        }
+        callback(name, value);
+    }};
+
+    while (pos != end)
+    {
+        const auto first{*pos};
+        if (first & 0x80) // indexed header field
+        {
+            const auto [name, value]{lookup(decode_integer(pos, end, 7))};
+            emit(name, value);
+        }
+        else if ((first & 0xc0) == 0x40) // literal header field with incremental indexing
+        {
+            const auto index{decode_integer(pos, end, 6)};
+            header_entry entry{};
+            entry.name = index ? std::string{lookup(index).first} : decode_string(pos, end);
+            entry.value = decode_string(pos, end);
+            emit(entry.name, entry.value);
+            insert(std::move(entry));
+        }
+        else if ((first & 0xe0) == 0x20) // dynamic table size update
+        {
+            if (fields_started)
+            {
+                throw connection_error{error_code::compression_error, "misplaced HPACK table size update"};
+            }
+            const auto size{decode_integer(pos, end, 5)};
+            if (size > settings_table_size_)
+            {
+                throw connection_error{error_code::compression_error, "HPACK table size update too large"};
+            }
+            max_table_size_ = static_cast<std::size_t>(size);
+            evict(max_table_size_);
+        }
+        else // literal header field without indexing or never indexed
+        {
+            const auto index{decode_integer(pos, end, 4)};
+            const auto name{index ? std::string{lookup(index).first} : decode_string(pos, end)};
+            const auto value{decode_string(pos, end)};
+            emit(name, value);
+        }
+    }
+}
+
+void hpack_encoder::evict(const std::size_t max_size)
+{
+    while (table_size_ > max_size && !table_.empty())
+    {
+        table_size_ -= table_.back().size();
+        table_.pop_back();
+    }
+}
+
+void hpack_encoder::max_table_size(const std::size_t size)
+{
+    // never grow beyond the default, a smaller table has to be announced
+    if (size >= max_table_size_)
+    {
+        return;
+    }
+    max_table_size_ = size;
+    evict(size);
+    pending_size_update_ = size_update_pending_ ? std::min(pending_size_update_, size) : size;
+    size_update_pending_ = true;
+}
+
+void hpack_encoder::begin_block(std::string &out)
+{
+    if (!size_update_pending_)
+    {
+        return;
+    }
+    if (pending_size_update_ < max_table_size_)
+    {
+        encode_integer(out, pending_size_update_, 5, 0x20);
+    }
+    encode_integer(out, max_table_size_, 5, 0x20);
+    size_update_pending_ = false;
+}
+
+void hpack_encoder::encode(const std::string_view name, const std::string_view value, std::string &out,
+                           const bool sensitive)
+{
+    std::uint64_t name_index{};
+    for (std::size_t i{}; i < static_table.size(); ++i)
+    {
+        if (static_table[i].first != name)
+        {
+            continue;
+        }
+        if (static_table[i].second == value && !sensitive)
+        {
+            encode_integer(out, i + 1, 7, 0x80);
+            return;
+        }
+        if (!name_index)
+        {
+            name_index = i + 1;
+        }
+    }
+    for (std::size_t i{}; i < table_.size(); ++i)
+    {
+        if (table_[i].name != name)
+        {
+            continue;
+        }
+        if (table_[i].value == value && !sensitive)
+        {
+            encode_integer(out, static_table.size() + i + 1, 7, 0x80);
+            return;
+        }
+        if (!name_index)
+        {
+            name_index = static_table.size() + i + 1;
+        }
+    }
+
+    if (sensitive)
+    {
+        encode_integer(out, name_index, 4, 0x10);
+    }
+    else if (std::ranges::find(unindexed_fields, name) != unindexed_fields.end() ||
+             name.size() + value.size() + 32 > max_table_size_ / 2)
+    {
+        encode_integer(out, name_index, 4, 0x00);
+    }
+    else
+    {
+        encode_integer(out, name_index, 6, 0x40);
+        header_entry entry{std::string{name}, std::string{value}};
+        evict(max_table_size_ - entry.size());
+        table_size_ += entry.size();
+        table_.push_front(std::move(entry));
+    }
+    if (!name_index)
+    {
+        encode_string(out, name);
+    }
+    encode_string(out, value);
+}
+} // namespace lpbackend::networking::http2
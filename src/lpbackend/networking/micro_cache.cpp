@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/networking/micro_cache.hpp>
+#include <lpbackend/util/codec.hpp>
+
+namespace lpbackend::networking
+{
+namespace
+{
+// a rough estimate of the list node and the index entry of a response besides its key and body
+constexpr std::size_t entry_overhead{192};
+} // namespace
+
+std::optional<std::string> micro_cache::canonical_target(const std::string_view target)
+{
+    auto key{util::normalize_path(target)};
+    const auto query_start{target.find('?')};
+    if (!key || query_start == std::string_view::npos)
+    {
+        return key;
+    }
+
+    // "?b=2&a=1" and "?a=1&&b=2" ask for the same
+    std::vector<std::string_view> parameters{};
+    for (auto query{target.substr(query_start + 1)}; !query.empty();)
+    {
+        const auto end{std::min(query.find('&'), query.size())};
+        if (end > 0)
+        {
+            parameters.push_back(query.substr(0, end));
+        }
+        query.remove_prefix(std::min(end + 1, query.size()));
+    }
+    std::ranges::sort(parameters);
+    for (std::size_t i{}; i < parameters.size(); ++i)
+    {
+        key->push_back(i == 0 ? '?' : '&');
+        key->append(parameters[i]);
+    }
+    return key;
+}
+
+micro_cache::~micro_cache()
+{
+    close();
+}
+
+void micro_cache::close()
+{
+    std::vector<std::pair<std::string, std::shared_ptr<flight>>> pending{};
+    {
+        std::lock_guard lock{mutex_};
+        for (auto &[key, remaining] : flights_)
+        {
+            pending.emplace_back(key, remaining);
+        }
+    }
+    const auto error{std::make_exception_ptr(boost::system::system_error{boost::asio::error::operation_aborted})};
+    for (const auto &[key, remaining] : pending)
+    {
+        abandon(key, remaining, error);
+    }
+}
+
+void micro_cache::configure(const config::lpbackend_config::fields_t::http_t &http)
+{
+    std::lock_guard lock{mutex_};
+    max_memory_ = static_cast<std::size_t>(http.api_cache_memory_bytes);
+}
+
+void micro_cache::erase(const std::list<entry>::iterator it)
+{
+    memory_ -= it->charge;
+    index_.erase(it->key);
+    entries_.erase(it);
+    memory::set_usage(memory::tag::api_cache, memory_);
+}
+
+micro_cache::claim micro_cache::acquire(const std::string &key, const policy &route)
+{
+    const auto now{clock_type::now()};
+    std::lock_guard lock{mutex_};
+    if (const auto it{index_.find(key)}; it != index_.end())
+    {
+        const auto &cached{*it->second};
+        if (now < cached.fresh_until)
+        {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return claim{.kind = outcome::hit, .response = cached.response};
+        }
+        if (now < cached.stale_until)
+        {
+            stale_hits_.fetch_add(1, std::memory_order_relaxed);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            if (flights_.contains(key))
+            {
+                return claim{.kind = outcome::stale, .response = cached.response};
+            }
+            revalidations_.fetch_add(1, std::memory_order_relaxed);
+            auto pending{std::make_shared<flight>(flight{.deadline = now + route.timeout})};
+            flights_.emplace(key, pending);
+            return claim{.kind = outcome::revalidate, .response = cached.response, .pending = std::move(pending)};
+        }
+        erase(it->second);
+    }
+
+    if (const auto it{flights_.find(key)}; it != flights_.end())
+    {
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return claim{.kind = outcome::coalesce, .pending = it->second};
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto pending{std::make_shared<flight>(flight{.deadline = now + route.timeout})};
+    flights_.emplace(key, pending);
+    return claim{.kind = outcome::compute, .pending = std::move(pending)};
+}
+
+std::optional<std::uint64_t> micro_cache::wait(flight &pending, completion_type completion)
+{
+    std::unique_lock lock{mutex_};
+    if (!pending.done)
+    {
+        const auto id{pending.next_waiter++};
+        pending.waiters.emplace_back(id, std::move(completion));
+        return id;
+    }
+    auto error{pending.error};
+    auto response{pending.response};
+    lock.unlock();
+    completion(error, std::move(response));
+    return std::nullopt;
+}
+
+void micro_cache::cancel_wait(const std::string &key, const std::shared_ptr<flight> &pending,
+                              const std::uint64_t waiter)
+{
+    if (clock_type::now() >= pending->deadline)
+    {
+        abandon(key, pending, std::make_exception_ptr(boost::system::system_error{boost::asio::error::timed_out}));
+        return;
+    }
+
+    // the request went away, the others keep waiting
+    completion_type completion{};
+    {
+        std::lock_guard lock{mutex_};
+        const auto it{std::ranges::find(pending->waiters, waiter, [](const auto &w) { return w.first; })};
+        if (it == pending->waiters.end())
+        {
+            return;
+        }
+        completion = std::move(it->second);
+        pending->waiters.erase(it);
+    }
+    completion(std::make_exception_ptr(boost::system::system_error{boost::asio::error::operation_aborted}), nullptr);
+}
+
+void micro_cache::abandon(const std::string &key, const std::shared_ptr<flight> &pending,
+                          const std::exception_ptr error)
+{
+    std::vector<std::pair<std::uint64_t, completion_type>> waiters{};
+    {
+        std::lock_guard lock{mutex_};
+        if (const auto it{flights_.find(key)}; it != flights_.end() && it->second == pending)
+        {
+            flights_.erase(it);
+        }
+        if (pending->done)
+        {
+            return;
+        }
+        pending->done = true;
+        pending->error = error;
+        waiters = std::move(pending->waiters);
+    }
+    for (auto &[id, waiter] : waiters)
+    {
+        waiter(error, nullptr);
+    }
+}
+
+void micro_cache::complete(const std::string &key, const std::shared_ptr<flight> &pending, const policy &route,
+                           const std::exception_ptr error, result_type response)
+{
+    std::vector<std::pair<std::uint64_t, completion_type>> waiters{};
+    {
+        std::lock_guard lock{mutex_};
+        // a flight that timed out may have been replaced by a newer one
+        if (const auto it{flights_.find(key)}; it != flights_.end() && it->second == pending)
+        {
+            flights_.erase(it);
+        }
+        if (!pending->done)
+        {
+            pending->done = true;
+            pending->error = error;
+            pending->response = response;
+            waiters = std::move(pending->waiters);
+        }
+
+        // a stale response that failed to be revalidated is served until its window closes
+        const auto charge{2 * key.size() + (response ? response->content_type.size() + response->body.size() : 0) +
+                          entry_overhead};
+        if (error)
+        {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (route.ttl > clock_type::duration::zero() && charge <= max_memory_)
+        {
+            if (const auto it{index_.find(key)}; it != index_.end())
+            {
+                erase(it->second);
+            }
+            const auto now{clock_type::now()};
+            entries_.push_front(entry{.key = key,
+                                      .response = response,
+                                      .fresh_until = now + route.ttl,
+                                      .stale_until = now + route.ttl + route.stale_while_revalidate,
+                                      .charge = charge});
+            index_.emplace(entries_.front().key, entries_.begin());
+            memory_ += charge;
+            while (memory_ > max_memory_)
+            {
+                erase(std::prev(entries_.end()));
+            }
+            memory::set_usage(memory::tag::api_cache, memory_);
+        }
+    }
+    for (auto &[id, waiter] : waiters)
+    {
+        waiter(error, response);
+    }
+}
+
+void micro_cache::shrink()
+{
+    std::lock_guard lock{mutex_};
+    for (auto count{entries_.size() / 2}; count > 0; --count)
+    {
+        erase(std::prev(entries_.end()));
+    }
+}
+
+micro_cache::statistics micro_cache::collect()
+{
+    std::lock_guard lock{mutex_};
+    return statistics{.hits = hits_.exchange(0, std::memory_order_relaxed),
+                      .stale_hits = stale_hits_.exchange(0, std::memory_order_relaxed),
+                      .misses = misses_.exchange(0, std::memory_order_relaxed),
+                      .coalesced = coalesced_.exchange(0, std::memory_order_relaxed),
+                      .revalidations = revalidations_.exchange(0, std::memory_order_relaxed),
+                      .failures = failures_.exchange(0, std::memory_order_relaxed),
+                      .entries = entries_.size(),
+                      .memory = memory_};
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fmt/format.h>
+
+#include <lpbackend/networking/response_templates.hpp>
+
+namespace lpbackend::networking
+{
+std::string format_http_date(const std::chrono::system_clock::time_point time)
+{
+    static constexpr std::array<std::string_view, 7> weekdays{"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static constexpr std::array<std::string_view, 12> months{"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                                             "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    const auto seconds{std::chrono::floor<std::chrono::seconds>(time)};
+    const auto days{std::chrono::floor<std::chrono::days>(seconds)};
+    const std::chrono::year_month_day date{days};
+    const std::chrono::hh_mm_ss clock{seconds - days};
+    return fmt::format("{}, {:02} {} {:04} {:02}:{:02}:{:02} GMT",
+                       weekdays[std::chrono::weekday{days}.c_encoding()], static_cast<unsigned>(date.day()),
+                       months[static_cast<unsigned>(date.month()) - 1], static_cast<int>(date.year()),
+                       clock.hours().count(), clock.minutes().count(), clock.seconds().count());
+}
+
+std::string_view http_date()
+{
+    thread_local std::chrono::system_clock::time_point formatted{};
+    thread_local std::string date{};
+
+    const auto now{std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now())};
+    if (date.empty() || now != formatted)
+    {
+        formatted = now;
+        date = format_http_date(now);
+    }
+    return date;
+}
+
+response_templates::response_templates()
+{
+    const auto make_template{[this](const error kind, const boost::beast::http::status status,
+                                    const std::string_view body) -> string_response & {
+        auto &res{errors_[static_cast<std::size_t>(kind)]};
+        res.result(status);
+        res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(boost::beast::http::field::content_type, "text/html");
+        res.body() = body;
+        res.prepare_payload();
+        return res;
+    }};
+
+    make_template(error::unknown_method, boost::beast::http::status::bad_request, "Unknown HTTP-method");
+    make_template(error::illegal_target, boost::beast::http::status::bad_request, "Illegal request-target");
+    make_template(error::not_found, boost::beast::http::status::not_found, "The resource was not found.");
+    make_template(error::server_error, boost::beast::http::status::internal_server_error,
+                  "An internal error occurred.");
+    make_template(error::too_early, static_cast<boost::beast::http::status>(425),
+                  "The request may be replayed, retry after the TLS handshake.")
+        .reason("Too Early");
+    make_template(error::unauthorized, boost::beast::http::status::unauthorized, "Authorization required.")
+        .set(boost::beast::http::field::www_authenticate, "Bearer");
+    make_template(error::bad_request, boost::beast::http::status::bad_request, "Malformed request");
+    make_template(error::header_too_large, boost::beast::http::status::request_header_fields_too_large,
+                  "The request header is too large.");
+    make_template(error::body_too_large, boost::beast::http::status::payload_too_large,
+                  "The request body is too large.");
+
+    const auto make_header{[this](const content kind, const std::string_view content_type,
+                                  const std::string_view cache_control) {
+        auto &header{headers_[static_cast<std::size_t>(kind)]};
+        header.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
+        if (!content_type.empty())
+        {
+            header.set(boost::beast::http::field::content_type, content_type);
+        }
+        if (!cache_control.empty())
+        {
+            header.set(boost::beast::http::field::cache_control, cache_control);
+        }
+    }};
+
+    make_header(content::asset, {}, {});
+    make_header(content::json, "application/json", "no-store");
+    make_header(content::report, "text/plain; charset=utf-8", "no-store");
+    make_header(content::shared, {}, "no-cache");
+}
+
+string_response response_templates::make(const error kind, const unsigned version, const bool keep_alive) const
+{
+    auto res{errors_[static_cast<std::size_t>(kind)]};
+    finish_response(res, version, keep_alive);
+    return res;
+}
+
+boost::beast::http::response_header<> response_templates::header(const content kind,
+                                                                 const boost::beast::http::status status) const
+{
+    auto header{headers_[static_cast<std::size_t>(kind)]};
+    header.result(status);
+    return header;
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include <mimalloc.h>
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/networking/session_memory.hpp>
+
+namespace lpbackend::networking
+{
+namespace
+{
+// requests and their headers fit into pooled blocks, larger buffers are taken from mimalloc directly
+constexpr std::pmr::pool_options pool_options{.max_blocks_per_chunk = 16, .largest_required_pool_block = 16384};
+
+std::atomic<std::uint64_t> closed_sessions{};
+std::atomic<std::uint64_t> total_peak{};
+std::atomic<std::size_t> max_peak{};
+} // namespace
+
+void *session_memory::upstream_resource::do_allocate(const std::size_t bytes, const std::size_t alignment)
+{
+    auto *const pointer{mi_malloc_aligned(bytes, alignment)};
+    if (!pointer)
+    {
+        throw std::bad_alloc{};
+    }
+    allocated_ += bytes;
+    peak_ = std::max(peak_, allocated_);
+    memory::account(memory::tag::sessions, static_cast<std::int64_t>(bytes));
+    return pointer;
+}
+
+void session_memory::upstream_resource::do_deallocate(void *const pointer, const std::size_t bytes,
+                                                      const std::size_t)
+{
+    mi_free(pointer);
+    allocated_ -= bytes;
+    memory::account(memory::tag::sessions, -static_cast<std::int64_t>(bytes));
+}
+
+bool session_memory::upstream_resource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+session_memory::session_memory() : pool_{pool_options, &upstream_}
+{
+}
+
+session_memory::~session_memory()
+{
+    // the pool returns its chunks to the upstream resource when it is destroyed after this
+    const auto peak{upstream_.peak()};
+    closed_sessions.fetch_add(1, std::memory_order_relaxed);
+    total_peak.fetch_add(peak, std::memory_order_relaxed);
+    auto current{max_peak.load(std::memory_order_relaxed)};
+    while (current < peak && !max_peak.compare_exchange_weak(current, peak, std::memory_order_relaxed))
+    {
+    }
+}
+
+session_allocator session_memory::get_allocator() noexcept
+{
+    return session_allocator{&pool_};
+}
+
+std::size_t session_memory::allocated() const noexcept
+{
+    return upstream_.allocated();
+}
+
+std::size_t session_memory::peak() const noexcept
+{
+    return upstream_.peak();
+}
+
+session_memory::statistics session_memory::collect()
+{
+    const auto sessions{closed_sessions.exchange(0, std::memory_order_relaxed)};
+    const auto peaks{total_peak.exchange(0, std::memory_order_relaxed)};
+    return statistics{
+        .sessions = sessions,
+        .average_peak = sessions ? static_cast<std::size_t>(peaks / sessions) : 0,
+        .max_peak = max_peak.exchange(0, std::memory_order_relaxed),
+        .in_use = memory::usage(memory::tag::sessions),
+    };
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cxx_detect.h>
+
+#if !CXX_OS_WINDOWS
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <fmt/format.h>
+
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include <lpbackend/networking/tls_session_manager.hpp>
+#include <lpbackend/storage/file_io.hpp>
+
+namespace
+{
+constexpr std::array<char, 4> key_file_magic{'L', 'P', 'T', 'K'};
+constexpr unsigned char session_id_context[]{"lpbackend"};
+
+int ex_data_index()
+{
+    static const int index{SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr)};
+    return index;
+}
+
+std::uint64_t mix(std::uint64_t value) noexcept
+{
+    // splitmix64 finalizer
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+std::int64_t unix_now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
+namespace lpbackend::networking
+{
+int tls_session_manager::ticket_key_callback(SSL *ssl, unsigned char *key_name, unsigned char *iv,
+                                             EVP_CIPHER_CTX *cipher_ctx, EVP_MAC_CTX *mac_ctx, const int encrypt)
+{
+    auto *self{static_cast<tls_session_manager *>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ex_data_index()))};
+    return self->handle_ticket_key(key_name, iv, cipher_ctx, mac_ctx, encrypt != 0);
+}
+
+int tls_session_manager::handle_ticket_key(unsigned char *key_name, unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx,
+                                           EVP_MAC_CTX *mac_ctx, const bool encrypt)
+{
+    std::shared_lock lock{mutex_};
+    const ticket_key *key{};
+    bool current{};
+    if (encrypt)
+    {
+        if (keys_.empty() || RAND_bytes(iv, EVP_MAX_IV_LENGTH) != 1)
+        {
+            return -1;
+        }
+        key = &keys_.back();
+        current = true;
+        std::memcpy(key_name, key->name.data(), key->name.size());
+    }
+    else
+    {
+        const auto it{std::ranges::find_if(keys_, [key_name](const ticket_key &candidate) {
+            return std::memcmp(candidate.name.data(), key_name, candidate.name.size()) == 0;
+        })};
+        if (it == keys_.end())
+        {
+            // unknown or expired key, fall back to a full handshake
+            return 0;
+        }
+        key = &*it;
+        current = key == &keys_.back();
+    }
+
+    OSSL_PARAM params[]{
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<std::uint8_t *>(key->hmac_key.data()),
+                                          key->hmac_key.size()),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char *>("SHA256"), 0),
+        OSSL_PARAM_construct_end()};
+    if (EVP_MAC_CTX_set_params(mac_ctx, params) != 1)
+    {
+        return -1;
+    }
+    const auto initialized{encrypt ? EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key->aes_key.data(), iv)
+                                   : EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key->aes_key.data(), iv)};
+    if (initialized != 1)
+    {
+        return -1;
+    }
+    // tickets of older keys are accepted but renewed with the current key
+    return current ? 1 : 2;
+}
+
+int tls_session_manager::allow_early_data_callback(SSL *ssl, void *arg)
+{
+    return static_cast<tls_session_manager *>(arg)->first_seen(ssl) ? 1 : 0;
+}
+
+bool tls_session_manager::first_seen(const SSL *ssl)
+{
+    // a replayed ClientHello carries the random of the original one
+    std::array<std::uint8_t, SSL3_RANDOM_SIZE> client_random{};
+    SSL_get_client_random(ssl, client_random.data(), client_random.size());
+    std::array<std::size_t, replay_filter_hashes> bits{};
+    for (std::size_t i{}; i < bits.size(); ++i)
+    {
+        std::uint64_t word{};
+        std::memcpy(&word, client_random.data() + i * sizeof(word), sizeof(word));
+        bits[i] = static_cast<std::size_t>(mix(word ^ replay_salt_[i]) % replay_filter_bits);
+    }
+
+    std::lock_guard lock{replay_mutex_};
+    const auto now{std::chrono::steady_clock::now()};
+    if (now - replay_generation_start_ >= replay_window)
+    {
+        replay_generation_ ^= 1;
+        std::ranges::fill(replay_filters_[replay_generation_], 0);
+        replay_generation_start_ = now;
+    }
+
+    const auto contains{[&bits](const std::vector<std::uint64_t> &filter) {
+        return std::ranges::all_of(bits, [&filter](const std::size_t bit) {
+            return (filter[bit / 64] >> (bit % 64)) & 1;
+        });
+    }};
+    if (contains(replay_filters_[0]) || contains(replay_filters_[1]))
+    {
+        early_data_replays_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    for (const auto bit : bits)
+    {
+        replay_filters_[replay_generation_][bit / 64] |= std::uint64_t{1} << (bit % 64);
+    }
+    return true;
+}
+
+void tls_session_manager::configure_early_data(SSL_CTX *ctx, const std::uint64_t max_early_data)
+{
+    if (RAND_bytes(reinterpret_cast<unsigned char *>(replay_salt_.data()),
+                   static_cast<int>(replay_salt_.size() * sizeof(std::uint64_t))) != 1)
+    {
+        throw std::runtime_error{"failed to generate anti-replay salt"};
+    }
+    for (auto &filter : replay_filters_)
+    {
+        filter.assign(replay_filter_bits / 64, 0);
+    }
+    replay_generation_start_ = std::chrono::steady_clock::now();
+
+    // the built-in protection makes tickets single use by turning them
+    // stateful, which would bypass the rotating ticket keys
+    SSL_CTX_set_options(ctx, SSL_OP_NO_ANTI_REPLAY);
+    if (SSL_CTX_set_max_early_data(ctx, static_cast<std::uint32_t>(max_early_data)) != 1 ||
+        SSL_CTX_set_recv_max_early_data(ctx, static_cast<std::uint32_t>(max_early_data)) != 1)
+    {
+        throw std::runtime_error{"failed to configure TLS early data"};
+    }
+    SSL_CTX_set_allow_early_data_cb(ctx, allow_early_data_callback, this);
+    LPBACKEND_LOG(lg_, info) << fmt::format("TLS 1.3 early data enabled for up to {} bytes", max_early_data);
+}
+
+tls_session_manager::ticket_key tls_session_manager::generate_key() const
+{
+    ticket_key key{.created = unix_now()};
+    if (RAND_bytes(key.name.data(), static_cast<int>(key.name.size())) != 1 ||
+        RAND_bytes(key.hmac_key.data(), static_cast<int>(key.hmac_key.size())) != 1 ||
+        RAND_bytes(key.aes_key.data(), static_cast<int>(key.aes_key.size())) != 1)
+    {
+        throw std::runtime_error{"failed to generate session ticket key"};
+    }
+    return key;
+}
+
+bool tls_session_manager::current_key_expired(const std::int64_t now) const noexcept
+{
+    return keys_.empty() || now - keys_.back().created >= rotation_interval_.count();
+}
+
+void tls_session_manager::drop_expired_keys(const std::int64_t now)
+{
+    // a key decrypts tickets for a whole session lifetime after it was replaced
+    const auto max_age{rotation_interval_.count() + session_timeout_.count()};
+    while (keys_.size() > 1 && now - keys_.front().created >= max_age)
+    {
+        keys_.pop_front();
+    }
+}
+
+void tls_session_manager::load_keys()
+{
+    if (key_file_.empty() || !std::filesystem::exists(key_file_))
+    {
+        return;
+    }
+
+    std::ifstream file_stream{key_file_, std::ios::binary};
+    std::array<char, key_file_magic.size()> magic{};
+    file_stream.read(magic.data(), magic.size());
+    if (!file_stream || magic != key_file_magic)
+    {
+        LPBACKEND_LOG(lg_, warning) << fmt::format("Ignoring malformed session ticket key file {}",
+                                                   key_file_.string());
+        return;
+    }
+
+    std::deque<ticket_key> keys{};
+    for (;;)
+    {
+        ticket_key key{};
+        std::array<std::uint8_t, 8> created{};
+        file_stream.read(reinterpret_cast<char *>(created.data()), created.size());
+        file_stream.read(reinterpret_cast<char *>(key.name.data()), key.name.size());
+        file_stream.read(reinterpret_cast<char *>(key.hmac_key.data()), key.hmac_key.size());
+        file_stream.read(reinterpret_cast<char *>(key.aes_key.data()), key.aes_key.size());
+        if (!file_stream)
+        {
+            break;
+        }
+        std::uint64_t value{};
+        for (const auto byte : created)
+        {
+            value = (value << 8) | byte;
+        }
+        key.created = static_cast<std::int64_t>(value);
+        keys.push_back(key);
+    }
+    std::ranges::sort(keys, {}, &ticket_key::created);
+    keys_ = std::move(keys);
+    LPBACKEND_LOG(lg_, info) << fmt::format("Loaded {} session ticket keys from {}", keys_.size(), key_file_.string());
+}
+
+void tls_session_manager::save_keys(const std::deque<ticket_key> &keys) const
+{
+    if (key_file_.empty())
+    {
+        return;
+    }
+
+    std::string content{key_file_magic.data(), key_file_magic.size()};
+    for (const auto &key : keys)
+    {
+        for (std::size_t i{}; i < 8; ++i)
+        {
+            content.push_back(static_cast<char>(static_cast<std::uint64_t>(key.created) >> (56 - 8 * i)));
+        }
+        content.append(reinterpret_cast<const char *>(key.name.data()), key.name.size());
+        content.append(reinterpret_cast<const char *>(key.hmac_key.data()), key.hmac_key.size());
+        content.append(reinterpret_cast<const char *>(key.aes_key.data()), key.aes_key.size());
+    }
+
+    // replace the file atomically so a crash never leaves a truncated key file
+    auto temp_path{key_file_};
+    temp_path += ".tmp";
+    boost::system::error_code ec{};
+    {
+        boost::beast::file file{};
+#if CXX_OS_WINDOWS
+        file.open(temp_path.string().c_str(), boost::beast::file_mode::write, ec);
+#else
+        // the keys decrypt every ticket issued with them, so the file is never readable by anyone else, not even
+        // before it is written
+        std::filesystem::remove(temp_path);
+        if (const auto fd{::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR)};
+            fd == -1)
+        {
+            ec.assign(errno, boost::system::generic_category());
+        }
+        else
+        {
+            file.native_handle(fd);
+        }
+#endif
+        if (!ec)
+        {
+            storage::write_at(file, 0, content, ec);
+        }
+        if (!ec)
+        {
+            storage::sync_file(file, ec);
+        }
+    }
+    if (ec)
+    {
+        std::error_code ignored{};
+        std::filesystem::remove(temp_path, ignored);
+        throw std::runtime_error{fmt::format("failed to write {}: {}", temp_path.string(), ec.message())};
+    }
+    std::filesystem::rename(temp_path, key_file_);
+}
+
+void tls_session_manager::configure(SSL_CTX *ctx, const config::lpbackend_config::fields_t::ssl_t &config)
+{
+    key_file_ = config.ticket_key_file;
+    rotation_interval_ = std::chrono::seconds{std::max<std::uint64_t>(config.ticket_key_rotation_seconds, 1)};
+    session_timeout_ = std::chrono::seconds{config.session_timeout_seconds};
+
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, static_cast<long>(config.session_cache_size));
+    SSL_CTX_set_timeout(ctx, static_cast<long>(config.session_timeout_seconds));
+    if (SSL_CTX_set_session_id_context(ctx, session_id_context, sizeof(session_id_context) - 1) != 1 ||
+        SSL_CTX_set_ex_data(ctx, ex_data_index(), this) != 1)
+    {
+        throw std::runtime_error{"failed to configure the TLS session cache"};
+    }
+
+    if (config.early_data)
+    {
+        configure_early_data(ctx, config.max_early_data_bytes);
+    }
+
+    if (!config.session_tickets)
+    {
+        // TLS 1.3 resumes from the session cache instead
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        LPBACKEND_LOG(lg_, info) << fmt::format("TLS session cache enabled for {} sessions, tickets disabled",
+                                                config.session_cache_size);
+        return;
+    }
+
+    if (!key_file_.empty())
+    {
+        create_directories(key_file_.parent_path());
+    }
+    load_keys();
+    rotate();
+    if (SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, ticket_key_callback) != 1)
+    {
+        throw std::runtime_error{"failed to install the session ticket key callback"};
+    }
+    LPBACKEND_LOG(lg_, info) << fmt::format(
+        "TLS session cache enabled for {} sessions, ticket keys rotate every {}s", config.session_cache_size,
+        rotation_interval_.count());
+}
+
+bool tls_session_manager::rotate()
+{
+    const auto now{unix_now()};
+    std::deque<ticket_key> keys{};
+    {
+        std::unique_lock lock{mutex_};
+        if (!current_key_expired(now))
+        {
+            return false;
+        }
+        keys_.push_back(generate_key());
+        drop_expired_keys(now);
+        // handshakes must not wait for the disk
+        keys = keys_;
+    }
+    LPBACKEND_LOG(lg_, info) << fmt::format("Rotated session ticket key, {} keys accepted", keys.size());
+
+    try
+    {
+        save_keys(keys);
+    }
+    catch (const std::exception &e)
+    {
+        // resumption keeps working until the next restart
+        LPBACKEND_LOG(lg_, error) << fmt::format("Failed to persist session ticket keys: {}", e.what());
+    }
+    return true;
+}
+
+std::chrono::seconds tls_session_manager::rotation_interval() const noexcept
+{
+    return rotation_interval_;
+}
+
+void tls_session_manager::record_handshake(const SSL *ssl) noexcept
+{
+    if (SSL_get_early_data_status(ssl) == SSL_EARLY_DATA_ACCEPTED)
+    {
+        early_data_accepted_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (SSL_session_reused(ssl))
+    {
+        resumed_handshakes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        full_handshakes_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t tls_session_manager::full_handshakes() const noexcept
+{
+    return full_handshakes_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t tls_session_manager::resumed_handshakes() const noexcept
+{
+    return resumed_handshakes_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t tls_session_manager::early_data_accepted() const noexcept
+{
+    return early_data_accepted_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t tls_session_manager::early_data_replays() const noexcept
+{
+    return early_data_replays_.load(std::memory_order_relaxed);
+}
+} // namespace lpbackend::networking
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/render/fragment_cache.hpp>
+
+namespace lpbackend::render
+{
+namespace
+{
+// a rough estimate of the list node, the index entries and the tag sets of a fragment besides its HTML
+constexpr std::size_t entry_overhead{160};
+constexpr std::size_t tag_overhead{64};
+// the sketch has a counter per this many bytes of the cap, within the bounds below
+constexpr std::size_t sketch_bytes_per_counter{2048};
+constexpr std::size_t min_sketch_counters{1024};
+constexpr std::size_t max_sketch_counters{1 << 22};
+// counts are halved once this many accesses per counter were recorded
+constexpr std::size_t sketch_sample_factor{10};
+
+std::uint64_t mix(std::uint64_t x) noexcept
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+} // namespace
+
+std::size_t fragment_cache::key_hash::operator()(const key &k) const noexcept
+{
+    return static_cast<std::size_t>(mix(k.post * 0x9e3779b97f4a7c15 + k.revision));
+}
+
+std::size_t fragment_cache::tag_hash::operator()(const fragment_tag &tag) const noexcept
+{
+    return static_cast<std::size_t>(mix(tag.id * 4 + static_cast<std::uint64_t>(tag.type)));
+}
+
+void fragment_cache::configure(const config::lpbackend_config::fields_t::http_t &http)
+{
+    std::lock_guard lock{mutex_};
+    max_memory_ = static_cast<std::size_t>(http.fragment_cache_memory_bytes);
+    sketch_.assign(max_memory_ ? std::bit_ceil(std::clamp(max_memory_ / sketch_bytes_per_counter,
+                                                          min_sketch_counters, max_sketch_counters))
+                               : 0,
+                   0);
+    sketch_additions_ = 0;
+}
+
+void fragment_cache::record_access(const key &k)
+{
+    if (sketch_.empty())
+    {
+        return;
+    }
+    // four counters per key from two hashes, the smallest one is the estimate
+    const auto hash{mix(key_hash{}(k))};
+    const auto mask{sketch_.size() - 1};
+    for (std::uint64_t i{}; i < 4; ++i)
+    {
+        auto &counter{sketch_[static_cast<std::size_t>(hash + i * (hash >> 32 | 1)) & mask]};
+        if (counter < max_frequency)
+        {
+            ++counter;
+        }
+    }
+    if (++sketch_additions_ >= sketch_.size() * sketch_sample_factor)
+    {
+        // ages the counts, so posts that were popular once give way to the current ones
+        for (auto &counter : sketch_)
+        {
+            counter >>= 1;
+        }
+        sketch_additions_ = 0;
+    }
+}
+
+std::uint8_t fragment_cache::frequency(const key &k) const
+{
+    if (sketch_.empty())
+    {
+        return 0;
+    }
+    const auto hash{mix(key_hash{}(k))};
+    const auto mask{sketch_.size() - 1};
+    std::uint8_t estimate{max_frequency};
+    for (std::uint64_t i{}; i < 4; ++i)
+    {
+        estimate = std::min(estimate, sketch_[static_cast<std::size_t>(hash + i * (hash >> 32 | 1)) & mask]);
+    }
+    return estimate;
+}
+
+bool fragment_cache::invalidated_since(const std::uint64_t ticket, const std::span<const fragment_tag> tags) const
+{
+    if (epoch_ - ticket > recent_invalidations)
+    {
+        return true;
+    }
+    for (auto epoch{ticket + 1}; epoch <= epoch_; ++epoch)
+    {
+        if (std::ranges::find(tags, invalidations_[epoch % recent_invalidations]) != tags.end())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void fragment_cache::erase(const std::list<entry>::iterator it)
+{
+    for (const auto &tag : it->tags)
+    {
+        if (const auto tagged{tagged_.find(tag)}; tagged != tagged_.end())
+        {
+            tagged->second.erase(it->id);
+            if (tagged->second.empty())
+            {
+                tagged_.erase(tagged);
+            }
+        }
+    }
+    memory_ -= it->charge;
+    index_.erase(it->id);
+    entries_.erase(it);
+    memory::set_usage(memory::tag::fragment_cache, memory_);
+}
+
+fragment_cache::lookup fragment_cache::find(const std::uint64_t post, const std::uint64_t revision)
+{
+    const key k{post, revision};
+    std::lock_guard lock{mutex_};
+    record_access(k);
+    const auto it{index_.find(k)};
+    if (it == index_.end())
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return lookup{.html = nullptr, .ticket = epoch_};
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return lookup{.html = it->second->html, .ticket = epoch_};
+}
+
+std::shared_ptr<const std::string> fragment_cache::insert(const std::uint64_t post, const std::uint64_t revision,
+                                                          std::string html, const std::span<const fragment_tag> tags,
+                                                          const std::uint64_t ticket)
+{
+    const key k{post, revision};
+    std::vector<fragment_tag> all_tags{};
+    all_tags.reserve(tags.size() + 1);
+    all_tags.push_back(fragment_tag{.type = fragment_tag::kind::post, .id = post});
+    for (const auto &tag : tags)
+    {
+        if (std::ranges::find(all_tags, tag) == all_tags.end())
+        {
+            all_tags.push_back(tag);
+        }
+    }
+    const auto charge{html.size() + entry_overhead + all_tags.size() * tag_overhead};
+    auto shared{std::make_shared<const std::string>(std::move(html))};
+
+    std::lock_guard lock{mutex_};
+    if (invalidated_since(ticket, all_tags))
+    {
+        stale_.fetch_add(1, std::memory_order_relaxed);
+        return shared;
+    }
+    if (const auto it{index_.find(k)}; it != index_.end())
+    {
+        // rendered concurrently by another request
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->html;
+    }
+    // a single fragment may not take more than an eighth of the cache
+    if (charge > max_memory_ / 8)
+    {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return shared;
+    }
+    if (memory_ + charge > max_memory_ && !entries_.empty() && frequency(k) <= frequency(entries_.back().id))
+    {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return shared;
+    }
+    while (memory_ + charge > max_memory_ && !entries_.empty())
+    {
+        erase(std::prev(entries_.end()));
+        evicted_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    entries_.push_front(entry{.id = k, .html = shared, .tags = std::move(all_tags), .charge = charge});
+    index_.emplace(k, entries_.begin());
+    for (const auto &tag : entries_.front().tags)
+    {
+        tagged_[tag].insert(k);
+    }
+    memory_ += charge;
+    admitted_.fetch_add(1, std::memory_order_relaxed);
+    memory::set_usage(memory::tag::fragment_cache, memory_);
+    return shared;
+}
+
+std::size_t fragment_cache::invalidate(const fragment_tag tag)
+{
+    std::lock_guard lock{mutex_};
+    ++epoch_;
+    invalidations_[epoch_ % recent_invalidations] = tag;
+    const auto tagged{tagged_.find(tag)};
+    if (tagged == tagged_.end())
+    {
+        return 0;
+    }
+    // erase() modifies the set that is iterated
+    const std::vector<key> keys(tagged->second.begin(), tagged->second.end());
+    for (const auto &k : keys)
+    {
+        erase(index_.at(k));
+    }
+    invalidated_.fetch_add(keys.size(), std::memory_order_relaxed);
+    return keys.size();
+}
+
+void fragment_cache::shrink()
+{
+    std::lock_guard lock{mutex_};
+    for (auto count{entries_.size() / 2}; count > 0; --count)
+    {
+        erase(std::prev(entries_.end()));
+        evicted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+fragment_cache::statistics fragment_cache::collect()
+{
+    std::lock_guard lock{mutex_};
+    return statistics{.hits = hits_.exchange(0, std::memory_order_relaxed),
+                      .misses = misses_.exchange(0, std::memory_order_relaxed),
+                      .admitted = admitted_.exchange(0, std::memory_order_relaxed),
+                      .rejected = rejected_.exchange(0, std::memory_order_relaxed),
+                      .stale = stale_.exchange(0, std::memory_order_relaxed),
+                      .evicted = evicted_.exchange(0, std::memory_order_relaxed),
+                      .invalidated = invalidated_.exchange(0, std::memory_order_relaxed),
+                      .entries = entries_.size(),
+                      .memory = memory_};
+}
+} // namespace lpbackend::render
@@ -0,0 +1,1422 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include <boost/beast.hpp>
+#include <boost/crc.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fmt/format.h>
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/search/full_text_index.hpp>
+#include <lpbackend/search/postings.hpp>
+#include <lpbackend/search/tokenizer.hpp>
+#include <lpbackend/storage/file_io.hpp>
+
+namespace lpbackend::search
+{
+namespace
+{
+constexpr std::string_view segment_magic{"LPSEARCH"};
+constexpr std::uint32_t format_version{1};
+constexpr std::uint32_t segment_merged{1 << 0};
+// magic, version, flags, id and the lowest id the segment replaces
+constexpr std::uint64_t header_size{32};
+// offsets of the documents and the terms, their counts, a reserved word and the checksum
+constexpr std::uint64_t footer_size{32};
+// id, length and flags
+constexpr std::uint64_t document_entry_size{16};
+constexpr std::uint32_t document_tombstone{1 << 0};
+constexpr std::uint32_t no_document{0xffffffff};
+// segment files are written in chunks of this size
+constexpr std::size_t write_chunk_bytes{1 << 20};
+constexpr std::size_t merge_width{4};
+constexpr std::uint32_t title_weight{3};
+constexpr double bm25_k1{1.2};
+constexpr double bm25_b{0.75};
+// rough estimates of a buffered posting and of a buffered term besides its text
+constexpr std::int64_t posting_overhead{8};
+constexpr std::int64_t term_overhead{96};
+
+std::uint32_t load32(const char *in) noexcept
+{
+    std::uint32_t value{};
+    for (std::size_t i{4}; i-- > 0;)
+    {
+        value = value << 8 | static_cast<unsigned char>(in[i]);
+    }
+    return value;
+}
+
+std::uint64_t load64(const char *in) noexcept
+{
+    return load32(in) | static_cast<std::uint64_t>(load32(in + 4)) << 32;
+}
+
+void append32(std::string &out, const std::uint32_t value)
+{
+    for (std::size_t i{}; i < 4; ++i)
+    {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void append64(std::string &out, const std::uint64_t value)
+{
+    append32(out, static_cast<std::uint32_t>(value));
+    append32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+void append_varint(std::string &out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+std::uint64_t read_varint(const std::string_view data, std::size_t &offset)
+{
+    std::uint64_t value{};
+    for (unsigned shift{}; shift < 64 && offset < data.size(); shift += 7)
+    {
+        const auto byte{static_cast<unsigned char>(data[offset++])};
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    throw std::runtime_error{"Malformed term table"};
+}
+
+struct string_hash
+{
+    using is_transparent = void;
+
+    std::size_t operator()(const std::string_view text) const noexcept
+    {
+        return std::hash<std::string_view>{}(text);
+    }
+};
+
+struct query_term
+{
+    std::string text;
+    double idf;
+};
+
+// orders hits best first, the heap of the best hits keeps the worst on top
+bool better(const full_text_index::hit &a, const full_text_index::hit &b) noexcept
+{
+    return a.score > b.score || (a.score == b.score && a.id < b.id);
+}
+
+using top_hits = std::priority_queue<full_text_index::hit, std::vector<full_text_index::hit>, decltype(&better)>;
+
+double bm25(const double idf, const std::uint32_t frequency, const std::uint32_t length,
+            const double average_length) noexcept
+{
+    const auto tf{static_cast<double>(frequency)};
+    return idf * tf * (bm25_k1 + 1) / (tf + bm25_k1 * (1 - bm25_b + bm25_b * length / average_length));
+}
+} // namespace
+
+class full_text_index::segment
+{
+  public:
+    struct document
+    {
+        std::uint64_t id;
+        std::uint32_t length;
+        bool tombstone;
+    };
+
+    // the postings of one term, buffered in memory or compressed in a file
+    struct postings
+    {
+        std::size_t count{};
+        std::span<const std::uint32_t> documents;
+        std::span<const std::uint32_t> frequencies;
+        std::optional<posting_reader> reader;
+
+        std::size_t block_count() const noexcept
+        {
+            return reader ? reader->block_count() : (count + posting_block_size - 1) / posting_block_size;
+        }
+
+        std::uint32_t block_last(const std::size_t i) const noexcept
+        {
+            return reader ? reader->block_last(i) : documents[std::min(count, (i + 1) * posting_block_size) - 1];
+        }
+
+        // the highest score a document of block i can get for the term, buffered postings keep no bounds
+        double block_bound(const std::size_t i, const double idf, const double average_length) const noexcept
+        {
+            if (!reader)
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            return bm25(idf, reader->block_max_frequency(i), reader->block_min_length(i), average_length);
+        }
+
+        double bound(const double idf, const double average_length) const noexcept
+        {
+            if (!reader)
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            return bm25(idf, reader->max_frequency(), reader->min_length(), average_length);
+        }
+
+        // points documents and frequencies at block i, compressed blocks are decoded into the buffers
+        std::size_t load(const std::size_t i, std::uint32_t *document_buffer, std::uint32_t *frequency_buffer,
+                         const std::uint32_t *&block_documents, const std::uint32_t *&block_frequencies) const
+        {
+            if (reader)
+            {
+                block_documents = document_buffer;
+                block_frequencies = frequency_buffer;
+                return reader->decode(i, document_buffer, frequency_buffer);
+            }
+            block_documents = documents.data() + i * posting_block_size;
+            block_frequencies = frequencies.data() + i * posting_block_size;
+            return std::min(posting_block_size, count - i * posting_block_size);
+        }
+    };
+
+  private:
+    std::size_t capacity_;
+    // set for replaced documents and tombstones, searches skip them
+    std::unique_ptr<std::atomic<std::uint64_t>[]> dead_;
+
+  public:
+    const std::uint64_t id;
+
+    segment(const std::uint64_t id, const std::size_t capacity)
+        : capacity_{capacity}, dead_{std::make_unique<std::atomic<std::uint64_t>[]>((capacity + 63) / 64)}, id{id}
+    {
+    }
+
+    segment(const segment &) = delete;
+    segment &operator=(const segment &) = delete;
+    virtual ~segment() = default;
+
+    virtual std::size_t size() const noexcept = 0;
+    virtual document at(std::uint32_t i) const noexcept = 0;
+    virtual std::size_t count(std::string_view term) const = 0;
+    virtual std::optional<postings> find(std::string_view term) const = 0;
+    // bytes in memory or on disk
+    virtual std::uint64_t bytes() const noexcept = 0;
+    virtual bool in_memory() const noexcept = 0;
+
+    std::size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    bool dead(const std::uint32_t i) const noexcept
+    {
+        return dead_[i / 64].load(std::memory_order_relaxed) >> (i % 64) & 1;
+    }
+
+    void kill(const std::uint32_t i) noexcept
+    {
+        dead_[i / 64].fetch_or(std::uint64_t{1} << (i % 64), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Adds the live documents that contain every term to top
+     *
+     * Goes through the blocks of the rarest term and skips those whose best
+     * document could not beat the worst hit in top, even with the best score
+     * of every other term.
+     */
+    void score(const std::vector<query_term> &terms, const double average_length, top_hits &top,
+               const std::size_t limit) const
+    {
+        std::vector<postings> lists{};
+        lists.reserve(terms.size());
+        for (const auto &term : terms)
+        {
+            auto found{find(term.text)};
+            if (!found)
+            {
+                return;
+            }
+            lists.push_back(std::move(*found));
+        }
+        std::vector<std::size_t> order(terms.size());
+        for (std::size_t i{}; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::ranges::sort(order, {}, [&lists](const std::size_t i) { return lists[i].count; });
+        double others_bound{};
+        for (auto term{std::next(order.begin())}; term != order.end(); ++term)
+        {
+            others_bound += lists[*term].bound(terms[*term].idf, average_length);
+        }
+
+        // the block every term has decoded, in the order of rarity
+        const auto count{order.size()};
+        std::vector<std::size_t> cursors(count);
+        std::vector<std::size_t> decoded(count, std::numeric_limits<std::size_t>::max());
+        std::vector<std::array<std::uint32_t, posting_block_size>> document_buffers(count);
+        std::vector<std::array<std::uint32_t, posting_block_size>> frequency_buffers(count);
+        std::vector<const std::uint32_t *> block_documents(count);
+        std::vector<const std::uint32_t *> block_frequencies(count);
+        std::vector<std::size_t> block_sizes(count);
+        // the candidates of a block of the rarest term and the frequency of every term in them
+        std::array<std::uint32_t, posting_block_size> candidates{};
+        std::vector<std::array<std::uint32_t, posting_block_size>> frequencies(count);
+        std::array<std::uint32_t, posting_block_size> candidate_hits{};
+        std::array<std::uint32_t, posting_block_size> block_hits{};
+
+        const auto &rarest{lists[order.front()]};
+        const auto rarest_idf{terms[order.front()].idf};
+        for (std::size_t b{}; b < rarest.block_count(); ++b)
+        {
+            if (top.size() >= limit)
+            {
+                // the bounds of the whole lists first, then those of the blocks that overlap this one
+                const auto threshold{top.top().score};
+                auto bound{rarest.block_bound(b, rarest_idf, average_length)};
+                if (bound + others_bound < threshold)
+                {
+                    continue;
+                }
+                const auto first{b == 0 ? 0 : rarest.block_last(b - 1) + 1};
+                const auto last{rarest.block_last(b)};
+                for (std::size_t t{1}; t < count; ++t)
+                {
+                    const auto &list{lists[order[t]]};
+                    while (cursors[t] < list.block_count() && list.block_last(cursors[t]) < first)
+                    {
+                        ++cursors[t];
+                    }
+                    double term_bound{};
+                    for (auto j{cursors[t]}; j < list.block_count(); ++j)
+                    {
+                        term_bound = std::max(term_bound, list.block_bound(j, terms[order[t]].idf, average_length));
+                        if (list.block_last(j) >= last)
+                        {
+                            break;
+                        }
+                    }
+                    bound += term_bound;
+                }
+                if (bound < threshold)
+                {
+                    continue;
+                }
+            }
+            block_sizes[0] = rarest.load(b, document_buffers[0].data(), frequency_buffers[0].data(),
+                                         block_documents[0], block_frequencies[0]);
+            std::size_t matches{};
+            for (std::size_t k{}; k < block_sizes[0]; ++k)
+            {
+                if (!dead(block_documents[0][k]))
+                {
+                    candidates[matches] = block_documents[0][k];
+                    frequencies[0][matches++] = block_frequencies[0][k];
+                }
+            }
+
+            // every other term keeps the candidates found in its blocks, blocks between them are not decoded
+            for (std::size_t t{1}; t < count && matches > 0; ++t)
+            {
+                const auto &list{lists[order[t]]};
+                std::size_t kept{};
+                std::size_t next{};
+                while (next < matches)
+                {
+                    while (cursors[t] < list.block_count() && list.block_last(cursors[t]) < candidates[next])
+                    {
+                        ++cursors[t];
+                    }
+                    if (cursors[t] == list.block_count())
+                    {
+                        break;
+                    }
+                    if (decoded[t] != cursors[t])
+                    {
+                        block_sizes[t] = list.load(cursors[t], document_buffers[t].data(), frequency_buffers[t].data(),
+                                                   block_documents[t], block_frequencies[t]);
+                        decoded[t] = cursors[t];
+                    }
+                    const auto end{static_cast<std::size_t>(
+                        std::upper_bound(candidates.begin() + static_cast<std::ptrdiff_t>(next),
+                                         candidates.begin() + static_cast<std::ptrdiff_t>(matches),
+                                         list.block_last(cursors[t])) -
+                        candidates.begin())};
+                    const auto found{intersect(std::span{candidates}.subspan(next, end - next),
+                                               std::span{block_documents[t], block_sizes[t]}, candidate_hits.data(),
+                                               block_hits.data())};
+                    for (std::size_t h{}; h < found; ++h)
+                    {
+                        const auto from{next + candidate_hits[h]};
+                        candidates[kept] = candidates[from];
+                        for (std::size_t u{}; u < t; ++u)
+                        {
+                            frequencies[u][kept] = frequencies[u][from];
+                        }
+                        frequencies[t][kept++] = block_frequencies[t][block_hits[h]];
+                    }
+                    next = end;
+                }
+                matches = kept;
+            }
+
+            for (std::size_t i{}; i < matches; ++i)
+            {
+                const auto document{at(candidates[i])};
+                double total{};
+                for (std::size_t t{}; t < count; ++t)
+                {
+                    total += bm25(terms[order[t]].idf, frequencies[t][i], document.length, average_length);
+                }
+                const hit found{document.id, total};
+                if (top.size() < limit)
+                {
+                    top.push(found);
+                }
+                else if (better(found, top.top()))
+                {
+                    top.pop();
+                    top.push(found);
+                }
+            }
+        }
+    }
+};
+
+class full_text_index::memory_segment final : public segment
+{
+  public:
+    struct buffered
+    {
+        std::vector<std::uint32_t> documents;
+        std::vector<std::uint32_t> frequencies;
+    };
+
+  private:
+    std::vector<document> documents_;
+    std::unordered_map<std::string, buffered, string_hash, std::equal_to<>> terms_;
+    std::int64_t bytes_{};
+
+  public:
+    memory_segment(const std::uint64_t id, const std::size_t capacity) : segment{id, capacity}
+    {
+        documents_.reserve(capacity);
+    }
+
+    ~memory_segment() override
+    {
+        memory::account(memory::tag::search_index, -bytes_);
+    }
+
+    bool full() const noexcept
+    {
+        return documents_.size() >= capacity();
+    }
+
+    std::uint32_t append(const document &added, const std::vector<std::pair<std::string, std::uint32_t>> &terms)
+    {
+        const auto number{static_cast<std::uint32_t>(documents_.size())};
+        documents_.push_back(added);
+        std::int64_t delta{};
+        for (const auto &[term, frequency] : terms)
+        {
+            auto [entry, inserted]{terms_.try_emplace(term)};
+            if (inserted)
+            {
+                delta += static_cast<std::int64_t>(term.size()) + term_overhead;
+            }
+            entry->second.documents.push_back(number);
+            entry->second.frequencies.push_back(frequency);
+            delta += posting_overhead;
+        }
+        bytes_ += delta;
+        memory::account(memory::tag::search_index, delta);
+        return number;
+    }
+
+    const std::vector<document> &documents() const noexcept
+    {
+        return documents_;
+    }
+
+    std::vector<std::pair<std::string_view, const buffered *>> sorted_terms() const
+    {
+        std::vector<std::pair<std::string_view, const buffered *>> sorted{};
+        sorted.reserve(terms_.size());
+        for (const auto &[term, postings] : terms_)
+        {
+            sorted.emplace_back(term, &postings);
+        }
+        std::ranges::sort(sorted, {}, &std::pair<std::string_view, const buffered *>::first);
+        return sorted;
+    }
+
+    std::size_t size() const noexcept override
+    {
+        return documents_.size();
+    }
+
+    document at(const std::uint32_t i) const noexcept override
+    {
+        return documents_[i];
+    }
+
+    std::size_t count(const std::string_view term) const override
+    {
+        const auto found{terms_.find(term)};
+        return found == terms_.end() ? 0 : found->second.documents.size();
+    }
+
+    std::optional<postings> find(const std::string_view term) const override
+    {
+        const auto found{terms_.find(term)};
+        if (found == terms_.end())
+        {
+            return std::nullopt;
+        }
+        return postings{.count = found->second.documents.size(),
+                        .documents = found->second.documents,
+                        .frequencies = found->second.frequencies,
+                        .reader = std::nullopt};
+    }
+
+    std::uint64_t bytes() const noexcept override
+    {
+        return static_cast<std::uint64_t>(bytes_);
+    }
+
+    bool in_memory() const noexcept override
+    {
+        return true;
+    }
+};
+
+class full_text_index::file_segment final : public segment
+{
+  private:
+    struct term_entry
+    {
+        std::string_view term;
+        std::uint32_t count;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    std::filesystem::path path_;
+    boost::interprocess::mapped_region region_;
+    std::uint32_t flags_{};
+    std::uint64_t covers_from_{};
+    std::string_view postings_;
+    std::string_view documents_;
+    std::vector<term_entry> terms_;
+
+    static std::size_t document_count(const boost::interprocess::mapped_region &region) noexcept
+    {
+        if (region.get_size() < header_size + footer_size)
+        {
+            return 0;
+        }
+        return load32(static_cast<const char *>(region.get_address()) + region.get_size() - footer_size + 16);
+    }
+
+    std::string_view data() const noexcept
+    {
+        return {static_cast<const char *>(region_.get_address()), region_.get_size()};
+    }
+
+    void parse()
+    {
+        const auto file{data()};
+        if (file.size() < header_size + footer_size || file.substr(0, segment_magic.size()) != segment_magic ||
+            load32(file.data() + 8) != format_version || load64(file.data() + 16) != id)
+        {
+            throw std::runtime_error{"Not a segment of this index"};
+        }
+        flags_ = load32(file.data() + 12);
+        covers_from_ = load64(file.data() + 24);
+
+        const auto *footer{file.data() + file.size() - footer_size};
+        boost::crc_32_type crc{};
+        crc.process_bytes(file.data(), file.size() - 4);
+        if (crc.checksum() != load32(footer + 28))
+        {
+            throw std::runtime_error{"Checksum mismatch"};
+        }
+        const auto documents_offset{load64(footer)};
+        const auto terms_offset{load64(footer + 8)};
+        const auto documents{load32(footer + 16)};
+        const auto terms{load32(footer + 20)};
+        if (documents_offset < header_size || terms_offset > file.size() - footer_size ||
+            terms_offset - documents_offset != documents * document_entry_size)
+        {
+            throw std::runtime_error{"Malformed footer"};
+        }
+        postings_ = file.substr(header_size, documents_offset - header_size);
+        documents_ = file.substr(documents_offset, terms_offset - documents_offset);
+
+        const auto table{file.substr(terms_offset, file.size() - footer_size - terms_offset)};
+        std::size_t offset{};
+        terms_.reserve(terms);
+        for (std::uint32_t i{}; i < terms; ++i)
+        {
+            const auto term_size{read_varint(table, offset)};
+            if (table.size() - offset < term_size)
+            {
+                throw std::runtime_error{"Malformed term table"};
+            }
+            const auto term{table.substr(offset, term_size)};
+            offset += term_size;
+            const auto count{read_varint(table, offset)};
+            const auto postings_offset{read_varint(table, offset)};
+            const term_entry entry{.term = term,
+                                   .count = static_cast<std::uint32_t>(count),
+                                   .offset = postings_offset,
+                                   .size = read_varint(table, offset)};
+            if (entry.offset > postings_.size() || postings_.size() - entry.offset < entry.size ||
+                count > documents || (!terms_.empty() && terms_.back().term >= entry.term))
+            {
+                throw std::runtime_error{"Malformed term table"};
+            }
+            terms_.push_back(entry);
+        }
+    }
+
+  public:
+    // counts the merges that produced the segment, a new file name for each
+    std::uint64_t generation{};
+    // removes the file once the last search is done with the mapping
+    std::atomic<bool> obsolete{false};
+
+    file_segment(const std::uint64_t id, const std::filesystem::path &path, boost::interprocess::mapped_region region)
+        : segment{id, document_count(region)}, path_{path}, region_{std::move(region)}
+    {
+        try
+        {
+            parse();
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error{fmt::format("{} is not a valid segment: {}", path.string(), e.what())};
+        }
+    }
+
+    static std::shared_ptr<file_segment> map(const std::uint64_t id, const std::filesystem::path &path)
+    {
+        const boost::interprocess::file_mapping file{path.string().c_str(), boost::interprocess::read_only};
+        return std::make_shared<file_segment>(
+            id, path, boost::interprocess::mapped_region{file, boost::interprocess::read_only});
+    }
+
+    bool merged() const noexcept
+    {
+        return flags_ & segment_merged;
+    }
+
+    std::uint64_t covers_from() const noexcept
+    {
+        return covers_from_;
+    }
+
+    std::size_t term_count() const noexcept
+    {
+        return terms_.size();
+    }
+
+    std::string_view term(const std::size_t i) const noexcept
+    {
+        return terms_[i].term;
+    }
+
+    postings postings_at(const std::size_t i) const
+    {
+        const auto &entry{terms_[i]};
+        return postings{.count = entry.count,
+                        .documents = {},
+                        .frequencies = {},
+                        .reader = posting_reader{postings_.substr(entry.offset, entry.size), entry.count}};
+    }
+
+    std::size_t size() const noexcept override
+    {
+        return documents_.size() / document_entry_size;
+    }
+
+    document at(const std::uint32_t i) const noexcept override
+    {
+        const auto *entry{documents_.data() + i * document_entry_size};
+        return document{load64(entry), load32(entry + 8), (load32(entry + 12) & document_tombstone) != 0};
+    }
+
+    std::size_t count(const std::string_view term) const override
+    {
+        const auto found{std::ranges::lower_bound(terms_, term, {}, &term_entry::term)};
+        return found == terms_.end() || found->term != term ? 0 : found->count;
+    }
+
+    std::optional<postings> find(const std::string_view term) const override
+    {
+        const auto found{std::ranges::lower_bound(terms_, term, {}, &term_entry::term)};
+        if (found == terms_.end() || found->term != term)
+        {
+            return std::nullopt;
+        }
+        return postings_at(static_cast<std::size_t>(found - terms_.begin()));
+    }
+
+    std::uint64_t bytes() const noexcept override
+    {
+        return region_.get_size();
+    }
+
+    bool in_memory() const noexcept override
+    {
+        return false;
+    }
+
+    ~file_segment() override
+    {
+        if (obsolete.load(std::memory_order_acquire))
+        {
+            region_ = boost::interprocess::mapped_region{};
+            std::error_code ec{};
+            std::filesystem::remove(path_, ec);
+        }
+    }
+};
+
+/**
+ * @brief Streams a segment file, terms must be added in ascending order
+ */
+class full_text_index::segment_writer
+{
+  private:
+    std::filesystem::path path_;
+    boost::beast::file file_;
+    boost::crc_32_type crc_;
+    std::uint64_t written_{};
+    std::string buffer_;
+    std::uint64_t postings_size_{};
+    std::string terms_;
+    std::uint32_t term_count_{};
+
+    void write(const bool all)
+    {
+        if (buffer_.empty() || (!all && buffer_.size() < write_chunk_bytes))
+        {
+            return;
+        }
+        boost::system::error_code ec{};
+        storage::write_at(file_, written_, buffer_, ec);
+        if (ec)
+        {
+            throw boost::system::system_error{ec, "Failed to write a segment"};
+        }
+        crc_.process_bytes(buffer_.data(), buffer_.size());
+        written_ += buffer_.size();
+        buffer_.clear();
+    }
+
+  public:
+    segment_writer(const std::filesystem::path &path, const std::uint64_t id, const std::uint64_t covers_from,
+                   const std::uint32_t flags)
+        : path_{path}
+    {
+        boost::system::error_code ec{};
+        file_.open(path.string().c_str(), boost::beast::file_mode::write, ec);
+        if (ec)
+        {
+            throw boost::system::system_error{ec, "Failed to create a segment"};
+        }
+        buffer_ = segment_magic;
+        append32(buffer_, format_version);
+        append32(buffer_, flags);
+        append64(buffer_, id);
+        append64(buffer_, covers_from);
+    }
+
+    void add_term(const std::string_view term, const std::span<const std::uint32_t> documents,
+                  const std::span<const std::uint32_t> frequencies, const std::span<const std::uint32_t> lengths)
+    {
+        const auto start{buffer_.size()};
+        encode_postings(buffer_, documents, frequencies, lengths);
+        const auto size{buffer_.size() - start};
+        append_varint(terms_, term.size());
+        terms_ += term;
+        append_varint(terms_, documents.size());
+        append_varint(terms_, postings_size_);
+        append_varint(terms_, size);
+        postings_size_ += size;
+        ++term_count_;
+        write(false);
+    }
+
+    void finish(const std::vector<segment::document> &documents)
+    {
+        const auto documents_offset{header_size + postings_size_};
+        for (const auto &added : documents)
+        {
+            append64(buffer_, added.id);
+            append32(buffer_, added.length);
+            append32(buffer_, added.tombstone ? document_tombstone : 0);
+            write(false);
+        }
+        const auto terms_offset{documents_offset + documents.size() * document_entry_size};
+        buffer_ += terms_;
+        append64(buffer_, documents_offset);
+        append64(buffer_, terms_offset);
+        append32(buffer_, static_cast<std::uint32_t>(documents.size()));
+        append32(buffer_, term_count_);
+        append32(buffer_, 0);
+        crc_.process_bytes(buffer_.data(), buffer_.size());
+        append32(buffer_, crc_.checksum());
+
+        boost::system::error_code ec{};
+        storage::write_at(file_, written_, buffer_, ec);
+        if (!ec)
+        {
+            storage::sync_file(file_, ec);
+        }
+        if (ec)
+        {
+            throw boost::system::system_error{ec, "Failed to write a segment"};
+        }
+        file_.close(ec);
+    }
+};
+
+std::filesystem::path full_text_index::path_of(const std::uint64_t id, const std::uint64_t generation) const
+{
+    if (generation == 0)
+    {
+        return directory_ / fmt::format("{:016x}.seg", id);
+    }
+    return directory_ / fmt::format("{:016x}-{:x}.seg", id, generation);
+}
+
+std::shared_ptr<full_text_index::segment> full_text_index::find_segment(const std::uint64_t id) const
+{
+    if (active_->id == id)
+    {
+        return active_;
+    }
+    const auto found{std::ranges::lower_bound(segments_, id, {}, [](const auto &s) { return s->id; })};
+    return found != segments_.end() && (*found)->id == id ? *found : nullptr;
+}
+
+void full_text_index::retire(const std::uint64_t id)
+{
+    const auto found{live_.find(id)};
+    if (found == live_.end())
+    {
+        return;
+    }
+    const auto owner{find_segment(found->second.segment)};
+    owner->kill(found->second.document);
+    total_length_ -= owner->at(found->second.document).length;
+    live_.erase(found);
+}
+
+void full_text_index::recover()
+{
+    std::filesystem::create_directories(directory_);
+
+    // ids with their generations, <id>.seg or <id>-<generation>.seg
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ids{};
+    for (const auto &entry : std::filesystem::directory_iterator{directory_})
+    {
+        const auto &path{entry.path()};
+        if (path.extension() == ".writing")
+        {
+            // an unfinished flush or merge, what it read is all still there
+            std::filesystem::remove(path);
+            continue;
+        }
+        const auto stem{path.stem().string()};
+        const auto *const end{stem.data() + stem.size()};
+        std::uint64_t id{};
+        std::uint64_t generation{};
+        if (path.extension() != ".seg" || stem.size() < 16 ||
+            std::from_chars(stem.data(), stem.data() + 16, id, 16).ptr != stem.data() + 16)
+        {
+            continue;
+        }
+        if (stem.size() == 16 ||
+            (stem.size() > 17 && stem[16] == '-' && std::from_chars(stem.data() + 17, end, generation, 16).ptr == end))
+        {
+            ids.emplace_back(id, generation);
+        }
+    }
+    std::ranges::sort(ids);
+
+    std::vector<std::shared_ptr<file_segment>> found{};
+    for (const auto &[id, generation] : ids)
+    {
+        auto mapped{file_segment::map(id, path_of(id, generation))};
+        mapped->generation = generation;
+        // a merged segment holds everything that is alive in the segments it replaced, older generations of its id
+        // included
+        if (mapped->merged())
+        {
+            while (!found.empty() && found.back()->id >= mapped->covers_from())
+            {
+                found.back()->obsolete.store(true, std::memory_order_release);
+                found.pop_back();
+            }
+        }
+        found.push_back(std::move(mapped));
+    }
+
+    std::unique_lock lock{mutex_};
+    next_id_ = ids.empty() ? 0 : ids.back().first + 1;
+    active_ = std::make_shared<memory_segment>(next_id_++, flush_documents_);
+    active_since_ = std::chrono::steady_clock::now();
+    for (const auto &recovered : found)
+    {
+        segments_.push_back(recovered);
+        for (std::uint32_t i{}; i < recovered->size(); ++i)
+        {
+            const auto document{recovered->at(i)};
+            retire(document.id);
+            if (document.tombstone)
+            {
+                recovered->kill(i);
+                continue;
+            }
+            live_.insert_or_assign(document.id, document_ref{recovered->id, i});
+            total_length_ += document.length;
+        }
+    }
+}
+
+void full_text_index::open(const config::lpbackend_config::fields_t::search_t &search)
+{
+    directory_ = search.directory;
+    flush_documents_ = std::clamp<std::uint64_t>(search.flush_documents, 1, no_document - 1);
+    flush_interval_ = std::chrono::seconds{search.flush_seconds};
+    max_segments_ = std::max<std::uint64_t>(search.max_segments, 2);
+    recover();
+
+    std::shared_lock lock{mutex_};
+    LPBACKEND_LOG(lg_, info) << fmt::format("Opened full-text index at {} ({} documents in {} segments)",
+                                            directory_.string(), live_.size(), segments_.size());
+    // writes and merges segments
+    thread_.emplace(1);
+}
+
+void full_text_index::close()
+{
+    if (!thread_)
+    {
+        return;
+    }
+    thread_->join();
+    thread_.reset();
+    {
+        std::unique_lock lock{mutex_};
+        seal();
+    }
+    try
+    {
+        write_sealed();
+    }
+    catch (const std::exception &e)
+    {
+        LPBACKEND_LOG(lg_, error) << "Failed to write the buffered documents: " << e.what();
+    }
+}
+
+bool full_text_index::is_open() const noexcept
+{
+    return thread_.has_value();
+}
+
+void full_text_index::seal()
+{
+    if (active_->size() == 0)
+    {
+        return;
+    }
+    segments_.push_back(active_);
+    active_ = std::make_shared<memory_segment>(next_id_++, flush_documents_);
+    active_since_ = std::chrono::steady_clock::now();
+}
+
+void full_text_index::add(const std::uint64_t id, const std::string_view title, const std::string_view body)
+{
+    std::unordered_map<std::string, std::uint32_t, string_hash, std::equal_to<>> frequencies{};
+    std::uint32_t length{};
+    for (auto &term : tokenize(title, token_mode::document))
+    {
+        frequencies[std::move(term)] += title_weight;
+        length += title_weight;
+    }
+    for (auto &term : tokenize(body, token_mode::document))
+    {
+        ++frequencies[std::move(term)];
+        ++length;
+    }
+    const std::vector<std::pair<std::string, std::uint32_t>> terms(frequencies.begin(), frequencies.end());
+
+    bool sealed{false};
+    {
+        std::unique_lock lock{mutex_};
+        if (!active_)
+        {
+            throw std::runtime_error{"The full-text index is not open"};
+        }
+        retire(id);
+        const auto number{active_->append(segment::document{id, length, false}, terms)};
+        live_.insert_or_assign(id, document_ref{active_->id, number});
+        total_length_ += length;
+        if (active_->full())
+        {
+            seal();
+            sealed = true;
+        }
+    }
+    added_.fetch_add(1, std::memory_order_relaxed);
+    if (sealed)
+    {
+        schedule_maintenance();
+    }
+}
+
+void full_text_index::remove(const std::uint64_t id)
+{
+    bool sealed{false};
+    {
+        std::unique_lock lock{mutex_};
+        if (!active_ || !live_.contains(id))
+        {
+            return;
+        }
+        retire(id);
+        // the tombstone hides the copies in older segments after a restart
+        active_->kill(active_->append(segment::document{id, 0, true}, {}));
+        if (active_->full())
+        {
+            seal();
+            sealed = true;
+        }
+    }
+    removed_.fetch_add(1, std::memory_order_relaxed);
+    if (sealed)
+    {
+        schedule_maintenance();
+    }
+}
+
+std::vector<full_text_index::hit> full_text_index::search(const std::string_view query, const std::size_t limit) const
+{
+    const auto started{std::chrono::steady_clock::now()};
+    auto texts{tokenize(query, token_mode::query)};
+    std::ranges::sort(texts);
+    texts.erase(std::unique(texts.begin(), texts.end()), texts.end());
+    if (texts.empty() || limit == 0)
+    {
+        return {};
+    }
+
+    top_hits top{&better};
+    std::vector<std::shared_ptr<segment>> snapshot{};
+    std::vector<query_term> terms{};
+    double average_length{1};
+    {
+        std::shared_lock lock{mutex_};
+        if (!active_ || live_.empty())
+        {
+            return {};
+        }
+        snapshot = segments_;
+        const auto documents{static_cast<double>(live_.size())};
+        average_length = std::max(1.0, static_cast<double>(total_length_) / documents);
+        for (auto &text : texts)
+        {
+            // dead documents are counted as well until their segment is merged
+            std::size_t frequency{active_->count(text)};
+            for (const auto &s : snapshot)
+            {
+                frequency += s->count(text);
+            }
+            if (frequency == 0)
+            {
+                return {};
+            }
+            const auto df{static_cast<double>(frequency)};
+            const auto idf{std::log(1 + (std::max(documents, df) - df + 0.5) / (df + 0.5))};
+            terms.push_back(query_term{std::move(text), idf});
+        }
+        // the active segment changes once the lock is released
+        active_->score(terms, average_length, top, limit);
+    }
+    for (const auto &s : snapshot)
+    {
+        s->score(terms, average_length, top, limit);
+    }
+
+    std::vector<hit> result(top.size());
+    for (auto i{result.size()}; i-- > 0;)
+    {
+        result[i] = top.top();
+        top.pop();
+    }
+
+    searches_.fetch_add(1, std::memory_order_relaxed);
+    const auto elapsed{static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count())};
+    auto slowest{slowest_search_us_.load(std::memory_order_relaxed)};
+    while (elapsed > slowest &&
+           !slowest_search_us_.compare_exchange_weak(slowest, elapsed, std::memory_order_relaxed))
+    {
+    }
+    return result;
+}
+
+void full_text_index::schedule_maintenance()
+{
+    if (!thread_)
+    {
+        return;
+    }
+    // a pass that is already running may have missed the segment sealed for this request
+    maintenance_requested_.store(true, std::memory_order_release);
+    if (maintaining_.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    boost::asio::post(*thread_, [this] {
+        do
+        {
+            while (maintenance_requested_.exchange(false, std::memory_order_acq_rel))
+            {
+                try
+                {
+                    maintain();
+                }
+                catch (const std::exception &e)
+                {
+                    LPBACKEND_LOG(lg_, error) << "Index maintenance failed: " << e.what();
+                }
+            }
+            maintaining_.store(false, std::memory_order_release);
+            // a request between the last check and the store found the flag still set
+        } while (maintenance_requested_.load(std::memory_order_acquire) &&
+                 !maintaining_.exchange(true, std::memory_order_acq_rel));
+    });
+}
+
+void full_text_index::maintain()
+{
+    do
+    {
+        write_sealed();
+    } while (merge());
+}
+
+void full_text_index::write_sealed()
+{
+    for (;;)
+    {
+        std::shared_ptr<memory_segment> sealed{};
+        {
+            std::shared_lock lock{mutex_};
+            const auto found{std::ranges::find_if(segments_, [](const auto &s) { return s->in_memory(); })};
+            if (found == segments_.end())
+            {
+                return;
+            }
+            sealed = std::static_pointer_cast<memory_segment>(*found);
+        }
+
+        // a sealed segment does not change any more, only its dead documents
+        const auto path{path_of(sealed->id)};
+        auto temporary{path};
+        temporary.replace_extension(".writing");
+        try
+        {
+            segment_writer writer{temporary, sealed->id, sealed->id, 0};
+            std::vector<std::uint32_t> lengths{};
+            for (const auto &[term, postings] : sealed->sorted_terms())
+            {
+                lengths.clear();
+                for (const auto document : postings->documents)
+                {
+                    lengths.push_back(sealed->at(document).length);
+                }
+                writer.add_term(term, postings->documents, postings->frequencies, lengths);
+            }
+            writer.finish(sealed->documents());
+            std::filesystem::rename(temporary, path);
+            storage::sync_directory(directory_);
+        }
+        catch (...)
+        {
+            std::error_code ec{};
+            std::filesystem::remove(temporary, ec);
+            throw;
+        }
+
+        auto written{file_segment::map(sealed->id, path)};
+        std::unique_lock lock{mutex_};
+        for (std::uint32_t i{}; i < sealed->size(); ++i)
+        {
+            if (sealed->dead(i))
+            {
+                written->kill(i);
+            }
+        }
+        *std::ranges::find(segments_, sealed->id, [](const auto &s) { return s->id; }) = written;
+        lock.unlock();
+        flushes_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool full_text_index::merge()
+{
+    // the adjacent written segments with the fewest bytes
+    std::vector<std::shared_ptr<file_segment>> window{};
+    bool from_oldest{};
+    {
+        std::shared_lock lock{mutex_};
+        const auto written{static_cast<std::size_t>(
+            std::ranges::find_if(segments_, [](const auto &s) { return s->in_memory(); }) - segments_.begin())};
+        if (segments_.size() <= max_segments_ || written < 2)
+        {
+            return false;
+        }
+        const auto width{std::min(merge_width, written)};
+        std::size_t best{};
+        std::uint64_t best_bytes{std::numeric_limits<std::uint64_t>::max()};
+        for (std::size_t start{}; start + width <= written; ++start)
+        {
+            std::uint64_t bytes{};
+            for (auto i{start}; i < start + width; ++i)
+            {
+                bytes += segments_[i]->bytes();
+            }
+            if (bytes < best_bytes)
+            {
+                best = start;
+                best_bytes = bytes;
+            }
+        }
+        for (auto i{best}; i < best + width; ++i)
+        {
+            window.push_back(std::static_pointer_cast<file_segment>(segments_[i]));
+        }
+        from_oldest = best == 0;
+    }
+
+    // tombstones are dropped unless an older segment is left that they could shadow
+    std::vector<std::vector<std::uint32_t>> remap(window.size());
+    std::vector<segment::document> documents{};
+    for (std::size_t k{}; k < window.size(); ++k)
+    {
+        remap[k].assign(window[k]->size(), no_document);
+        for (std::uint32_t i{}; i < window[k]->size(); ++i)
+        {
+            const auto document{window[k]->at(i)};
+            if (document.tombstone ? !from_oldest : !window[k]->dead(i))
+            {
+                remap[k][i] = static_cast<std::uint32_t>(documents.size());
+                documents.push_back(document);
+            }
+        }
+    }
+
+    // the output keeps the id of the newest segment of the window under a new
+    // file name, a mapped file cannot be replaced on Windows
+    const auto id{window.back()->id};
+    const auto generation{window.back()->generation + 1};
+    const auto path{path_of(id, generation)};
+    auto temporary{path};
+    temporary.replace_extension(".writing");
+    try
+    {
+        segment_writer writer{temporary, id, window.front()->id, segment_merged};
+        std::vector<std::size_t> positions(window.size());
+        std::vector<std::uint32_t> merged_documents{};
+        std::vector<std::uint32_t> merged_frequencies{};
+        std::vector<std::uint32_t> merged_lengths{};
+        std::array<std::uint32_t, posting_block_size> document_buffer{};
+        std::array<std::uint32_t, posting_block_size> frequency_buffer{};
+        const std::uint32_t *block_documents{};
+        const std::uint32_t *block_frequencies{};
+        for (;;)
+        {
+            // the smallest term of the sorted term tables
+            std::optional<std::string_view> term{};
+            for (std::size_t k{}; k < window.size(); ++k)
+            {
+                if (positions[k] < window[k]->term_count() && (!term || window[k]->term(positions[k]) < *term))
+                {
+                    term = window[k]->term(positions[k]);
+                }
+            }
+            if (!term)
+            {
+                break;
+            }
+            merged_documents.clear();
+            merged_frequencies.clear();
+            merged_lengths.clear();
+            for (std::size_t k{}; k < window.size(); ++k)
+            {
+                if (positions[k] >= window[k]->term_count() || window[k]->term(positions[k]) != *term)
+                {
+                    continue;
+                }
+                const auto list{window[k]->postings_at(positions[k]++)};
+                for (std::size_t b{}; b < list.block_count(); ++b)
+                {
+                    const auto size{list.load(b, document_buffer.data(), frequency_buffer.data(), block_documents,
+                                              block_frequencies)};
+                    for (std::size_t d{}; d < size; ++d)
+                    {
+                        if (const auto to{remap[k][block_documents[d]]}; to != no_document)
+                        {
+                            merged_documents.push_back(to);
+                            merged_frequencies.push_back(block_frequencies[d]);
+                            merged_lengths.push_back(documents[to].length);
+                        }
+                    }
+                }
+            }
+            if (!merged_documents.empty())
+            {
+                writer.add_term(*term, merged_documents, merged_frequencies, merged_lengths);
+            }
+        }
+        writer.finish(documents);
+        // from here on a recovery finds the merged segment and ignores the ones it replaces
+        std::filesystem::rename(temporary, path);
+        storage::sync_directory(directory_);
+    }
+    catch (...)
+    {
+        std::error_code ec{};
+        std::filesystem::remove(temporary, ec);
+        throw;
+    }
+
+    auto merged{file_segment::map(id, path)};
+    merged->generation = generation;
+    std::size_t alive{};
+    std::unique_lock lock{mutex_};
+    // documents replaced or removed during the merge stay dead
+    for (std::size_t k{}; k < window.size(); ++k)
+    {
+        for (std::uint32_t i{}; i < window[k]->size(); ++i)
+        {
+            const auto to{remap[k][i]};
+            if (to == no_document)
+            {
+                continue;
+            }
+            if (documents[to].tombstone || window[k]->dead(i))
+            {
+                merged->kill(to);
+                continue;
+            }
+            live_.insert_or_assign(documents[to].id, document_ref{id, to});
+            ++alive;
+        }
+        window[k]->obsolete.store(true, std::memory_order_release);
+    }
+    const auto first{std::ranges::find(segments_, window.front()->id, [](const auto &s) { return s->id; })};
+    *segments_.erase(first, first + static_cast<std::ptrdiff_t>(window.size() - 1)) = merged;
+    lock.unlock();
+
+    merges_.fetch_add(1, std::memory_order_relaxed);
+    LPBACKEND_LOG(lg_, info) << fmt::format("Merged {} segments into {}, {} documents are alive", window.size(),
+                                            path.filename().string(), alive);
+    return true;
+}
+
+boost::asio::awaitable<void, full_text_index::executor_type> full_text_index::run()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (!thread_ || flush_interval_.count() == 0)
+    {
+        co_return;
+    }
+
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(flush_interval_);
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+        {
+            std::unique_lock lock{mutex_};
+            if (std::chrono::steady_clock::now() - active_since_ >= flush_interval_)
+            {
+                seal();
+            }
+        }
+        schedule_maintenance();
+    }
+}
+
+full_text_index::statistics full_text_index::collect()
+{
+    std::shared_lock lock{mutex_};
+    return statistics{.added = added_.exchange(0, std::memory_order_relaxed),
+                      .removed = removed_.exchange(0, std::memory_order_relaxed),
+                      .searches = searches_.exchange(0, std::memory_order_relaxed),
+                      .slowest_search_us = slowest_search_us_.exchange(0, std::memory_order_relaxed),
+                      .flushes = flushes_.exchange(0, std::memory_order_relaxed),
+                      .merges = merges_.exchange(0, std::memory_order_relaxed),
+                      .documents = live_.size(),
+                      .segments = segments_.size()};
+}
+
+full_text_index::~full_text_index()
+{
+    close();
+}
+} // namespace lpbackend::search
@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LPBACKEND_POSTINGS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LPBACKEND_TARGET(isa)
+#else
+#define LPBACKEND_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LPBACKEND_POSTINGS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <lpbackend/search/postings.hpp>
+
+namespace lpbackend::search
+{
+namespace
+{
+void append_varint(std::string &out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+std::uint64_t read_varint(const std::string_view data, std::size_t &offset)
+{
+    std::uint64_t value{};
+    for (unsigned shift{}; shift < 64; shift += 7)
+    {
+        if (offset >= data.size())
+        {
+            break;
+        }
+        const auto byte{static_cast<unsigned char>(data[offset++])};
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    throw std::runtime_error{"Malformed posting list"};
+}
+
+// merges what the vector kernels leave over
+std::size_t intersect_scalar(const std::span<const std::uint32_t> a, const std::span<const std::uint32_t> b,
+                             std::size_t i, std::size_t j, std::uint32_t *a_hits, std::uint32_t *b_hits,
+                             std::size_t found) noexcept
+{
+    while (i < a.size() && j < b.size())
+    {
+        if (a[i] < b[j])
+        {
+            ++i;
+        }
+        else if (b[j] < a[i])
+        {
+            ++j;
+        }
+        else
+        {
+            a_hits[found] = static_cast<std::uint32_t>(i++);
+            b_hits[found++] = static_cast<std::uint32_t>(j++);
+        }
+    }
+    return found;
+}
+
+// Every value of a is compared with a window of b at once. Windows that end below the value are skipped
+// without a comparison, the window stays while the values of a fall into it.
+#if LPBACKEND_POSTINGS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+bool cpu_has_avx2() noexcept
+{
+    int info[4]{};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+}
+#else
+bool cpu_has_avx2() noexcept
+{
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+LPBACKEND_TARGET("avx2")
+std::size_t intersect_avx2(const std::span<const std::uint32_t> a, const std::span<const std::uint32_t> b,
+                           std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept
+{
+    std::size_t i{};
+    std::size_t j{};
+    std::size_t found{};
+    while (i < a.size() && j + 8 <= b.size())
+    {
+        const auto value{a[i]};
+        if (b[j + 7] < value)
+        {
+            j += 8;
+            continue;
+        }
+        const auto window{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b.data() + j))};
+        const auto equal{_mm256_cmpeq_epi32(window, _mm256_set1_epi32(static_cast<int>(value)))};
+        const auto mask{static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)))};
+        if (mask != 0)
+        {
+            a_hits[found] = static_cast<std::uint32_t>(i);
+            b_hits[found++] = static_cast<std::uint32_t>(j + std::countr_zero(mask));
+        }
+        ++i;
+    }
+    return intersect_scalar(a, b, i, j, a_hits, b_hits, found);
+}
+
+// SSE2 is part of every x86-64 CPU
+std::size_t intersect_sse2(const std::span<const std::uint32_t> a, const std::span<const std::uint32_t> b,
+                           std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept
+{
+    std::size_t i{};
+    std::size_t j{};
+    std::size_t found{};
+    while (i < a.size() && j + 4 <= b.size())
+    {
+        const auto value{a[i]};
+        if (b[j + 3] < value)
+        {
+            j += 4;
+            continue;
+        }
+        const auto window{_mm_loadu_si128(reinterpret_cast<const __m128i *>(b.data() + j))};
+        const auto equal{_mm_cmpeq_epi32(window, _mm_set1_epi32(static_cast<int>(value)))};
+        const auto mask{static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)))};
+        if (mask != 0)
+        {
+            a_hits[found] = static_cast<std::uint32_t>(i);
+            b_hits[found++] = static_cast<std::uint32_t>(j + std::countr_zero(mask));
+        }
+        ++i;
+    }
+    return intersect_scalar(a, b, i, j, a_hits, b_hits, found);
+}
+#elif LPBACKEND_POSTINGS_NEON
+std::size_t intersect_neon(const std::span<const std::uint32_t> a, const std::span<const std::uint32_t> b,
+                           std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept
+{
+    constexpr std::uint32_t lanes[4]{1, 2, 4, 8};
+    const auto lane_bits{vld1q_u32(lanes)};
+    std::size_t i{};
+    std::size_t j{};
+    std::size_t found{};
+    while (i < a.size() && j + 4 <= b.size())
+    {
+        const auto value{a[i]};
+        if (b[j + 3] < value)
+        {
+            j += 4;
+            continue;
+        }
+        const auto equal{vceqq_u32(vld1q_u32(b.data() + j), vdupq_n_u32(value))};
+        const auto mask{vaddvq_u32(vandq_u32(equal, lane_bits))};
+        if (mask != 0)
+        {
+            a_hits[found] = static_cast<std::uint32_t>(i);
+            b_hits[found++] = static_cast<std::uint32_t>(j + std::countr_zero(mask));
+        }
+        ++i;
+    }
+    return intersect_scalar(a, b, i, j, a_hits, b_hits, found);
+}
+#else
+std::size_t intersect_generic(const std::span<const std::uint32_t> a, const std::span<const std::uint32_t> b,
+                              std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept
+{
+    return intersect_scalar(a, b, 0, 0, a_hits, b_hits, 0);
+}
+#endif
+
+struct intersection_kernel
+{
+    std::string_view isa;
+    std::size_t (*intersect)(std::span<const std::uint32_t> a, std::span<const std::uint32_t> b,
+                             std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept;
+};
+
+const intersection_kernel &active_kernel() noexcept
+{
+    static const intersection_kernel selected{[] {
+#if LPBACKEND_POSTINGS_X86
+        if (cpu_has_avx2())
+        {
+            return intersection_kernel{"avx2", intersect_avx2};
+        }
+        return intersection_kernel{"sse2", intersect_sse2};
+#elif LPBACKEND_POSTINGS_NEON
+        return intersection_kernel{"neon", intersect_neon};
+#else
+        return intersection_kernel{"scalar", intersect_generic};
+#endif
+    }()};
+    return selected;
+}
+} // namespace
+
+void encode_postings(std::string &out, const std::span<const std::uint32_t> documents,
+                     const std::span<const std::uint32_t> frequencies, const std::span<const std::uint32_t> lengths)
+{
+    std::string blocks{};
+    std::uint32_t previous{};
+    for (std::size_t first{}; first < documents.size(); first += posting_block_size)
+    {
+        const auto last{std::min(first + posting_block_size, documents.size())};
+        const auto start{blocks.size()};
+        const auto base{previous};
+        std::uint32_t max_frequency{};
+        auto min_length{std::numeric_limits<std::uint32_t>::max()};
+        for (auto i{first}; i < last; ++i)
+        {
+            append_varint(blocks, documents[i] - previous);
+            append_varint(blocks, frequencies[i]);
+            previous = documents[i];
+            max_frequency = std::max(max_frequency, frequencies[i]);
+            min_length = std::min(min_length, lengths[i]);
+        }
+        append_varint(out, documents[last - 1] - base);
+        append_varint(out, blocks.size() - start);
+        append_varint(out, max_frequency);
+        append_varint(out, min_length);
+    }
+    out += blocks;
+}
+
+posting_reader::posting_reader(const std::string_view data, const std::size_t count)
+    : data_{data}, count_{count}, min_length_{std::numeric_limits<std::uint32_t>::max()}
+{
+    const auto block_count{(count + posting_block_size - 1) / posting_block_size};
+    blocks_.reserve(block_count);
+    std::size_t offset{};
+    std::uint32_t last{};
+    std::size_t size{};
+    for (std::size_t i{}; i < block_count; ++i)
+    {
+        const auto base{last};
+        last += static_cast<std::uint32_t>(read_varint(data, offset));
+        const auto block_size{static_cast<std::size_t>(read_varint(data, offset))};
+        const auto max_frequency{static_cast<std::uint32_t>(read_varint(data, offset))};
+        const auto min_length{static_cast<std::uint32_t>(read_varint(data, offset))};
+        blocks_.push_back(block{last, base, size, block_size, max_frequency, min_length});
+        size += block_size;
+        max_frequency_ = std::max(max_frequency_, max_frequency);
+        min_length_ = std::min(min_length_, min_length);
+    }
+    if (data.size() - offset < size)
+    {
+        throw std::runtime_error{"Malformed posting list"};
+    }
+    for (auto &b : blocks_)
+    {
+        b.offset += offset;
+    }
+}
+
+std::size_t posting_reader::decode(const std::size_t i, std::uint32_t *documents, std::uint32_t *frequencies) const
+{
+    const auto &b{blocks_[i]};
+    const auto count{std::min(posting_block_size, count_ - i * posting_block_size)};
+    const auto data{data_.substr(b.offset, b.size)};
+    std::size_t offset{};
+    auto document{b.base};
+    for (std::size_t k{}; k < count; ++k)
+    {
+        document += static_cast<std::uint32_t>(read_varint(data, offset));
+        documents[k] = document;
+        frequencies[k] = static_cast<std::uint32_t>(read_varint(data, offset));
+    }
+    return count;
+}
+
+std::string_view intersection_isa() noexcept
+{
+    return active_kernel().isa;
+}
+
+std::size_t intersect(const std::span<const std::uint32_t> a, const std::span<const std::uint32_t> b,
+                      std::uint32_t *a_hits, std::uint32_t *b_hits) noexcept
+{
+    return active_kernel().intersect(a, b, a_hits, b_hits);
+}
+} // namespace lpbackend::search
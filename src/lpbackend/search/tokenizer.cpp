@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>
+
+#include <lpbackend/search/tokenizer.hpp>
+
+namespace lpbackend::search
+{
+namespace
+{
+constexpr std::size_t max_word_bytes{64};
+constexpr char32_t invalid{0xffffffff};
+
+enum class char_class
+{
+    separator,
+    word,
+    cjk
+};
+
+// returns invalid and skips one byte if the sequence is malformed
+char32_t decode(const std::string_view text, std::size_t &i) noexcept
+{
+    const auto lead{static_cast<unsigned char>(text[i])};
+    if (lead < 0x80)
+    {
+        ++i;
+        return lead;
+    }
+    std::size_t length{};
+    char32_t cp{};
+    char32_t minimum{};
+    if ((lead & 0xe0) == 0xc0)
+    {
+        length = 2;
+        cp = lead & 0x1f;
+        minimum = 0x80;
+    }
+    else if ((lead & 0xf0) == 0xe0)
+    {
+        length = 3;
+        cp = lead & 0x0f;
+        minimum = 0x800;
+    }
+    else if ((lead & 0xf8) == 0xf0)
+    {
+        length = 4;
+        cp = lead & 0x07;
+        minimum = 0x10000;
+    }
+    else
+    {
+        ++i;
+        return invalid;
+    }
+    if (text.size() - i < length)
+    {
+        ++i;
+        return invalid;
+    }
+    for (std::size_t k{1}; k < length; ++k)
+    {
+        const auto continuation{static_cast<unsigned char>(text[i + k])};
+        if ((continuation & 0xc0) != 0x80)
+        {
+            ++i;
+            return invalid;
+        }
+        cp = cp << 6 | (continuation & 0x3f);
+    }
+    if (cp < minimum || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+    {
+        ++i;
+        return invalid;
+    }
+    i += length;
+    return cp;
+}
+
+void encode(std::string &out, const char32_t cp)
+{
+    if (cp < 0x80)
+    {
+        out.push_back(static_cast<char>(cp));
+    }
+    else if (cp < 0x800)
+    {
+        out.push_back(static_cast<char>(0xc0 | cp >> 6));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+    else if (cp < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xe0 | cp >> 12));
+        out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xf0 | cp >> 18));
+        out.push_back(static_cast<char>(0x80 | (cp >> 12 & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+}
+
+bool in(const char32_t cp, const char32_t first, const char32_t last) noexcept
+{
+    return cp >= first && cp <= last;
+}
+
+// folds case and fullwidth forms, the result is what the index stores
+char32_t fold(char32_t cp) noexcept
+{
+    // fullwidth ASCII
+    if (in(cp, 0xff01, 0xff5e))
+    {
+        cp -= 0xfee0;
+    }
+    if (in(cp, 'A', 'Z') || (in(cp, 0xc0, 0xde) && cp != 0xd7) || in(cp, 0x391, 0x3a9) || in(cp, 0x410, 0x42f))
+    {
+        return cp + 0x20;
+    }
+    if (in(cp, 0x400, 0x40f))
+    {
+        return cp + 0x50;
+    }
+    return cp;
+}
+
+char_class classify(const char32_t cp) noexcept
+{
+    if (cp < 0x80)
+    {
+        return in(cp, '0', '9') || in(cp, 'a', 'z') ? char_class::word : char_class::separator;
+    }
+    // Han with its extensions and compatibility forms, kana, hangul syllables, and the iteration mark
+    if (in(cp, 0x3400, 0x4dbf) || in(cp, 0x4e00, 0x9fff) || in(cp, 0xf900, 0xfaff) || in(cp, 0x20000, 0x3134f) ||
+        in(cp, 0x3040, 0x30ff) || in(cp, 0xac00, 0xd7af) || cp == 0x3005)
+    {
+        return char_class::cjk;
+    }
+    // Latin-1 punctuation and symbols, general punctuation, CJK punctuation, halfwidth and fullwidth
+    // punctuation, emoji and other symbols
+    if (in(cp, 0x80, 0xbf) || cp == 0xd7 || cp == 0xf7 || in(cp, 0x2000, 0x2bff) || in(cp, 0x3000, 0x303f) ||
+        in(cp, 0xfe30, 0xfe4f) || in(cp, 0xff00, 0xffef) || in(cp, 0x1f000, 0x1faff) || cp == invalid)
+    {
+        return char_class::separator;
+    }
+    return char_class::word;
+}
+
+void flush_cjk(std::vector<std::string> &terms, const std::vector<char32_t> &run, const token_mode mode)
+{
+    if (run.size() == 1 || mode == token_mode::document)
+    {
+        for (const auto cp : run)
+        {
+            std::string term{};
+            encode(term, cp);
+            terms.push_back(std::move(term));
+        }
+    }
+    for (std::size_t i{1}; i < run.size(); ++i)
+    {
+        std::string term{};
+        encode(term, run[i - 1]);
+        encode(term, run[i]);
+        terms.push_back(std::move(term));
+    }
+}
+} // namespace
+
+std::vector<std::string> tokenize(const std::string_view text, const token_mode mode)
+{
+    std::vector<std::string> terms{};
+    std::string word{};
+    std::vector<char32_t> run{};
+    const auto finish_word{[&] {
+        if (!word.empty() && word.size() <= max_word_bytes)
+        {
+            terms.push_back(std::move(word));
+        }
+        word.clear();
+    }};
+    const auto finish_run{[&] {
+        if (!run.empty())
+        {
+            flush_cjk(terms, run, mode);
+            run.clear();
+        }
+    }};
+
+    for (std::size_t i{}; i < text.size();)
+    {
+        const auto cp{fold(decode(text, i))};
+        switch (classify(cp))
+        {
+        case char_class::word:
+            finish_run();
+            encode(word, cp);
+            break;
+        case char_class::cjk:
+            finish_word();
+            run.push_back(cp);
+            break;
+        case char_class::separator:
+            finish_word();
+            finish_run();
+            break;
+        }
+    }
+    finish_word();
+    finish_run();
+    return terms;
+}
+} // namespace lpbackend::search
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <lpbackend/storage/counter_service.hpp>
+
+namespace lpbackend::storage
+{
+namespace
+{
+constexpr std::array<std::string_view, 4> counter_names{"thread_views", "thread_likes", "thread_replies",
+                                                        "post_likes"};
+
+// hands the shards out to threads in turn, so the I/O threads spread evenly over them
+std::atomic<std::size_t> next_shard{};
+thread_local const std::size_t thread_shard{next_shard.fetch_add(1, std::memory_order_relaxed)};
+
+std::string encode_total(const std::int64_t total)
+{
+    const auto bits{static_cast<std::uint64_t>(total)};
+    std::string out(8, '\0');
+    for (std::size_t i{}; i < 8; ++i)
+    {
+        out[i] = static_cast<char>(bits >> (8 * i));
+    }
+    return out;
+}
+
+std::int64_t decode_total(const std::string_view in) noexcept
+{
+    std::uint64_t bits{};
+    for (std::size_t i{std::min<std::size_t>(in.size(), 8)}; i-- > 0;)
+    {
+        bits = bits << 8 | static_cast<unsigned char>(in[i]);
+    }
+    return static_cast<std::int64_t>(bits);
+}
+} // namespace
+
+counter_service::counter_service(log_store &store)
+    : store_{store}, shard_count_{std::max<std::size_t>(std::thread::hardware_concurrency(), 1)},
+      shards_{std::make_unique<shard[]>(shard_count_)}
+{
+}
+
+std::string counter_service::store_key(const key &k)
+{
+    return fmt::format("counter/{}/{}", counter_names[static_cast<std::size_t>(k.kind)], k.id);
+}
+
+counter_service::shard &counter_service::local_shard() noexcept
+{
+    return shards_[thread_shard % shard_count_];
+}
+
+std::int64_t &counter_service::total_of(const key &k)
+{
+    if (const auto it{totals_.find(k)}; it != totals_.end())
+    {
+        return it->second.value;
+    }
+    if (totals_.size() >= max_totals_)
+    {
+        evict();
+    }
+    auto &added{totals_[k]};
+    if (store_.is_open())
+    {
+        if (const auto stored{store_.get(store_key(k))})
+        {
+            added.value = decode_total(*stored);
+        }
+    }
+    return added.value;
+}
+
+void counter_service::evict()
+{
+    // down to three quarters, so the scan is amortized over a quarter of the limit of insertions
+    const auto target{max_totals_ - max_totals_ / 4};
+    std::uint64_t evicted{};
+    for (auto pass{0}; pass < 2 && totals_.size() > target; ++pass)
+    {
+        for (auto it{totals_.begin()}; it != totals_.end() && totals_.size() > target;)
+        {
+            // totals that are not committed stay, a reload would read an older value from the store, and a total
+            // that was read gets a second chance
+            if (dirty_.contains(it->first) || in_flight_.contains(it->first) ||
+                (pass == 0 && it->second.referenced.exchange(false, std::memory_order_relaxed)))
+            {
+                ++it;
+                continue;
+            }
+            it = totals_.erase(it);
+            ++evicted;
+        }
+    }
+    evicted_totals_.fetch_add(evicted, std::memory_order_relaxed);
+}
+
+void counter_service::configure(const config::lpbackend_config::fields_t::storage_t &storage)
+{
+    flush_interval_ = std::chrono::seconds{storage.counter_flush_seconds};
+    std::lock_guard lock{mutex_};
+    max_totals_ = std::max<std::size_t>(static_cast<std::size_t>(storage.max_counter_totals), 1);
+}
+
+void counter_service::add(const counter kind, const std::uint64_t id, const std::int64_t delta)
+{
+    auto &local{local_shard()};
+    std::lock_guard lock{local.mutex};
+    local.deltas[key{kind, id}] += delta;
+    ++local.increments;
+}
+
+std::int64_t counter_service::get(const counter kind, const std::uint64_t id)
+{
+    const key k{kind, id};
+    {
+        std::shared_lock lock{mutex_};
+        if (const auto it{totals_.find(k)}; it != totals_.end())
+        {
+            it->second.referenced.store(true, std::memory_order_relaxed);
+            return it->second.value;
+        }
+    }
+    std::unique_lock lock{mutex_};
+    return total_of(k);
+}
+
+void counter_service::flush(completion_type completion)
+{
+    // held until the batch is queued, so the batches of two flushes commit in the order they were taken
+    std::unique_lock lock{mutex_};
+    std::unordered_map<key, std::int64_t, key_hash> deltas{};
+    for (std::size_t i{}; i < shard_count_; ++i)
+    {
+        {
+            std::lock_guard shard_lock{shards_[i].mutex};
+            deltas.swap(shards_[i].deltas);
+        }
+        for (const auto &[k, delta] : deltas)
+        {
+            if (delta != 0)
+            {
+                total_of(k) += delta;
+                dirty_.insert(k);
+            }
+        }
+        deltas.clear();
+    }
+    flushes_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!store_.is_open())
+    {
+        dirty_.clear();
+        lock.unlock();
+        completion({});
+        return;
+    }
+    if (dirty_.empty())
+    {
+        lock.unlock();
+        completion({});
+        return;
+    }
+
+    write_batch batch{};
+    std::vector<key> written{};
+    written.reserve(dirty_.size());
+    for (const auto &k : dirty_)
+    {
+        batch.put(store_key(k), encode_total(totals_.at(k).value));
+        written.push_back(k);
+        ++in_flight_[k];
+    }
+    dirty_.clear();
+    store_.async_write(std::move(batch), [this, written = std::move(written), completion = std::move(completion)](
+                                             const boost::system::error_code ec) mutable {
+        {
+            std::unique_lock lock{mutex_};
+            for (const auto &k : written)
+            {
+                if (const auto it{in_flight_.find(k)}; --it->second == 0)
+                {
+                    in_flight_.erase(it);
+                }
+                // written again by the next flush, with whatever the totals are by then
+                if (ec && totals_.contains(k))
+                {
+                    dirty_.insert(k);
+                }
+            }
+        }
+        if (!ec)
+        {
+            written_totals_.fetch_add(written.size(), std::memory_order_relaxed);
+        }
+        completion(ec);
+    });
+}
+
+boost::asio::awaitable<void, counter_service::executor_type> counter_service::run()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (flush_interval_.count() == 0)
+    {
+        co_return;
+    }
+
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(flush_interval_);
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+        const auto [flush_ec]{co_await async_flush(boost::asio::as_tuple(boost::asio::deferred))};
+        if (flush_ec)
+        {
+            LPBACKEND_LOG(lg_, warning) << "Failed to write the counters: " << flush_ec.message();
+        }
+    }
+}
+
+void counter_service::close()
+{
+    std::promise<boost::system::error_code> done{};
+    auto written{done.get_future()};
+    flush([&done](const boost::system::error_code ec) { done.set_value(ec); });
+    if (const auto ec{written.get()})
+    {
+        LPBACKEND_LOG(lg_, error) << "Failed to write the counters: " << ec.message();
+    }
+}
+
+counter_service::statistics counter_service::collect()
+{
+    std::uint64_t increments{};
+    for (std::size_t i{}; i < shard_count_; ++i)
+    {
+        std::lock_guard lock{shards_[i].mutex};
+        increments += std::exchange(shards_[i].increments, 0);
+    }
+    std::shared_lock lock{mutex_};
+    return statistics{.increments = increments,
+                      .flushes = flushes_.exchange(0, std::memory_order_relaxed),
+                      .written_totals = written_totals_.exchange(0, std::memory_order_relaxed),
+                      .evicted_totals = evicted_totals_.exchange(0, std::memory_order_relaxed),
+                      .totals = totals_.size()};
+}
+} // namespace lpbackend::storage
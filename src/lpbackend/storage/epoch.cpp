@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <lpbackend/storage/epoch.hpp>
+
+namespace lpbackend::storage::epoch
+{
+namespace
+{
+// retire() tries to advance the epoch every this many retirements
+constexpr std::size_t collect_interval{64};
+
+struct alignas(64) participant
+{
+    // the pinned epoch, 0 while the thread is outside any guard
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<bool> in_use{true};
+    participant *next{nullptr};
+};
+
+struct retired_pointer
+{
+    void *pointer;
+    void (*deleter)(void *);
+    std::uint64_t epoch;
+};
+
+void free_all(const std::vector<retired_pointer> &freeing)
+{
+    for (const auto &r : freeing)
+    {
+        r.deleter(r.pointer);
+    }
+}
+
+struct domain
+{
+    std::atomic<std::uint64_t> global{1};
+    // participants are never freed, those of exited threads are reused
+    std::atomic<participant *> participants{nullptr};
+    std::mutex retired_mutex;
+    std::vector<retired_pointer> retired;
+    std::size_t since_collect{0};
+
+    // at exit, other threads that might still hold guards are no longer running code of ours
+    ~domain()
+    {
+        free_all(retired);
+        for (auto *p{participants.load(std::memory_order_acquire)}; p != nullptr;)
+        {
+            delete std::exchange(p, p->next);
+        }
+    }
+
+    participant *acquire()
+    {
+        for (auto *p{participants.load(std::memory_order_acquire)}; p != nullptr; p = p->next)
+        {
+            bool expected{false};
+            if (p->in_use.load(std::memory_order_relaxed) == false &&
+                p->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return p;
+            }
+        }
+        auto *p{new participant{}};
+        p->next = participants.load(std::memory_order_relaxed);
+        while (!participants.compare_exchange_weak(p->next, p, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        return p;
+    }
+
+    // the caller holds retired_mutex and frees what is returned after releasing it
+    std::vector<retired_pointer> collect_locked()
+    {
+        since_collect = 0;
+        const auto current{global.load(std::memory_order_seq_cst)};
+        bool advance{true};
+        for (auto *p{participants.load(std::memory_order_acquire)}; p != nullptr; p = p->next)
+        {
+            const auto pinned{p->epoch.load(std::memory_order_seq_cst)};
+            if (pinned != 0 && pinned != current)
+            {
+                advance = false;
+                break;
+            }
+        }
+        // every pinned thread has seen the current epoch, so none is pinned before it any more
+        const auto safe{advance ? current + 1 : current};
+        if (advance)
+        {
+            global.store(safe, std::memory_order_seq_cst);
+        }
+        // anything retired two epochs ago cannot be reached by a guard that is still alive
+        const auto last{
+            std::partition(retired.begin(), retired.end(), [safe](const auto &r) { return r.epoch + 2 > safe; })};
+        std::vector<retired_pointer> freeing(std::make_move_iterator(last), std::make_move_iterator(retired.end()));
+        retired.erase(last, retired.end());
+        return freeing;
+    }
+};
+
+domain &instance()
+{
+    static domain d{};
+    return d;
+}
+
+struct local_state
+{
+    participant *self{instance().acquire()};
+    std::size_t depth{0};
+
+    ~local_state()
+    {
+        self->epoch.store(0, std::memory_order_release);
+        self->in_use.store(false, std::memory_order_release);
+    }
+};
+
+local_state &local()
+{
+    thread_local local_state state{};
+    return state;
+}
+} // namespace
+
+guard::guard() noexcept
+{
+    auto &state{local()};
+    if (state.depth++ != 0)
+    {
+        return;
+    }
+    auto &d{instance()};
+    auto pinned{d.global.load(std::memory_order_seq_cst)};
+    // a collector that missed the pin must not have advanced past it meanwhile
+    for (;;)
+    {
+        state.self->epoch.store(pinned, std::memory_order_seq_cst);
+        const auto current{d.global.load(std::memory_order_seq_cst)};
+        if (current == pinned)
+        {
+            break;
+        }
+        pinned = current;
+    }
+}
+
+guard::~guard()
+{
+    auto &state{local()};
+    if (--state.depth == 0)
+    {
+        state.self->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void retire(void *pointer, void (*deleter)(void *))
+{
+    auto &d{instance()};
+    std::vector<retired_pointer> freeing{};
+    {
+        std::lock_guard lock{d.retired_mutex};
+        d.retired.emplace_back(retired_pointer{pointer, deleter, d.global.load(std::memory_order_seq_cst)});
+        if (++d.since_collect >= collect_interval)
+        {
+            freeing = d.collect_locked();
+        }
+    }
+    free_all(freeing);
+}
+
+std::size_t collect()
+{
+    auto &d{instance()};
+    std::vector<retired_pointer> freeing{};
+    std::size_t waiting{};
+    {
+        std::lock_guard lock{d.retired_mutex};
+        freeing = d.collect_locked();
+        waiting = d.retired.size();
+    }
+    free_all(freeing);
+    return waiting;
+}
+} // namespace lpbackend::storage::epoch
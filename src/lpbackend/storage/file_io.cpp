@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cxx_detect.h>
+
+#if CXX_OS_WINDOWS
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+#include <lpbackend/storage/file_io.hpp>
+
+namespace lpbackend::storage
+{
+void write_at(boost::beast::file &file, std::uint64_t offset, std::string_view data, boost::system::error_code &ec)
+{
+    ec = {};
+    while (!data.empty())
+    {
+#if CXX_OS_WINDOWS
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xffffffff);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written{};
+        const auto chunk{static_cast<DWORD>(std::min<std::size_t>(data.size(), MAXDWORD))};
+        if (!WriteFile(file.native_handle(), data.data(), chunk, &written, &overlapped))
+        {
+            ec.assign(static_cast<int>(GetLastError()), boost::system::system_category());
+            return;
+        }
+#else
+        const auto written{::pwrite(file.native_handle(), data.data(), data.size(), static_cast<off_t>(offset))};
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ec.assign(errno, boost::system::generic_category());
+            return;
+        }
+#endif
+        if (written == 0)
+        {
+            // a device that accepts nothing would make no progress
+            ec = boost::system::errc::make_error_code(boost::system::errc::no_space_on_device);
+            return;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+        offset += static_cast<std::uint64_t>(written);
+    }
+}
+
+void sync_file(boost::beast::file &file, boost::system::error_code &ec)
+{
+    ec = {};
+#if CXX_OS_WINDOWS
+    if (!FlushFileBuffers(file.native_handle()))
+    {
+        ec.assign(static_cast<int>(GetLastError()), boost::system::system_category());
+    }
+#elif defined(__APPLE__)
+    // fsync on macOS does not reach the disk
+    if (::fcntl(file.native_handle(), F_FULLFSYNC) == -1)
+    {
+        ec.assign(errno, boost::system::generic_category());
+    }
+#else
+    if (::fdatasync(file.native_handle()) == -1)
+    {
+        ec.assign(errno, boost::system::generic_category());
+    }
+#endif
+}
+
+void sync_directory([[maybe_unused]] const std::filesystem::path &directory)
+{
+#if !CXX_OS_WINDOWS
+    const auto fd{::open(directory.c_str(), O_RDONLY | O_DIRECTORY)};
+    if (fd == -1)
+    {
+        throw std::filesystem::filesystem_error{"Failed to open directory", directory,
+                                                std::error_code{errno, std::generic_category()}};
+    }
+    const auto result{::fsync(fd)};
+    const auto error{errno};
+    ::close(fd);
+    if (result == -1)
+    {
+        throw std::filesystem::filesystem_error{"Failed to sync directory", directory,
+                                                std::error_code{error, std::generic_category()}};
+    }
+#endif
+}
+} // namespace lpbackend::storage
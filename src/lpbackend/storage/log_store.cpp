@@ -0,0 +1,781 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/beast.hpp>
+#include <boost/crc.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fmt/format.h>
+
+#include <lpbackend/memory/accounting.hpp>
+#include <lpbackend/storage/file_io.hpp>
+#include <lpbackend/storage/log_store.hpp>
+
+namespace lpbackend::storage
+{
+namespace
+{
+constexpr std::string_view segment_magic{"LPSEGMNT"};
+constexpr std::uint32_t format_version{1};
+// magic, version, flags, id and a reserved word
+constexpr std::uint64_t segment_header_size{32};
+constexpr std::uint32_t segment_compacted{1 << 0};
+// checksum, flags, key size and value size
+constexpr std::uint64_t record_header_size{16};
+constexpr std::uint32_t record_tombstone{1 << 0};
+constexpr std::uint32_t record_batch_continues{1 << 1};
+// compaction writes its output in chunks of this size
+constexpr std::size_t compaction_chunk_bytes{1 << 20};
+// a rough estimate of an index entry besides its key
+constexpr std::int64_t index_entry_overhead{64};
+
+std::uint32_t load32(const char *in) noexcept
+{
+    std::uint32_t value{};
+    for (std::size_t i{4}; i-- > 0;)
+    {
+        value = value << 8 | static_cast<unsigned char>(in[i]);
+    }
+    return value;
+}
+
+std::uint64_t load64(const char *in) noexcept
+{
+    return load32(in) | static_cast<std::uint64_t>(load32(in + 4)) << 32;
+}
+
+void append32(std::string &out, const std::uint32_t value)
+{
+    for (std::size_t i{}; i < 4; ++i)
+    {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void append64(std::string &out, const std::uint64_t value)
+{
+    append32(out, static_cast<std::uint32_t>(value));
+    append32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+std::uint32_t checksum(const std::string_view data) noexcept
+{
+    boost::crc_32_type crc{};
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+std::string segment_header(const std::uint64_t id, const bool compacted)
+{
+    std::string header{segment_magic};
+    append32(header, format_version);
+    append32(header, compacted ? segment_compacted : 0);
+    append64(header, id);
+    append64(header, 0);
+    return header;
+}
+
+std::uint64_t record_size(const std::string_view key, const std::optional<std::string> &value) noexcept
+{
+    return record_header_size + key.size() + (value ? value->size() : 0);
+}
+
+void append_record(std::string &out, const std::string_view key, const std::string_view value,
+                   const std::uint32_t flags)
+{
+    const auto start{out.size()};
+    append32(out, 0);
+    append32(out, flags);
+    append32(out, static_cast<std::uint32_t>(key.size()));
+    append32(out, static_cast<std::uint32_t>(value.size()));
+    out.append(key);
+    out.append(value);
+    const auto crc{checksum(std::string_view{out}.substr(start + 4))};
+    for (std::size_t i{}; i < 4; ++i)
+    {
+        out[start + i] = static_cast<char>(crc >> (8 * i));
+    }
+}
+
+struct record_view
+{
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t flags;
+    std::string_view key;
+    std::string_view value;
+};
+
+/**
+ * @brief Visits the records of every complete batch in a segment
+ *
+ * Stops at the zeros of the preallocated space, at a record that is cut off
+ * or fails its checksum, and drops the batch that record belongs to.
+ *
+ * @return the end of the last complete batch
+ */
+template <typename Visitor> std::uint64_t scan(const std::string_view data, Visitor &&visit)
+{
+    std::vector<record_view> batch{};
+    std::uint64_t offset{segment_header_size};
+    std::uint64_t end{segment_header_size};
+    while (data.size() - offset >= record_header_size)
+    {
+        const auto *header{data.data() + offset};
+        const auto crc{load32(header)};
+        const auto flags{load32(header + 4)};
+        const auto key_size{load32(header + 8)};
+        const auto value_size{load32(header + 12)};
+        if (crc == 0 && flags == 0 && key_size == 0 && value_size == 0)
+        {
+            break;
+        }
+        const auto size{record_header_size + key_size + value_size};
+        if (size > data.size() - offset || checksum(data.substr(offset + 4, size - 4)) != crc)
+        {
+            break;
+        }
+        batch.push_back(record_view{.offset = offset,
+                                    .size = size,
+                                    .flags = flags,
+                                    .key = data.substr(offset + record_header_size, key_size),
+                                    .value = data.substr(offset + record_header_size + key_size, value_size)});
+        offset += size;
+        if (!(flags & record_batch_continues))
+        {
+            for (const auto &record : batch)
+            {
+                visit(record);
+            }
+            batch.clear();
+            end = offset;
+        }
+    }
+    return end;
+}
+
+void throw_if(const boost::system::error_code &ec, const std::string_view what)
+{
+    if (ec)
+    {
+        throw boost::system::system_error{ec, std::string{what}};
+    }
+}
+} // namespace
+
+struct log_store::segment
+{
+    std::uint64_t id{};
+    // counts the compactions that produced the segment, a new file name for each
+    std::uint64_t generation{};
+    std::filesystem::path path;
+    boost::interprocess::mapped_region region;
+    // open for writing while the segment is active
+    boost::beast::file file;
+    bool compacted{false};
+    // the end of the committed records
+    std::uint64_t size{};
+    // bytes of records the index points at, guarded by mutex_
+    std::uint64_t live_bytes{};
+    // removes the file once the last reader is done with the mapping
+    std::atomic<bool> obsolete{false};
+
+    std::string_view data() const noexcept
+    {
+        return {static_cast<const char *>(region.get_address()), region.get_size()};
+    }
+
+    ~segment()
+    {
+        if (obsolete.load(std::memory_order_acquire))
+        {
+            region = boost::interprocess::mapped_region{};
+            boost::system::error_code ec{};
+            file.close(ec);
+            std::error_code remove_ec{};
+            std::filesystem::remove(path, remove_ec);
+        }
+    }
+};
+
+std::filesystem::path log_store::path_of(const std::uint64_t id, const std::uint64_t generation) const
+{
+    if (generation == 0)
+    {
+        return directory_ / fmt::format("{:016x}.log", id);
+    }
+    return directory_ / fmt::format("{:016x}-{:x}.log", id, generation);
+}
+
+std::shared_ptr<log_store::segment> log_store::map_segment(const std::uint64_t id,
+                                                           const std::filesystem::path &path) const
+{
+    auto result{std::make_shared<segment>()};
+    result->id = id;
+    result->path = path;
+    const boost::interprocess::file_mapping file{path.string().c_str(), boost::interprocess::read_only};
+    result->region = boost::interprocess::mapped_region{file, boost::interprocess::read_only};
+
+    const auto data{result->data()};
+    if (data.size() < segment_header_size || data.substr(0, segment_magic.size()) != segment_magic ||
+        load32(data.data() + 8) != format_version || load64(data.data() + 16) != id)
+    {
+        throw std::runtime_error{fmt::format("{} is not a segment of this store", path.string())};
+    }
+    result->compacted = load32(data.data() + 12) & segment_compacted;
+    result->size = segment_header_size;
+    return result;
+}
+
+std::shared_ptr<log_store::segment> log_store::create_segment(const std::uint64_t id)
+{
+    const auto path{path_of(id)};
+    boost::beast::file file{};
+    boost::system::error_code ec{};
+    file.open(path.string().c_str(), boost::beast::file_mode::write, ec);
+    throw_if(ec, "Failed to create a segment");
+    write_at(file, 0, segment_header(id, false), ec);
+    throw_if(ec, "Failed to write a segment header");
+    // the zeros of the preallocated space mark the end of the records
+    std::filesystem::resize_file(path, segment_bytes_);
+    sync_file(file, ec);
+    throw_if(ec, "Failed to sync a segment");
+    sync_directory(directory_);
+
+    auto result{map_segment(id, path)};
+    result->file = std::move(file);
+    return result;
+}
+
+void log_store::apply(const std::string_view key, const std::optional<location> &record)
+{
+    auto found{index_.find(key)};
+    if (found != index_.end())
+    {
+        segments_.at(found->second.segment)->live_bytes -= found->second.record_size;
+    }
+    if (record)
+    {
+        segments_.at(record->segment)->live_bytes += record->record_size;
+        if (found != index_.end())
+        {
+            found->second = *record;
+        }
+        else
+        {
+            index_.emplace(std::string{key}, *record);
+            memory::account(memory::tag::storage_index, static_cast<std::int64_t>(key.size()) + index_entry_overhead);
+        }
+    }
+    else if (found != index_.end())
+    {
+        index_.erase(found);
+        memory::account(memory::tag::storage_index, -(static_cast<std::int64_t>(key.size()) + index_entry_overhead));
+    }
+}
+
+void log_store::recover()
+{
+    std::filesystem::create_directories(directory_);
+
+    // ids with their generations, <id>.log or <id>-<generation>.log
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ids{};
+    for (const auto &entry : std::filesystem::directory_iterator{directory_})
+    {
+        const auto &path{entry.path()};
+        if (path.extension() == ".compacting")
+        {
+            // an unfinished compaction, the segments it read are all still there
+            std::filesystem::remove(path);
+            continue;
+        }
+        const auto stem{path.stem().string()};
+        const auto *const end{stem.data() + stem.size()};
+        std::uint64_t id{};
+        std::uint64_t generation{};
+        if (path.extension() != ".log" || stem.size() < 16 ||
+            std::from_chars(stem.data(), stem.data() + 16, id, 16).ptr != stem.data() + 16)
+        {
+            continue;
+        }
+        if (stem.size() == 16 ||
+            (stem.size() > 17 && stem[16] == '-' && std::from_chars(stem.data() + 17, end, generation, 16).ptr == end))
+        {
+            ids.emplace_back(id, generation);
+        }
+    }
+    std::ranges::sort(ids);
+
+    std::vector<std::shared_ptr<segment>> found{};
+    for (const auto &[id, generation] : ids)
+    {
+        auto mapped{map_segment(id, path_of(id, generation))};
+        mapped->generation = generation;
+        // a compacted segment holds everything that is alive below it, older generations of its id included
+        if (mapped->compacted)
+        {
+            for (const auto &superseded : found)
+            {
+                superseded->obsolete.store(true, std::memory_order_release);
+            }
+            found.clear();
+        }
+        found.push_back(std::move(mapped));
+    }
+
+    std::unique_lock lock{mutex_};
+    for (const auto &recovered : found)
+    {
+        segments_.emplace(recovered->id, recovered);
+        recovered->size = scan(recovered->data(), [this, &recovered](const record_view &record) {
+            if (record.flags & record_tombstone)
+            {
+                apply(record.key, std::nullopt);
+                return;
+            }
+            apply(record.key, location{.segment = recovered->id,
+                                       .offset = record.offset,
+                                       .record_size = static_cast<std::uint32_t>(record.size),
+                                       .value_size = static_cast<std::uint32_t>(record.value.size())});
+        });
+    }
+    next_id_ = ids.empty() ? 0 : ids.back().first + 1;
+
+    // appending continues where the last segment ends unless it is mostly full, records of a torn batch are
+    // overwritten
+    if (!found.empty() && !found.back()->compacted &&
+        found.back()->data().size() - found.back()->size >= segment_bytes_ / 2)
+    {
+        active_ = found.back();
+        boost::system::error_code ec{};
+        active_->file.open(active_->path.string().c_str(), boost::beast::file_mode::write_existing, ec);
+        throw_if(ec, "Failed to open the last segment");
+    }
+    else
+    {
+        active_ = create_segment(next_id_++);
+        segments_.emplace(active_->id, active_);
+    }
+    active_id_.store(active_->id, std::memory_order_relaxed);
+}
+
+void log_store::open(const config::lpbackend_config::fields_t::storage_t &storage)
+{
+    directory_ = storage.directory;
+    segment_bytes_ = std::max<std::uint64_t>(storage.segment_bytes, 1 << 20);
+    garbage_percent_ = std::clamp<std::uint64_t>(storage.compaction_garbage_percent, 1, 100);
+    check_interval_ = std::chrono::seconds{storage.compaction_check_seconds};
+    recover();
+
+    std::shared_lock lock{mutex_};
+    LPBACKEND_LOG(lg_, info) << fmt::format("Opened store at {} ({} keys in {} segments)", directory_.string(),
+                                            index_.size(), segments_.size());
+    // one thread commits and one compacts
+    threads_.emplace(2);
+}
+
+void log_store::close()
+{
+    if (threads_)
+    {
+        threads_->join();
+        threads_.reset();
+    }
+}
+
+bool log_store::is_open() const noexcept
+{
+    return threads_.has_value();
+}
+
+std::optional<std::string> log_store::get(const std::string_view key) const
+{
+    std::shared_ptr<segment> holder{};
+    location found{};
+    {
+        std::shared_lock lock{mutex_};
+        const auto entry{index_.find(key)};
+        if (entry == index_.end())
+        {
+            return std::nullopt;
+        }
+        found = entry->second;
+        holder = segments_.at(found.segment);
+    }
+    // committed records are never modified, the mapping can be read without the lock
+    return std::string{holder->data().substr(found.offset + found.record_size - found.value_size, found.value_size)};
+}
+
+bool log_store::contains(const std::string_view key) const
+{
+    std::shared_lock lock{mutex_};
+    return index_.contains(key);
+}
+
+void log_store::submit(write_batch batch, completion_type completion)
+{
+    if (!threads_)
+    {
+        completion(boost::system::errc::make_error_code(boost::system::errc::bad_file_descriptor));
+        return;
+    }
+    std::lock_guard lock{pending_mutex_};
+    pending_.push_back(pending_batch{std::move(batch), std::move(completion)});
+    if (!committing_)
+    {
+        committing_ = true;
+        boost::asio::post(*threads_, [this] { commit_pending(); });
+    }
+}
+
+void log_store::commit_pending()
+{
+    for (;;)
+    {
+        std::vector<pending_batch> batches{};
+        {
+            std::lock_guard lock{pending_mutex_};
+            if (pending_.empty())
+            {
+                committing_ = false;
+                return;
+            }
+            batches.swap(pending_);
+        }
+
+        std::vector<boost::system::error_code> errors(batches.size());
+        std::vector<std::vector<location>> placements(batches.size());
+        std::vector<std::size_t> buffered{};
+        std::string buffer{};
+        auto start{active_->size};
+
+        // writes and syncs the buffered batches, then makes them visible
+        const auto commit{[&] {
+            if (buffered.empty())
+            {
+                return;
+            }
+            boost::system::error_code ec{};
+            write_at(active_->file, start, buffer, ec);
+            if (!ec)
+            {
+                sync_file(active_->file, ec);
+            }
+            if (ec)
+            {
+                LPBACKEND_LOG(lg_, error) << fmt::format("Failed to commit to {}: {}", active_->path.string(),
+                                                         ec.message());
+                for (const auto i : buffered)
+                {
+                    errors[i] = ec;
+                }
+            }
+            else
+            {
+                std::unique_lock lock{mutex_};
+                for (const auto i : buffered)
+                {
+                    const auto &operations{batches[i].batch.operations()};
+                    for (std::size_t k{}; k < operations.size(); ++k)
+                    {
+                        const auto &record{placements[i][k]};
+                        apply(operations[k].key, operations[k].value ? std::optional{record} : std::nullopt);
+                    }
+                    records_.fetch_add(operations.size(), std::memory_order_relaxed);
+                }
+                active_->size = start + buffer.size();
+                commits_.fetch_add(1, std::memory_order_relaxed);
+                written_bytes_.fetch_add(buffer.size(), std::memory_order_relaxed);
+            }
+            start += ec ? 0 : buffer.size();
+            buffer.clear();
+            buffered.clear();
+        }};
+
+        for (std::size_t i{}; i < batches.size(); ++i)
+        {
+            const auto &operations{batches[i].batch.operations()};
+            std::uint64_t bytes{};
+            bool representable{true};
+            for (const auto &operation : operations)
+            {
+                constexpr auto limit{std::numeric_limits<std::uint32_t>::max()};
+                bytes += record_size(operation.key, operation.value);
+                representable = representable && operation.key.size() <= limit &&
+                                (!operation.value || operation.value->size() <= limit);
+            }
+            if (operations.empty())
+            {
+                continue;
+            }
+            if (!representable || bytes > segment_bytes_ - segment_header_size)
+            {
+                errors[i] = boost::system::errc::make_error_code(boost::system::errc::file_too_large);
+                continue;
+            }
+
+            // a batch never spans two segments
+            if (start + buffer.size() + bytes > active_->data().size())
+            {
+                commit();
+                try
+                {
+                    auto next{create_segment(next_id_++)};
+                    std::unique_lock lock{mutex_};
+                    segments_.emplace(next->id, next);
+                    boost::system::error_code ec{};
+                    active_->file.close(ec);
+                    active_ = std::move(next);
+                    active_id_.store(active_->id, std::memory_order_relaxed);
+                }
+                catch (const std::exception &e)
+                {
+                    LPBACKEND_LOG(lg_, error) << "Failed to start a segment: " << e.what();
+                    errors[i] = boost::system::errc::make_error_code(boost::system::errc::io_error);
+                    continue;
+                }
+                start = active_->size;
+            }
+
+            for (std::size_t k{}; k < operations.size(); ++k)
+            {
+                const auto &operation{operations[k]};
+                const std::string_view value{operation.value ? *operation.value : std::string_view{}};
+                const auto offset{start + buffer.size()};
+                append_record(buffer, operation.key, value,
+                              (operation.value ? 0 : record_tombstone) |
+                                  (k + 1 < operations.size() ? record_batch_continues : 0));
+                const auto size{start + buffer.size() - offset};
+                placements[i].push_back(location{.segment = active_->id,
+                                                 .offset = offset,
+                                                 .record_size = static_cast<std::uint32_t>(size),
+                                                 .value_size = static_cast<std::uint32_t>(value.size())});
+            }
+            buffered.push_back(i);
+        }
+        commit();
+
+        batches_.fetch_add(batches.size(), std::memory_order_relaxed);
+        auto largest{largest_commit_.load(std::memory_order_relaxed)};
+        while (largest < batches.size() &&
+               !largest_commit_.compare_exchange_weak(largest, batches.size(), std::memory_order_relaxed))
+        {
+        }
+        for (std::size_t i{}; i < batches.size(); ++i)
+        {
+            batches[i].completion(errors[i]);
+        }
+    }
+}
+
+void log_store::compact()
+{
+    // the oldest sealed segments whose live records fit into one segment
+    std::vector<std::shared_ptr<segment>> victims{};
+    std::uint64_t total{};
+    std::uint64_t live{};
+    {
+        std::shared_lock lock{mutex_};
+        const auto active{active_id_.load(std::memory_order_relaxed)};
+        for (const auto &[id, candidate] : segments_)
+        {
+            if (id >= active || live + candidate->live_bytes > segment_bytes_ - segment_header_size)
+            {
+                break;
+            }
+            victims.push_back(candidate);
+            total += candidate->size - segment_header_size;
+            live += candidate->live_bytes;
+        }
+    }
+    if (victims.empty() || total == live || (total - live) * 100 < total * garbage_percent_)
+    {
+        return;
+    }
+
+    // the output keeps the id of the newest victim under a new file name, a
+    // mapped file cannot be replaced on Windows
+    const auto id{victims.back()->id};
+    const auto generation{victims.back()->generation + 1};
+    const auto target{path_of(id, generation)};
+    auto temporary{target};
+    temporary.replace_extension(".compacting");
+
+    struct relocation
+    {
+        std::string key;
+        location from;
+        location to;
+    };
+    std::vector<relocation> moves{};
+    std::uint64_t written{segment_header_size};
+    try
+    {
+        boost::beast::file file{};
+        boost::system::error_code ec{};
+        file.open(temporary.string().c_str(), boost::beast::file_mode::write, ec);
+        throw_if(ec, "Failed to create the compacted segment");
+        std::string buffer{segment_header(id, true)};
+        std::uint64_t flushed{};
+
+        // tombstones are dropped, no older segment is left that they could shadow
+        for (const auto &victim : victims)
+        {
+            scan(victim->data().substr(0, victim->size), [&](const record_view &record) {
+                if (record.flags & record_tombstone)
+                {
+                    return;
+                }
+                const location from{.segment = victim->id,
+                                    .offset = record.offset,
+                                    .record_size = static_cast<std::uint32_t>(record.size),
+                                    .value_size = static_cast<std::uint32_t>(record.value.size())};
+                {
+                    std::shared_lock lock{mutex_};
+                    const auto entry{index_.find(record.key)};
+                    if (entry == index_.end() || entry->second != from)
+                    {
+                        return;
+                    }
+                }
+                auto to{from};
+                to.segment = id;
+                to.offset = flushed + buffer.size();
+                append_record(buffer, record.key, record.value, 0);
+                moves.push_back(relocation{std::string{record.key}, from, to});
+                if (buffer.size() >= compaction_chunk_bytes)
+                {
+                    write_at(file, flushed, buffer, ec);
+                    throw_if(ec, "Failed to write the compacted segment");
+                    flushed += buffer.size();
+                    buffer.clear();
+                }
+            });
+        }
+        write_at(file, flushed, buffer, ec);
+        throw_if(ec, "Failed to write the compacted segment");
+        written = flushed + buffer.size();
+        sync_file(file, ec);
+        throw_if(ec, "Failed to sync the compacted segment");
+        file.close(ec);
+
+        // from here on a recovery finds the compacted segment and ignores everything below it
+        std::filesystem::rename(temporary, target);
+        sync_directory(directory_);
+    }
+    catch (...)
+    {
+        std::error_code ec{};
+        std::filesystem::remove(temporary, ec);
+        throw;
+    }
+
+    auto output{map_segment(id, target)};
+    output->generation = generation;
+    output->size = written;
+    std::unique_lock lock{mutex_};
+    for (auto &victim : victims)
+    {
+        segments_.erase(victim->id);
+        victim->obsolete.store(true, std::memory_order_release);
+    }
+    segments_.emplace(id, output);
+    std::uint64_t moved{};
+    for (const auto &relocated : moves)
+    {
+        // keys written during the compaction keep their newer record
+        const auto entry{index_.find(relocated.key)};
+        if (entry != index_.end() && entry->second == relocated.from)
+        {
+            entry->second = relocated.to;
+            output->live_bytes += relocated.to.record_size;
+            moved += relocated.to.record_size;
+        }
+    }
+    lock.unlock();
+
+    compactions_.fetch_add(1, std::memory_order_relaxed);
+    reclaimed_bytes_.fetch_add(total - std::min(total, moved), std::memory_order_relaxed);
+    LPBACKEND_LOG(lg_, info) << fmt::format("Compacted {} segments into {}, {} of {} bytes were alive",
+                                            victims.size(), target.filename().string(), moved, total);
+}
+
+boost::asio::awaitable<void, log_store::executor_type> log_store::run()
+{
+    auto state{co_await boost::asio::this_coro::cancellation_state};
+    co_await boost::asio::this_coro::reset_cancellation_state(boost::asio::enable_total_cancellation());
+    if (!threads_ || check_interval_.count() == 0)
+    {
+        co_return;
+    }
+
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    while (!state.cancelled())
+    {
+        timer.expires_after(check_interval_);
+        auto [ec]{co_await timer.async_wait(boost::asio::as_tuple)};
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            co_return;
+        }
+        // compaction runs beside the commits, one at a time
+        if (!compacting_.exchange(true, std::memory_order_acq_rel))
+        {
+            boost::asio::post(*threads_, [this] {
+                try
+                {
+                    compact();
+                }
+                catch (const std::exception &e)
+                {
+                    LPBACKEND_LOG(lg_, error) << "Compaction failed: " << e.what();
+                }
+                compacting_.store(false, std::memory_order_release);
+            });
+        }
+    }
+}
+
+log_store::statistics log_store::collect()
+{
+    std::shared_lock lock{mutex_};
+    return statistics{.commits = commits_.exchange(0, std::memory_order_relaxed),
+                      .batches = batches_.exchange(0, std::memory_order_relaxed),
+                      .records = records_.exchange(0, std::memory_order_relaxed),
+                      .written_bytes = written_bytes_.exchange(0, std::memory_order_relaxed),
+                      .largest_commit = largest_commit_.exchange(0, std::memory_order_relaxed),
+                      .compactions = compactions_.exchange(0, std::memory_order_relaxed),
+                      .reclaimed_bytes = reclaimed_bytes_.exchange(0, std::memory_order_relaxed),
+                      .keys = index_.size(),
+                      .segments = segments_.size()};
+}
+
+log_store::~log_store()
+{
+    close();
+}
+} // namespace lpbackend::storage
@@ -0,0 +1,962 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LPBACKEND_CODEC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LPBACKEND_TARGET(isa)
+#else
+#define LPBACKEND_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LPBACKEND_CODEC_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <lpbackend/util/codec.hpp>
+
+namespace lpbackend::util
+{
+namespace
+{
+constexpr std::string_view base64_digits{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+constexpr std::string_view hex_digits{"0123456789abcdef"};
+
+// 0xff marks characters outside the alphabet
+constexpr auto base64_values{[] {
+    std::array<std::uint8_t, 256> values{};
+    values.fill(0xff);
+    for (std::size_t i{}; i < base64_digits.size(); ++i)
+    {
+        values[static_cast<unsigned char>(base64_digits[i])] = static_cast<std::uint8_t>(i);
+    }
+    return values;
+}()};
+
+constexpr auto hex_values{[] {
+    std::array<std::uint8_t, 256> values{};
+    values.fill(0xff);
+    for (std::uint8_t i{}; i < 10; ++i)
+    {
+        values['0' + i] = i;
+    }
+    for (std::uint8_t i{}; i < 6; ++i)
+    {
+        values['a' + i] = static_cast<std::uint8_t>(10 + i);
+        values['A' + i] = static_cast<std::uint8_t>(10 + i);
+    }
+    return values;
+}()};
+
+// Lookup tables of the UTF-8 validation by Keiser and Lemire. Each bit is an error that a pair of
+// bytes can show, a pair is invalid if the high nibble of its first and second byte and the low
+// nibble of its first byte all agree on an error.
+constexpr std::uint8_t too_short{1 << 0};
+constexpr std::uint8_t too_long{1 << 1};
+constexpr std::uint8_t overlong_3{1 << 2};
+constexpr std::uint8_t too_large{1 << 3};
+constexpr std::uint8_t surrogate{1 << 4};
+constexpr std::uint8_t overlong_2{1 << 5};
+constexpr std::uint8_t too_large_1000{1 << 6};
+constexpr std::uint8_t overlong_4{1 << 6};
+constexpr std::uint8_t two_continuations{1 << 7};
+constexpr std::uint8_t carry{too_short | too_long | two_continuations};
+
+constexpr std::array<std::uint8_t, 16> utf8_byte_1_high{
+    too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+    two_continuations, two_continuations, two_continuations, two_continuations,
+    too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+    too_short | too_large | too_large_1000 | overlong_4};
+
+constexpr std::array<std::uint8_t, 16> utf8_byte_1_low{
+    carry | overlong_3 | overlong_2 | overlong_4,
+    carry | overlong_2,
+    carry,
+    carry,
+    carry | too_large,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000 | surrogate,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000};
+
+constexpr std::array<std::uint8_t, 16> utf8_byte_2_high{
+    too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+    too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+    too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+    too_long | overlong_2 | two_continuations | surrogate | too_large,
+    too_long | overlong_2 | two_continuations | surrogate | too_large,
+    too_short, too_short, too_short, too_short};
+
+// a lead byte in the last 3 bytes of a block exceeds its threshold if its sequence continues in the next block
+constexpr auto utf8_incomplete_thresholds{[] {
+    std::array<std::uint8_t, 32> thresholds{};
+    thresholds.fill(0xff);
+    thresholds[29] = 0xf0 - 1;
+    thresholds[30] = 0xe0 - 1;
+    thresholds[31] = 0xc0 - 1;
+    return thresholds;
+}()};
+
+/**
+ * @brief Kernels of one instruction set
+ *
+ * The bulk kernels process a prefix of the input and return its length, the
+ * scalar code finishes the rest, so they may stop at any block they cannot
+ * handle, e.g. base64 padding.
+ */
+struct kernels
+{
+    std::string_view isa;
+    std::size_t (*base64_encode)(const std::uint8_t *in, std::size_t size, char *out) noexcept;
+    // may write up to 32 bytes past the decoded prefix
+    std::size_t (*base64_decode)(const char *in, std::size_t size, std::uint8_t *out) noexcept;
+    std::size_t (*hex_encode)(const std::uint8_t *in, std::size_t size, char *out) noexcept;
+    bool (*validate_utf8)(const char *in, std::size_t size) noexcept;
+    // returns size if there is no '%'
+    std::size_t (*find_percent)(const char *in, std::size_t size) noexcept;
+};
+
+std::size_t no_bulk_encode(const std::uint8_t *, std::size_t, char *) noexcept
+{
+    return 0;
+}
+
+std::size_t no_bulk_decode(const char *, std::size_t, std::uint8_t *) noexcept
+{
+    return 0;
+}
+
+bool validate_utf8_scalar(const char *in, const std::size_t size) noexcept
+{
+    const auto *bytes{reinterpret_cast<const std::uint8_t *>(in)};
+    std::size_t i{};
+    while (i < size)
+    {
+        const auto lead{bytes[i]};
+        if (lead < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        std::size_t length{};
+        std::uint32_t code_point{};
+        std::uint32_t minimum{};
+        if ((lead & 0xe0) == 0xc0)
+        {
+            length = 2;
+            code_point = lead & 0x1f;
+            minimum = 0x80;
+        }
+        else if ((lead & 0xf0) == 0xe0)
+        {
+            length = 3;
+            code_point = lead & 0x0f;
+            minimum = 0x800;
+        }
+        else if ((lead & 0xf8) == 0xf0)
+        {
+            length = 4;
+            code_point = lead & 0x07;
+            minimum = 0x10000;
+        }
+        else
+        {
+            return false;
+        }
+        if (size - i < length)
+        {
+            return false;
+        }
+        for (std::size_t k{1}; k < length; ++k)
+        {
+            if ((bytes[i + k] & 0xc0) != 0x80)
+            {
+                return false;
+            }
+            code_point = code_point << 6 | (bytes[i + k] & 0x3f);
+        }
+        if (code_point < minimum || code_point > 0x10ffff || (code_point >= 0xd800 && code_point <= 0xdfff))
+        {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+std::size_t find_percent_scalar(const char *in, const std::size_t size) noexcept
+{
+    const auto *found{static_cast<const char *>(std::memchr(in, '%', size))};
+    return found ? static_cast<std::size_t>(found - in) : size;
+}
+
+#if LPBACKEND_CODEC_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+bool cpu_has_sse42() noexcept
+{
+    int info[4]{};
+    __cpuid(info, 1);
+    return info[2] & (1 << 20);
+}
+
+bool cpu_has_avx2() noexcept
+{
+    int info[4]{};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    // the OS must save the YMM registers as well
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+}
+#else
+bool cpu_has_sse42() noexcept
+{
+    return __builtin_cpu_supports("sse4.2");
+}
+
+bool cpu_has_avx2() noexcept
+{
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+template <std::size_t N> __m128i load_table(const std::array<std::uint8_t, N> &table) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(table.data()));
+}
+
+// Base64 with SSSE3 and AVX2 after Muła and Lemire: bytes are spread to 6-bit indices by
+// shuffles and multiplications, indices become characters by adding a per-range offset
+LPBACKEND_TARGET("sse4.2") __m128i base64_indices_sse(const __m128i in) noexcept
+{
+    const auto spread{_mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1))};
+    const auto t0{_mm_and_si128(spread, _mm_set1_epi32(0x0fc0fc00))};
+    const auto t1{_mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040))};
+    const auto t2{_mm_and_si128(spread, _mm_set1_epi32(0x003f03f0))};
+    const auto t3{_mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010))};
+    return _mm_or_si128(t1, t3);
+}
+
+LPBACKEND_TARGET("sse4.2") __m128i base64_characters_sse(const __m128i indices) noexcept
+{
+    const auto offsets{_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0)};
+    auto range{_mm_subs_epu8(indices, _mm_set1_epi8(51))};
+    range = _mm_sub_epi8(range, _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+}
+
+LPBACKEND_TARGET("sse4.2")
+std::size_t base64_encode_sse(const std::uint8_t *in, const std::size_t size, char *out) noexcept
+{
+    std::size_t i{};
+    // 16 bytes are loaded for the 12 that are encoded
+    for (; i + 16 <= size; i += 12, out += 16)
+    {
+        const auto block{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), base64_characters_sse(base64_indices_sse(block)));
+    }
+    return i;
+}
+
+LPBACKEND_TARGET("sse4.2")
+std::size_t base64_decode_sse(const char *in, const std::size_t size, std::uint8_t *out) noexcept
+{
+    const auto lut_lo{_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b,
+                                    0x1b, 0x1b, 0x1a)};
+    const auto lut_hi{_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                    0x10, 0x10, 0x10)};
+    const auto lut_roll{_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0)};
+    const auto mask_2f{_mm_set1_epi8(0x2f)};
+    const auto pack{_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)};
+
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16, out += 12)
+    {
+        auto block{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))};
+        const auto hi_nibbles{_mm_and_si128(_mm_srli_epi32(block, 4), mask_2f)};
+        const auto lo_nibbles{_mm_and_si128(block, mask_2f)};
+        // padding and characters outside the alphabet are left to the scalar code
+        if (!_mm_testz_si128(_mm_shuffle_epi8(lut_lo, lo_nibbles), _mm_shuffle_epi8(lut_hi, hi_nibbles)))
+        {
+            break;
+        }
+        const auto roll{_mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(block, mask_2f), hi_nibbles))};
+        block = _mm_add_epi8(block, roll);
+        const auto merged{_mm_madd_epi16(_mm_maddubs_epi16(block, _mm_set1_epi32(0x01400140)),
+                                         _mm_set1_epi32(0x00011000))};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_shuffle_epi8(merged, pack));
+    }
+    return i;
+}
+
+LPBACKEND_TARGET("sse4.2")
+std::size_t hex_encode_sse(const std::uint8_t *in, const std::size_t size, char *out) noexcept
+{
+    const auto digits{_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex_digits.data()))};
+    const auto nibble{_mm_set1_epi8(0x0f)};
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16, out += 32)
+    {
+        const auto block{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))};
+        const auto high{_mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(block, 4), nibble))};
+        const auto low{_mm_shuffle_epi8(digits, _mm_and_si128(block, nibble))};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+struct utf8_state_sse
+{
+    __m128i previous;
+    __m128i incomplete;
+    __m128i error;
+};
+
+LPBACKEND_TARGET("sse4.2") void utf8_block_sse(utf8_state_sse &state, const __m128i input) noexcept
+{
+    if (_mm_movemask_epi8(input) == 0)
+    {
+        // ASCII cannot continue a sequence of the previous block
+        state.error = _mm_or_si128(state.error, state.incomplete);
+    }
+    else
+    {
+        const auto nibble{_mm_set1_epi8(0x0f)};
+        const auto prev1{_mm_alignr_epi8(input, state.previous, 15)};
+        const auto byte_1_high{
+            _mm_shuffle_epi8(load_table(utf8_byte_1_high), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble))};
+        const auto byte_1_low{_mm_shuffle_epi8(load_table(utf8_byte_1_low), _mm_and_si128(prev1, nibble))};
+        const auto byte_2_high{
+            _mm_shuffle_epi8(load_table(utf8_byte_2_high), _mm_and_si128(_mm_srli_epi16(input, 4), nibble))};
+        const auto special{_mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high)};
+
+        // the third and fourth byte of a sequence must be continuations
+        const auto prev2{_mm_alignr_epi8(input, state.previous, 14)};
+        const auto prev3{_mm_alignr_epi8(input, state.previous, 13)};
+        const auto third{_mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xe0 - 0x80)))};
+        const auto fourth{_mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xf0 - 0x80)))};
+        const auto must_continue{_mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)))};
+        state.error = _mm_or_si128(state.error, _mm_xor_si128(must_continue, special));
+        state.incomplete = _mm_subs_epu8(
+            input, _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_incomplete_thresholds.data() + 16)));
+    }
+    state.previous = input;
+}
+
+LPBACKEND_TARGET("sse4.2") bool validate_utf8_sse(const char *in, const std::size_t size) noexcept
+{
+    utf8_state_sse state{_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16)
+    {
+        utf8_block_sse(state, _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+    }
+    // the rest is padded with ASCII, which also ends any sequence left open
+    std::array<char, 16> tail{};
+    std::memcpy(tail.data(), in + i, size - i);
+    utf8_block_sse(state, _mm_loadu_si128(reinterpret_cast<const __m128i *>(tail.data())));
+    if (size - i == 16)
+    {
+        utf8_block_sse(state, _mm_setzero_si128());
+    }
+    return _mm_testz_si128(state.error, state.error);
+}
+
+LPBACKEND_TARGET("sse4.2") std::size_t find_percent_sse(const char *in, const std::size_t size) noexcept
+{
+    const auto percent{_mm_set1_epi8('%')};
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto mask{static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), percent)))};
+        if (mask)
+        {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_percent_scalar(in + i, size - i);
+}
+
+LPBACKEND_TARGET("avx2") __m256i broadcast(const __m128i value) noexcept
+{
+    return _mm256_broadcastsi128_si256(value);
+}
+
+LPBACKEND_TARGET("avx2")
+std::size_t base64_encode_avx2(const std::uint8_t *in, const std::size_t size, char *out) noexcept
+{
+    const auto spread{broadcast(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1))};
+    const auto offsets{broadcast(_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0))};
+    std::size_t i{};
+    // every lane encodes 12 bytes, the second lane loads 4 bytes past the 24 that are encoded
+    for (; i + 28 <= size; i += 24, out += 32)
+    {
+        auto block{_mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12)), 1)};
+        block = _mm256_shuffle_epi8(block, spread);
+        const auto t0{_mm256_and_si256(block, _mm256_set1_epi32(0x0fc0fc00))};
+        const auto t1{_mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040))};
+        const auto t2{_mm256_and_si256(block, _mm256_set1_epi32(0x003f03f0))};
+        const auto t3{_mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010))};
+        const auto indices{_mm256_or_si256(t1, t3)};
+        auto range{_mm256_subs_epu8(indices, _mm256_set1_epi8(51))};
+        range = _mm256_sub_epi8(range, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out),
+                            _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range)));
+    }
+    // the SSE kernels use legacy encodings, which stall on dirty upper halves
+    _mm256_zeroupper();
+    return i + base64_encode_sse(in + i, size - i, out);
+}
+
+LPBACKEND_TARGET("avx2")
+std::size_t base64_decode_avx2(const char *in, const std::size_t size, std::uint8_t *out) noexcept
+{
+    const auto lut_lo{broadcast(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+                                              0x1b, 0x1b, 0x1b, 0x1a))};
+    const auto lut_hi{broadcast(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+                                              0x10, 0x10, 0x10, 0x10))};
+    const auto lut_roll{broadcast(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0))};
+    const auto mask_2f{_mm256_set1_epi8(0x2f)};
+    const auto pack{broadcast(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1))};
+    const auto join{_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7)};
+
+    std::size_t i{};
+    for (; i + 32 <= size; i += 32, out += 24)
+    {
+        auto block{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i))};
+        const auto hi_nibbles{_mm256_and_si256(_mm256_srli_epi32(block, 4), mask_2f)};
+        const auto lo_nibbles{_mm256_and_si256(block, mask_2f)};
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo_nibbles), _mm256_shuffle_epi8(lut_hi, hi_nibbles)))
+        {
+            break;
+        }
+        const auto roll{
+            _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(block, mask_2f), hi_nibbles))};
+        block = _mm256_add_epi8(block, roll);
+        const auto merged{_mm256_madd_epi16(_mm256_maddubs_epi16(block, _mm256_set1_epi32(0x01400140)),
+                                            _mm256_set1_epi32(0x00011000))};
+        const auto packed{_mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack), join)};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), packed);
+    }
+    _mm256_zeroupper();
+    return i + base64_decode_sse(in + i, size - i, out);
+}
+
+LPBACKEND_TARGET("avx2")
+std::size_t hex_encode_avx2(const std::uint8_t *in, const std::size_t size, char *out) noexcept
+{
+    const auto digits{broadcast(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex_digits.data())))};
+    const auto nibble{_mm256_set1_epi8(0x0f)};
+    std::size_t i{};
+    for (; i + 32 <= size; i += 32, out += 64)
+    {
+        const auto block{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i))};
+        const auto high{_mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble))};
+        const auto low{_mm256_shuffle_epi8(digits, _mm256_and_si256(block, nibble))};
+        // unpacking works within lanes, the lanes are put back in order afterwards
+        const auto first{_mm256_unpacklo_epi8(high, low)};
+        const auto second{_mm256_unpackhi_epi8(high, low)};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    _mm256_zeroupper();
+    return i + hex_encode_sse(in + i, size - i, out);
+}
+
+struct utf8_state_avx2
+{
+    __m256i previous;
+    __m256i incomplete;
+    __m256i error;
+};
+
+LPBACKEND_TARGET("avx2") void utf8_block_avx2(utf8_state_avx2 &state, const __m256i input) noexcept
+{
+    if (_mm256_movemask_epi8(input) == 0)
+    {
+        state.error = _mm256_or_si256(state.error, state.incomplete);
+    }
+    else
+    {
+        const auto nibble{_mm256_set1_epi8(0x0f)};
+        // the bytes before each lane, across the lane boundary
+        const auto shifted{_mm256_permute2x128_si256(state.previous, input, 0x21)};
+        const auto prev1{_mm256_alignr_epi8(input, shifted, 15)};
+        const auto byte_1_high{_mm256_shuffle_epi8(broadcast(load_table(utf8_byte_1_high)),
+                                                   _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble))};
+        const auto byte_1_low{
+            _mm256_shuffle_epi8(broadcast(load_table(utf8_byte_1_low)), _mm256_and_si256(prev1, nibble))};
+        const auto byte_2_high{_mm256_shuffle_epi8(broadcast(load_table(utf8_byte_2_high)),
+                                                   _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble))};
+        const auto special{_mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high)};
+
+        const auto prev2{_mm256_alignr_epi8(input, shifted, 14)};
+        const auto prev3{_mm256_alignr_epi8(input, shifted, 13)};
+        const auto third{_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80)))};
+        const auto fourth{_mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)))};
+        const auto must_continue{
+            _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)))};
+        state.error = _mm256_or_si256(state.error, _mm256_xor_si256(must_continue, special));
+        state.incomplete = _mm256_subs_epu8(
+            input, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(utf8_incomplete_thresholds.data())));
+    }
+    state.previous = input;
+}
+
+LPBACKEND_TARGET("avx2") bool validate_utf8_avx2(const char *in, const std::size_t size) noexcept
+{
+    utf8_state_avx2 state{_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    std::size_t i{};
+    for (; i + 32 <= size; i += 32)
+    {
+        utf8_block_avx2(state, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)));
+    }
+    std::array<char, 32> tail{};
+    std::memcpy(tail.data(), in + i, size - i);
+    utf8_block_avx2(state, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tail.data())));
+    if (size - i == 32)
+    {
+        utf8_block_avx2(state, _mm256_setzero_si256());
+    }
+    return _mm256_testz_si256(state.error, state.error);
+}
+
+LPBACKEND_TARGET("avx2") std::size_t find_percent_avx2(const char *in, const std::size_t size) noexcept
+{
+    const auto percent{_mm256_set1_epi8('%')};
+    std::size_t i{};
+    for (; i + 32 <= size; i += 32)
+    {
+        const auto mask{static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)), percent)))};
+        if (mask)
+        {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    _mm256_zeroupper();
+    return i + find_percent_sse(in + i, size - i);
+}
+#endif
+
+#if LPBACKEND_CODEC_NEON
+std::size_t base64_encode_neon(const std::uint8_t *in, const std::size_t size, char *out) noexcept
+{
+    const uint8x16x4_t table{{vld1q_u8(reinterpret_cast<const std::uint8_t *>(base64_digits.data())),
+                              vld1q_u8(reinterpret_cast<const std::uint8_t *>(base64_digits.data()) + 16),
+                              vld1q_u8(reinterpret_cast<const std::uint8_t *>(base64_digits.data()) + 32),
+                              vld1q_u8(reinterpret_cast<const std::uint8_t *>(base64_digits.data()) + 48)}};
+    const auto mask{vdupq_n_u8(0x3f)};
+    std::size_t i{};
+    // 48 bytes are split into their first, second and third bytes by the load
+    for (; i + 48 <= size; i += 48, out += 64)
+    {
+        const auto block{vld3q_u8(in + i)};
+        uint8x16x4_t characters{};
+        characters.val[0] = vqtbl4q_u8(table, vshrq_n_u8(block.val[0], 2));
+        characters.val[1] =
+            vqtbl4q_u8(table, vandq_u8(vorrq_u8(vshlq_n_u8(block.val[0], 4), vshrq_n_u8(block.val[1], 4)), mask));
+        characters.val[2] =
+            vqtbl4q_u8(table, vandq_u8(vorrq_u8(vshlq_n_u8(block.val[1], 2), vshrq_n_u8(block.val[2], 6)), mask));
+        characters.val[3] = vqtbl4q_u8(table, vandq_u8(block.val[2], mask));
+        vst4q_u8(reinterpret_cast<std::uint8_t *>(out), characters);
+    }
+    return i;
+}
+
+std::size_t base64_decode_neon(const char *in, const std::size_t size, std::uint8_t *out) noexcept
+{
+    // the alphabet spans '+' to 'z', which is 80 characters
+    constexpr std::uint8_t first{'+'};
+    const auto *values{base64_values.data() + first};
+    const uint8x16x4_t low_table{{vld1q_u8(values), vld1q_u8(values + 16), vld1q_u8(values + 32),
+                                  vld1q_u8(values + 48)}};
+    const auto high_table{vld1q_u8(values + 64)};
+    std::size_t i{};
+    for (; i + 64 <= size; i += 64, out += 48)
+    {
+        auto block{vld4q_u8(reinterpret_cast<const std::uint8_t *>(in + i))};
+        auto invalid{vdupq_n_u8(0)};
+        for (auto &lane : block.val)
+        {
+            // out of range indices keep 0xff, which marks an invalid character
+            const auto index{vsubq_u8(lane, vdupq_n_u8(first))};
+            auto value{vqtbx4q_u8(vdupq_n_u8(0xff), low_table, index)};
+            value = vqtbx1q_u8(value, high_table, vsubq_u8(index, vdupq_n_u8(64)));
+            invalid = vorrq_u8(invalid, value);
+            lane = value;
+        }
+        if (vmaxvq_u8(invalid) > 63)
+        {
+            break;
+        }
+        uint8x16x3_t bytes{};
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(block.val[0], 2), vshrq_n_u8(block.val[1], 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(block.val[1], 4), vshrq_n_u8(block.val[2], 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(block.val[2], 6), block.val[3]);
+        vst3q_u8(out, bytes);
+    }
+    return i;
+}
+
+std::size_t hex_encode_neon(const std::uint8_t *in, const std::size_t size, char *out) noexcept
+{
+    const auto digits{vld1q_u8(reinterpret_cast<const std::uint8_t *>(hex_digits.data()))};
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16, out += 32)
+    {
+        const auto block{vld1q_u8(in + i)};
+        const uint8x16x2_t characters{
+            {vqtbl1q_u8(digits, vshrq_n_u8(block, 4)), vqtbl1q_u8(digits, vandq_u8(block, vdupq_n_u8(0x0f)))}};
+        vst2q_u8(reinterpret_cast<std::uint8_t *>(out), characters);
+    }
+    return i;
+}
+
+struct utf8_state_neon
+{
+    uint8x16_t previous;
+    uint8x16_t incomplete;
+    uint8x16_t error;
+};
+
+void utf8_block_neon(utf8_state_neon &state, const uint8x16_t input) noexcept
+{
+    if (vmaxvq_u8(input) < 0x80)
+    {
+        state.error = vorrq_u8(state.error, state.incomplete);
+    }
+    else
+    {
+        const auto prev1{vextq_u8(state.previous, input, 15)};
+        const auto byte_1_high{vqtbl1q_u8(vld1q_u8(utf8_byte_1_high.data()), vshrq_n_u8(prev1, 4))};
+        const auto byte_1_low{vqtbl1q_u8(vld1q_u8(utf8_byte_1_low.data()), vandq_u8(prev1, vdupq_n_u8(0x0f)))};
+        const auto byte_2_high{vqtbl1q_u8(vld1q_u8(utf8_byte_2_high.data()), vshrq_n_u8(input, 4))};
+        const auto special{vandq_u8(vandq_u8(byte_1_high, byte_1_low), byte_2_high)};
+
+        const auto prev2{vextq_u8(state.previous, input, 14)};
+        const auto prev3{vextq_u8(state.previous, input, 13)};
+        const auto third{vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80))};
+        const auto fourth{vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80))};
+        const auto must_continue{vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80))};
+        state.error = vorrq_u8(state.error, veorq_u8(must_continue, special));
+        state.incomplete = vqsubq_u8(input, vld1q_u8(utf8_incomplete_thresholds.data() + 16));
+    }
+    state.previous = input;
+}
+
+bool validate_utf8_neon(const char *in, const std::size_t size) noexcept
+{
+    utf8_state_neon state{vdupq_n_u8(0), vdupq_n_u8(0), vdupq_n_u8(0)};
+    const auto *bytes{reinterpret_cast<const std::uint8_t *>(in)};
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16)
+    {
+        utf8_block_neon(state, vld1q_u8(bytes + i));
+    }
+    std::array<std::uint8_t, 16> tail{};
+    std::memcpy(tail.data(), bytes + i, size - i);
+    utf8_block_neon(state, vld1q_u8(tail.data()));
+    if (size - i == 16)
+    {
+        utf8_block_neon(state, vdupq_n_u8(0));
+    }
+    return vmaxvq_u8(state.error) == 0;
+}
+
+std::size_t find_percent_neon(const char *in, const std::size_t size) noexcept
+{
+    const auto percent{vdupq_n_u8('%')};
+    std::size_t i{};
+    for (; i + 16 <= size; i += 16)
+    {
+        if (vmaxvq_u8(vceqq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t *>(in + i)), percent)) != 0)
+        {
+            return i + find_percent_scalar(in + i, 16);
+        }
+    }
+    return i + find_percent_scalar(in + i, size - i);
+}
+#endif
+
+const kernels &active_kernels() noexcept
+{
+    static const kernels selected{[] {
+        // LPBACKEND_CODEC_ISA caps the instruction set, so the tests and the
+        // benchmark can run the same input through the slower kernels
+        const auto *const cap_env{std::getenv("LPBACKEND_CODEC_ISA")};
+        const std::string_view cap{cap_env != nullptr ? cap_env : ""};
+        [[maybe_unused]] const auto allowed{[cap](const std::string_view isa) {
+            return cap.empty() || cap == isa || (cap == "avx2" && isa == "sse4.2");
+        }};
+#if LPBACKEND_CODEC_X86
+        if (allowed("avx2") && cpu_has_avx2())
+        {
+            return kernels{"avx2", base64_encode_avx2, base64_decode_avx2, hex_encode_avx2, validate_utf8_avx2,
+                           find_percent_avx2};
+        }
+        if (allowed("sse4.2") && cpu_has_sse42())
+        {
+            return kernels{"sse4.2", base64_encode_sse, base64_decode_sse, hex_encode_sse, validate_utf8_sse,
+                           find_percent_sse};
+        }
+        return kernels{"scalar", no_bulk_encode, no_bulk_decode, no_bulk_encode, validate_utf8_scalar,
+                       find_percent_scalar};
+#elif LPBACKEND_CODEC_NEON
+        // NEON is part of every AArch64 CPU
+        if (!allowed("neon"))
+        {
+            return kernels{"scalar", no_bulk_encode, no_bulk_decode, no_bulk_encode, validate_utf8_scalar,
+                           find_percent_scalar};
+        }
+        return kernels{"neon", base64_encode_neon, base64_decode_neon, hex_encode_neon, validate_utf8_neon,
+                       find_percent_neon};
+#else
+        return kernels{"scalar", no_bulk_encode, no_bulk_decode, no_bulk_encode, validate_utf8_scalar,
+                       find_percent_scalar};
+#endif
+    }()};
+    return selected;
+}
+} // namespace
+
+std::string_view codec_isa() noexcept
+{
+    return active_kernels().isa;
+}
+
+std::string base64_encode(const std::string_view data)
+{
+    const auto *in{reinterpret_cast<const std::uint8_t *>(data.data())};
+    std::string out((data.size() + 2) / 3 * 4, '\0');
+    auto i{active_kernels().base64_encode(in, data.size(), out.data())};
+    auto *o{out.data() + i / 3 * 4};
+    for (; i + 3 <= data.size(); i += 3)
+    {
+        const std::uint32_t group{static_cast<std::uint32_t>(in[i]) << 16 | static_cast<std::uint32_t>(in[i + 1]) << 8 |
+                                  in[i + 2]};
+        *o++ = base64_digits[group >> 18];
+        *o++ = base64_digits[(group >> 12) & 0x3f];
+        *o++ = base64_digits[(group >> 6) & 0x3f];
+        *o++ = base64_digits[group & 0x3f];
+    }
+    if (const auto rest{data.size() - i}; rest > 0)
+    {
+        const std::uint32_t group{static_cast<std::uint32_t>(in[i]) << 16 |
+                                  (rest == 2 ? static_cast<std::uint32_t>(in[i + 1]) << 8 : 0)};
+        *o++ = base64_digits[group >> 18];
+        *o++ = base64_digits[(group >> 12) & 0x3f];
+        *o++ = rest == 2 ? base64_digits[(group >> 6) & 0x3f] : '=';
+        *o++ = '=';
+    }
+    return out;
+}
+
+std::optional<std::string> base64_decode(const std::string_view text)
+{
+    if (text.size() % 4 != 0)
+    {
+        return std::nullopt;
+    }
+    // room for the stores of the bulk kernels
+    std::string out(text.size() / 4 * 3 + 32, '\0');
+    auto *const begin{reinterpret_cast<std::uint8_t *>(out.data())};
+    auto i{active_kernels().base64_decode(text.data(), text.size(), begin)};
+    auto *o{begin + i / 4 * 3};
+    const auto value{[&text](const std::size_t at) { return base64_values[static_cast<unsigned char>(text[at])]; }};
+    for (; i < text.size(); i += 4)
+    {
+        const bool last{i + 4 == text.size()};
+        const auto a{value(i)};
+        const auto b{value(i + 1)};
+        if ((a | b) > 63)
+        {
+            return std::nullopt;
+        }
+        *o++ = static_cast<std::uint8_t>(a << 2 | b >> 4);
+        if (last && text[i + 2] == '=' && text[i + 3] == '=')
+        {
+            break;
+        }
+        const auto c{value(i + 2)};
+        if (c > 63)
+        {
+            return std::nullopt;
+        }
+        *o++ = static_cast<std::uint8_t>(b << 4 | c >> 2);
+        if (last && text[i + 3] == '=')
+        {
+            break;
+        }
+        const auto d{value(i + 3)};
+        if (d > 63)
+        {
+            return std::nullopt;
+        }
+        *o++ = static_cast<std::uint8_t>(c << 6 | d);
+    }
+    out.resize(static_cast<std::size_t>(o - begin));
+    return out;
+}
+
+std::string hex_encode(const std::string_view data)
+{
+    const auto *in{reinterpret_cast<const std::uint8_t *>(data.data())};
+    std::string out(data.size() * 2, '\0');
+    for (auto i{active_kernels().hex_encode(in, data.size(), out.data())}; i < data.size(); ++i)
+    {
+        out[2 * i] = hex_digits[in[i] >> 4];
+        out[2 * i + 1] = hex_digits[in[i] & 0x0f];
+    }
+    return out;
+}
+
+std::optional<std::string> hex_decode(const std::string_view text)
+{
+    if (text.size() % 2 != 0)
+    {
+        return std::nullopt;
+    }
+    std::string out(text.size() / 2, '\0');
+    for (std::size_t i{}; i < out.size(); ++i)
+    {
+        const auto high{hex_values[static_cast<unsigned char>(text[2 * i])]};
+        const auto low{hex_values[static_cast<unsigned char>(text[2 * i + 1])]};
+        if ((high | low) > 15)
+        {
+            return std::nullopt;
+        }
+        out[i] = static_cast<char>(high << 4 | low);
+    }
+    return out;
+}
+
+bool is_valid_utf8(const std::string_view text) noexcept
+{
+    return active_kernels().validate_utf8(text.data(), text.size());
+}
+
+std::optional<std::string> percent_decode(const std::string_view text)
+{
+    const auto &k{active_kernels()};
+    std::string out{};
+    out.reserve(text.size());
+    std::size_t i{};
+    while (i < text.size())
+    {
+        const auto found{i + k.find_percent(text.data() + i, text.size() - i)};
+        out.append(text.data() + i, found - i);
+        if (found == text.size())
+        {
+            break;
+        }
+        if (found + 3 > text.size())
+        {
+            return std::nullopt;
+        }
+        const auto high{hex_values[static_cast<unsigned char>(text[found + 1])]};
+        const auto low{hex_values[static_cast<unsigned char>(text[found + 2])]};
+        if ((high | low) > 15)
+        {
+            return std::nullopt;
+        }
+        out.push_back(static_cast<char>(high << 4 | low));
+        i = found + 3;
+    }
+    return out;
+}
+
+std::optional<std::string> normalize_path(const std::string_view target)
+{
+    const auto decoded{percent_decode(target.substr(0, target.find('?')))};
+    if (!decoded || decoded->empty() || decoded->front() != '/' || decoded->find('\0') != std::string::npos ||
+        decoded->find('\\') != std::string::npos)
+    {
+        return std::nullopt;
+    }
+
+    // segments are appended as "/name", ".." removes the last one
+    const std::string_view path{*decoded};
+    std::string out{};
+    out.reserve(path.size());
+    for (std::size_t position{1}; position <= path.size();)
+    {
+        auto end{path.find('/', position)};
+        if (end == std::string_view::npos)
+        {
+            end = path.size();
+        }
+        const auto segment{path.substr(position, end - position)};
+        if (segment == "..")
+        {
+            if (out.empty())
+            {
+                return std::nullopt;
+            }
+            out.resize(out.rfind('/'));
+        }
+        else if (!segment.empty() && segment != ".")
+        {
+            out.push_back('/');
+            out.append(segment);
+        }
+        position = end + 1;
+    }
+
+    // a path naming a directory keeps its trailing slash
+    const auto last{path.substr(path.rfind('/') + 1)};
+    if (out.empty() || last.empty() || last == "." || last == "..")
+    {
+        out.push_back('/');
+    }
+    return out;
+}
+} // namespace lpbackend::util
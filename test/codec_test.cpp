@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BOOST_TEST_MODULE codec
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <lpbackend/util/codec.hpp>
+
+// The SIMD kernels only take whole blocks and leave the rest to the scalar
+// code, so every codec is compared with a plain byte-by-byte reference on
+// lengths around the block sizes of every instruction set.
+
+namespace
+{
+constexpr std::string_view base64_alphabet{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+
+std::string reference_base64_encode(const std::string_view data)
+{
+    std::string out{};
+    std::size_t i{};
+    for (; i + 3 <= data.size(); i += 3)
+    {
+        const auto v{static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[i])) << 16 |
+                     static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[i + 1])) << 8 |
+                     static_cast<std::uint8_t>(data[i + 2])};
+        for (int shift{18}; shift >= 0; shift -= 6)
+        {
+            out.push_back(base64_alphabet[(v >> shift) & 63]);
+        }
+    }
+    if (const auto rest{data.size() - i}; rest > 0)
+    {
+        auto v{static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[i])) << 16};
+        if (rest == 2)
+        {
+            v |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[i + 1])) << 8;
+        }
+        out.push_back(base64_alphabet[(v >> 18) & 63]);
+        out.push_back(base64_alphabet[(v >> 12) & 63]);
+        out.push_back(rest == 2 ? base64_alphabet[(v >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+std::string reference_hex_encode(const std::string_view data)
+{
+    constexpr std::string_view digits{"0123456789abcdef"};
+    std::string out{};
+    for (const auto c : data)
+    {
+        out.push_back(digits[static_cast<std::uint8_t>(c) >> 4]);
+        out.push_back(digits[static_cast<std::uint8_t>(c) & 15]);
+    }
+    return out;
+}
+
+bool reference_is_valid_utf8(const std::string_view text)
+{
+    const auto *in{reinterpret_cast<const std::uint8_t *>(text.data())};
+    for (std::size_t i{}; i < text.size();)
+    {
+        const auto lead{in[i]};
+        std::size_t length{};
+        std::uint32_t code_point{};
+        std::uint32_t minimum{};
+        if (lead < 0x80)
+        {
+            ++i;
+            continue;
+        }
+        if (lead >= 0xc2 && lead <= 0xdf)
+        {
+            length = 2;
+            code_point = lead & 0x1f;
+            minimum = 0x80;
+        }
+        else if ((lead & 0xf0) == 0xe0)
+        {
+            length = 3;
+            code_point = lead & 0x0f;
+            minimum = 0x800;
+        }
+        else if (lead >= 0xf0 && lead <= 0xf4)
+        {
+            length = 4;
+            code_point = lead & 0x07;
+            minimum = 0x10000;
+        }
+        else
+        {
+            return false;
+        }
+        if (text.size() - i < length)
+        {
+            return false;
+        }
+        for (std::size_t k{1}; k < length; ++k)
+        {
+            if ((in[i + k] & 0xc0) != 0x80)
+            {
+                return false;
+            }
+            code_point = code_point << 6 | (in[i + k] & 0x3f);
+        }
+        if (code_point < minimum || code_point > 0x10ffff || (code_point >= 0xd800 && code_point <= 0xdfff))
+        {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+std::string random_bytes(std::mt19937 &random, const std::size_t size)
+{
+    std::string out(size, '\0');
+    for (auto &c : out)
+    {
+        c = static_cast<char>(random());
+    }
+    return out;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(reports_isa)
+{
+    BOOST_TEST_MESSAGE("codecs run on " << lpbackend::util::codec_isa());
+    BOOST_TEST(!lpbackend::util::codec_isa().empty());
+}
+
+BOOST_AUTO_TEST_CASE(base64_matches_reference)
+{
+    std::mt19937 random{1};
+    for (std::size_t size{}; size < 300; ++size)
+    {
+        const auto data{random_bytes(random, size)};
+        const auto encoded{lpbackend::util::base64_encode(data)};
+        BOOST_TEST(encoded == reference_base64_encode(data));
+        const auto decoded{lpbackend::util::base64_decode(encoded)};
+        BOOST_TEST_REQUIRE(decoded.has_value());
+        BOOST_TEST(*decoded == data);
+    }
+    BOOST_TEST(lpbackend::util::base64_encode("") == "");
+    BOOST_TEST(lpbackend::util::base64_encode("f") == "Zg==");
+    BOOST_TEST(lpbackend::util::base64_encode("fo") == "Zm8=");
+    BOOST_TEST(lpbackend::util::base64_encode("foo") == "Zm9v");
+}
+
+BOOST_AUTO_TEST_CASE(base64_rejects_malformed_input)
+{
+    BOOST_TEST(!lpbackend::util::base64_decode("Zg=").has_value());
+    BOOST_TEST(!lpbackend::util::base64_decode("Z===").has_value());
+    BOOST_TEST(!lpbackend::util::base64_decode("Zg==Zg==").has_value());
+
+    // a bad character anywhere, including inside the blocks the kernels take
+    std::mt19937 random{2};
+    for (std::size_t size{1}; size < 200; ++size)
+    {
+        auto encoded{lpbackend::util::base64_encode(random_bytes(random, size))};
+        for (const auto bad : std::string_view{"!-_ \xff\n."})
+        {
+            auto corrupted{encoded};
+            corrupted[random() % corrupted.size()] = bad;
+            BOOST_TEST(!lpbackend::util::base64_decode(corrupted).has_value());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hex_matches_reference)
+{
+    std::mt19937 random{3};
+    for (std::size_t size{}; size < 200; ++size)
+    {
+        const auto data{random_bytes(random, size)};
+        const auto encoded{lpbackend::util::hex_encode(data)};
+        BOOST_TEST(encoded == reference_hex_encode(data));
+        const auto decoded{lpbackend::util::hex_decode(encoded)};
+        BOOST_TEST_REQUIRE(decoded.has_value());
+        BOOST_TEST(*decoded == data);
+    }
+    BOOST_TEST(*lpbackend::util::hex_decode("DEADbeef") == "\xde\xad\xbe\xef");
+    BOOST_TEST(!lpbackend::util::hex_decode("abc").has_value());
+    BOOST_TEST(!lpbackend::util::hex_decode("0g").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(utf8_matches_reference)
+{
+    // valid sequences of every length and the classic malformed ones
+    constexpr std::string_view valid[]{"a", "\xc3\xa9", "\xe4\xb8\xad", "\xf0\x9f\x98\x80"};
+    constexpr std::string_view invalid[]{"\x80",         "\xc0\xaf",         "\xed\xa0\x80", "\xf4\x90\x80\x80",
+                                         "\xe0\x80\xaf", "\xf0\x80\x80\x80", "\xc3",         "\xe4\xb8",
+                                         "\xff",         "\xf5"};
+    std::mt19937 random{4};
+    for (int round{}; round < 20000; ++round)
+    {
+        std::string text{};
+        const auto pieces{random() % 120};
+        for (std::size_t i{}; i < pieces; ++i)
+        {
+            text.append(random() % 100 < 95 ? valid[random() % std::size(valid)]
+                                            : invalid[random() % std::size(invalid)]);
+        }
+        BOOST_TEST(lpbackend::util::is_valid_utf8(text) == reference_is_valid_utf8(text));
+
+        const auto bytes{random_bytes(random, random() % 80)};
+        BOOST_TEST(lpbackend::util::is_valid_utf8(bytes) == reference_is_valid_utf8(bytes));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(percent_decode_and_normalize_path)
+{
+    BOOST_TEST(*lpbackend::util::percent_decode("a%20b+c") == "a b+c");
+    BOOST_TEST(!lpbackend::util::percent_decode("%2").has_value());
+    BOOST_TEST(!lpbackend::util::percent_decode("%zz").has_value());
+
+    // escapes beyond the first block of the kernels
+    const std::string plain(100, 'x');
+    BOOST_TEST(*lpbackend::util::percent_decode(plain + "%41" + plain) == plain + "A" + plain);
+
+    const auto normalized{[](const std::string_view target) {
+        return lpbackend::util::normalize_path(target).value_or("<rejected>");
+    }};
+    BOOST_TEST(normalized("/") == "/");
+    BOOST_TEST(normalized("/a/./b") == "/a/b");
+    BOOST_TEST(normalized("/a/../b") == "/b");
+    BOOST_TEST(normalized("/a//b/") == "/a/b/");
+    BOOST_TEST(normalized("/a/b?x=../..") == "/a/b");
+    BOOST_TEST(normalized("/%E4%B8%AD.html") == "/\xe4\xb8\xad.html");
+    BOOST_TEST(normalized("/..") == "<rejected>");
+    BOOST_TEST(normalized("/%2e%2e/x") == "<rejected>");
+    BOOST_TEST(normalized("/a%2f..%2f..") == "<rejected>");
+    BOOST_TEST(normalized("/x%00") == "<rejected>");
+    BOOST_TEST(normalized("/x\\y") == "<rejected>");
+    BOOST_TEST(normalized("a") == "<rejected>");
+}
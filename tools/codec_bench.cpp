@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include <lpbackend/util/codec.hpp>
+
+namespace
+{
+volatile std::size_t sink{};
+
+// Runs f over and over for about 200 ms and prints the throughput in MB/s
+template <typename F> void measure(const std::string_view name, const std::size_t size, F &&f)
+{
+    using clock = std::chrono::steady_clock;
+    std::size_t rounds{};
+    const auto start{clock::now()};
+    auto elapsed{clock::duration{}};
+    do
+    {
+        for (int i{}; i < 64; ++i)
+        {
+            sink = sink + f();
+        }
+        rounds += 64;
+        elapsed = clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds{200});
+    const auto seconds{std::chrono::duration<double>(elapsed).count()};
+    fmt::print("{:<16}{:>10}{:>12.1f}\n", name, size, static_cast<double>(size * rounds) / seconds / 1e6);
+}
+} // namespace
+
+// Measures the throughput of the codecs on the kernels chosen for this CPU.
+// Run it again with LPBACKEND_CODEC_ISA=scalar to compare with the scalar code.
+int main()
+{
+    fmt::print("isa: {}\n{:<16}{:>10}{:>12}\n", lpbackend::util::codec_isa(), "codec", "bytes", "MB/s");
+    std::mt19937 random{1};
+    for (const std::size_t size : {64, 1024, 65536, 1048576})
+    {
+        std::string bytes(size, '\0');
+        for (auto &c : bytes)
+        {
+            c = static_cast<char>(random());
+        }
+        std::string text{};
+        while (text.size() < size)
+        {
+            // mostly ASCII with some multi-byte characters, like forum posts
+            text.append(random() % 8 == 0 ? "\xe4\xb8\xad" : "abcdefgh");
+        }
+        text.resize(size);
+        while (!lpbackend::util::is_valid_utf8(text))
+        {
+            text.pop_back();
+        }
+        const auto base64{lpbackend::util::base64_encode(bytes)};
+        const auto hex{lpbackend::util::hex_encode(bytes)};
+        const auto path{"/" + std::string(size - 1, 'a')};
+
+        measure("base64_encode", size, [&] { return lpbackend::util::base64_encode(bytes).size(); });
+        measure("base64_decode", base64.size(), [&] { return lpbackend::util::base64_decode(base64)->size(); });
+        measure("hex_encode", size, [&] { return lpbackend::util::hex_encode(bytes).size(); });
+        measure("hex_decode", hex.size(), [&] { return lpbackend::util::hex_decode(hex)->size(); });
+        measure("is_valid_utf8", text.size(), [&] { return std::size_t{lpbackend::util::is_valid_utf8(text)}; });
+        measure("normalize_path", path.size(), [&] { return lpbackend::util::normalize_path(path)->size(); });
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+#include <boost/nowide/args.hpp>
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+
+#include <lpbackend/log.hpp>
+#include <lpbackend/networking/asset_bundle.hpp>
+#include <lpbackend/networking/mime_database.hpp>
+
+// Packs a directory into an asset bundle for http.asset_bundle. The output
+// is replaced atomically, so it can be written over the bundle of a
+// running server.
+int main(int argc, char *argv[])
+{
+    lpbackend::log::initialize_logging_system();
+    logger lg{channel_logger("pack")};
+
+    boost::program_options::options_description desc{"LPBackend Asset Packer"};
+    desc.add_options()("help", "Show the help")(
+        "input", boost::program_options::value<std::filesystem::path>()->required(), "Directory to pack")(
+        "output", boost::program_options::value<std::filesystem::path>()->required(), "Bundle to write");
+    boost::program_options::positional_options_description positional{};
+    positional.add("input", 1).add("output", 1);
+    boost::program_options::variables_map vm{};
+    try
+    {
+        boost::nowide::args _{argc, argv};
+        store(boost::program_options::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+        if (vm.contains("help"))
+        {
+            std::cerr << "Usage: lpbackend-pack <input> <output>\n" << desc << std::endl;
+            return 1;
+        }
+        notify(vm);
+    }
+    catch (const std::exception &e)
+    {
+        LPBACKEND_LOG(lg, fatal) << "Failed to parse command line: " << e.what();
+        return 1;
+    }
+
+    const auto &input{vm["input"].as<std::filesystem::path>()};
+    const auto &output{vm["output"].as<std::filesystem::path>()};
+    try
+    {
+        // only the built-in MIME types are used, the database is not updated
+        lpbackend::networking::mime_database db{};
+        const auto entries{lpbackend::networking::asset_bundle::pack(input, output, db)};
+        const auto bundle{lpbackend::networking::asset_bundle::open(output)};
+        LPBACKEND_LOG(lg, info) << fmt::format("Packed {} files of {} into {} ({} bytes)", entries, input.string(),
+                                               output.string(), bundle->mapped_bytes());
+    }
+    catch (const std::exception &e)
+    {
+        LPBACKEND_LOG(lg, fatal) << "Failed to pack assets: " << e.what();
+        return 1;
+    }
+    return 0;
+}
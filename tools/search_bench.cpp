@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2025 Laptis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/nowide/args.hpp>
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+
+#include <lpbackend/log.hpp>
+#include <lpbackend/search/full_text_index.hpp>
+
+namespace
+{
+// queries by the frequency of their terms, w0 occurs in most documents and w40000 in few
+constexpr std::string_view queries[]{"w0",      "w0 w1",           "w1 w2 w3",  "w3 w7",
+                                     "w5 w100", "w10 w20 w30 w40", "w0 w4000",  "w100 w200",
+                                     "w40000",  "w12 w13 w14 w15", "w20000 w1", "w2000 w3000"};
+} // namespace
+
+// Builds a full-text index of synthetic documents with Zipf-distributed
+// words and prints the latency of queries of common and rare terms.
+int main(int argc, char *argv[])
+{
+    lpbackend::log::initialize_logging_system();
+    logger lg{channel_logger("search_bench")};
+
+    boost::program_options::options_description desc{"LPBackend Search Benchmark"};
+    desc.add_options()("help", "Show the help")(
+        "directory", boost::program_options::value<std::filesystem::path>()->required(),
+        "Directory of the index, emptied first")(
+        "documents", boost::program_options::value<std::uint64_t>()->default_value(2000000), "Documents to index")(
+        "words", boost::program_options::value<std::uint64_t>()->default_value(40), "Words per document")(
+        "rounds", boost::program_options::value<std::uint64_t>()->default_value(20), "Runs of every query");
+    boost::program_options::variables_map vm{};
+    try
+    {
+        boost::nowide::args _{argc, argv};
+        store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+        if (vm.contains("help"))
+        {
+            std::cerr << "Usage: lpbackend-search-bench --directory <path>\n" << desc << std::endl;
+            return 1;
+        }
+        notify(vm);
+    }
+    catch (const std::exception &e)
+    {
+        LPBACKEND_LOG(lg, fatal) << "Failed to parse command line: " << e.what();
+        return 1;
+    }
+
+    try
+    {
+        lpbackend::config::lpbackend_config::fields_t::search_t config{};
+        config.directory = vm["directory"].as<std::filesystem::path>();
+        std::filesystem::remove_all(config.directory);
+        lpbackend::search::full_text_index index{};
+        index.open(config);
+
+        constexpr std::size_t vocabulary{50000};
+        std::vector<std::string> words(vocabulary);
+        std::vector<double> weights(vocabulary);
+        for (std::size_t i{}; i < vocabulary; ++i)
+        {
+            words[i] = fmt::format("w{}", i);
+            weights[i] = 1.0 / static_cast<double>(i + 1);
+        }
+        std::mt19937 random{1};
+        std::discrete_distribution<std::size_t> zipf{weights.begin(), weights.end()};
+
+        const auto documents{vm["documents"].as<std::uint64_t>()};
+        const auto started{std::chrono::steady_clock::now()};
+        std::string body{};
+        for (std::uint64_t id{}; id < documents; ++id)
+        {
+            body.clear();
+            for (std::uint64_t i{}; i < vm["words"].as<std::uint64_t>(); ++i)
+            {
+                body.append(words[zipf(random)]).push_back(' ');
+            }
+            index.add(id, words[zipf(random)], body);
+        }
+        // merges run in the background, wait until they are done
+        for (auto segments{index.collect().segments}; segments > config.max_segments + 1;
+             segments = index.collect().segments)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        }
+        const auto built{std::chrono::steady_clock::now() - started};
+        const auto totals{index.collect()};
+        fmt::print("indexed {} documents into {} segments in {:.1f}s\n", totals.documents, totals.segments,
+                   std::chrono::duration<double>(built).count());
+
+        fmt::print("{:<20}{:>8}{:>12}{:>12}\n", "query", "hits", "median ms", "max ms");
+        const auto rounds{std::max<std::uint64_t>(vm["rounds"].as<std::uint64_t>(), 1)};
+        for (const auto query : queries)
+        {
+            std::vector<double> latencies{};
+            std::size_t hits{};
+            for (std::uint64_t round{}; round < rounds; ++round)
+            {
+                const auto begin{std::chrono::steady_clock::now()};
+                hits = index.search(query, 20).size();
+                latencies.push_back(
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+            }
+            std::ranges::sort(latencies);
+            fmt::print("{:<20}{:>8}{:>12.2f}{:>12.2f}\n", query, hits, latencies[latencies.size() / 2],
+                       latencies.back());
+        }
+        index.close();
+    }
+    catch (const std::exception &e)
+    {
+        LPBACKEND_LOG(lg, fatal) << "Benchmark failed: " << e.what();
+        return 1;
+    }
+    return 0;
+}